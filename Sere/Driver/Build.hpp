@@ -0,0 +1,560 @@
+#ifndef DRIVER_BUILD_HPP
+#define DRIVER_BUILD_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <stdexcept>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+
+#include "../Parser/AST/Midlevel/ModuleInterface.hpp"
+#include "./Options.hpp"
+#include "./Pipeline.hpp"
+#include "./Session.hpp"
+#include "./InterfaceFile.hpp"
+#include "./ThinLTO.hpp"
+#include "./Profile.hpp"
+#include "./WorkStealingPool.hpp"
+
+//
+// `sere build`: resolves the entry file's imports into a module DAG, compiles
+// each module to its own object on a work-stealing pool (a module starts as
+// soon as the modules it imports are done), and links them with a generated
+// startup object. A module is recompiled only when its source, the options
+// or the interface of something it imports changed; a module whose source is
+// unchanged is not even parsed, its .serei stands in for it.
+//
+namespace SereDriver {
+
+    struct BuildModule {
+        std::string name;                     // dotted import name; the entry uses its file stem
+        std::string path;
+        std::string init_name;
+        std::vector<size_t> imports;          // indices of directly imported modules
+        std::vector<size_t> dependents;       // indices of modules importing this one
+        Runtime::ModuleInterface iface;
+        std::vector<Runtime::FunctionSignature> definitions;
+        std::unique_ptr<Session> session;     // parsed statements; null while the .serei is current
+        std::string object_path;              // .o, or ThinLTO bitcode with --emit=bc
+        std::string interface_path;
+        std::string source_key;               // source + options
+        std::string stamp;                    // source_key + imported interfaces
+        std::string previous_stamp;           // from the .serei, when its source_key matches
+        bool planned = false;
+        bool up_to_date = false;
+
+        // Scheduling state
+        std::atomic<unsigned> pending{0};     // imports not finished yet
+        std::atomic<bool> blocked{false};     // an import failed
+        bool failed = false;
+        bool compiled = false;
+        std::string diagnostics;
+    };
+
+    inline std::string read_text_file(const std::string &path)
+    {
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        return buffer ? (*buffer)->getBuffer().str() : std::string();
+    }
+
+    inline bool write_file(const std::string &path, llvm::StringRef bytes)
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream file(path, ec, llvm::sys::fs::OF_None);
+        if (ec) return false;
+        file << bytes;
+        return true;
+    }
+
+    inline std::string sha1_hex(const std::string &text)
+    {
+        llvm::SHA1 sha;
+        sha.update(text);
+        return llvm::toHex(sha.final(), /*LowerCase=*/true);
+    }
+
+    class Builder
+    {
+    public:
+        explicit Builder(const Options &opts) : opts_(opts) {}
+
+        int build(llvm::raw_ostream &err)
+        {
+            if (auto ec = llvm::sys::fs::create_directories(opts_.build_dir)) {
+                err << "Cannot create build directory '" << opts_.build_dir << "': " << ec.message() << "\n";
+                return 73;
+            }
+
+            pgo_key_ = pgo_key(opts_);
+            target_key_ = resolve_target_cpu(opts_.march).key();
+            plan(path_stem(opts_.input), opts_.input, "__init__", {});
+            check_symbols();
+
+            schedule();
+
+            unsigned compiled = 0, failed = 0, parsed = 0;
+            for (size_t i : order_) {
+                const BuildModule &mod = *modules_[i];
+                if (!mod.diagnostics.empty())
+                    err << mod.diagnostics;
+                if (mod.failed) ++failed;
+                if (mod.compiled) ++compiled;
+                if (mod.session) ++parsed;
+            }
+            if (failed) {
+                err << "sere: build failed: " << failed << " of " << order_.size() << " module"
+                    << (order_.size() == 1 ? "" : "s") << " did not compile\n";
+                return 1;
+            }
+
+            bool linked = false;
+            int rc = link(err, linked);
+            if (rc != 0) return rc;
+
+            err << "sere: " << executable_path() << ": " << compiled << " compiled, "
+                << (order_.size() - compiled) << " up to date, " << parsed << " parsed"
+                << (linked ? "" : ", link skipped") << "\n";
+            return 0;
+        }
+
+    private:
+        bool thin_lto() const { return opts_.emit == EmitKind::BC; }
+
+        std::string thinlto_cache_dir() const
+        {
+            return opts_.thinlto_cache_dir.empty() ? build_path("thinlto-cache") : opts_.thinlto_cache_dir;
+        }
+
+        std::string executable_path() const
+        {
+            return opts_.output.empty() ? default_output_path(opts_) : opts_.output;
+        }
+
+        std::string build_path(const std::string &file) const
+        {
+            llvm::SmallString<256> path(opts_.build_dir);
+            llvm::sys::path::append(path, file);
+            return std::string(path.str());
+        }
+
+        // "a.b" -> "<root>/a/b.sere" for the entry's directory, then each -I root.
+        std::string resolve(const std::string &module_name, const std::string &importer) const
+        {
+            std::string relative = module_name;
+            for (char &c : relative)
+                if (c == '.') c = '/';
+            relative += ".sere";
+
+            std::vector<std::string> roots;
+            llvm::StringRef entry_dir = llvm::sys::path::parent_path(opts_.input);
+            roots.push_back(entry_dir.empty() ? "." : entry_dir.str());
+            roots.insert(roots.end(), opts_.include_dirs.begin(), opts_.include_dirs.end());
+
+            for (const auto &root : roots) {
+                llvm::SmallString<256> candidate(root);
+                llvm::sys::path::append(candidate, relative);
+                if (llvm::sys::fs::exists(candidate))
+                    return std::string(candidate.str());
+            }
+            throw std::runtime_error("Cannot find module '" + module_name + "' imported by '" + importer + "'.");
+        }
+
+        Options module_options(const BuildModule &mod) const
+        {
+            Options module_opts = opts_;
+            module_opts.command = Command::COMPILE;
+            module_opts.emit = thin_lto() ? EmitKind::BC : EmitKind::OBJ;
+            module_opts.input = mod.path;
+            module_opts.output = mod.object_path;
+            return module_opts;
+        }
+
+        // Depth-first: reads the module's imports, then plans each of them.
+        // Modules land in `order_` after their imports (a topological order).
+        size_t plan(const std::string &name, const std::string &path, const std::string &init_name,
+                    std::vector<std::string> stack)
+        {
+            auto seen = index_.find(name);
+            if (seen != index_.end()) {
+                if (!modules_[seen->second]->planned) {
+                    std::string cycle;
+                    for (auto it = std::find(stack.begin(), stack.end(), name); it != stack.end(); ++it)
+                        cycle += *it + " -> ";
+                    throw std::runtime_error("Import cycle: " + cycle + name);
+                }
+                return seen->second;
+            }
+
+            size_t index = modules_.size();
+            modules_.push_back(std::make_unique<BuildModule>());
+            index_[name] = index;
+            stack.push_back(name);
+
+            BuildModule &mod = *modules_[index];
+            mod.name = name;
+            mod.path = path;
+            mod.init_name = init_name;
+            mod.object_path = build_path(name + (thin_lto() ? ".bc" : ".o"));
+            mod.interface_path = build_path(name + ".serei");
+
+            auto source = llvm::MemoryBuffer::getFile(path);
+            if (!source)
+                throw std::runtime_error("Cannot read module '" + name + "' (" + path + "): " + source.getError().message());
+            mod.source_key = sha1_hex(SERE_COMPILER_VERSION " llvm-" LLVM_VERSION_STRING "\n" +
+                                      std::to_string(opts_.opt_level) + (thin_lto() ? " bc" : " obj") + (opts_.checked_arith ? " checked" : "") + "\n" + pgo_key_ + "\n" + target_key_ + "\n" + name + "\n" + init_name + "\n" +
+                                      (*source)->getBuffer().str());
+
+            std::vector<std::string> import_names;
+            auto cached = load_interface_file(mod.interface_path);
+            if (cached && cached->source_key == mod.source_key) {
+                import_names = std::move(cached->imports);
+                mod.iface = std::move(cached->iface);
+                mod.definitions = std::move(cached->definitions);
+                mod.previous_stamp = std::move(cached->stamp);
+            } else {
+                parse_module(mod);
+                import_names = imports_of(mod.session->statements());
+            }
+
+            std::vector<size_t> imports;
+            for (const auto &import : import_names) {
+                size_t dep = plan(import, resolve(import, name), Runtime::init_symbol_for(import), stack);
+                if (std::find(imports.begin(), imports.end(), dep) == imports.end())
+                    imports.push_back(dep);
+            }
+
+            mod.imports = std::move(imports);
+            for (size_t dep : mod.imports)
+                modules_[dep]->dependents.push_back(index);
+            mod.planned = true;
+            order_.push_back(index);
+            return index;
+        }
+
+        // Parses the module and derives its interface from the AST.
+        void parse_module(BuildModule &mod) const
+        {
+            auto session = std::make_unique<Session>(module_options(mod));
+            if (!session->parse())
+                throw std::runtime_error("Failed to parse module '" + mod.name + "' (" + mod.path + ").");
+
+            mod.iface = Runtime::ModuleInterface();
+            mod.iface.name = mod.name;
+            mod.iface.init_name = mod.init_name;
+            mod.definitions.clear();
+            for (const auto &stat : session->statements()) {
+                auto fn = dynamic_cast<const SereParser::FunctionStatAST *>(stat.get());
+                if (!fn) continue;
+                Runtime::FunctionSignature sig = signature_of(*fn);
+                // Nothing imports the entry module, so it exports nothing. Generic
+                // functions are specialized per call site and stay module-local.
+                if (!is_entry(mod) && Runtime::is_exported_name(fn->name.lexeme) && !fn->is_generic())
+                    mod.iface.functions.push_back(sig);
+                if (fn->name.lexeme == "main")
+                    sig.name = "__main__";
+                mod.definitions.push_back(std::move(sig));
+            }
+            mod.session = std::move(session);
+        }
+
+        static bool is_entry(const BuildModule &mod)
+        {
+            return mod.init_name == "__init__";
+        }
+
+        static std::vector<std::string> imports_of(const std::vector<std::shared_ptr<SereParser::StatAST>> &stats)
+        {
+            std::vector<std::string> names;
+            for (const auto &stat : stats)
+                if (auto import = dynamic_cast<const SereParser::ImportStatAST *>(stat.get()))
+                    names.push_back(import->module_name);
+            return names;
+        }
+
+        static Runtime::FunctionSignature signature_of(const SereParser::FunctionStatAST &fn)
+        {
+            Runtime::FunctionSignature sig;
+            sig.name = fn.name.lexeme;
+            bool generic = false;
+            for (const auto &param : fn.params) {
+                generic |= !param->type_annotation;
+                sig.param_types.push_back(param->type_annotation ? param->type_annotation->name.lexeme : "?");
+            }
+            sig.return_type = fn.type_annotation ? fn.type_annotation->name.lexeme : generic ? "?" : "none";
+            return sig;
+        }
+
+        // Exported functions share one symbol namespace; catch clashes before the
+        // linker does. Private, generic and entry-module functions are internal.
+        void check_symbols() const
+        {
+            std::unordered_map<std::string, std::string> owner;
+            for (size_t i : order_) {
+                const BuildModule &mod = *modules_[i];
+                for (const auto &sig : mod.iface.functions) {
+                    auto [it, inserted] = owner.emplace(sig.name, mod.name);
+                    if (!inserted)
+                        throw std::runtime_error("Function '" + sig.name + "' is defined in both '" + it->second +
+                                                 "' and '" + mod.name + "'.");
+                }
+            }
+        }
+
+        // What the module's object depends on: its source and options, plus the
+        // interfaces of its imports (signatures and inlinable bodies, no other
+        // bodies). Runs once the imports are built.
+        void compute_stamp(BuildModule &mod) const
+        {
+            std::string key = mod.source_key + "\n";
+            for (size_t dep : mod.imports)
+                key += modules_[dep]->iface.fingerprint();
+            mod.stamp = sha1_hex(key);
+            mod.up_to_date = !mod.previous_stamp.empty() && mod.previous_stamp == mod.stamp &&
+                             llvm::sys::fs::exists(mod.object_path);
+        }
+
+        void schedule()
+        {
+            unsigned jobs = opts_.jobs ? opts_.jobs : std::max(1u, std::thread::hardware_concurrency());
+            WorkStealingPool pool(std::min<unsigned>(jobs, static_cast<unsigned>(order_.size())));
+
+            std::function<void(size_t)> run_module = [&](size_t index) {
+                BuildModule &mod = *modules_[index];
+                if (mod.blocked.load()) {
+                    mod.failed = true;
+                    mod.diagnostics = "sere: " + mod.name + ": skipped, an imported module failed\n";
+                } else {
+                    compute_stamp(mod);
+                    if (!mod.up_to_date)
+                        compile_module(mod);
+                }
+                for (size_t dependent : mod.dependents) {
+                    BuildModule &next = *modules_[dependent];
+                    if (mod.failed) next.blocked.store(true);
+                    if (next.pending.fetch_sub(1) == 1)
+                        pool.submit([&run_module, dependent] { run_module(dependent); });
+                }
+            };
+
+            for (size_t i : order_)
+                modules_[i]->pending.store(static_cast<unsigned>(modules_[i]->imports.size()));
+            for (size_t i : order_)
+                if (modules_[i]->imports.empty())
+                    pool.submit([&run_module, i] { run_module(i); });
+            pool.wait_idle();
+        }
+
+        // Runs on a pool worker, which has its own RT::ctx and LLVMContext.
+        void compile_module(BuildModule &mod)
+        {
+            std::string err_buf;
+            llvm::raw_string_ostream err(err_buf);
+            int rc = 0;
+            try {
+                if (!mod.session)
+                    parse_module(mod); // the .serei was current but an import's interface changed
+
+                SereParser::RT::interfaces.clear();
+                for (size_t dep : mod.imports)
+                    SereParser::RT::interfaces[modules_[dep]->name] = modules_[dep]->iface;
+
+                mod.session->lower_parsed(mod.name, mod.init_name, /*exports=*/!is_entry(mod));
+                // Inlined copies would count into the importer's profile, not the callee's
+                if (!opts_.pgo_instrument)
+                    mod.iface.inline_bitcode = extract_inline_bodies(*SereParser::RT::ctx.get_module(), mod.iface,
+                                                                     opts_.opt_level, err);
+                std::string ignored;
+                llvm::raw_string_ostream out(ignored);
+                rc = mod.session->emit_lowered(out, err);
+                for (auto &sig : mod.iface.functions)
+                    sig.effects = mod.session->effects_of(SereParser::_sanitize_name_impl_(sig.name));
+            } catch (const std::exception &e) {
+                err << "Error: " << e.what() << "\n";
+                rc = 1;
+            }
+
+            if (rc == 0) {
+                InterfaceFile file;
+                file.source_key = mod.source_key;
+                file.stamp = mod.stamp;
+                for (size_t dep : mod.imports)
+                    file.imports.push_back(modules_[dep]->name);
+                file.definitions = mod.definitions;
+                file.iface = mod.iface;
+                if (!write_file(mod.interface_path, serialize_interface(file))) {
+                    err << "Cannot write '" << mod.interface_path << "'\n";
+                    rc = 73;
+                }
+            }
+            mod.compiled = rc == 0;
+            mod.failed = rc != 0;
+            err.flush();
+            if (!err_buf.empty())
+                mod.diagnostics = "sere: " + mod.name + " (" + mod.path + "):\n" + err_buf;
+        }
+
+        // C `main`: runs every module's top-level code in import order, then
+        // the entry module's `main` if it has one.
+        std::unique_ptr<llvm::Module> startup_module(llvm::LLVMContext &context) const
+        {
+            auto module = std::make_unique<llvm::Module>("__start__", context);
+            llvm::IRBuilder<> builder(context);
+            auto *i32 = builder.getInt32Ty();
+            auto *main_fn = llvm::Function::Create(llvm::FunctionType::get(i32, false),
+                                                   llvm::Function::ExternalLinkage, "main", module.get());
+            builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", main_fn));
+
+            auto *void_fn = llvm::FunctionType::get(builder.getVoidTy(), false);
+            if (opts_.pgo_instrument)
+                builder.CreateCall(module->getOrInsertFunction("atexit", i32, void_fn->getPointerTo()),
+                                   {profile_writer(*module)});
+            for (size_t i : order_)
+                builder.CreateCall(module->getOrInsertFunction(modules_[i]->init_name, void_fn));
+
+            const BuildModule &entry = *modules_[order_.back()];
+            auto user_main = std::find_if(entry.definitions.begin(), entry.definitions.end(),
+                                          [](const Runtime::FunctionSignature &sig) { return sig.name == "__main__"; });
+            if (user_main == entry.definitions.end()) {
+                builder.CreateRet(builder.getInt32(0));
+                return module;
+            }
+
+            llvm::Type *ret = SereParser::typename_to_llvm_type(user_main->return_type);
+            auto *call = builder.CreateCall(module->getOrInsertFunction("__main__", llvm::FunctionType::get(ret, false)));
+            if (user_main->return_type == "int")
+                builder.CreateRet(builder.CreateTrunc(call, i32));
+            else
+                builder.CreateRet(builder.getInt32(0));
+            return module;
+        }
+
+        // Writes every module's counters to $SERE_PROFILE_FILE (default.proftext).
+        llvm::Function *profile_writer(llvm::Module &module) const
+        {
+            auto &context = module.getContext();
+            llvm::IRBuilder<> builder(context);
+            auto *i8ptr = builder.getInt8PtrTy();
+            auto *writer = llvm::Function::Create(llvm::FunctionType::get(builder.getVoidTy(), false),
+                                                  llvm::Function::InternalLinkage, "__sere_profile_write", module);
+            auto *entry = llvm::BasicBlock::Create(context, "entry", writer);
+            auto *write = llvm::BasicBlock::Create(context, "write", writer);
+            auto *done = llvm::BasicBlock::Create(context, "done", writer);
+
+            builder.SetInsertPoint(entry);
+            llvm::Value *env = builder.CreateCall(module.getOrInsertFunction("getenv", i8ptr, i8ptr),
+                                                  {builder.CreateGlobalStringPtr("SERE_PROFILE_FILE")});
+            llvm::Value *path = builder.CreateSelect(builder.CreateIsNull(env),
+                                                     builder.CreateGlobalStringPtr("default.proftext"), env);
+            llvm::Value *file = builder.CreateCall(module.getOrInsertFunction("fopen", i8ptr, i8ptr, i8ptr),
+                                                   {path, builder.CreateGlobalStringPtr("w")});
+            builder.CreateCondBr(builder.CreateIsNull(file), done, write);
+
+            builder.SetInsertPoint(write);
+            builder.CreateCall(module.getOrInsertFunction("fputs", builder.getInt32Ty(), i8ptr, i8ptr),
+                               {builder.CreateGlobalStringPtr("# IR level Instrumentation Flag\n:ir\n"), file});
+            auto *dump_fn = llvm::FunctionType::get(builder.getVoidTy(), {i8ptr}, false);
+            for (size_t i : order_)
+                builder.CreateCall(module.getOrInsertFunction(profile_dump_symbol(modules_[i]->init_name), dump_fn), {file});
+            builder.CreateCall(module.getOrInsertFunction("fclose", builder.getInt32Ty(), i8ptr), {file});
+            builder.CreateBr(done);
+
+            builder.SetInsertPoint(done);
+            builder.CreateRetVoid();
+            return writer;
+        }
+
+        // Relinks only when an object changed or the executable is missing.
+        int link(llvm::raw_ostream &err, bool &linked)
+        {
+            std::string exe = executable_path();
+            std::string link_key = exe + "\n";
+            for (size_t i : order_)
+                link_key += modules_[i]->stamp + "\n";
+            std::string link_stamp = sha1_hex(link_key);
+            std::string link_stamp_path = build_path("__link__.stamp");
+            if (llvm::sys::fs::exists(exe) && read_text_file(link_stamp_path) == link_stamp)
+                return 0;
+
+            std::string start_path = build_path("__start__.o");
+            {
+                // typename_to_llvm_type works in RT::ctx's context
+                auto &context = SereParser::RT::ctx.llvm_ctx;
+                auto module = startup_module(context);
+                auto machine = create_target_machine(opts_.opt_level, resolve_target_cpu(opts_.march));
+                prepare_module_for_target(*module, *machine);
+                auto object = emit_object(*module, *machine);
+                if (!write_file(start_path, llvm::StringRef(object.data(), object.size()))) {
+                    err << "Cannot write '" << start_path << "'\n";
+                    return 73;
+                }
+            }
+
+            std::vector<std::string> args = {"-o", exe};
+            if (thin_lto()) {
+                auto flags = thinlto_link_flags(opts_, thinlto_cache_dir());
+                args.insert(args.end(), flags.begin(), flags.end());
+            }
+            for (size_t i : order_)
+                args.push_back(modules_[i]->object_path);
+            args.push_back(start_path);
+            if (int rc = run_tool("cc", args, err))
+                return rc;
+
+            write_file(link_stamp_path, link_stamp);
+            linked = true;
+            return 0;
+        }
+
+        Options opts_;
+        std::string pgo_key_;                 // "" unless --pgo-instrument / --pgo-use
+        std::string target_key_;              // --march, resolved (native -> host CPU and features)
+        std::vector<std::unique_ptr<BuildModule>> modules_;
+        std::unordered_map<std::string, size_t> index_;
+        std::vector<size_t> order_;
+    };
+
+    // Runs a COMPILE/RUN/BUILD request, mapping failures to exit codes.
+    inline int execute(const Options &opts, llvm::raw_ostream &out, llvm::raw_ostream &err)
+    {
+        try
+        {
+            warm_up();
+            if (opts.command == Command::BUILD)
+                return Builder(opts).build(err);
+            Session session(opts);
+            if (opts.command == Command::RUN)
+                return session.run(err);
+            return session.compile(out, err);
+        }
+        catch (const std::exception &e)
+        {
+            err << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        catch (...)
+        {
+            err << "An unknown error occurred\n";
+            return 2;
+        }
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_BUILD_HPP
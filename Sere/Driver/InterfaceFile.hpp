@@ -0,0 +1,243 @@
+#ifndef DRIVER_INTERFACEFILE_HPP
+#define DRIVER_INTERFACEFILE_HPP
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include "../Parser/AST/Midlevel/ModuleInterface.hpp"
+#include "./Pipeline.hpp"
+
+//
+// Compiled module interfaces (`.serei`), written next to each module's object
+// by `sere build`. Importers load them instead of re-parsing the module.
+//
+// Layout (integers are u32 little-endian, strings are u32 length + bytes):
+//   "SEREI\0\0" version:u8
+//   source_key  stamp  name  init_name
+//   imports:      count, name...
+//   exports:      count, { name, param count, param types..., return type, effects }...
+//   definitions:  same shape; every function the object defines (symbol clash checks)
+//   inline_bitcode
+//
+namespace SereDriver {
+
+    struct InterfaceFile {
+        std::string source_key;                          // hash of source + options; stale when it differs
+        std::string stamp;                               // source_key + imported interfaces of the object
+        std::vector<std::string> imports;                // modules imported directly
+        std::vector<Runtime::FunctionSignature> definitions;
+        Runtime::ModuleInterface iface;
+    };
+
+    inline const char SEREI_MAGIC[8] = {'S', 'E', 'R', 'E', 'I', '\0', '\0', '\2'};
+
+    // Largest body (in instructions, after optimization) copied into an interface
+    inline const unsigned SEREI_INLINE_LIMIT = 24;
+
+    class InterfaceWriter {
+    public:
+        void u32(uint32_t value) {
+            for (int shift = 0; shift < 32; shift += 8)
+                bytes_ += static_cast<char>((value >> shift) & 0xff);
+        }
+        void str(llvm::StringRef text) {
+            u32(static_cast<uint32_t>(text.size()));
+            bytes_.append(text.data(), text.size());
+        }
+        void signatures(const std::vector<Runtime::FunctionSignature> &sigs) {
+            u32(static_cast<uint32_t>(sigs.size()));
+            for (const auto &sig : sigs) {
+                str(sig.name);
+                u32(static_cast<uint32_t>(sig.param_types.size()));
+                for (const auto &param : sig.param_types) str(param);
+                str(sig.return_type);
+                u32(sig.effects);
+            }
+        }
+        const std::string &bytes() const { return bytes_; }
+
+    private:
+        std::string bytes_ = std::string(SEREI_MAGIC, sizeof(SEREI_MAGIC));
+    };
+
+    // Bounds-checked cursor over a mapped file; any overrun marks it bad.
+    class InterfaceReader {
+    public:
+        explicit InterfaceReader(llvm::StringRef data) : data_(data) {
+            ok_ = data_.size() >= sizeof(SEREI_MAGIC) && std::memcmp(data_.data(), SEREI_MAGIC, sizeof(SEREI_MAGIC)) == 0;
+            pos_ = sizeof(SEREI_MAGIC);
+        }
+        uint32_t u32() {
+            if (!ok_ || data_.size() - pos_ < 4) return fail();
+            uint32_t value = 0;
+            for (int i = 0; i < 4; ++i)
+                value |= static_cast<uint32_t>(static_cast<unsigned char>(data_[pos_ + i])) << (8 * i);
+            pos_ += 4;
+            return value;
+        }
+        std::string str() {
+            uint32_t len = u32();
+            if (!ok_ || data_.size() - pos_ < len) {
+                fail();
+                return "";
+            }
+            std::string text = data_.substr(pos_, len).str();
+            pos_ += len;
+            return text;
+        }
+        // A count can't exceed the bytes left; corrupt input can't force huge allocations
+        uint32_t count() {
+            uint32_t n = u32();
+            return ok_ && n <= data_.size() - pos_ ? n : fail();
+        }
+        std::vector<Runtime::FunctionSignature> signatures() {
+            std::vector<Runtime::FunctionSignature> sigs(count());
+            for (auto &sig : sigs) {
+                sig.name = str();
+                sig.param_types.resize(count());
+                for (auto &param : sig.param_types) param = str();
+                sig.return_type = str();
+                sig.effects = u32();
+            }
+            return sigs;
+        }
+        bool ok() const { return ok_; }
+        bool at_end() const { return pos_ == data_.size(); }
+
+    private:
+        uint32_t fail() { ok_ = false; return 0; }
+
+        llvm::StringRef data_;
+        size_t pos_ = 0;
+        bool ok_ = false;
+    };
+
+    inline std::string serialize_interface(const InterfaceFile &file)
+    {
+        InterfaceWriter writer;
+        writer.str(file.source_key);
+        writer.str(file.stamp);
+        writer.str(file.iface.name);
+        writer.str(file.iface.init_name);
+        writer.u32(static_cast<uint32_t>(file.imports.size()));
+        for (const auto &import : file.imports) writer.str(import);
+        writer.signatures(file.iface.functions);
+        writer.signatures(file.definitions);
+        writer.str(file.iface.inline_bitcode);
+        return writer.bytes();
+    }
+
+    // Maps the file read-only; returns nothing when it is missing or malformed.
+    inline std::optional<InterfaceFile> load_interface_file(const std::string &path)
+    {
+        auto fd = llvm::sys::fs::openNativeFileForRead(path);
+        if (!fd) {
+            llvm::consumeError(fd.takeError());
+            return std::nullopt;
+        }
+        uint64_t size = 0;
+        std::error_code ec = llvm::sys::fs::file_size(path, size);
+        if (ec || size == 0) {
+            llvm::sys::fs::closeFile(*fd);
+            return std::nullopt;
+        }
+        llvm::sys::fs::mapped_file_region region(*fd, llvm::sys::fs::mapped_file_region::readonly, size, 0, ec);
+        llvm::sys::fs::closeFile(*fd);
+        if (ec) return std::nullopt;
+
+        InterfaceReader reader(llvm::StringRef(region.const_data(), size));
+        InterfaceFile file;
+        file.source_key = reader.str();
+        file.stamp = reader.str();
+        file.iface.name = reader.str();
+        file.iface.init_name = reader.str();
+        file.imports.resize(reader.count());
+        for (auto &import : file.imports) import = reader.str();
+        file.iface.functions = reader.signatures();
+        file.definitions = reader.signatures();
+        file.iface.inline_bitcode = reader.str();
+        if (!reader.ok() || !reader.at_end()) return std::nullopt;
+        return file;
+    }
+
+    //
+    // Copies small (or `@inline`) exported functions out of a freshly lowered
+    // module as available_externally definitions, so importers can inline
+    // them. A body qualifies when everything it calls is visible to importers too.
+    //
+    inline std::string extract_inline_bodies(const llvm::Module &module, const Runtime::ModuleInterface &iface,
+                                             unsigned opt_level, llvm::raw_ostream &err)
+    {
+        if (opt_level == 0) return ""; // nothing would inline them
+
+        llvm::StringSet<> exported;
+        for (const auto &sig : iface.functions) exported.insert(sig.name);
+
+        auto visible = [&](const llvm::Function &callee) {
+            return callee.isDeclaration() || exported.count(callee.getName()) || callee.hasLinkOnceODRLinkage() ||
+                   callee.hasAvailableExternallyLinkage();
+        };
+        auto candidate = [&](const llvm::Function &func) {
+            if (func.isDeclaration() || !exported.count(func.getName())) return false;
+            if (func.hasFnAttribute("sere-multiversion")) return false; // inlining would bypass the dispatch
+            if (func.hasFnAttribute(llvm::Attribute::NoInline)) return false;
+            for (const auto &inst : llvm::instructions(func))
+                if (auto call = llvm::dyn_cast<llvm::CallBase>(&inst))
+                    if (!call->getCalledFunction() || !visible(*call->getCalledFunction()))
+                        return false;
+            return true;
+        };
+
+        llvm::ValueToValueMapTy vmap;
+        auto bodies = llvm::CloneModule(module, vmap, [&](const llvm::GlobalValue *gv) {
+            if (auto func = llvm::dyn_cast<llvm::Function>(gv)) return candidate(*func);
+            return llvm::isa<llvm::GlobalVariable>(gv) && gv->hasLocalLinkage();
+        });
+        if (compile_optimization_passes(bodies.get(), opt_level, err) != 0) return "";
+
+        bool any = false;
+        for (auto &func : *bodies) {
+            if (func.isDeclaration()) continue;
+            bool small = func.getInstructionCount() <= SEREI_INLINE_LIMIT ||
+                         func.hasFnAttribute(llvm::Attribute::AlwaysInline);
+            if (!exported.count(func.getName()) || !small) {
+                func.deleteBody();
+                continue;
+            }
+            func.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+            any = true;
+        }
+        if (!any) return "";
+
+        for (auto it = bodies->begin(); it != bodies->end();) {
+            llvm::Function &func = *it++;
+            if (func.isDeclaration() && func.use_empty()) func.eraseFromParent();
+        }
+        for (auto it = bodies->global_begin(); it != bodies->global_end();) {
+            llvm::GlobalVariable &gv = *it++;
+            if (gv.use_empty()) gv.eraseFromParent();
+        }
+
+        std::string bitcode;
+        llvm::raw_string_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*bodies, os);
+        return os.str();
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_INTERFACEFILE_HPP
@@ -0,0 +1,198 @@
+#ifndef DRIVER_OBJECTCACHE_HPP
+#define DRIVER_OBJECTCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <unistd.h>
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+
+#include "./Options.hpp"
+
+namespace SereDriver {
+
+    struct CacheStats {
+        unsigned hits = 0;
+        unsigned misses = 0;
+        uint64_t bytes_saved = 0;    // object bytes served from the cache
+        uint64_t bytes_written = 0;  // object bytes added to the cache
+
+        void report(llvm::raw_ostream &os, const std::string &dir) const {
+            os << "sere: object cache " << dir << ": " << hits << " hit" << (hits == 1 ? "" : "s")
+               << ", " << misses << " miss" << (misses == 1 ? "" : "es")
+               << ", " << bytes_saved << " bytes reused, " << bytes_written << " bytes written\n";
+        }
+    };
+
+    //
+    // Content-addressed store of per-function object files. The AOT path
+    // uses lookup()/store() directly; the JIT reaches it through the ORC
+    // ObjectCache interface, using the module identifier as the key.
+    //
+    class FunctionObjectCache : public llvm::ObjectCache {
+    public:
+        explicit FunctionObjectCache(std::string dir) : dir_(std::move(dir)) {
+            if (auto ec = llvm::sys::fs::create_directories(dir_))
+                throw std::runtime_error("Cannot create cache directory '" + dir_ + "': " + ec.message());
+        }
+
+        const std::string &dir() const { return dir_; }
+
+        std::string path_for(const std::string &key) const {
+            llvm::SmallString<256> path(dir_);
+            llvm::sys::path::append(path, key + ".o");
+            return std::string(path.str());
+        }
+
+        std::unique_ptr<llvm::MemoryBuffer> lookup(const std::string &key) {
+            auto buffer = llvm::MemoryBuffer::getFile(path_for(key));
+            if (!buffer) {
+                ++stats.misses;
+                return nullptr;
+            }
+            ++stats.hits;
+            stats.bytes_saved += (*buffer)->getBufferSize();
+            return std::move(*buffer);
+        }
+
+        void store(const std::string &key, llvm::StringRef object) {
+            // Write-then-rename so concurrent compilers never see a torn object
+            std::string final_path = path_for(key);
+            std::string tmp_path = final_path + ".tmp." + std::to_string(getpid());
+            {
+                std::error_code ec;
+                llvm::raw_fd_ostream file(tmp_path, ec, llvm::sys::fs::OF_None);
+                if (ec) return; // the cache is best-effort
+                file << object;
+            }
+            if (llvm::sys::fs::rename(tmp_path, final_path)) {
+                llvm::sys::fs::remove(tmp_path);
+                return;
+            }
+            stats.bytes_written += object.size();
+        }
+
+        // --- llvm::ObjectCache ---
+        void notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef object) override {
+            store(module->getModuleIdentifier(), object.getBuffer());
+        }
+
+        std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *module) override {
+            return lookup(module->getModuleIdentifier());
+        }
+
+        CacheStats stats;
+
+    private:
+        std::string dir_;
+    };
+
+    struct FunctionUnit {
+        std::string name;
+        std::string key;
+        std::unique_ptr<llvm::Module> module; // identifier == key
+    };
+
+    //
+    // Cache key for one unit: its optimized IR (the function, the constants
+    // it uses and the declarations it calls), the code generation level, the
+    // target and the compiler. Code generation sees nothing else, so units
+    // with equal keys produce equal objects.
+    //
+    inline std::string unit_cache_key(const llvm::Module &unit, unsigned opt_level, const std::string &target) {
+        std::string ir;
+        llvm::raw_string_ostream os(ir);
+        unit.print(os, nullptr);
+        llvm::SHA1 sha;
+        sha.update(SERE_COMPILER_VERSION " llvm-" LLVM_VERSION_STRING "\n");
+        sha.update("opt " + std::to_string(opt_level) + "\n" + target + "\n");
+        sha.update(os.str());
+        return llvm::toHex(sha.final(), /*LowerCase=*/true);
+    }
+
+    //
+    // Splits an optimized module into one module per defined function, so
+    // inlining and the other interprocedural passes have already seen the
+    // whole module. Local constants (string literals) and linkonce_odr
+    // variables (the output buffer) are copied into every unit that uses
+    // them; everything else becomes an external declaration.
+    //
+    // Units reference each other by symbol, so local functions become
+    // hidden globals here; the AOT path turns them back into locals once
+    // the units are linked together (Session::link_relocatable). Units are
+    // read back from bitcode that keeps the use-list order: CloneModule
+    // reorders uses, and the code generator's choices with them.
+    //
+    inline std::vector<FunctionUnit> split_module(llvm::Module &module, unsigned opt_level, const std::string &target) {
+        for (auto &func : module) {
+            if (!func.isDeclaration() && func.hasLocalLinkage()) {
+                func.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                func.setVisibility(llvm::GlobalValue::HiddenVisibility);
+            }
+        }
+
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream bitcode_stream(bitcode);
+        llvm::WriteBitcodeToFile(module, bitcode_stream, /*ShouldPreserveUseListOrder=*/true);
+        llvm::MemoryBufferRef buffer(llvm::StringRef(bitcode.data(), bitcode.size()), module.getModuleIdentifier());
+
+        std::vector<FunctionUnit> units;
+        for (auto &func : module) {
+            // available_externally bodies are only inlining fodder; they emit no code
+            if (func.isDeclaration() || func.hasAvailableExternallyLinkage()) continue;
+
+            FunctionUnit unit;
+            unit.name = func.getName().str();
+            auto lazy = llvm::getLazyBitcodeModule(buffer, module.getContext());
+            if (!lazy)
+                throw std::runtime_error("Cannot split module: " + llvm::toString(lazy.takeError()));
+            unit.module = std::move(*lazy);
+
+            // Only this function's body is read; the others stay declarations
+            for (auto &other : *unit.module) {
+                if (other.getName() == unit.name) {
+                    if (auto error = other.materialize())
+                        throw std::runtime_error("Cannot split module: " + llvm::toString(std::move(error)));
+                } else if (!other.isDeclaration()) {
+                    other.deleteBody();
+                }
+            }
+            if (auto error = unit.module->materializeAll())
+                throw std::runtime_error("Cannot split module: " + llvm::toString(std::move(error)));
+
+            // Drop the constants and buffers this unit doesn't use
+            for (auto it = unit.module->global_begin(); it != unit.module->global_end();) {
+                llvm::GlobalVariable &gv = *it++;
+                if (gv.hasLocalLinkage() || gv.hasLinkOnceODRLinkage()) {
+                    if (gv.use_empty()) gv.eraseFromParent();
+                } else if (!gv.isDeclaration()) {
+                    gv.setInitializer(nullptr);
+                    gv.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                    gv.setComdat(nullptr);
+                }
+            }
+            unit.module->setModuleIdentifier("unit");
+            unit.key = unit_cache_key(*unit.module, opt_level, target);
+            unit.module->setModuleIdentifier(unit.key);
+            units.push_back(std::move(unit));
+        }
+        return units;
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_OBJECTCACHE_HPP
@@ -0,0 +1,241 @@
+#ifndef DRIVER_OPTIONS_HPP
+#define DRIVER_OPTIONS_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <unistd.h>
+
+#define SERE_COMPILER_VERSION "0.2.0"
+
+namespace SereDriver {
+
+    enum class Command {
+        COMPILE,    // sere [compile] <file>   -> optimized IR
+        RUN,        // sere run <file>         -> JIT and execute
+        BUILD,      // sere build <entry>      -> multi-module executable
+        SERVER,     // sere --server[=sock]    -> persistent compile daemon
+        CLIENT      // sere --client[=sock] .. -> forward a request to the daemon
+    };
+
+    enum class EmitKind {
+        IR,         // textual LLVM IR
+        OBJ,        // relocatable object file
+        BC,         // bitcode with a ThinLTO summary; `build` then links with ThinLTO
+        SIR         // textual SIR of the functions, after the SIR passes
+    };
+
+    class UsageError : public std::invalid_argument {
+    public:
+        explicit UsageError(const std::string& msg) : std::invalid_argument(msg) {}
+    };
+
+    struct Options {
+        Command command = Command::COMPILE;
+        std::string input;
+        std::string output;                      // empty -> stdout
+        unsigned opt_level = 2;
+        EmitKind emit = EmitKind::IR;
+        std::string cache_dir;                   // empty -> per-function object cache disabled
+        bool cache_stats = false;
+        unsigned jobs = 0;                       // BUILD: 0 -> one per hardware thread
+        std::string build_dir = ".sere-build";   // BUILD: objects and rebuild stamps
+        std::vector<std::string> include_dirs;   // BUILD: extra import search roots
+        std::string thinlto_cache_dir;           // BUILD --emit=bc: empty -> <build_dir>/thinlto-cache
+        bool pgo_instrument = false;             // BUILD: executable writes an IR-level profile at exit
+        std::string pgo_use;                     // BUILD/COMPILE: indexed .profdata to optimize with
+        std::string march;                       // BUILD/COMPILE: native | x86-64[-v2|-v3|-v4]; empty -> generic
+        std::optional<std::vector<std::string>> sir_passes; // SIR pass pipeline; unset -> the default one
+        bool checked_arith = false;              // integer + - * trap on overflow instead of wrapping
+        std::string callgraph;                   // COMPILE: "json" | "dot" replaces the output; empty -> off
+        std::string socket_path;
+        bool shutdown = false;                   // CLIENT: ask the server to exit
+        std::vector<std::string> forward_args;   // CLIENT: request sent verbatim
+    };
+
+    inline std::string default_socket_path() {
+        return "/tmp/sere-" + std::to_string(getuid()) + ".sock";
+    }
+
+    inline std::string usage(const std::string& prog) {
+        return "Usage: \n"
+               "\t" + prog + " [compile] <input_file> [-o <out>] [-O0|-O1|-O2|-O3] [--emit=ir|obj|bc|sir]\n"
+               "\t  [--callgraph[=json|dot]]\n"
+               "\t" + prog + " run <input_file> [-O<n>]\n"
+               "\t" + prog + " build <entry_file> [-o <exe>] [-j<n>] [-I <dir>] [--build-dir=<dir>] [-O<n>]\n"
+               "\t  [--emit=bc [--thinlto-cache-dir=<dir>]] [--pgo-instrument | --pgo-use=<file.profdata>]\n"
+               "\t  compile/build: --march=native|x86-64|x86-64-v2|x86-64-v3|x86-64-v4\n"
+               "\t  shared: --cache-dir=<dir> [--cache-stats] [--sir-passes=<pass,...>] [--checked-arith]\n"
+               "\t" + prog + " --server[=<socket>]\n"
+               "\t" + prog + " --client[=<socket>] <command...> | --shutdown";
+    }
+
+    inline std::string option_value(const std::string& arg, const std::string& flag) {
+        // "--flag=value" -> "value", "--flag" -> ""
+        if (arg.size() > flag.size() && arg[flag.size()] == '=')
+            return arg.substr(flag.size() + 1);
+        return "";
+    }
+
+    inline bool is_flag(const std::string& arg, const std::string& flag) {
+        return arg == flag || arg.rfind(flag + "=", 0) == 0;
+    }
+
+    // "dir/name.sere" -> "name"
+    inline std::string path_stem(const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+        size_t dot = base.find_last_of('.');
+        return (dot == std::string::npos || dot == 0) ? base : base.substr(0, dot);
+    }
+
+    // Output written when -o is absent (empty means stdout).
+    inline std::string default_output_path(const Options& opts) {
+        if (opts.command == Command::BUILD) return path_stem(opts.input);
+        if (opts.emit == EmitKind::OBJ) return path_stem(opts.input) + ".o";
+        if (opts.emit == EmitKind::BC) return path_stem(opts.input) + ".bc";
+        return "";
+    }
+
+    // Parses everything after argv[0].
+    inline Options parse_options(const std::vector<std::string>& args) {
+        Options opts;
+        if (args.empty())
+            throw UsageError("no input file");
+
+        size_t i = 0;
+        const std::string& first = args[0];
+        if (is_flag(first, "--server")) {
+            opts.command = Command::SERVER;
+            opts.socket_path = option_value(first, "--server");
+            if (opts.socket_path.empty()) opts.socket_path = default_socket_path();
+            if (args.size() > 1)
+                throw UsageError("--server takes no further arguments");
+            return opts;
+        }
+        if (is_flag(first, "--client")) {
+            opts.command = Command::CLIENT;
+            opts.socket_path = option_value(first, "--client");
+            if (opts.socket_path.empty()) opts.socket_path = default_socket_path();
+            opts.forward_args.assign(args.begin() + 1, args.end());
+            if (opts.forward_args.size() == 1 && opts.forward_args[0] == "--shutdown") {
+                opts.shutdown = true;
+                return opts;
+            }
+            // Validate locally so typos don't round-trip through the daemon
+            Options forwarded = parse_options(opts.forward_args);
+            if (forwarded.command == Command::SERVER || forwarded.command == Command::CLIENT)
+                throw UsageError("cannot forward --server/--client to a server");
+            return opts;
+        }
+
+        if (first == "run") {
+            opts.command = Command::RUN;
+            ++i;
+        } else if (first == "build") {
+            opts.command = Command::BUILD;
+            ++i;
+        } else if (first == "compile") {
+            ++i;
+        }
+
+        for (; i < args.size(); ++i) {
+            const std::string& arg = args[i];
+            if (arg == "-o") {
+                if (i + 1 >= args.size())
+                    throw UsageError("-o requires a path");
+                opts.output = args[++i];
+            } else if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' && arg[2] <= '3') {
+                opts.opt_level = static_cast<unsigned>(arg[2] - '0');
+            } else if (arg.rfind("-j", 0) == 0) {
+                std::string count = arg.size() > 2 ? arg.substr(2) : (i + 1 < args.size() ? args[++i] : "");
+                if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos)
+                    throw UsageError("-j requires a number");
+                opts.jobs = static_cast<unsigned>(std::stoul(count));
+            } else if (arg.rfind("-I", 0) == 0) {
+                std::string dir = arg.size() > 2 ? arg.substr(2) : (i + 1 < args.size() ? args[++i] : "");
+                if (dir.empty())
+                    throw UsageError("-I requires a directory");
+                opts.include_dirs.push_back(dir);
+            } else if (is_flag(arg, "--build-dir")) {
+                opts.build_dir = option_value(arg, "--build-dir");
+                if (opts.build_dir.empty())
+                    throw UsageError("--build-dir requires a directory");
+            } else if (is_flag(arg, "--emit")) {
+                std::string kind = option_value(arg, "--emit");
+                if (kind == "ir") opts.emit = EmitKind::IR;
+                else if (kind == "obj") opts.emit = EmitKind::OBJ;
+                else if (kind == "bc") opts.emit = EmitKind::BC;
+                else if (kind == "sir") opts.emit = EmitKind::SIR;
+                else throw UsageError("unknown --emit kind '" + kind + "'");
+            } else if (is_flag(arg, "--cache-dir")) {
+                opts.cache_dir = option_value(arg, "--cache-dir");
+                if (opts.cache_dir.empty())
+                    throw UsageError("--cache-dir requires a directory");
+            } else if (is_flag(arg, "--thinlto-cache-dir")) {
+                opts.thinlto_cache_dir = option_value(arg, "--thinlto-cache-dir");
+                if (opts.thinlto_cache_dir.empty())
+                    throw UsageError("--thinlto-cache-dir requires a directory");
+            } else if (arg == "--pgo-instrument") {
+                opts.pgo_instrument = true;
+            } else if (is_flag(arg, "--pgo-use")) {
+                opts.pgo_use = option_value(arg, "--pgo-use");
+                if (opts.pgo_use.empty())
+                    throw UsageError("--pgo-use requires a .profdata file");
+            } else if (is_flag(arg, "--march")) {
+                opts.march = option_value(arg, "--march");
+                if (opts.march != "native" && opts.march != "x86-64" && opts.march != "x86-64-v2" &&
+                    opts.march != "x86-64-v3" && opts.march != "x86-64-v4")
+                    throw UsageError("unknown --march '" + opts.march + "'");
+            } else if (is_flag(arg, "--sir-passes")) {
+                // Comma-separated, in order; empty runs none
+                std::vector<std::string> passes;
+                std::string list = option_value(arg, "--sir-passes");
+                for (size_t start = 0; start < list.size();) {
+                    size_t comma = list.find(',', start);
+                    if (comma == std::string::npos) comma = list.size();
+                    if (comma == start)
+                        throw UsageError("empty pass name in --sir-passes");
+                    passes.push_back(list.substr(start, comma - start));
+                    start = comma + 1;
+                }
+                opts.sir_passes = passes;
+            } else if (is_flag(arg, "--callgraph")) {
+                opts.callgraph = option_value(arg, "--callgraph");
+                if (opts.callgraph.empty()) opts.callgraph = "json";
+                if (opts.callgraph != "json" && opts.callgraph != "dot")
+                    throw UsageError("unknown --callgraph format '" + opts.callgraph + "'");
+            } else if (arg == "--checked-arith") {
+                opts.checked_arith = true;
+            } else if (arg == "--cache-stats") {
+                opts.cache_stats = true;
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw UsageError("unknown option '" + arg + "'");
+            } else {
+                if (!opts.input.empty())
+                    throw UsageError("more than one input file given");
+                opts.input = arg;
+            }
+        }
+
+        if (opts.input.empty())
+            throw UsageError("no input file");
+        if (opts.pgo_instrument && !opts.pgo_use.empty())
+            throw UsageError("--pgo-instrument and --pgo-use are exclusive");
+        if (opts.pgo_instrument && opts.command != Command::BUILD)
+            throw UsageError("--pgo-instrument needs 'build' (the startup code writes the profile)");
+        if (!opts.pgo_use.empty() && opts.command == Command::RUN)
+            throw UsageError("--pgo-use applies to 'build' and 'compile'");
+        if (opts.emit == EmitKind::SIR && opts.command != Command::COMPILE)
+            throw UsageError("--emit=sir applies to 'compile'");
+        if (!opts.callgraph.empty() && (opts.command != Command::COMPILE || opts.emit != EmitKind::IR))
+            throw UsageError("--callgraph applies to 'compile' and replaces --emit");
+        if (!opts.march.empty() && opts.command == Command::RUN)
+            throw UsageError("--march applies to 'build' and 'compile'; the JIT always targets the host");
+        return opts;
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_OPTIONS_HPP
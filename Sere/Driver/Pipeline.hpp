@@ -0,0 +1,189 @@
+#ifndef DRIVER_PIPELINE_HPP
+#define DRIVER_PIPELINE_HPP
+
+#include <stdexcept>
+#include <memory>
+#include <string>
+
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/Host.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
+#include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/Scalar/GVN.h>
+#include <llvm/Transforms/Utils.h>
+#include <llvm/Transforms/InstCombine/InstCombine.h>
+#include <llvm/Transforms/Vectorize.h>
+
+#include "./Target.hpp"
+
+namespace SereDriver {
+
+    // With a target machine, cost models see the real CPU (vector width, --march).
+    inline int compile_optimization_passes(llvm::Module *module, unsigned opt_level, llvm::raw_ostream &err,
+                                           llvm::TargetMachine *machine = nullptr)
+    {
+        if (module == nullptr) throw std::invalid_argument("Module is null");
+
+        // verify the pre-optimized module
+        if (llvm::verifyModule(*module, &err)) {
+            err << "Module verification failed before optimization.\n";
+            return -1;
+        }
+
+        if (opt_level == 0) {
+            // `@inline` is a promise even without optimization
+            for (auto &func : *module)
+                if (!func.isDeclaration() && func.hasFnAttribute(llvm::Attribute::AlwaysInline)) {
+                    llvm::legacy::PassManager passManager;
+                    passManager.add(llvm::createAlwaysInlinerLegacyPass());
+                    passManager.run(*module);
+                    break;
+                }
+            return 0;
+        }
+
+        llvm::legacy::PassManager passManager;
+        if (machine)
+            passManager.add(llvm::createTargetTransformInfoWrapperPass(machine->getTargetIRAnalysis()));
+
+        /* ========= OPTIMIZATION PIPELINE ========= //
+
+            IN (already SSA) -> [inline, -O2+; only `@inline` below] -> simply -> TRE -> reassociate -> GVN -> CFGS
+               -> [loops, -O2+: rotate -> LICM -> indvars -> delete -> full unroll
+                                -> vectorize -> SLP -> unroll -> LICM -> CFGS]
+               -> [hot/cold split, -O2+ with a profile] -> constant merge -> GlobalDCE -> OPTIMIZED OUTPUT
+
+        */
+        if (opt_level >= 2)
+            passManager.add(llvm::createFunctionInliningPass(opt_level, 0, false)); // incl. imported available_externally bodies
+        else
+            passManager.add(llvm::createAlwaysInlinerLegacyPass());
+        passManager.add(llvm::createInstructionCombiningPass()); // combine redundant instructions
+        passManager.add(llvm::createTailCallEliminationPass()); // self-recursion SIR left: accumulators (`n * f(n - 1)`), direct lowering
+        passManager.add(llvm::createReassociatePass()); // reorder expressions
+        passManager.add(llvm::createGVNPass()); // Eliminate common subexpressions
+        passManager.add(llvm::createCFGSimplificationPass()); // Control flow graph cleanup
+        if (opt_level >= 2) {
+            passManager.add(llvm::createLoopRotatePass()); // `while` loops into guarded bottom-tested form
+            passManager.add(llvm::createLICMPass()); // hoist loop-invariant code
+            passManager.add(llvm::createIndVarSimplifyPass()); // canonical induction variables, exit values
+            passManager.add(llvm::createLoopDeletionPass()); // loops without side effects
+            passManager.add(llvm::createSimpleLoopUnrollPass(opt_level)); // fully unroll short constant trip counts
+            passManager.add(llvm::createInstructionCombiningPass());
+            passManager.add(llvm::createLoopVectorizePass()); // cost model from the target's TTI
+            passManager.add(llvm::createSLPVectorizerPass()); // straight-line code, incl. unrolled remainders
+            passManager.add(llvm::createInstructionCombiningPass());
+            passManager.add(llvm::createLoopUnrollPass(opt_level)); // runtime unrolling of the vector loop
+            passManager.add(llvm::createLICMPass());
+            passManager.add(llvm::createCFGSimplificationPass());
+        }
+        if (opt_level >= 2 && module->getProfileSummary(/*IsCS=*/false))
+            passManager.add(llvm::createHotColdSplittingPass()); // PGO: outline never-run blocks
+        passManager.add(llvm::createConstantMergePass()); // fold equal unnamed_addr constants (e.g. from inlined imports)
+        passManager.add(llvm::createGlobalDCEPass()); // drop internal functions nothing calls anymore
+
+        passManager.run(*module);
+
+        // verify the optimized module
+        if (llvm::verifyModule(*module, &err)) {
+            err << "Module verification failed after attempting optimization.\n";
+            return -1;
+        }
+        return 0;
+    }
+
+    //
+    // Runs once per module before optimization (and before any per-function
+    // split). Library copies become private to the module, and local
+    // functions that are only ever called directly switch to fastcc. A
+    // `musttail` call needs the caller's convention; where that no longer
+    // holds (an exported caller, a fastcc callee) it stays a plain `tail`.
+    //
+    inline void internalize_module(llvm::Module &module)
+    {
+        for (auto &func : module) {
+            if (func.isDeclaration()) continue;
+            if (func.hasLinkOnceODRLinkage())
+                func.setLinkage(llvm::GlobalValue::InternalLinkage);
+            if (!func.hasLocalLinkage() || func.isVarArg() || func.hasAddressTaken()) continue;
+            func.setCallingConv(llvm::CallingConv::Fast);
+            for (auto *user : func.users())
+                llvm::cast<llvm::CallBase>(user)->setCallingConv(llvm::CallingConv::Fast);
+        }
+        for (auto &func : module)
+            for (auto &block : func)
+                if (auto *call = block.getTerminatingMustTailCall())
+                    if (call->getCallingConv() != func.getCallingConv())
+                        call->setTailCallKind(llvm::CallInst::TCK_Tail);
+    }
+
+    inline llvm::CodeGenOpt::Level codegen_opt_level(unsigned opt_level)
+    {
+        switch (opt_level) {
+            case 0: return llvm::CodeGenOpt::None;
+            case 1: return llvm::CodeGenOpt::Less;
+            case 3: return llvm::CodeGenOpt::Aggressive;
+            default: return llvm::CodeGenOpt::Default;
+        }
+    }
+
+    // With `stack_sizes`, objects carry each function's frame size (see SereIR::read_stack_sizes).
+    inline std::unique_ptr<llvm::TargetMachine> create_target_machine(unsigned opt_level, const TargetCPU &cpu = TargetCPU(),
+                                                                      bool stack_sizes = false)
+    {
+        std::string triple = llvm::sys::getDefaultTargetTriple();
+        std::string error;
+        const llvm::Target *target = llvm::TargetRegistry::lookupTarget(triple, error);
+        if (!target)
+            throw std::runtime_error("Cannot find target for " + triple + ": " + error);
+
+        llvm::TargetOptions options;
+        options.EmitStackSizeSection = stack_sizes;
+        return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+            triple, cpu.cpu, cpu.features, options, llvm::Reloc::PIC_, llvm::None, codegen_opt_level(opt_level)));
+    }
+
+    inline void prepare_module_for_target(llvm::Module &module, const llvm::TargetMachine &machine)
+    {
+        module.setTargetTriple(machine.getTargetTriple().str());
+        module.setDataLayout(machine.createDataLayout());
+        set_function_targets(module, TargetCPU{machine.getTargetCPU().str(), machine.getTargetFeatureString().str()});
+    }
+
+    inline llvm::SmallVector<char, 0> emit_object(llvm::Module &module, llvm::TargetMachine &machine)
+    {
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream stream(buffer);
+        llvm::legacy::PassManager passManager;
+        if (machine.addPassesToEmitFile(passManager, stream, nullptr, llvm::CGFT_ObjectFile))
+            throw std::runtime_error("Target cannot emit object files");
+        passManager.run(module);
+        return buffer;
+    }
+
+    // Bitcode plus the module summary ThinLTO's thin link works from.
+    inline llvm::SmallVector<char, 0> emit_thin_bitcode(llvm::Module &module)
+    {
+        llvm::ProfileSummaryInfo psi(module);
+        llvm::ModuleSummaryIndex index = llvm::buildModuleSummaryIndex(module, nullptr, &psi);
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream stream(buffer);
+        // The module hash is what makes ThinLTO backend results cacheable
+        llvm::WriteBitcodeToFile(module, stream, /*ShouldPreserveUseListOrder=*/false, &index, /*GenerateHash=*/true);
+        return buffer;
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_PIPELINE_HPP
@@ -0,0 +1,176 @@
+#ifndef DRIVER_PROFILE_HPP
+#define DRIVER_PROFILE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Transforms/Instrumentation.h>
+#include <llvm/Transforms/Utils.h>
+
+#include "./Options.hpp"
+
+//
+// IR-level PGO. `--pgo-instrument` runs LLVM's PGO instrumentation (the
+// same CFG hashing and counter placement as `clang -fprofile-generate`) and
+// lowers the counters here: every module gets plain i64 counter arrays and
+// a `__sere_profile_<init>` function that prints them in llvm-profdata's
+// text format. The startup module writes the file at exit, so no profile
+// runtime library is needed.
+//
+//   ./app                                   # writes default.proftext ($SERE_PROFILE_FILE)
+//   llvm-profdata merge -o app.profdata default.proftext
+//   sere build app.sere --pgo-use=app.profdata
+//
+namespace SereDriver {
+
+    inline bool pgo_active(const Options &opts)
+    {
+        return opts.pgo_instrument || !opts.pgo_use.empty();
+    }
+
+    // Part of every build/cache key: the mode and, for use, the profile contents.
+    inline std::string pgo_key(const Options &opts)
+    {
+        if (opts.pgo_instrument) return "pgo-instrument";
+        if (opts.pgo_use.empty()) return "";
+        auto profile = llvm::MemoryBuffer::getFile(opts.pgo_use);
+        if (!profile)
+            throw std::runtime_error("Cannot read profile '" + opts.pgo_use + "': " + profile.getError().message());
+        llvm::SHA1 sha;
+        sha.update((*profile)->getBuffer());
+        return "pgo-use:" + llvm::toHex(sha.final(), /*LowerCase=*/true);
+    }
+
+    inline std::string profile_dump_symbol(const std::string &init_name)
+    {
+        return "__sere_profile_" + init_name;
+    }
+
+    inline llvm::FunctionCallee declare_fprintf(llvm::Module &module)
+    {
+        auto *i8ptr = llvm::Type::getInt8PtrTy(module.getContext());
+        return module.getOrInsertFunction("fprintf",
+            llvm::FunctionType::get(llvm::Type::getInt32Ty(module.getContext()), {i8ptr, i8ptr}, true));
+    }
+
+    //
+    // Replaces llvm.instrprof.* intrinsics with counter updates and emits the
+    // module's dump function. Value-profiling sites are dropped: Sere has no
+    // indirect calls or memory intrinsics for them to observe.
+    //
+    inline void lower_profile_counters(llvm::Module &module, const std::string &init_name)
+    {
+        struct Record {
+            std::string name;
+            uint64_t hash;
+            llvm::GlobalVariable *counters;
+        };
+        std::vector<Record> records;
+        std::unordered_map<llvm::GlobalVariable *, size_t> record_of; // keyed by the __profn_ name variable
+
+        auto &context = module.getContext();
+        auto *i64 = llvm::Type::getInt64Ty(context);
+        std::vector<llvm::Instruction *> dead;
+        for (auto &func : module) {
+            for (auto &inst : llvm::instructions(func)) {
+                auto *intrinsic = llvm::dyn_cast<llvm::IntrinsicInst>(&inst);
+                if (!intrinsic) continue;
+                if (llvm::isa<llvm::InstrProfValueProfileInst>(intrinsic)) {
+                    dead.push_back(intrinsic);
+                    continue;
+                }
+                auto *increment = llvm::dyn_cast<llvm::InstrProfIncrementInst>(intrinsic);
+                if (!increment) increment = llvm::dyn_cast<llvm::InstrProfIncrementInstStep>(intrinsic);
+                if (!increment) continue;
+
+                llvm::GlobalVariable *name_var = increment->getName();
+                auto found = record_of.find(name_var);
+                if (found == record_of.end()) {
+                    uint64_t count = increment->getNumCounters()->getZExtValue();
+                    auto *array = llvm::ArrayType::get(i64, count);
+                    std::string name = llvm::cast<llvm::ConstantDataArray>(name_var->getInitializer())->getAsString().str();
+                    auto *counters = new llvm::GlobalVariable(module, array, false, llvm::GlobalValue::InternalLinkage,
+                                                              llvm::ConstantAggregateZero::get(array),
+                                                              "__sere_prof_cnts_" + func.getName().str());
+                    found = record_of.emplace(name_var, records.size()).first;
+                    records.push_back({name, increment->getHash()->getZExtValue(), counters});
+                }
+
+                llvm::IRBuilder<> builder(increment);
+                llvm::GlobalVariable *counters = records[found->second].counters;
+                llvm::Value *slot = builder.CreateConstInBoundsGEP2_64(counters->getValueType(), counters, 0,
+                                                                       increment->getIndex()->getZExtValue());
+                llvm::Value *step = increment->getStep();
+                if (step->getType() != i64) step = builder.CreateZExtOrTrunc(step, i64);
+                builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i64, slot), step), slot);
+                dead.push_back(increment);
+            }
+        }
+        for (auto *inst : dead)
+            inst->eraseFromParent();
+        for (auto &[name_var, index] : record_of)
+            if (name_var->use_empty()) name_var->eraseFromParent();
+
+        auto *i8ptr = llvm::Type::getInt8PtrTy(context);
+        auto *dump = llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i8ptr}, false),
+                                            llvm::Function::ExternalLinkage, profile_dump_symbol(init_name), module);
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", dump));
+        llvm::FunctionCallee fprintf = declare_fprintf(module);
+        llvm::Value *file = dump->getArg(0);
+        llvm::Value *header = builder.CreateGlobalStringPtr("%s\n# Func Hash:\n%llu\n# Num Counters:\n%llu\n# Counter Values:\n");
+        llvm::Value *value_line = builder.CreateGlobalStringPtr("%llu\n");
+        llvm::Value *end_record = builder.CreateGlobalStringPtr("\n");
+        for (const auto &record : records) {
+            uint64_t count = llvm::cast<llvm::ArrayType>(record.counters->getValueType())->getNumElements();
+            builder.CreateCall(fprintf, {file, header, builder.CreateGlobalStringPtr(record.name),
+                                         builder.getInt64(record.hash), builder.getInt64(count)});
+            for (uint64_t i = 0; i < count; ++i) {
+                llvm::Value *slot = builder.CreateConstInBoundsGEP2_64(record.counters->getValueType(), record.counters, 0, i);
+                builder.CreateCall(fprintf, {file, value_line, builder.CreateLoad(i64, slot)});
+            }
+            builder.CreateCall(fprintf, {file, end_record});
+        }
+        builder.CreateRetVoid();
+    }
+
+    //
+    // Runs before the optimization pipeline. Instrumentation and profile use
+    // must see the same CFG, so both run on the module exactly as lowered.
+    //
+    inline void apply_pgo(llvm::Module &module, const Options &opts, const std::string &init_name)
+    {
+        if (!pgo_active(opts)) return;
+
+        // Library copies are linked into every module; counting them per module
+        // would give one function several records
+        for (auto &func : module)
+            if (func.hasLinkOnceODRLinkage() || func.hasAvailableExternallyLinkage())
+                func.addFnAttr(llvm::Attribute::NoProfile);
+
+        llvm::legacy::PassManager passManager;
+        if (opts.pgo_instrument)
+            passManager.add(llvm::createPGOInstrumentationGenLegacyPass());
+        else
+            passManager.add(llvm::createPGOInstrumentationUseLegacyPass(opts.pgo_use));
+        passManager.run(module);
+
+        if (opts.pgo_instrument)
+            lower_profile_counters(module, init_name);
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_PROFILE_HPP
@@ -0,0 +1,318 @@
+#ifndef DRIVER_SERVER_HPP
+#define DRIVER_SERVER_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <csignal>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include "./Options.hpp"
+#include "./Build.hpp"
+
+//
+// Persistent compile server.
+//
+// Wire format: every message is a frame `<channel:1><length:u32 BE><payload>`.
+//   client -> server  'q'  cwd '\0' arg0 '\0' arg1 ...
+//   server -> client  'o'  stdout bytes
+//                     'e'  stderr bytes
+//                     'x'  decimal exit code, always the last frame
+//
+// The server stays single-threaded: it reads each request and forks a child
+// for the connection, so requests from several clients run in parallel. The
+// command itself runs in a further fork whose stdout and stderr stream back
+// as frames; a crash in user code or the compiler ends only that request.
+//
+namespace SereDriver {
+
+    inline bool write_all(int fd, const char *data, size_t len)
+    {
+        while (len > 0) {
+            ssize_t n = ::write(fd, data, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    inline bool read_all(int fd, char *data, size_t len)
+    {
+        while (len > 0) {
+            ssize_t n = ::read(fd, data, len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    inline bool send_frame(int fd, char channel, const std::string &payload)
+    {
+        char header[5];
+        uint32_t len = htonl(static_cast<uint32_t>(payload.size()));
+        header[0] = channel;
+        std::memcpy(header + 1, &len, sizeof(len));
+        return write_all(fd, header, sizeof(header)) && write_all(fd, payload.data(), payload.size());
+    }
+
+    // Frame lengths come from the peer; anything above max_len is refused
+    // rather than allocated.
+    constexpr size_t max_request_frame = 1 << 20;
+    constexpr size_t max_output_frame = 16 << 20;
+
+    inline bool recv_frame(int fd, char &channel, std::string &payload, size_t max_len)
+    {
+        char header[5];
+        if (!read_all(fd, header, sizeof(header))) return false;
+        uint32_t len;
+        std::memcpy(&len, header + 1, sizeof(len));
+        channel = header[0];
+        if (ntohl(len) > max_len) return false;
+        payload.resize(ntohl(len));
+        return read_all(fd, payload.data(), payload.size());
+    }
+
+    inline std::string absolute_path(const std::string &path, const std::string &cwd)
+    {
+        if (path.empty() || path[0] == '/') return path;
+        return cwd + "/" + path;
+    }
+
+    inline sockaddr_un make_socket_address(const std::string &path)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            throw std::invalid_argument("Socket path too long: " + path);
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        return addr;
+    }
+
+    // Runs the command in a forked child that inherits the warm state, with
+    // its stdout and stderr (scanner errors included) relayed to the client.
+    inline int execute_forked(int client_fd, const Options &opts)
+    {
+        int out_pipe[2], err_pipe[2];
+        if (pipe(out_pipe) != 0 || pipe(err_pipe) != 0)
+            throw std::runtime_error("pipe() failed: " + std::string(std::strerror(errno)));
+
+        pid_t pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("fork() failed: " + std::string(std::strerror(errno)));
+
+        if (pid == 0) {
+            ::close(client_fd);
+            dup2(out_pipe[1], STDOUT_FILENO);
+            dup2(err_pipe[1], STDERR_FILENO);
+            ::close(out_pipe[0]); ::close(out_pipe[1]);
+            ::close(err_pipe[0]); ::close(err_pipe[1]);
+            int rc = execute(opts, llvm::outs(), llvm::errs());
+            llvm::outs().flush();
+            llvm::errs().flush();
+            std::fflush(nullptr);
+            _exit(rc);
+        }
+
+        ::close(out_pipe[1]);
+        ::close(err_pipe[1]);
+        pollfd fds[2] = {{out_pipe[0], POLLIN, 0}, {err_pipe[0], POLLIN, 0}};
+        const char channels[2] = {'o', 'e'};
+        int open_fds = 2;
+        char chunk[4096];
+        while (open_fds > 0) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < 2; ++i) {
+                if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP))) continue;
+                ssize_t n = ::read(fds[i].fd, chunk, sizeof(chunk));
+                if (n > 0) {
+                    send_frame(client_fd, channels[i], std::string(chunk, static_cast<size_t>(n)));
+                } else {
+                    ::close(fds[i].fd);
+                    fds[i].fd = -1;
+                    --open_fds;
+                }
+            }
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (WIFEXITED(status)) return WEXITSTATUS(status);
+        send_frame(client_fd, 'e', "Program terminated by signal " + std::to_string(WTERMSIG(status)) + "\n");
+        return 128 + WTERMSIG(status);
+    }
+
+    // Reads a request frame: the client's working directory and arguments.
+    inline bool read_request(int client_fd, std::string &cwd, std::vector<std::string> &args)
+    {
+        char channel;
+        std::string payload;
+        if (!recv_frame(client_fd, channel, payload, max_request_frame) || channel != 'q')
+            return false;
+
+        std::vector<std::string> fields;
+        size_t pos = 0;
+        while (pos <= payload.size()) {
+            size_t end = payload.find('\0', pos);
+            if (end == std::string::npos) end = payload.size();
+            fields.push_back(payload.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        if (fields.empty() || fields.front().empty())
+            return false; // a request always starts with the client's cwd
+        cwd = fields.front();
+        args.assign(fields.begin() + 1, fields.end());
+        return true;
+    }
+
+    // Serves one request in the connection's child process.
+    inline void serve_request(int client_fd, const std::string &cwd, const std::vector<std::string> &args)
+    {
+        int rc = 0;
+        try {
+            Options opts = parse_options(args);
+            if (opts.command == Command::SERVER || opts.command == Command::CLIENT)
+                throw UsageError("cannot forward --server/--client to a server");
+            opts.input = absolute_path(opts.input, cwd);
+            opts.output = absolute_path(opts.output.empty() ? default_output_path(opts) : opts.output, cwd);
+            opts.cache_dir = absolute_path(opts.cache_dir, cwd);
+            opts.build_dir = absolute_path(opts.build_dir, cwd);
+            opts.thinlto_cache_dir = absolute_path(opts.thinlto_cache_dir, cwd);
+            opts.pgo_use = absolute_path(opts.pgo_use, cwd);
+            for (auto &dir : opts.include_dirs)
+                dir = absolute_path(dir, cwd);
+            rc = execute_forked(client_fd, opts);
+        } catch (const UsageError &e) {
+            send_frame(client_fd, 'e', std::string("Error: ") + e.what() + "\n");
+            rc = 64;
+        } catch (const std::exception &e) {
+            send_frame(client_fd, 'e', std::string("Error: ") + e.what() + "\n");
+            rc = 1;
+        }
+        send_frame(client_fd, 'x', std::to_string(rc));
+    }
+
+    inline int run_server(const Options &opts)
+    {
+        warm_up();
+        signal(SIGPIPE, SIG_IGN); // a vanished client must not kill the server
+
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            std::cerr << "Error: socket() failed: " << std::strerror(errno) << std::endl;
+            return 71;
+        }
+
+        sockaddr_un addr = make_socket_address(opts.socket_path);
+        ::unlink(opts.socket_path.c_str());
+        if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 64) != 0) {
+            std::cerr << "Error: cannot listen on " << opts.socket_path << ": " << std::strerror(errno) << std::endl;
+            ::close(listen_fd);
+            return 71;
+        }
+        std::cerr << "sere: listening on " << opts.socket_path << std::endl;
+
+        // A client that stalls mid-request must not hold up the accept loop
+        timeval read_timeout{10, 0};
+        bool running = true;
+        while (running) {
+            int client_fd = accept(listen_fd, nullptr, nullptr);
+            while (waitpid(-1, nullptr, WNOHANG) > 0) {} // connections that finished
+            if (client_fd < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &read_timeout, sizeof(read_timeout));
+
+            std::string cwd;
+            std::vector<std::string> args;
+            if (!read_request(client_fd, cwd, args)) {
+                ::close(client_fd);
+                continue;
+            }
+            if (args.size() == 1 && args[0] == "--shutdown") {
+                send_frame(client_fd, 'x', "0");
+                running = false;
+            } else {
+                pid_t pid = fork();
+                if (pid == 0) {
+                    ::close(listen_fd);
+                    serve_request(client_fd, cwd, args);
+                    _exit(0);
+                }
+                if (pid < 0) {
+                    send_frame(client_fd, 'e', "Error: fork() failed: " + std::string(std::strerror(errno)) + "\n");
+                    send_frame(client_fd, 'x', "71");
+                }
+            }
+            ::close(client_fd);
+        }
+
+        ::close(listen_fd);
+        while (wait(nullptr) > 0 || errno == EINTR) {} // requests still running finish first
+        ::unlink(opts.socket_path.c_str());
+        return 0;
+    }
+
+    // Thin client: forwards argv to the server and replays its output.
+    inline int run_client(const Options &opts)
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr = make_socket_address(opts.socket_path);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "Error: no sere server at " << opts.socket_path << " (start one with --server)" << std::endl;
+            if (fd >= 0) ::close(fd);
+            return 69;
+        }
+
+        char cwd[4096];
+        std::string request = getcwd(cwd, sizeof(cwd)) ? cwd : ".";
+        for (const auto &arg : opts.forward_args) {
+            request += '\0';
+            request += arg;
+        }
+
+        int rc = 70;
+        if (send_frame(fd, 'q', request)) {
+            char channel;
+            std::string payload;
+            while (recv_frame(fd, channel, payload, max_output_frame)) {
+                if (channel == 'o') {
+                    std::cout << payload << std::flush;
+                } else if (channel == 'e') {
+                    std::cerr << payload << std::flush;
+                } else if (channel == 'x') {
+                    if (!payload.empty() && payload.size() <= 3 &&
+                        payload.find_first_not_of("0123456789") == std::string::npos)
+                        rc = std::stoi(payload);
+                    break;
+                }
+            }
+        }
+        ::close(fd);
+        return rc;
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_SERVER_HPP
@@ -0,0 +1,415 @@
+#ifndef DRIVER_SESSION_HPP
+#define DRIVER_SESSION_HPP
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+
+#include "../Scanner/Token.hpp"
+#include "../Scanner/Scanner.hpp"
+#include "../Parser/Parser.hpp"
+#include "../Parser/AST/Visitor.hpp"
+#include "../Parser/AST/Midlevel/ConstantFolding.hpp"
+#include "../SIR/Printer.hpp"
+#include "../IR/CallGraph.hpp"
+#include "../Std/Registry.hpp"
+#include "./Options.hpp"
+#include "./Pipeline.hpp"
+#include "./ObjectCache.hpp"
+#include "./Profile.hpp"
+#include "./Target.hpp"
+
+namespace SereDriver {
+
+    inline std::vector<unsigned char> sere_read_file(const char *filepath)
+    {
+        if (filepath == nullptr)
+        {
+            throw std::invalid_argument("Filepath is null");
+        }
+
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("File not found or could not be opened");
+        }
+
+        std::streamsize size = file.tellg();
+        if (size < 0)
+        {
+            throw std::runtime_error("Failed to determine file size");
+        }
+        file.seekg(0, std::ios::beg);
+
+        std::vector<unsigned char> buffer(static_cast<size_t>(size));
+        if (!file.read(reinterpret_cast<char *>(buffer.data()), size))
+        {
+            throw std::runtime_error("File read error");
+        }
+
+        // The scanner takes a C string
+        buffer.push_back('\0');
+        return buffer;
+    }
+
+    // One-time, process-wide initialization. A server pays this once.
+    inline void warm_up()
+    {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+            llvm::InitializeNativeTargetAsmParser();
+            SereLib::load_registry();
+        });
+    }
+
+    // Runs an external tool (ld, cc) and reports failures to `err`.
+    inline int run_tool(const std::string &tool, const std::vector<std::string> &args, llvm::raw_ostream &err)
+    {
+        auto program = llvm::sys::findProgramByName(tool);
+        if (!program) {
+            err << "Cannot find '" << tool << "' in PATH\n";
+            return 69;
+        }
+        std::vector<llvm::StringRef> argv = {*program};
+        for (const auto &arg : args) argv.push_back(arg);
+        std::string message;
+        int rc = llvm::sys::ExecuteAndWait(*program, argv, llvm::None, {}, 0, 0, &message);
+        if (rc != 0) {
+            err << tool << " failed" << (message.empty() ? "" : ": " + message) << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    //
+    // A single compilation: source -> AST -> module in RT::ctx -> optimized module.
+    // Sessions reuse the warm LLVMContext and library cache held by RT::ctx.
+    //
+    class Session
+    {
+    public:
+        explicit Session(const Options &opts) : opts_(opts), target_(resolve_target_cpu(opts.march)) {}
+
+        // Reads and parses the input. Returns false when nothing could be parsed.
+        bool parse()
+        {
+            std::vector<unsigned char> buffer = sere_read_file(opts_.input.c_str());
+            SereLexer::Scanner scanner(reinterpret_cast<const char *>(buffer.data()));
+            SereLexer::TokenList tokens = scanner.tokenize();
+            SereParser::Parser parser(tokens);
+            stats_ = SereParser::fold_constants(parser.parse(), opts_.checked_arith);
+            return !stats_.empty();
+        }
+
+        // Lowers the parsed statements into a fresh RT::ctx module.
+        void lower_parsed(const std::string &module_name = "__module__", const std::string &init_name = "__init__",
+                          bool exports = false)
+        {
+            init_name_ = init_name;
+            SereParser::RT::reset(module_name, init_name, exports);
+            SereParser::RT::sir.keep = opts_.emit == EmitKind::SIR;
+            SereParser::RT::sir.pipeline = opts_.sir_passes;
+            SereParser::RT::ctx.checked_arith = opts_.checked_arith;
+            SereLib::include_lib("core");
+
+            auto type_checker = std::make_shared<SereParser::TypeChecker>();
+            auto expr_visitor = std::make_shared<SereParser::ExprVisitor<SereParser::SereObject>>(type_checker);
+            auto visitor = std::make_shared<SereParser::StatVisitor<SereParser::SereObject>>(expr_visitor);
+            for (auto stat : stats_) {
+                SereParser::SereObject result = stat.get()->accept(*visitor);
+            }
+            SereParser::RT::ctx.done();
+            SereLib::flush_output_on_return(*SereParser::RT::ctx.get_module(), {init_name, "__main__"});
+            SereLib::flush_output_before_traps(*SereParser::RT::ctx.get_module());
+        }
+
+        bool lower()
+        {
+            if (!parse())
+                return false;
+            lower_parsed();
+            return true;
+        }
+
+        const std::vector<std::shared_ptr<SereParser::StatAST>> &statements() const { return stats_; }
+
+        int compile(llvm::raw_ostream &out, llvm::raw_ostream &err)
+        {
+            if (!lower()) {
+                err << "Failed to parse expression.\n";
+                return 66;
+            }
+
+            return emit_lowered(out, err);
+        }
+
+        // Effects inferred for each defined function by the last emit (SereIR::EffectBits).
+        uint32_t effects_of(const std::string &symbol) const
+        {
+            auto found = effects_.find(symbol);
+            return found == effects_.end() ? 0 : found->second;
+        }
+
+        // Optimizes and writes the module currently held by RT::ctx.
+        int emit_lowered(llvm::raw_ostream &out, llvm::raw_ostream &err)
+        {
+            if (opts_.emit == EmitKind::SIR)
+                return emit_sir(out, err);
+            auto module = SereParser::RT::ctx.get_module();
+            auto machine = create_target_machine(opts_.opt_level, target_);
+            prepare_module_for_target(*module, *machine);
+            apply_pgo(*module, opts_, init_name_);
+            multiversion_functions(*module, opts_.march, /*use_ifunc=*/opts_.emit != EmitKind::BC);
+            internalize_module(*module);
+            std::unique_ptr<SereIR::ProgramCallGraph> graph;
+            if (!opts_.callgraph.empty())
+                graph = std::make_unique<SereIR::ProgramCallGraph>(*module); // before shrinking: shows what goes
+            SereIR::shrink_program(*module, opts_.opt_level);
+            effects_ = SereIR::infer_effects(*module);
+            if (graph)
+                return emit_callgraph(*graph, *module, out, err);
+            if (opts_.emit == EmitKind::OBJ)
+                return emit_object_file(*module, *machine, err);
+            if (opts_.emit == EmitKind::BC)
+                return emit_bitcode_file(*module, *machine, err);
+
+            if (compile_optimization_passes(module, opts_.opt_level, err, machine.get()) != 0)
+                return 1;
+
+            if (opts_.output.empty()) {
+                module->print(out, nullptr);
+                return 0;
+            }
+
+            std::error_code ec;
+            llvm::raw_fd_ostream file(opts_.output, ec, llvm::sys::fs::OF_Text);
+            if (ec) {
+                err << "Cannot open output file '" << opts_.output << "': " << ec.message() << "\n";
+                return 73;
+            }
+            module->print(file, nullptr);
+            return 0;
+        }
+
+        // JIT-compiles the module, runs __init__ then __main__ and returns
+        // __main__'s result (or 0) as the exit code.
+        int run(llvm::raw_ostream &err)
+        {
+            if (!lower()) {
+                err << "Failed to parse expression.\n";
+                return 66;
+            }
+
+            std::unique_ptr<FunctionObjectCache> cache;
+            if (!opts_.cache_dir.empty())
+                cache = std::make_unique<FunctionObjectCache>(opts_.cache_dir);
+
+            llvm::orc::LLJITBuilder builder;
+            if (cache) {
+                builder.setCompileFunctionCreator([&cache](llvm::orc::JITTargetMachineBuilder jtmb)
+                        -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+                    auto machine = jtmb.createTargetMachine();
+                    if (!machine) return machine.takeError();
+                    return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(*machine), cache.get());
+                });
+            }
+            auto jit = builder.create();
+            if (!jit) {
+                err << "JIT: " << llvm::toString(jit.takeError()) << "\n";
+                return 70;
+            }
+
+            auto module = SereParser::RT::ctx.take_module();
+            module->setDataLayout((*jit)->getDataLayout());
+            internalize_module(*module);
+            SereIR::shrink_program(*module, opts_.opt_level);
+            effects_ = SereIR::infer_effects(*module);
+
+            llvm::Function *main_fn = module->getFunction("__main__");
+            bool has_main = main_fn != nullptr;
+            bool main_returns_int = main_fn && main_fn->getReturnType()->isIntegerTy();
+
+            auto process_symbols = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                (*jit)->getDataLayout().getGlobalPrefix());
+            if (!process_symbols) {
+                err << "JIT: " << llvm::toString(process_symbols.takeError()) << "\n";
+                return 70;
+            }
+            (*jit)->getMainJITDylib().addGenerator(std::move(*process_symbols));
+
+            if (compile_optimization_passes(module.get(), opts_.opt_level, err) != 0)
+                return 1;
+            std::vector<std::unique_ptr<llvm::Module>> jit_modules;
+            if (cache) {
+                // One optimized module per function; the ObjectCache hands
+                // back the objects of units it already holds.
+                std::string target = (*jit)->getTargetTriple().str();
+                for (auto &unit : split_module(*module, opts_.opt_level, target))
+                    jit_modules.push_back(std::move(unit.module));
+                module.reset();
+            } else {
+                jit_modules.push_back(std::move(module));
+            }
+
+            for (auto &jit_module : jit_modules) {
+                if (auto e = (*jit)->addIRModule(llvm::orc::ThreadSafeModule(std::move(jit_module), SereParser::RT::ctx.ts_ctx))) {
+                    err << "JIT: " << llvm::toString(std::move(e)) << "\n";
+                    return 70;
+                }
+            }
+
+            if (auto init = (*jit)->lookup("__init__")) {
+                reinterpret_cast<void (*)()>(init->getAddress())();
+            } else {
+                llvm::consumeError(init.takeError());
+            }
+
+            int exit_code = 0;
+            if (has_main) {
+                auto entry = (*jit)->lookup("__main__");
+                if (!entry) {
+                    err << "JIT: " << llvm::toString(entry.takeError()) << "\n";
+                    return 70;
+                }
+                if (main_returns_int)
+                    exit_code = static_cast<int>(reinterpret_cast<int64_t (*)()>(entry->getAddress())());
+                else
+                    reinterpret_cast<void (*)()>(entry->getAddress())();
+            }
+            std::fflush(stdout);
+            if (cache && opts_.cache_stats)
+                cache->stats.report(err, cache->dir());
+            return exit_code;
+        }
+
+    private:
+        std::string object_output_path() const
+        {
+            return opts_.output.empty() ? default_output_path(opts_) : opts_.output;
+        }
+
+        // The functions lowered through SIR as they went to LLVM, and those that were not
+        int emit_sir(llvm::raw_ostream &out, llvm::raw_ostream &err)
+        {
+            std::ostringstream text;
+            SereSIR::Printer(text).print(SereParser::RT::sir);
+            if (opts_.output.empty()) {
+                out << text.str();
+                return 0;
+            }
+            return write_output(opts_.output, text.str(), err);
+        }
+
+        // Optimizes and generates code for the module only to measure its frames
+        int emit_callgraph(SereIR::ProgramCallGraph &graph, llvm::Module &module, llvm::raw_ostream &out,
+                           llvm::raw_ostream &err)
+        {
+            auto machine = create_target_machine(opts_.opt_level, target_, /*stack_sizes=*/true);
+            if (compile_optimization_passes(&module, opts_.opt_level, err, machine.get()) != 0)
+                return 1;
+            auto object = emit_object(module, *machine);
+            graph.measure(module, llvm::StringRef(object.data(), object.size()));
+
+            std::string text;
+            llvm::raw_string_ostream stream(text);
+            if (opts_.callgraph == "dot")
+                graph.write_dot(stream);
+            else
+                graph.write_json(stream);
+            if (opts_.output.empty()) {
+                out << stream.str();
+                return 0;
+            }
+            return write_output(opts_.output, stream.str(), err);
+        }
+
+        int write_output(const std::string &path, llvm::StringRef bytes, llvm::raw_ostream &err)
+        {
+            std::error_code ec;
+            llvm::raw_fd_ostream file(path, ec, llvm::sys::fs::OF_None);
+            if (ec) {
+                err << "Cannot open output file '" << path << "': " << ec.message() << "\n";
+                return 73;
+            }
+            file << bytes;
+            return 0;
+        }
+
+        int emit_object_file(llvm::Module &module, llvm::TargetMachine &machine, llvm::raw_ostream &err)
+        {
+            if (compile_optimization_passes(&module, opts_.opt_level, err, &machine) != 0)
+                return 1;
+            // Profile counters are module globals and ifuncs tie a resolver to its
+            // clones; neither survives splitting into per-function units
+            if (opts_.cache_dir.empty() || pgo_active(opts_) || !module.ifunc_empty()) {
+                auto object = emit_object(module, machine);
+                return write_output(object_output_path(), llvm::StringRef(object.data(), object.size()), err);
+            }
+
+            // Per-function objects from the cache, relinked into one relocatable
+            FunctionObjectCache cache(opts_.cache_dir);
+            std::string target = machine.getTargetTriple().str() + "/" + machine.getTargetCPU().str() +
+                                 "/" + machine.getTargetFeatureString().str();
+            std::vector<std::string> objects;
+            for (auto &unit : split_module(module, opts_.opt_level, target)) {
+                if (!cache.lookup(unit.key)) {
+                    auto object = emit_object(*unit.module, machine);
+                    cache.store(unit.key, llvm::StringRef(object.data(), object.size()));
+                }
+                objects.push_back(cache.path_for(unit.key));
+            }
+
+            int rc = link_relocatable(objects, object_output_path(), err);
+            if (opts_.cache_stats)
+                cache.stats.report(err, cache.dir());
+            return rc;
+        }
+
+        // The per-function cache does not apply: ThinLTO caches its own backend output
+        int emit_bitcode_file(llvm::Module &module, llvm::TargetMachine &machine, llvm::raw_ostream &err)
+        {
+            if (compile_optimization_passes(&module, opts_.opt_level, err, &machine) != 0)
+                return 1;
+            auto bitcode = emit_thin_bitcode(module);
+            return write_output(object_output_path(), llvm::StringRef(bitcode.data(), bitcode.size()), err);
+        }
+
+        // The functions split_module made hidden globals are local again afterwards
+        int link_relocatable(const std::vector<std::string> &objects, const std::string &output, llvm::raw_ostream &err)
+        {
+            std::vector<std::string> args = {"-r", "-o", output};
+            args.insert(args.end(), objects.begin(), objects.end());
+            if (int rc = run_tool("ld", args, err))
+                return rc;
+            return run_tool("objcopy", {"--localize-hidden", output}, err);
+        }
+
+        Options opts_;
+        std::vector<std::shared_ptr<SereParser::StatAST>> stats_;
+        std::string init_name_ = "__init__";
+        TargetCPU target_;
+        std::unordered_map<std::string, uint32_t> effects_;
+    };
+
+} // namespace SereDriver
+
+#endif // DRIVER_SESSION_HPP
@@ -0,0 +1,210 @@
+#ifndef DRIVER_TARGET_HPP
+#define DRIVER_TARGET_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalIFunc.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/X86TargetParser.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+//
+// What the generated code may assume about the CPU (`--march`), and
+// `@multiversion` functions: one clone per x86-64 ISA level above the
+// build's own, picked once at load time through an ifunc.
+//
+namespace SereDriver {
+
+    // CPU the code is generated for; features only for `native`.
+    struct TargetCPU {
+        std::string cpu = "generic";
+        std::string features;  // "+avx2,-avx512f,..."
+
+        std::string key() const { return cpu + " " + features; }
+    };
+
+    // x86-64 micro-architecture levels, lowest first
+    inline const char *const ISA_LEVELS[] = {"x86-64", "x86-64-v2", "x86-64-v3", "x86-64-v4"};
+
+    inline bool valid_march(const std::string &march)
+    {
+        if (march == "native") return true;
+        return std::find(std::begin(ISA_LEVELS), std::end(ISA_LEVELS), march) != std::end(ISA_LEVELS);
+    }
+
+    inline TargetCPU resolve_target_cpu(const std::string &march)
+    {
+        TargetCPU target;
+        if (march.empty()) return target;
+        if (march != "native") {
+            target.cpu = march;
+            return target;
+        }
+        target.cpu = llvm::sys::getHostCPUName().str();
+        llvm::StringMap<bool> host;
+        if (llvm::sys::getHostCPUFeatures(host)) {
+            std::vector<std::string> features;
+            for (const auto &feature : host)
+                features.push_back((feature.second ? "+" : "-") + feature.first().str());
+            std::sort(features.begin(), features.end()); // StringMap order isn't stable; build keys need it
+            target.features = llvm::join(features, ",");
+        }
+        return target;
+    }
+
+    // Functions without their own target attributes get the build's.
+    inline void set_function_targets(llvm::Module &module, const TargetCPU &target)
+    {
+        for (auto &func : module) {
+            if (func.isDeclaration() || func.hasFnAttribute("target-cpu")) continue;
+            func.addFnAttr("target-cpu", target.cpu);
+            if (!target.features.empty())
+                func.addFnAttr("target-features", target.features);
+        }
+    }
+
+    // Index into ISA_LEVELS of the build's baseline; -1 when it isn't a level (native).
+    inline int isa_level_of(const std::string &march)
+    {
+        if (march.empty()) return 0;
+        auto found = std::find(std::begin(ISA_LEVELS), std::end(ISA_LEVELS), march);
+        return found == std::end(ISA_LEVELS) ? -1 : static_cast<int>(found - std::begin(ISA_LEVELS));
+    }
+
+    // Feature word libgcc's __cpu_indicator_init fills in (what __builtin_cpu_supports reads).
+    inline uint32_t isa_level_mask(int level)
+    {
+        static const std::vector<std::vector<llvm::StringRef>> required = {
+            {},
+            {"popcnt", "sse3", "ssse3", "sse4.1", "sse4.2"},
+            {"popcnt", "sse3", "ssse3", "sse4.1", "sse4.2", "avx", "avx2", "bmi", "bmi2", "fma"},
+            {"popcnt", "sse3", "ssse3", "sse4.1", "sse4.2", "avx", "avx2", "bmi", "bmi2", "fma",
+             "avx512f", "avx512bw", "avx512cd", "avx512dq", "avx512vl"},
+        };
+        return static_cast<uint32_t>(llvm::X86::getCpuSupportsMask(required[level]));
+    }
+
+    //
+    // Calls through a pointer that the first call fills in from the resolver.
+    // Used instead of an ifunc for ThinLTO, whose LLVM 14 thin link loses
+    // track of ifunc resolvers.
+    //
+    inline void define_lazy_dispatch(llvm::Function *dispatch, llvm::Function *resolver)
+    {
+        auto &context = dispatch->getContext();
+        auto *ptr_ty = dispatch->getType();
+        auto *slot = new llvm::GlobalVariable(*dispatch->getParent(), ptr_ty, false, llvm::GlobalValue::InternalLinkage,
+                                              llvm::ConstantPointerNull::get(ptr_ty), dispatch->getName() + ".impl");
+        auto *entry = llvm::BasicBlock::Create(context, "entry", dispatch);
+        auto *resolve = llvm::BasicBlock::Create(context, "resolve", dispatch);
+        auto *call = llvm::BasicBlock::Create(context, "call", dispatch);
+        llvm::IRBuilder<> builder(entry);
+        auto *cached = builder.CreateLoad(ptr_ty, slot);
+        cached->setAtomic(llvm::AtomicOrdering::Monotonic);
+        cached->setAlignment(llvm::Align(8));
+        builder.CreateCondBr(builder.CreateIsNull(cached), resolve, call);
+
+        builder.SetInsertPoint(resolve);
+        llvm::Value *resolved = builder.CreateCall(resolver);
+        auto *store = builder.CreateStore(resolved, slot); // racing first calls store the same pointer
+        store->setAtomic(llvm::AtomicOrdering::Monotonic);
+        store->setAlignment(llvm::Align(8));
+        builder.CreateBr(call);
+
+        builder.SetInsertPoint(call);
+        auto *target = builder.CreatePHI(ptr_ty, 2);
+        target->addIncoming(cached, entry);
+        target->addIncoming(resolved, resolve);
+        std::vector<llvm::Value *> args;
+        for (auto &arg : dispatch->args()) args.push_back(&arg);
+        auto *result = builder.CreateCall(dispatch->getFunctionType(), target, args);
+        result->setTailCall();
+        if (dispatch->getReturnType()->isVoidTy()) builder.CreateRetVoid();
+        else builder.CreateRet(result);
+    }
+
+    //
+    // Replaces every function marked `sere-multiversion` (see `@multiversion`)
+    // with an ifunc of the same name. Its resolver runs once, while the
+    // dynamic loader processes relocations, and returns the clone for the
+    // highest ISA level the CPU supports; the original body becomes the
+    // baseline fallback. Nothing happens for `--march=native` or non-x86
+    // targets, where there is only one sensible version.
+    //
+    inline void multiversion_functions(llvm::Module &module, const std::string &march, bool use_ifunc = true)
+    {
+        std::vector<llvm::Function *> marked;
+        for (auto &func : module)
+            if (!func.isDeclaration() && func.hasFnAttribute("sere-multiversion"))
+                marked.push_back(&func);
+        if (marked.empty()) return;
+
+        for (auto *func : marked)
+            func->removeFnAttr("sere-multiversion");
+        int base = isa_level_of(march);
+        if (base < 0 || llvm::Triple(module.getTargetTriple()).getArch() != llvm::Triple::x86_64) return;
+        int levels = static_cast<int>(std::size(ISA_LEVELS));
+        if (base == levels - 1) return;
+
+        auto &context = module.getContext();
+        auto *i32 = llvm::Type::getInt32Ty(context);
+        // struct __processor_model { unsigned vendor, type, subtype; unsigned features[1]; }
+        auto *model_ty = llvm::StructType::get(context, {i32, i32, i32, llvm::ArrayType::get(i32, 1)});
+        auto *cpu_model = module.getOrInsertGlobal("__cpu_model", model_ty);
+        auto cpu_init = module.getOrInsertFunction("__cpu_indicator_init", llvm::Type::getVoidTy(context));
+
+        for (auto *func : marked) {
+            std::string name = func->getName().str();
+            auto linkage = func->getLinkage();
+            func->setName(name + ".default");
+            func->setLinkage(llvm::GlobalValue::InternalLinkage);
+
+            auto *resolver = llvm::Function::Create(llvm::FunctionType::get(func->getType(), false),
+                                                    llvm::GlobalValue::InternalLinkage, name + ".resolver", module);
+            if (use_ifunc) {
+                func->replaceAllUsesWith(llvm::GlobalIFunc::create(func->getFunctionType(), func->getAddressSpace(),
+                                                                   linkage, name, resolver, &module));
+            } else {
+                auto *dispatch = llvm::Function::Create(func->getFunctionType(), linkage, name, module);
+                dispatch->copyAttributesFrom(func);
+                func->replaceAllUsesWith(dispatch);
+                define_lazy_dispatch(dispatch, resolver);
+            }
+
+            llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", resolver));
+            // Resolvers can run before constructors, so fill __cpu_model first
+            builder.CreateCall(cpu_init);
+            auto *words_ty = llvm::ArrayType::get(i32, 1);
+            llvm::Value *words = builder.CreateConstInBoundsGEP2_32(model_ty, cpu_model, 0, 3);
+            llvm::Value *features = builder.CreateLoad(i32, builder.CreateConstInBoundsGEP2_32(words_ty, words, 0, 0), "features");
+
+            llvm::Value *chosen = func;
+            for (int level = base + 1; level < levels; ++level) {
+                llvm::ValueToValueMapTy vmap;
+                llvm::Function *clone = llvm::CloneFunction(func, vmap);
+                std::string suffix = ISA_LEVELS[level];
+                std::replace(suffix.begin(), suffix.end(), '-', '_');
+                clone->setName(name + "." + suffix);
+                clone->removeFnAttr("target-features");
+                clone->addFnAttr("target-cpu", ISA_LEVELS[level]);
+
+                uint32_t mask = isa_level_mask(level);
+                llvm::Value *supported = builder.CreateICmpEQ(builder.CreateAnd(features, mask), builder.getInt32(mask));
+                chosen = builder.CreateSelect(supported, clone, chosen);
+            }
+            builder.CreateRet(chosen);
+        }
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_TARGET_HPP
@@ -0,0 +1,53 @@
+#ifndef DRIVER_THINLTO_HPP
+#define DRIVER_THINLTO_HPP
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+
+#include "./Options.hpp"
+#include "./Target.hpp"
+
+#ifndef SERE_LLVM_LIBRARY_DIR
+#define SERE_LLVM_LIBRARY_DIR ""
+#endif
+
+namespace SereDriver {
+
+    // LLVM's gold plugin: it runs the thin link over the module summaries,
+    // then one parallel backend job per module (import, optimize, codegen).
+    inline std::string thinlto_plugin_path()
+    {
+        llvm::SmallString<256> path(SERE_LLVM_LIBRARY_DIR);
+        llvm::sys::path::append(path, "LLVMgold.so");
+        if (!llvm::sys::fs::exists(path))
+            throw std::runtime_error("ThinLTO needs the LLVM gold plugin, not found at '" + std::string(path.str()) + "'.");
+        return std::string(path.str());
+    }
+
+    //
+    // Driver flags that make `cc` link ThinLTO bitcode alongside native
+    // objects. Backend outputs are keyed by LLVM's ThinLTO cache key and
+    // reused from `cache_dir` across builds.
+    //
+    inline std::vector<std::string> thinlto_link_flags(const Options &opts, const std::string &cache_dir)
+    {
+        std::vector<std::string> flags = {
+            "-fuse-ld=gold",
+            "-Wl,-plugin," + thinlto_plugin_path(),
+            "-Wl,-plugin-opt=O" + std::to_string(opts.opt_level),
+            "-Wl,-plugin-opt=mcpu=" + resolve_target_cpu(opts.march).cpu,
+            "-Wl,-plugin-opt=cache-dir=" + cache_dir,
+        };
+        if (opts.jobs)
+            flags.push_back("-Wl,-plugin-opt=jobs=" + std::to_string(opts.jobs));
+        return flags;
+    }
+
+} // namespace SereDriver
+
+#endif // DRIVER_THINLTO_HPP
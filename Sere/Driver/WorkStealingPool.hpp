@@ -0,0 +1,137 @@
+#ifndef DRIVER_WORKSTEALINGPOOL_HPP
+#define DRIVER_WORKSTEALINGPOOL_HPP
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+namespace SereDriver {
+
+    //
+    // Fixed-size pool where every worker owns a deque. Workers pop their own
+    // newest task (LIFO, cache-warm) and steal the oldest task from a sibling
+    // when they run dry. Tasks submitted from inside a worker land on that
+    // worker's deque, so a finished module's dependents tend to stay local.
+    //
+    class WorkStealingPool {
+    public:
+        using Task = std::function<void()>;
+
+        explicit WorkStealingPool(unsigned workers)
+            : queues_(workers == 0 ? 1 : workers) {
+            for (unsigned i = 0; i < queues_.size(); ++i)
+                threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+
+        ~WorkStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto& thread : threads_) thread.join();
+        }
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        unsigned size() const { return static_cast<unsigned>(queues_.size()); }
+
+        void submit(Task task) {
+            unsigned target = current_worker() >= 0
+                ? static_cast<unsigned>(current_worker())
+                : next_queue_++ % size();
+            outstanding_.fetch_add(1);
+            {
+                std::lock_guard<std::mutex> lock(queues_[target].mutex);
+                queues_[target].tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                ++generation_;
+            }
+            wake_.notify_one();
+        }
+
+        // Blocks until every submitted task (and the tasks they spawned) ran.
+        void wait_idle() {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            idle_.wait(lock, [this] { return outstanding_.load() == 0; });
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        static int& current_worker() {
+            static thread_local int index = -1;
+            return index;
+        }
+
+        bool pop_local(unsigned self, Task& task) {
+            std::lock_guard<std::mutex> lock(queues_[self].mutex);
+            if (queues_[self].tasks.empty()) return false;
+            task = std::move(queues_[self].tasks.back());
+            queues_[self].tasks.pop_back();
+            return true;
+        }
+
+        bool steal(unsigned self, Task& task) {
+            for (unsigned offset = 1; offset < size(); ++offset) {
+                Queue& victim = queues_[(self + offset) % size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.tasks.empty()) continue;
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+            return false;
+        }
+
+        void worker_loop(unsigned self) {
+            current_worker() = static_cast<int>(self);
+            while (true) {
+                uint64_t seen;
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex_);
+                    seen = generation_;
+                }
+
+                Task task;
+                if (pop_local(self, task) || steal(self, task)) {
+                    task();
+                    if (outstanding_.fetch_sub(1) == 1) {
+                        std::lock_guard<std::mutex> lock(sleep_mutex_);
+                        idle_.notify_all();
+                    }
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+            }
+        }
+
+        std::vector<Queue> queues_;
+        std::vector<std::thread> threads_;
+        std::atomic<unsigned> next_queue_{0};
+        std::atomic<unsigned> outstanding_{0};
+
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        uint64_t generation_ = 0;
+        bool stopping_ = false;
+    };
+
+} // namespace SereDriver
+
+#endif // DRIVER_WORKSTEALINGPOOL_HPP
@@ -0,0 +1,418 @@
+#ifndef IR_ARITH_HPP
+#define IR_ARITH_HPP
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/Module.h>
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "./CodeGenContext.hpp"
+
+//
+// Python semantics for `//`, `%` and `**`, which no single instruction
+// has. `//` rounds toward negative infinity and `%` takes the sign of the
+// divisor (for unsigned types both are plain division and remainder); a
+// constant power-of-two divisor turns them into a shift and a mask.
+// Integer `**` is exponentiation by squaring, unrolled for constant
+// exponents. Division by zero traps where Python would raise, as does
+// the signed minimum divided by -1, and with --checked-arith so does `+`,
+// `-`, `*` or `**` that overflows. Also the trip
+// count of a counted `for` loop over range().
+//
+namespace SereIR {
+
+    // k when `value` is the constant 2^k (k >= 1)
+    inline std::optional<unsigned> power_of_two_shift(llvm::Value* value) {
+        auto* constant = llvm::dyn_cast<llvm::ConstantInt>(value);
+        if (!constant || constant->isNegative() || !constant->getValue().isPowerOf2() || constant->isOne())
+            return std::nullopt;
+        return constant->getValue().logBase2();
+    }
+
+    inline void check_divisor(CodeGenContext& ctx, llvm::Value* divisor) {
+        if (auto* constant = llvm::dyn_cast<llvm::ConstantInt>(divisor)) {
+            if (constant->isZero()) throw std::runtime_error("Integer division by zero.");
+            return;
+        }
+        ctx.trap_if(ctx.builder.CreateICmpEQ(divisor, llvm::ConstantInt::get(divisor->getType(), 0)), "divzero");
+    }
+
+    // Signed `a / -1` overflows for the type's minimum, where sdiv and srem
+    // are undefined: it traps as a zero divisor does, whether or not the
+    // divisor was proven non-zero.
+    inline void check_quotient(CodeGenContext& ctx, llvm::Value* a, llvm::Value* divisor) {
+        auto& builder = ctx.builder;
+        auto* type = llvm::cast<llvm::IntegerType>(a->getType());
+        auto* min = llvm::ConstantInt::get(type, llvm::APInt::getSignedMinValue(type->getBitWidth()));
+        auto* constant_divisor = llvm::dyn_cast<llvm::ConstantInt>(divisor);
+        auto* constant_a = llvm::dyn_cast<llvm::ConstantInt>(a);
+        if ((constant_divisor && !constant_divisor->isMinusOne()) || (constant_a && constant_a != min)) return;
+        if (constant_divisor && constant_a) throw std::runtime_error("Integer overflow.");
+        llvm::Value* overflows = builder.CreateICmpEQ(a, min);
+        if (!constant_divisor)
+            overflows = builder.CreateAnd(builder.CreateICmpEQ(divisor, llvm::ConstantInt::getAllOnesValue(type)), overflows);
+        ctx.trap_if(overflows, "overflow");
+    }
+
+    // True when a truncated remainder must move one divisor toward floor rounding
+    inline llvm::Value* signs_differ(llvm::IRBuilder<>& builder, llvm::Value* remainder, llvm::Value* divisor) {
+        if (remainder->getType()->isFloatingPointTy()) {
+            llvm::Value* zero = llvm::ConstantFP::get(remainder->getType(), 0.0);
+            return builder.CreateAnd(builder.CreateFCmpUNE(remainder, zero),
+                                     builder.CreateXor(builder.CreateFCmpOLT(remainder, zero),
+                                                       builder.CreateFCmpOLT(divisor, zero)));
+        }
+        llvm::Value* zero = llvm::ConstantInt::get(remainder->getType(), 0);
+        return builder.CreateAnd(builder.CreateICmpNE(remainder, zero),
+                                 builder.CreateICmpSLT(builder.CreateXor(remainder, divisor), zero));
+    }
+
+    //
+    // Python's float_divmod, {a // b, a % b}: the remainder is fmod moved to
+    // the divisor's sign (a zero one takes it too), and the quotient is
+    // (a - remainder) / b rounded to the nearest integer, so the two agree
+    // (`1.0 // 0.1` is 9.0, as 1.0 % 0.1 is nearly 0.1). ConstValue folds
+    // constants with the same steps (detail::float_floor_divmod).
+    //
+    inline std::pair<llvm::Value*, llvm::Value*> float_floor_divmod(llvm::IRBuilder<>& builder, llvm::Value* a, llvm::Value* b) {
+        llvm::Type* type = a->getType();
+        llvm::Value* zero = llvm::ConstantFP::get(type, 0.0);
+        llvm::Value* one = llvm::ConstantFP::get(type, 1.0);
+        llvm::Value* mod = builder.CreateFRem(a, b);
+        llvm::Value* div = builder.CreateFDiv(builder.CreateFSub(a, mod), b);
+        llvm::Value* adjust = signs_differ(builder, mod, b);
+        div = builder.CreateSelect(adjust, builder.CreateFSub(div, one), div);
+        mod = builder.CreateSelect(builder.CreateFCmpOEQ(mod, zero),
+                                   builder.CreateBinaryIntrinsic(llvm::Intrinsic::copysign, zero, b),
+                                   builder.CreateSelect(adjust, builder.CreateFAdd(mod, b), mod), "mod_tmp");
+        llvm::Value* floored = builder.CreateUnaryIntrinsic(llvm::Intrinsic::floor, div);
+        llvm::Value* round_up = builder.CreateFCmpOGT(builder.CreateFSub(div, floored), llvm::ConstantFP::get(type, 0.5));
+        floored = builder.CreateSelect(round_up, builder.CreateFAdd(floored, one), floored);
+        llvm::Value* signed_zero = builder.CreateBinaryIntrinsic(llvm::Intrinsic::copysign, zero, builder.CreateFDiv(a, b));
+        llvm::Value* quotient = builder.CreateSelect(builder.CreateFCmpOEQ(div, zero), signed_zero, floored, "floordiv_tmp");
+        return {quotient, mod};
+    }
+
+    // `checked`: false when the divisor is known not to be zero (SereSIR::DivisorCheckElimination).
+    inline llvm::Value* true_div(CodeGenContext& ctx, llvm::Value* a, llvm::Value* b, bool is_signed = true, bool checked = true) {
+        if (a->getType()->isFloatingPointTy()) return ctx.builder.CreateFDiv(a, b, "div_tmp");
+        if (checked) check_divisor(ctx, b);
+        if (!is_signed) return ctx.builder.CreateUDiv(a, b, "div_tmp");
+        check_quotient(ctx, a, b);
+        return ctx.builder.CreateSDiv(a, b, "div_tmp");
+    }
+
+    inline llvm::Value* floor_div(CodeGenContext& ctx, llvm::Value* a, llvm::Value* b, bool is_signed = true, bool checked = true) {
+        auto& builder = ctx.builder;
+        if (a->getType()->isFloatingPointTy())
+            return float_floor_divmod(builder, a, b).first;
+        if (auto shift = power_of_two_shift(b))
+            return is_signed ? builder.CreateAShr(a, *shift, "floordiv_tmp") : builder.CreateLShr(a, *shift, "floordiv_tmp");
+        if (checked) check_divisor(ctx, b);
+        if (!is_signed) return builder.CreateUDiv(a, b, "floordiv_tmp");
+        check_quotient(ctx, a, b);
+        llvm::Value* quotient = builder.CreateSDiv(a, b);
+        llvm::Value* remainder = builder.CreateSRem(a, b);
+        return builder.CreateSub(quotient, builder.CreateZExt(signs_differ(builder, remainder, b), a->getType()),
+                                 "floordiv_tmp");
+    }
+
+    inline llvm::Value* floor_mod(CodeGenContext& ctx, llvm::Value* a, llvm::Value* b, bool is_signed = true, bool checked = true) {
+        auto& builder = ctx.builder;
+        if (a->getType()->isFloatingPointTy())
+            return float_floor_divmod(builder, a, b).second;
+        if (power_of_two_shift(b)) {
+            auto* divisor = llvm::cast<llvm::ConstantInt>(b);
+            return builder.CreateAnd(a, divisor->getValue() - 1, "mod_tmp");
+        }
+        if (checked) check_divisor(ctx, b);
+        if (!is_signed) return builder.CreateURem(a, b, "mod_tmp");
+        check_quotient(ctx, a, b);
+        llvm::Value* remainder = builder.CreateSRem(a, b);
+        return builder.CreateSelect(signs_differ(builder, remainder, b), builder.CreateAdd(remainder, b), remainder,
+                                    "mod_tmp");
+    }
+
+    //
+    // Integer `a op b` (`+`, `-`, `*`) that traps when the exact result
+    // does not fit the type, through llvm.[su]{add,sub,mul}.with.overflow
+    // and a cold trap path as for a zero divisor. Constants that overflow
+    // are an error, as a constant zero divisor is.
+    //
+    inline llvm::Value* checked_arith(CodeGenContext& ctx, llvm::Instruction::BinaryOps op, llvm::Value* a, llvm::Value* b,
+                                      bool is_signed, const llvm::Twine& name = "") {
+        auto& builder = ctx.builder;
+        llvm::Intrinsic::ID id;
+        switch (op) {
+        case llvm::Instruction::Add: id = is_signed ? llvm::Intrinsic::sadd_with_overflow : llvm::Intrinsic::uadd_with_overflow; break;
+        case llvm::Instruction::Sub: id = is_signed ? llvm::Intrinsic::ssub_with_overflow : llvm::Intrinsic::usub_with_overflow; break;
+        case llvm::Instruction::Mul: id = is_signed ? llvm::Intrinsic::smul_with_overflow : llvm::Intrinsic::umul_with_overflow; break;
+        default: throw std::runtime_error("checked_arith: not + - *.");
+        }
+        auto* x = llvm::dyn_cast<llvm::ConstantInt>(a);
+        auto* y = llvm::dyn_cast<llvm::ConstantInt>(b);
+        if (x && y) {
+            bool overflow = false;
+            const llvm::APInt &u = x->getValue(), &v = y->getValue();
+            llvm::APInt result = op == llvm::Instruction::Add   ? (is_signed ? u.sadd_ov(v, overflow) : u.uadd_ov(v, overflow))
+                                 : op == llvm::Instruction::Sub ? (is_signed ? u.ssub_ov(v, overflow) : u.usub_ov(v, overflow))
+                                                                : (is_signed ? u.smul_ov(v, overflow) : u.umul_ov(v, overflow));
+            if (overflow) throw std::runtime_error("Integer overflow.");
+            return llvm::ConstantInt::get(a->getType(), result);
+        }
+        llvm::Value* pair = builder.CreateBinaryIntrinsic(id, a, b);
+        ctx.trap_if(builder.CreateExtractValue(pair, 1, "overflowed"), "overflow");
+        return builder.CreateExtractValue(pair, 0, name);
+    }
+
+    //
+    // i64 __sere_ipow(i64 base, i64 exp): square-and-multiply for exponents
+    // only known at run time. Internal to each module, so it is never
+    // exported for inlining, and the optimizer inlines it where it pays.
+    //
+    inline llvm::Function* int_pow_function(llvm::Module& module) {
+        if (llvm::Function* existing = module.getFunction("__sere_ipow")) return existing;
+        auto& context = module.getContext();
+        auto* i64 = llvm::Type::getInt64Ty(context);
+        auto* func = llvm::Function::Create(llvm::FunctionType::get(i64, {i64, i64}, false),
+                                            llvm::GlobalValue::InternalLinkage, "__sere_ipow", module);
+        llvm::Value* base = func->getArg(0);
+        llvm::Value* exp = func->getArg(1);
+        base->setName("base");
+        exp->setName("exp");
+
+        auto* entry = llvm::BasicBlock::Create(context, "entry", func);
+        auto* negative = llvm::BasicBlock::Create(context, "negexp", func);
+        auto* loop = llvm::BasicBlock::Create(context, "loop", func);
+        auto* step = llvm::BasicBlock::Create(context, "step", func);
+        auto* done = llvm::BasicBlock::Create(context, "done", func);
+        llvm::IRBuilder<> builder(entry);
+        // int ** negative int is a float in Python; there is no int result
+        builder.CreateCondBr(builder.CreateICmpSLT(exp, builder.getInt64(0)), negative, loop);
+
+        builder.SetInsertPoint(negative);
+        builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+        builder.CreateUnreachable();
+
+        builder.SetInsertPoint(loop);
+        llvm::PHINode* result = builder.CreatePHI(i64, 2, "result");
+        llvm::PHINode* square = builder.CreatePHI(i64, 2, "square");
+        llvm::PHINode* bits = builder.CreatePHI(i64, 2, "bits");
+        builder.CreateCondBr(builder.CreateICmpEQ(bits, builder.getInt64(0)), done, step);
+
+        builder.SetInsertPoint(step);
+        llvm::Value* odd = builder.CreateTrunc(bits, builder.getInt1Ty());
+        llvm::Value* next_result = builder.CreateSelect(odd, builder.CreateMul(result, square), result);
+        llvm::Value* next_square = builder.CreateMul(square, square);
+        llvm::Value* next_bits = builder.CreateLShr(bits, 1);
+        builder.CreateBr(loop);
+
+        result->addIncoming(builder.getInt64(1), entry);
+        result->addIncoming(next_result, step);
+        square->addIncoming(base, entry);
+        square->addIncoming(next_square, step);
+        bits->addIncoming(exp, entry);
+        bits->addIncoming(next_bits, step);
+
+        builder.SetInsertPoint(done);
+        builder.CreateRet(result);
+        return func;
+    }
+
+    //
+    // i64 __sere_ipow_checked(i64 base, i64 exp, i1 signed): __sere_ipow
+    // for --checked-arith, which traps when a product leaves i64 (u64
+    // unless `signed`). It squares only while
+    // exponent bits remain, so a square that is never used cannot trap.
+    //
+    inline llvm::Function* checked_int_pow_function(llvm::Module& module) {
+        if (llvm::Function* existing = module.getFunction("__sere_ipow_checked")) return existing;
+        auto& context = module.getContext();
+        auto* i64 = llvm::Type::getInt64Ty(context);
+        auto* func = llvm::Function::Create(llvm::FunctionType::get(i64, {i64, i64, llvm::Type::getInt1Ty(context)}, false),
+                                            llvm::GlobalValue::InternalLinkage, "__sere_ipow_checked", module);
+        llvm::Value* base = func->getArg(0);
+        llvm::Value* exp = func->getArg(1);
+        llvm::Value* is_signed = func->getArg(2);
+        base->setName("base");
+        exp->setName("exp");
+        is_signed->setName("signed");
+
+        auto* entry = llvm::BasicBlock::Create(context, "entry", func);
+        auto* trap = llvm::BasicBlock::Create(context, "trap", func);
+        auto* loop = llvm::BasicBlock::Create(context, "loop", func);
+        auto* step = llvm::BasicBlock::Create(context, "step", func);
+        auto* done = llvm::BasicBlock::Create(context, "done", func);
+        llvm::IRBuilder<> builder(entry);
+        builder.CreateCondBr(builder.CreateAnd(is_signed, builder.CreateICmpSLT(exp, builder.getInt64(0))), trap, loop);
+
+        builder.SetInsertPoint(trap);
+        builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+        builder.CreateUnreachable();
+
+        builder.SetInsertPoint(loop);
+        llvm::PHINode* result = builder.CreatePHI(i64, 2, "result");
+        llvm::PHINode* square = builder.CreatePHI(i64, 2, "square");
+        llvm::PHINode* bits = builder.CreatePHI(i64, 2, "bits");
+        builder.CreateCondBr(builder.CreateICmpEQ(bits, builder.getInt64(0)), done, step);
+
+        builder.SetInsertPoint(step);
+        // The product and whether it overflowed for the operands' signedness
+        auto multiply = [&](llvm::Value* a, llvm::Value* b, llvm::Value*& overflowed) {
+            llvm::Value* as_signed = builder.CreateBinaryIntrinsic(llvm::Intrinsic::smul_with_overflow, a, b);
+            llvm::Value* as_unsigned = builder.CreateBinaryIntrinsic(llvm::Intrinsic::umul_with_overflow, a, b);
+            overflowed = builder.CreateSelect(is_signed, builder.CreateExtractValue(as_signed, 1),
+                                              builder.CreateExtractValue(as_unsigned, 1));
+            return builder.CreateExtractValue(as_signed, 0);
+        };
+        llvm::Value* odd = builder.CreateTrunc(bits, builder.getInt1Ty());
+        llvm::Value* next_bits = builder.CreateLShr(bits, 1);
+        llvm::Value *result_overflowed, *square_overflowed;
+        llvm::Value* next_result = builder.CreateSelect(odd, multiply(result, square, result_overflowed), result);
+        llvm::Value* next_square = multiply(square, square, square_overflowed);
+        llvm::Value* overflowed =
+            builder.CreateOr(builder.CreateAnd(odd, result_overflowed),
+                             builder.CreateAnd(builder.CreateICmpNE(next_bits, builder.getInt64(0)), square_overflowed));
+        builder.CreateCondBr(overflowed, trap, loop);
+
+        result->addIncoming(builder.getInt64(1), entry);
+        result->addIncoming(next_result, step);
+        square->addIncoming(base, entry);
+        square->addIncoming(next_square, step);
+        bits->addIncoming(exp, entry);
+        bits->addIncoming(next_bits, step);
+
+        builder.SetInsertPoint(done);
+        builder.CreateRet(result);
+        return func;
+    }
+
+    // `exp_signed`: whether an integer exponent is of a signed type; an
+    // integer base has the exponent's type. `checked`: integer overflow
+    // traps (--checked-arith), as in SereIR::checked_arith.
+    inline llvm::Value* power(CodeGenContext& ctx, llvm::Value* base, llvm::Value* exp, bool exp_signed = true, bool checked = false) {
+        auto& builder = ctx.builder;
+        llvm::Type* type = base->getType();
+        if (type->isFloatingPointTy()) {
+            // Small integral exponents use powi, which the backend expands into multiplies
+            std::optional<int64_t> integral;
+            if (auto* constant = llvm::dyn_cast<llvm::ConstantInt>(exp)) {
+                if (exp_signed || constant->getValue().isIntN(63))
+                    integral = exp_signed ? constant->getSExtValue() : static_cast<int64_t>(constant->getZExtValue());
+            }
+            else if (auto* constant = llvm::dyn_cast<llvm::ConstantFP>(exp))
+                if (constant->getValueAPF().isInteger() && std::abs(constant->getValueAPF().convertToDouble()) < (1 << 16))
+                    integral = static_cast<int64_t>(constant->getValueAPF().convertToDouble());
+            if (integral && *integral >= INT32_MIN && *integral <= INT32_MAX)
+                return builder.CreateIntrinsic(llvm::Intrinsic::powi, {type, builder.getInt32Ty()},
+                                               {base, builder.getInt32(static_cast<int32_t>(*integral))}, nullptr, "pow_tmp");
+            if (exp->getType()->isIntegerTy())
+                exp = exp_signed ? builder.CreateSIToFP(exp, type) : builder.CreateUIToFP(exp, type);
+            return builder.CreateBinaryIntrinsic(llvm::Intrinsic::pow, base, exp, nullptr, "pow_tmp");
+        }
+
+        auto* constant = llvm::dyn_cast<llvm::ConstantInt>(exp);
+        if (!constant && checked) {
+            // Overflowing i64 (u64) overflows any narrower type too; otherwise the result must fit the type
+            auto* i64 = builder.getInt64Ty();
+            llvm::Function* pow = checked_int_pow_function(*ctx.get_module());
+            if (!exp_signed && exp->getType() == i64) {
+                llvm::Value* half = builder.CreateCall(pow, {base, builder.CreateLShr(exp, 1), builder.getFalse()});
+                llvm::Value* odd = builder.CreateTrunc(exp, builder.getInt1Ty());
+                return checked_arith(ctx, llvm::Instruction::Mul, checked_arith(ctx, llvm::Instruction::Mul, half, half, false),
+                                     builder.CreateSelect(odd, base, builder.getInt64(1)), false, "pow_tmp");
+            }
+            llvm::Value* result = builder.CreateCall(pow, {builder.CreateIntCast(base, i64, exp_signed), builder.CreateIntCast(exp, i64, exp_signed),
+                                                           builder.getInt1(exp_signed)}, "pow_tmp");
+            if (type == i64) return result;
+            llvm::Value* narrow = builder.CreateTrunc(result, type);
+            ctx.trap_if(builder.CreateICmpNE(builder.CreateIntCast(narrow, i64, exp_signed), result), "overflow");
+            return narrow;
+        }
+        if (!constant) {
+            // Narrower ints go through the i64 loop; the low bits of a product don't depend on the high ones
+            auto* i64 = builder.getInt64Ty();
+            llvm::Value* wide_base = builder.CreateZExtOrTrunc(base, i64);
+            llvm::Value* wide_exp = builder.CreateIntCast(exp, i64, exp_signed);
+            if (!exp_signed && exp->getType() == i64) {
+                // u64 exponents of 2**63 and above would read as negative: x**e = (x**(e/2))**2 * x**(e%2)
+                llvm::Value* half = builder.CreateCall(int_pow_function(*ctx.get_module()),
+                                                       {wide_base, builder.CreateLShr(exp, 1)});
+                llvm::Value* odd = builder.CreateTrunc(exp, builder.getInt1Ty());
+                return builder.CreateMul(builder.CreateMul(half, half), builder.CreateSelect(odd, base, builder.getInt64(1)), "pow_tmp");
+            }
+            llvm::Value* result = builder.CreateCall(int_pow_function(*ctx.get_module()), {wide_base, wide_exp}, "pow_tmp");
+            return builder.CreateTrunc(result, type);
+        }
+        if (exp_signed && constant->isNegative())
+            throw std::runtime_error("Negative exponent needs a float base.");
+
+        // Unrolled square-and-multiply: x**13 = x * x**4 * x**8
+        auto multiply = [&](llvm::Value* a, llvm::Value* b) {
+            return checked ? checked_arith(ctx, llvm::Instruction::Mul, a, b, exp_signed) : builder.CreateMul(a, b);
+        };
+        uint64_t bits = constant->getZExtValue();
+        llvm::Value* result = nullptr;
+        llvm::Value* square = base;
+        while (bits) {
+            if (bits & 1) result = result ? multiply(result, square) : square;
+            bits >>= 1;
+            if (bits) square = multiply(square, square);
+        }
+        return result ? result : llvm::ConstantInt::get(type, 1);
+    }
+
+    //
+    // range(start, stop, step) on integers of one type: whether it has an
+    // element, and how many, trips = (|stop - start| - 1) / |step| + 1, in
+    // unsigned arithmetic so that the type's full range neither overflows
+    // nor needs a wider type. The step is not zero. Its direction is usually
+    // known at compile time: it is a constant, or unsigned and ascending.
+    //
+    namespace detail {
+
+        template <typename Up, typename Down>
+        llvm::Value* by_direction(CodeGenContext& ctx, llvm::Value* step, bool is_signed, Up up, Down down, const char* what) {
+            auto* step_const = llvm::dyn_cast<llvm::ConstantInt>(step);
+            if (step_const || !is_signed) {
+                llvm::Value* chosen = step_const && is_signed && step_const->isNegative() ? down() : up();
+                chosen->setName(what);
+                return chosen;
+            }
+            llvm::Value* ascending = ctx.builder.CreateICmpSGT(step, llvm::ConstantInt::get(step->getType(), 0), "ascending");
+            return ctx.builder.CreateSelect(ascending, up(), down(), what);
+        }
+
+    } // namespace detail
+
+    inline llvm::Value* range_nonempty(CodeGenContext& ctx, llvm::Value* start, llvm::Value* stop, llvm::Value* step, bool is_signed) {
+        auto& builder = ctx.builder;
+        return detail::by_direction(
+            ctx, step, is_signed,
+            [&] { return builder.CreateICmp(is_signed ? llvm::CmpInst::ICMP_SLT : llvm::CmpInst::ICMP_ULT, start, stop); },
+            [&] { return builder.CreateICmpSGT(start, stop); }, "nonempty");
+    }
+
+    inline llvm::Value* range_trips(CodeGenContext& ctx, llvm::Value* start, llvm::Value* stop, llvm::Value* step, bool is_signed) {
+        auto& builder = ctx.builder;
+        llvm::Type* type = start->getType();
+        llvm::Value* distance = detail::by_direction(ctx, step, is_signed, [&] { return builder.CreateSub(stop, start); },
+                                                     [&] { return builder.CreateSub(start, stop); }, "distance");
+        auto* step_const = llvm::dyn_cast<llvm::ConstantInt>(step);
+        if (step_const && step_const->isOne()) return distance;
+        llvm::Value* magnitude = detail::by_direction(ctx, step, is_signed, [&] { return step; },
+                                                      [&] { return builder.CreateNeg(step); }, "magnitude");
+        return builder.CreateAdd(builder.CreateUDiv(builder.CreateSub(distance, llvm::ConstantInt::get(type, 1)), magnitude),
+                                 llvm::ConstantInt::get(type, 1), "trips", /*HasNUW=*/true);
+    }
+
+} // namespace SereIR
+
+#endif // IR_ARITH_HPP
@@ -0,0 +1,418 @@
+#ifndef IR_CALLGRAPH_HPP
+#define IR_CALLGRAPH_HPP
+
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Object/ELFObjectFile.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+// Whole-program call graph of one module: who calls whom and how often,
+// recursion (strongly connected components), what the entry points reach
+// and, given the object code, the worst-case stack depth of each function.
+//
+// Functions are lowered in source order, so the graph is only complete
+// once the whole module is; build it after internalize_module, when
+// linkage says what is visible from outside. The roots are the externally
+// visible functions (__main__, the module's init, exports) and those whose
+// address is taken (@multiversion clones); anything else is live only if a
+// root calls it, directly or not.
+//
+// Sere locals are SSA values, not allocas, so a frame's size is known only
+// after register allocation: codegen records it in a .stack_sizes section
+// (TargetOptions::EmitStackSizeSection), which measure() reads back.
+//
+namespace SereIR {
+
+    struct CallEdge {
+        std::string callee;
+        unsigned sites = 0;
+    };
+
+    struct CallGraphFunction {
+        std::string name;
+        bool external = false;                      // visible outside the module
+        bool address_taken = false;
+        bool indirect = false;                      // calls through a pointer (ifunc, dispatch)
+        bool recursive = false;
+        bool reachable = false;
+        unsigned scc = 0;                           // bottom-up: callees come first
+        unsigned call_sites = 0;                    // calls to it from the module
+        std::vector<CallEdge> callees;              // functions this module defines
+        std::vector<std::string> external_callees;  // declarations: libc, other modules
+
+        // Set by measure(); none where the optimizer inlined or removed the function
+        std::optional<uint64_t> frame;
+        std::optional<uint64_t> stack;              // incl. callees; none if unbounded
+        std::string stack_note;                     // why `stack` is none
+    };
+
+    //
+    // Frame sizes by symbol from an ELF object emitted with stack sizes.
+    // Each entry is a function address (relocated: the function symbol, or
+    // its section plus an offset for local ones) and a ULEB128 size.
+    //
+    inline std::unordered_map<std::string, uint64_t> read_stack_sizes(llvm::StringRef object) {
+        std::unordered_map<std::string, uint64_t> frames;
+        auto file = llvm::object::ObjectFile::createObjectFile(llvm::MemoryBufferRef(object, "stack-sizes"));
+        if (!file) {
+            llvm::consumeError(file.takeError());
+            return frames;
+        }
+
+        // Functions by (section, offset), for relocations against a section
+        std::map<std::pair<uint64_t, uint64_t>, std::string> at;
+        for (const llvm::object::SymbolRef& symbol : (*file)->symbols()) {
+            auto type = symbol.getType();
+            auto section = symbol.getSection();
+            auto name = symbol.getName();
+            auto address = symbol.getAddress();
+            if (!type || !section || !name || !address || *type != llvm::object::SymbolRef::ST_Function ||
+                *section == (*file)->section_end()) {
+                if (!type) llvm::consumeError(type.takeError());
+                if (!section) llvm::consumeError(section.takeError());
+                if (!name) llvm::consumeError(name.takeError());
+                if (!address) llvm::consumeError(address.takeError());
+                continue;
+            }
+            at[{(*section)->getIndex(), *address}] = name->str();
+        }
+
+        for (const llvm::object::SectionRef& relocations : (*file)->sections()) {
+            auto target = relocations.getRelocatedSection();
+            if (!target) {
+                llvm::consumeError(target.takeError());
+                continue;
+            }
+            if (*target == (*file)->section_end()) continue;
+            auto target_name = (*target)->getName();
+            auto contents = (*target)->getContents();
+            if (!target_name || *target_name != ".stack_sizes" || !contents) {
+                if (!target_name) llvm::consumeError(target_name.takeError());
+                if (!contents) llvm::consumeError(contents.takeError());
+                continue;
+            }
+
+            for (const llvm::object::RelocationRef& reloc : relocations.relocations()) {
+                auto symbol = reloc.getSymbol();
+                if (symbol == (*file)->symbol_end()) continue;
+                int64_t addend = 0;
+                if (llvm::isa<llvm::object::ELFObjectFileBase>(file->get())) {
+                    if (auto value = llvm::object::ELFRelocationRef(reloc).getAddend()) addend = *value;
+                    else llvm::consumeError(value.takeError());
+                }
+
+                std::string function;
+                auto type = symbol->getType();
+                if (type && *type == llvm::object::SymbolRef::ST_Function) {
+                    if (auto name = symbol->getName()) function = name->str();
+                    else llvm::consumeError(name.takeError());
+                } else {
+                    if (!type) llvm::consumeError(type.takeError());
+                    auto section = symbol->getSection();
+                    if (!section) {
+                        llvm::consumeError(section.takeError());
+                        continue;
+                    }
+                    auto found = at.find({(*section)->getIndex(), static_cast<uint64_t>(addend)});
+                    if (found != at.end()) function = found->second;
+                }
+
+                // The size follows the pointer-sized address the relocation fills in
+                uint64_t offset = reloc.getOffset() + ((*file)->getBytesInAddress());
+                if (function.empty() || offset >= contents->size()) continue;
+                const auto* bytes = reinterpret_cast<const uint8_t*>(contents->data());
+                frames[function] = llvm::decodeULEB128(bytes + offset, nullptr, bytes + contents->size());
+            }
+        }
+        return frames;
+    }
+
+    class ProgramCallGraph {
+    public:
+        explicit ProgramCallGraph(llvm::Module& module) {
+            unsigned scc_index = 0;
+            for_each_scc(module, [&](const std::vector<llvm::CallGraphNode*>& scc, bool cycle) {
+                for (llvm::CallGraphNode* node : scc) {
+                    llvm::Function* func = node->getFunction();
+                    CallGraphFunction info;
+                    info.name = func->getName().str();
+                    info.external = !func->hasLocalLinkage();
+                    info.address_taken = func->hasAddressTaken();
+                    info.recursive = cycle;
+                    info.scc = scc_index;
+                    for (const auto& record : *node) {
+                        llvm::Function* callee = record.second->getFunction();
+                        if (!callee) {
+                            info.indirect = true;
+                        } else if (callee->isDeclaration()) {
+                            if (!callee->isIntrinsic() &&
+                                std::find(info.external_callees.begin(), info.external_callees.end(),
+                                          callee->getName()) == info.external_callees.end())
+                                info.external_callees.push_back(callee->getName().str());
+                        } else {
+                            auto edge = std::find_if(info.callees.begin(), info.callees.end(),
+                                                     [&](const CallEdge& e) { return e.callee == callee->getName(); });
+                            if (edge == info.callees.end())
+                                info.callees.push_back({callee->getName().str(), 1});
+                            else
+                                ++edge->sites;
+                        }
+                    }
+                    index_[info.name] = functions_.size();
+                    functions_.push_back(std::move(info));
+                }
+                ++scc_index;
+            });
+
+            for (const auto& func : functions_)
+                for (const auto& edge : func.callees)
+                    functions_[index_.at(edge.callee)].call_sites += edge.sites;
+
+            std::vector<size_t> work;
+            for (size_t i = 0; i < functions_.size(); ++i)
+                if (functions_[i].external || functions_[i].address_taken) {
+                    functions_[i].reachable = true;
+                    work.push_back(i);
+                }
+            while (!work.empty()) {
+                size_t i = work.back();
+                work.pop_back();
+                for (const auto& edge : functions_[i].callees) {
+                    auto& callee = functions_[index_.at(edge.callee)];
+                    if (!callee.reachable) {
+                        callee.reachable = true;
+                        work.push_back(index_.at(edge.callee));
+                    }
+                }
+            }
+        }
+
+        // In bottom-up order: a function's callees precede it unless they share its SCC
+        const std::vector<CallGraphFunction>& functions() const { return functions_; }
+
+        const CallGraphFunction* find(const std::string& name) const {
+            auto found = index_.find(name);
+            return found == index_.end() ? nullptr : &functions_[found->second];
+        }
+
+        //
+        // Worst-case stack depth from the optimized module and its object
+        // code: a function's frame, plus per call the return address and
+        // the deepest callee. Recursion and indirect calls are unbounded;
+        // calls into other modules and libc count only the return address.
+        //
+        void measure(llvm::Module& optimized, llvm::StringRef object) {
+            auto frames = read_stack_sizes(object);
+            const uint64_t return_address = optimized.getDataLayout().getPointerSize();
+
+            std::unordered_map<const llvm::Function*, std::optional<uint64_t>> depth;
+            std::unordered_map<const llvm::Function*, std::string> notes;
+            for_each_scc(optimized, [&](const std::vector<llvm::CallGraphNode*>& scc, bool cycle) {
+                for (llvm::CallGraphNode* node : scc) {
+                    const llvm::Function* func = node->getFunction();
+                    std::optional<uint64_t> stack = frame_of(frames, func);
+                    std::string note;
+                    if (cycle) {
+                        stack.reset();
+                        note = "recursive";
+                    }
+                    for (const auto& record : *node) {
+                        if (!stack) break;
+                        const llvm::Function* callee = record.second->getFunction();
+                        if (!callee) {
+                            stack.reset();
+                            note = "indirect call";
+                        } else if (callee->isIntrinsic()) {
+                            continue;
+                        } else if (callee->isDeclaration()) {
+                            stack = std::max(*stack, frame_of(frames, func) + return_address);
+                        } else if (auto callee_depth = depth.find(callee); callee_depth != depth.end()) {
+                            if (!callee_depth->second) {
+                                stack.reset();
+                                note = "calls " + callee->getName().str() + " (" + notes[callee] + ")";
+                            } else {
+                                stack = std::max(*stack, frame_of(frames, func) + return_address + *callee_depth->second);
+                            }
+                        }
+                    }
+                    depth[func] = stack;
+                    notes[func] = note;
+                }
+            });
+
+            for (auto& info : functions_) {
+                const llvm::Function* func = optimized.getFunction(info.name);
+                if (!func || func->isDeclaration()) {
+                    info.stack_note = info.reachable ? "inlined" : "removed";
+                    continue;
+                }
+                auto frame = frames.find(info.name);
+                if (frame != frames.end()) info.frame = frame->second;
+                info.stack = depth[func];
+                info.stack_note = notes[func];
+            }
+        }
+
+        std::vector<std::string> unreachable() const {
+            std::vector<std::string> names;
+            for (const auto& func : functions_)
+                if (!func.reachable) names.push_back(func.name);
+            return names;
+        }
+
+        void write_json(llvm::raw_ostream& out) const {
+            llvm::json::OStream json(out, 2);
+            json.object([&] {
+                json.attributeArray("functions", [&] {
+                    for (const auto& func : functions_) {
+                        json.object([&] {
+                            json.attribute("name", func.name);
+                            json.attribute("external", func.external);
+                            json.attribute("reachable", func.reachable);
+                            json.attribute("recursive", func.recursive);
+                            json.attribute("scc", func.scc);
+                            json.attribute("call_sites", func.call_sites);
+                            if (func.address_taken) json.attribute("address_taken", true);
+                            if (func.indirect) json.attribute("indirect_calls", true);
+                            json.attributeArray("callees", [&] {
+                                for (const auto& edge : func.callees)
+                                    json.object([&] {
+                                        json.attribute("name", edge.callee);
+                                        json.attribute("sites", edge.sites);
+                                    });
+                            });
+                            json.attributeArray("external_callees", [&] {
+                                for (const auto& name : func.external_callees) json.value(name);
+                            });
+                            json.attribute("frame", func.frame ? llvm::json::Value(*func.frame) : nullptr);
+                            json.attribute("stack", func.stack ? llvm::json::Value(*func.stack) : nullptr);
+                            if (!func.stack_note.empty()) json.attribute("stack_note", func.stack_note);
+                        });
+                    }
+                });
+                json.attributeArray("recursive", [&] {
+                    for (const auto& scc : recursive_sccs())
+                        json.array([&] {
+                            for (const auto& name : scc) json.value(name);
+                        });
+                });
+                json.attributeArray("unreachable", [&] {
+                    for (const auto& name : unreachable()) json.value(name);
+                });
+            });
+            out << "\n";
+        }
+
+        // Unreachable functions are dashed, recursive ones red; edges carry call-site counts
+        void write_dot(llvm::raw_ostream& out) const {
+            out << "digraph callgraph {\n  node [shape=box];\n";
+            for (const auto& func : functions_) {
+                out << "  \"" << func.name << "\" [label=\"" << func.name;
+                if (func.frame) out << "\\nframe " << *func.frame << " B";
+                if (func.stack) out << "\\nstack " << *func.stack << " B";
+                else if (!func.stack_note.empty()) out << "\\nstack: " << func.stack_note;
+                out << "\"";
+                if (!func.reachable) out << " style=dashed color=gray";
+                else if (func.recursive) out << " color=red";
+                out << "];\n";
+            }
+            for (const auto& func : functions_)
+                for (const auto& edge : func.callees)
+                    out << "  \"" << func.name << "\" -> \"" << edge.callee << "\" [label=\"" << edge.sites << "\"];\n";
+            out << "}\n";
+        }
+
+    private:
+        //
+        // Calls `visit(members, cycle)` for each SCC of defined functions,
+        // callees first. LLVM's SCC iterator only walks what its external
+        // node reaches, so functions nothing visible calls are picked up
+        // in further walks, skipping the SCCs already visited.
+        //
+        template <typename Visit>
+        static void for_each_scc(llvm::Module& module, Visit visit) {
+            llvm::CallGraph graph(module);
+            std::unordered_map<const llvm::Function*, bool> seen;
+            auto walk = [&](auto scc) {
+                for (; !scc.isAtEnd(); ++scc) {
+                    std::vector<llvm::CallGraphNode*> members;
+                    for (llvm::CallGraphNode* node : *scc) {
+                        const llvm::Function* func = node->getFunction();
+                        if (func && !func->isDeclaration() && !seen[func]) members.push_back(node);
+                    }
+                    if (members.empty()) continue;
+                    for (llvm::CallGraphNode* node : members) seen[node->getFunction()] = true;
+                    visit(members, scc.hasCycle());
+                }
+            };
+            walk(llvm::scc_begin(&graph));
+            for (llvm::Function& func : module)
+                if (!func.isDeclaration() && !seen[&func]) walk(llvm::scc_begin(graph[&func]));
+        }
+
+        static uint64_t frame_of(const std::unordered_map<std::string, uint64_t>& frames, const llvm::Function* func) {
+            auto found = frames.find(func->getName().str());
+            return found == frames.end() ? 0 : found->second;
+        }
+
+        std::vector<std::vector<std::string>> recursive_sccs() const {
+            std::vector<std::vector<std::string>> sccs;
+            for (size_t i = 0; i < functions_.size(); ++i) {
+                if (!functions_[i].recursive) continue;
+                if (i == 0 || functions_[i - 1].scc != functions_[i].scc) sccs.emplace_back();
+                sccs.back().push_back(functions_[i].name);
+            }
+            return sccs;
+        }
+
+        std::vector<CallGraphFunction> functions_;
+        std::unordered_map<std::string, size_t> index_;
+    };
+
+    //
+    // What the call graph decides before optimization: local functions no
+    // root reaches are deleted (at every level; GlobalDCE would only see
+    // them at -O1 and above), and at -O1, where only `@inline` functions
+    // are inlined, a local non-recursive function with a single call site
+    // is inlined too, since that only removes code. -O2 leaves it to the
+    // inliner's own cost model. Returns the number of functions deleted.
+    //
+    inline unsigned shrink_program(llvm::Module& module, unsigned opt_level) {
+        ProgramCallGraph graph(module);
+        std::vector<llvm::Function*> dead;
+        for (const auto& info : graph.functions()) {
+            llvm::Function* func = module.getFunction(info.name);
+            if (!info.reachable && func->hasLocalLinkage()) {
+                dead.push_back(func);
+            } else if (opt_level == 1 && func->hasLocalLinkage() && !info.recursive && !info.address_taken &&
+                       info.call_sites == 1 && !func->hasFnAttribute(llvm::Attribute::NoInline) &&
+                       !func->hasFnAttribute(llvm::Attribute::Cold) &&
+                       !func->hasFnAttribute(llvm::Attribute::OptimizeNone)) {
+                func->addFnAttr(llvm::Attribute::AlwaysInline);
+            }
+        }
+        // Dead functions may call each other; unlink them all before deleting any
+        for (llvm::Function* func : dead) func->dropAllReferences();
+        for (llvm::Function* func : dead) func->eraseFromParent();
+        return static_cast<unsigned>(dead.size());
+    }
+
+} // namespace SereIR
+
+#endif // IR_CALLGRAPH_HPP
@@ -5,7 +5,10 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Type.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 
 #include <memory>
 #include <string>
@@ -14,36 +17,205 @@
 #include <unordered_map>
 #include <optional>
 
+#include "./SSABuilder.hpp"
+#include "./ConstantPool.hpp"
+
 namespace SereIR {
 
+    // Loop pragmas of the function being lowered (`@unroll`, `@vectorize`); 0 leaves it to the optimizer.
+    struct LoopHints {
+        int unroll = 0;     // -1: enable, n: unroll by n
+        int vectorize = 0;  // -1: enable, n: vector width n (1 turns vectorization off)
+    };
+
     class CodeGenContext {
     public:
-        llvm::LLVMContext llvm_ctx;
+        // The LLVMContext is owned through a ThreadSafeContext so finished
+        // modules can be handed to the JIT without re-parsing them.
+        llvm::orc::ThreadSafeContext ts_ctx;
+        llvm::LLVMContext& llvm_ctx;
         std::unique_ptr<llvm::Module> module;
         llvm::IRBuilder<> builder;
 
         llvm::Function* function = nullptr;
         llvm::Function* entry_point = nullptr;
+        llvm::Function* init_function = nullptr;  // holds the module's top-level statements
+
+        // Local variables live in SSA registers, never in memory
+        SSABuilder ssa;
+        ConstantPool constants;
+        LoopHints loop_hints;
+        bool checked_arith = false; // integer + - * and negation trap on overflow (--checked-arith)
+
+        // Prebuilt library modules, kept warm across resets (see SereLib::include_lib)
+        std::unordered_map<std::string, std::unique_ptr<llvm::Module>> lib_cache;
 
         CodeGenContext()
-            : module(std::make_unique<llvm::Module>("__module__", llvm_ctx)),
+            : ts_ctx(std::make_unique<llvm::LLVMContext>()),
+              llvm_ctx(*ts_ctx.getContext()),
+              module(std::make_unique<llvm::Module>("__module__", llvm_ctx)),
               builder(llvm_ctx) {
             // Always push global scope at the bottom
             named_value_stack.emplace_back(); 
             create_entry();
-            done();
         }
 
         ~CodeGenContext() = default;
 
         llvm::Module* get_module() { return module.get(); }
 
+        // Starts a fresh module in the same (warm) LLVMContext.
+        // `init_name` names the function holding top-level statements; only
+        // the program's entry module may use "__init__".
+        void reset(const std::string& module_name = "__module__", const std::string& init_name = "__init__") {
+            builder.ClearInsertionPoint();
+            function = nullptr;
+            entry_point = nullptr;
+            init_function = nullptr;
+            module = std::make_unique<llvm::Module>(module_name, llvm_ctx);
+            ssa.reset();
+            constants.reset();
+            loop_hints = LoopHints();
+            checked_arith = false;
+            builder.clearFastMathFlags();
+            named_value_stack.clear();
+            named_value_stack.emplace_back();
+            create_entry(init_name);
+        }
+
+        // Releases ownership of the finished module (e.g. to the JIT).
+        std::unique_ptr<llvm::Module> take_module() {
+            builder.ClearInsertionPoint();
+            function = nullptr;
+            entry_point = nullptr;
+            init_function = nullptr;
+            return std::move(module);
+        }
+
+        // Terminates the initializer once every top-level statement is lowered.
         void done() {
-            if (entry_point && !entry_point->empty() && !entry_point->back().getTerminator()) {
+            llvm::BasicBlock* block = builder.GetInsertBlock();
+            if (function == init_function && block && !block->getTerminator()) {
                 builder.CreateRetVoid();
             }
         }
 
+        //
+        // ===== Local Variables (SSA) =====
+        //
+
+        // Type of `name` in the current function, or null if it has never been assigned there.
+        llvm::Type* variable_type(const std::string& name) const {
+            return ssa.type_of(function, name);
+        }
+
+        void declare_variable(const std::string& name, llvm::Type* type) {
+            ssa.declare(function, name, type);
+        }
+
+        void assign_variable(const std::string& name, llvm::Value* value) {
+            ssa.write_variable(name, builder.GetInsertBlock(), value);
+        }
+
+        llvm::Value* read_variable(const std::string& name) {
+            return ssa.read_variable(name, builder.GetInsertBlock());
+        }
+
+        //
+        // ===== Control Flow =====
+        //
+
+        // `value` as an i1 for a branch: nonzero numbers, non-empty strings.
+        llvm::Value* truth_value(llvm::Value* value) {
+            llvm::Type* type = value->getType();
+            if (type->isIntegerTy(1)) return value;
+            if (type->isIntegerTy())
+                return builder.CreateICmpNE(value, llvm::ConstantInt::get(type, 0), "tobool");
+            if (type->isFloatingPointTy())
+                return builder.CreateFCmpUNE(value, llvm::ConstantFP::get(type, 0.0), "tobool");
+            if (type->isPointerTy()) {
+                llvm::Type* i8 = llvm::Type::getInt8Ty(llvm_ctx);
+                return builder.CreateICmpNE(builder.CreateLoad(i8, value), llvm::ConstantInt::get(i8, 0), "tobool");
+            }
+            throw std::runtime_error("Value cannot be used as a condition.");
+        }
+
+        //
+        // Stops the program where Python would raise (there are no exceptions
+        // yet); code after it is emitted into a fresh block.
+        //
+        void trap_if(llvm::Value* condition, const std::string& name) {
+            if (auto* known = llvm::dyn_cast<llvm::ConstantInt>(condition))
+                if (known->isZero()) return;
+            llvm::Function* func = builder.GetInsertBlock()->getParent();
+            auto* trap_block = llvm::BasicBlock::Create(llvm_ctx, name, func);
+            auto* cont_block = llvm::BasicBlock::Create(llvm_ctx, name + ".cont", func);
+            auto* branch = builder.CreateCondBr(condition, trap_block, cont_block);
+            branch->setMetadata(llvm::LLVMContext::MD_prof, llvm::MDBuilder(llvm_ctx).createBranchWeights(1, 1u << 20));
+
+            ssa.seal_block(trap_block);
+            builder.SetInsertPoint(trap_block);
+            builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+            builder.CreateUnreachable();
+            ssa.seal_block(cont_block);
+            builder.SetInsertPoint(cont_block);
+        }
+
+        //
+        // Called right before a `ret` of `returned` (null for `ret void`):
+        // when the call just emitted is what is returned, it becomes a tail
+        // call. With the caller's own prototype and calling convention it
+        // is `musttail`, which reuses the caller's frame even at -O0, so a
+        // chain of such calls runs in constant stack; internalize_module
+        // keeps that true when it changes conventions. Otherwise `tail`.
+        //
+        void mark_tail_call(llvm::Value* returned = nullptr) {
+            llvm::BasicBlock* block = builder.GetInsertBlock();
+            if (block->empty()) return;
+            auto* call = llvm::dyn_cast<llvm::CallInst>(&block->back());
+            if (!call || (returned ? returned != call : !call->getType()->isVoidTy())) return;
+            llvm::Function* callee = call->getCalledFunction();
+            llvm::Function* caller = block->getParent();
+            if (!callee || callee->isIntrinsic()) return;
+            const bool same_prototype = callee->getFunctionType() == caller->getFunctionType() && !callee->isVarArg() &&
+                                        callee->getCallingConv() == caller->getCallingConv();
+            call->setTailCallKind(same_prototype ? llvm::CallInst::TCK_MustTail : llvm::CallInst::TCK_Tail);
+        }
+
+        //
+        // Loop ID for the `llvm.loop` metadata of a back edge. Counted loops
+        // are finite, so they may assert forward progress; `while` loops may
+        // legitimately spin forever and must not. The current function's
+        // loop_hints are attached as the matching llvm.loop.* pragmas.
+        //
+        llvm::MDNode* loop_id(bool must_progress) {
+            llvm::SmallVector<llvm::Metadata*, 4> ops;
+            auto self = llvm::MDNode::getTemporary(llvm_ctx, llvm::None);
+            ops.push_back(self.get());
+            auto hint = [&](const char* name, llvm::Metadata* value = nullptr) {
+                llvm::SmallVector<llvm::Metadata*, 2> hint_ops{llvm::MDString::get(llvm_ctx, name)};
+                if (value) hint_ops.push_back(value);
+                ops.push_back(llvm::MDNode::get(llvm_ctx, hint_ops));
+            };
+            auto i32 = [&](int value) {
+                return llvm::ConstantAsMetadata::get(builder.getInt32(value));
+            };
+            if (must_progress)
+                hint("llvm.loop.mustprogress");
+            if (loop_hints.unroll < 0)
+                hint("llvm.loop.unroll.enable");
+            else if (loop_hints.unroll > 0)
+                hint("llvm.loop.unroll.count", i32(loop_hints.unroll));
+            if (loop_hints.vectorize != 0)
+                hint("llvm.loop.vectorize.enable",
+                     llvm::ConstantAsMetadata::get(builder.getInt1(loop_hints.vectorize != 1)));
+            if (loop_hints.vectorize > 0)
+                hint("llvm.loop.vectorize.width", i32(loop_hints.vectorize));
+            llvm::MDNode* id = llvm::MDNode::getDistinct(llvm_ctx, ops);
+            id->replaceOperandWith(0, id);
+            return id;
+        }
+
         //
         // ===== Scoped Variable Support =====
         //
@@ -86,20 +258,22 @@ namespace SereIR {
         }
 
     private:
-        void create_entry() {
+        void create_entry(const std::string& init_name = "__init__") {
             std::vector<llvm::Type*> arg_types;
             auto func_type = llvm::FunctionType::get(
                 llvm::Type::getVoidTy(llvm_ctx), arg_types, false
             );
 
             auto *enterance = llvm::Function::Create(
-                func_type, llvm::Function::ExternalLinkage, "__init__", module.get()
+                func_type, llvm::Function::ExternalLinkage, init_name, module.get()
             );
 
             auto* bb = llvm::BasicBlock::Create(llvm_ctx, "entry", enterance);
             builder.SetInsertPoint(bb);
+            ssa.seal_block(bb); // entry blocks have no predecessors
 
             entry_point = enterance;
+            init_function = enterance;
             function = enterance;
         }
 
@@ -0,0 +1,65 @@
+#ifndef IR_CONSTANTPOOL_HPP
+#define IR_CONSTANTPOOL_HPP
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Type.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace SereIR {
+
+    //
+    // Interned constants of the module being lowered. Every occurrence of a
+    // string literal shares one private, unnamed_addr constant global, so a
+    // message printed from a thousand places is stored once. Numeric
+    // literals need no pool: LLVM already uniques ConstantInt/ConstantFP.
+    //
+    class ConstantPool {
+    public:
+        void reset() { strings_.clear(); }
+
+        // `i8*` to the NUL-terminated `text`.
+        llvm::Constant* string(llvm::Module& module, const std::string& text) {
+            auto found = strings_.find(text);
+            llvm::GlobalVariable* global = found != strings_.end() ? found->second : nullptr;
+            if (!global) {
+                llvm::Constant* data = llvm::ConstantDataArray::getString(module.getContext(), text, true);
+                global = new llvm::GlobalVariable(module, data->getType(), true, llvm::GlobalValue::PrivateLinkage,
+                                                  data, ".str");
+                global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+                global->setAlignment(llvm::Align(1));
+                strings_.emplace(text, global);
+            }
+            return pointer_to(global);
+        }
+
+        // Registers string constants that arrived by linking (library code,
+        // imported inline bodies), so literals reuse them.
+        void adopt(llvm::Module& module) {
+            for (auto& global : module.globals()) {
+                if (!global.hasPrivateLinkage() || !global.isConstant() || !global.hasInitializer()) continue;
+                auto* data = llvm::dyn_cast<llvm::ConstantDataArray>(global.getInitializer());
+                if (!data || !data->isCString()) continue;
+                global.setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+                strings_.emplace(data->getAsCString().str(), &global);
+            }
+        }
+
+        size_t size() const { return strings_.size(); }
+
+    private:
+        static llvm::Constant* pointer_to(llvm::GlobalVariable* global) {
+            llvm::Constant* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(global->getContext()), 0);
+            llvm::Constant* indices[] = { zero, zero };
+            return llvm::ConstantExpr::getInBoundsGetElementPtr(global->getValueType(), global, indices);
+        }
+
+        std::unordered_map<std::string, llvm::GlobalVariable*> strings_;
+    };
+
+} // namespace SereIR
+
+#endif // IR_CONSTANTPOOL_HPP
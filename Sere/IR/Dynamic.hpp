@@ -0,0 +1,613 @@
+#ifndef IR_DYNAMIC_HPP
+#define IR_DYNAMIC_HPP
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Module.h>
+
+#include <cstdint>
+
+#include "./CodeGenContext.hpp"
+#include "./Arith.hpp"
+
+//
+// `dyn` values: one i64 per value, NaN-boxed. A double is stored as its
+// own bits; every other type lives in the space of quiet NaNs that no
+// arithmetic produces, its tag in the top 16 bits:
+//
+//   0000..FFF8  double (NaNs are canonicalized to 7FF8 0000 0000 0000)
+//   FFF9        int, 48-bit two's complement payload
+//   FFFA        bool, payload 0 or 1
+//   FFFB        str, 48-bit pointer
+//   FFFC        none
+//
+// An int outside 48 bits is boxed as the nearest double, as is an int
+// result of `dyn` arithmetic that overflows them. Operations on two ints
+// or two doubles run inline behind a tag test; everything else calls
+// `__sere_dyn_binop`, which has the full (Python) rules: mixed ints and
+// floats, bools as ints, `==` across types. Type errors trap where Python
+// would raise TypeError. The helpers are internal to each module, like
+// __sere_ipow, so no runtime library is needed.
+//
+namespace SereIR {
+
+    enum DynTag : uint64_t {
+        DYN_TAG_INT  = 0xFFF9,
+        DYN_TAG_BOOL = 0xFFFA,
+        DYN_TAG_STR  = 0xFFFB,
+        DYN_TAG_NONE = 0xFFFC,
+    };
+
+    inline constexpr uint64_t DYN_CANONICAL_NAN = 0x7FF8000000000000ull;
+    inline constexpr uint64_t DYN_PAYLOAD_MASK = (1ull << 48) - 1;
+
+    // Binary operators on `dyn` values; the helper takes them as an i32.
+    enum class DynOp : int32_t {
+        ADD, SUB, MUL, DIV, FLOOR_DIV, MOD, POW,
+        LT, LE, GT, GE, EQ, NE,
+    };
+
+    inline bool is_comparison(DynOp op) { return op >= DynOp::LT; }
+
+    inline llvm::Value* dyn_tag(llvm::IRBuilder<>& builder, llvm::Value* value) {
+        return builder.CreateLShr(value, 48, "dyn.tag");
+    }
+
+    inline llvm::Value* dyn_has_tag(llvm::IRBuilder<>& builder, llvm::Value* value, DynTag tag) {
+        return builder.CreateICmpEQ(dyn_tag(builder, value), builder.getInt64(tag));
+    }
+
+    inline llvm::Value* dyn_is_double(llvm::IRBuilder<>& builder, llvm::Value* value) {
+        return builder.CreateICmpULT(value, builder.getInt64(static_cast<uint64_t>(DYN_TAG_INT) << 48), "dyn.isfloat");
+    }
+
+    // The sign-extended payload of an int
+    inline llvm::Value* dyn_int_payload(llvm::IRBuilder<>& builder, llvm::Value* value) {
+        return builder.CreateAShr(builder.CreateShl(value, 16), 16, "dyn.int");
+    }
+
+    inline llvm::Value* dyn_fits(llvm::IRBuilder<>& builder, llvm::Value* i64) {
+        return builder.CreateICmpEQ(dyn_int_payload(builder, i64), i64, "dyn.fits");
+    }
+
+    inline llvm::Value* dyn_with_tag(llvm::IRBuilder<>& builder, llvm::Value* payload, DynTag tag) {
+        return builder.CreateOr(builder.CreateAnd(payload, DYN_PAYLOAD_MASK), static_cast<uint64_t>(tag) << 48, "dyn");
+    }
+
+    inline llvm::Value* box_float(llvm::IRBuilder<>& builder, llvm::Value* value) {
+        if (!value->getType()->isDoubleTy()) value = builder.CreateFPExt(value, builder.getDoubleTy());
+        return builder.CreateSelect(builder.CreateFCmpUNO(value, value), builder.getInt64(DYN_CANONICAL_NAN),
+                                    builder.CreateBitCast(value, builder.getInt64Ty()), "dyn");
+    }
+
+    // `value` is an i64, signed or not; outside 48 bits it becomes a double
+    inline llvm::Value* box_int(llvm::IRBuilder<>& builder, llvm::Value* value, bool is_signed = true) {
+        llvm::Value* fits = is_signed ? dyn_fits(builder, value)
+                                      : builder.CreateICmpULT(value, builder.getInt64(1ull << 47), "dyn.fits");
+        if (auto* known = llvm::dyn_cast<llvm::ConstantInt>(fits); known && known->isOne())
+            return dyn_with_tag(builder, value, DYN_TAG_INT);
+        llvm::Value* as_double = is_signed ? builder.CreateSIToFP(value, builder.getDoubleTy())
+                                           : builder.CreateUIToFP(value, builder.getDoubleTy());
+        return builder.CreateSelect(fits, dyn_with_tag(builder, value, DYN_TAG_INT),
+                                    builder.CreateBitCast(as_double, builder.getInt64Ty()), "dyn");
+    }
+
+    inline llvm::Value* box_bool(llvm::IRBuilder<>& builder, llvm::Value* value) {
+        return dyn_with_tag(builder, builder.CreateZExt(value, builder.getInt64Ty()), DYN_TAG_BOOL);
+    }
+
+    inline llvm::Value* box_str(llvm::IRBuilder<>& builder, llvm::Value* value) {
+        return dyn_with_tag(builder, builder.CreatePtrToInt(value, builder.getInt64Ty()), DYN_TAG_STR);
+    }
+
+    inline llvm::Value* box_none(llvm::IRBuilder<>& builder) {
+        return builder.getInt64(static_cast<uint64_t>(DYN_TAG_NONE) << 48);
+    }
+
+    namespace detail {
+
+        inline llvm::Function* dyn_helper(llvm::Module& module, const char* name, llvm::Type* result,
+                                          llvm::ArrayRef<llvm::Type*> params, bool& created) {
+            created = false;
+            if (llvm::Function* existing = module.getFunction(name)) return existing;
+            created = true;
+            auto* func = llvm::Function::Create(llvm::FunctionType::get(result, params, false),
+                                                llvm::GlobalValue::InternalLinkage, name, module);
+            func->addFnAttr(llvm::Attribute::NoUnwind);
+            return func;
+        }
+
+        inline void trap(llvm::IRBuilder<>& builder) {
+            builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+            builder.CreateUnreachable();
+        }
+
+        // A block of the helper being built; helpers never read variables, so it is sealed at once
+        inline llvm::BasicBlock* block(CodeGenContext& ctx, llvm::Function* func, const char* name) {
+            auto* created = llvm::BasicBlock::Create(ctx.llvm_ctx, name, func);
+            ctx.ssa.seal_block(created);
+            return created;
+        }
+
+    } // namespace detail
+
+    //
+    // i64 __sere_dyn_to_int(i64 value, i1 explicit): an int from anything
+    // numeric. Bools give 0 or 1; doubles only when `explicit` (`int(x)`),
+    // truncated and saturated like convert_value. Traps on anything else.
+    //
+    inline llvm::Function* dyn_to_int_function(CodeGenContext& ctx) {
+        auto& builder = ctx.builder;
+        bool created;
+        llvm::Function* func = detail::dyn_helper(*ctx.get_module(), "__sere_dyn_to_int", builder.getInt64Ty(),
+                                                  {builder.getInt64Ty(), builder.getInt1Ty()}, created);
+        if (!created) return func;
+        llvm::IRBuilderBase::InsertPointGuard guard(builder);
+        llvm::Value* value = func->getArg(0);
+        llvm::Value* explicit_conversion = func->getArg(1);
+
+        builder.SetInsertPoint(detail::block(ctx, func, "entry"));
+        auto* is_int = detail::block(ctx, func, "int");
+        auto* not_int = detail::block(ctx, func, "notint");
+        auto* is_bool = detail::block(ctx, func, "bool");
+        auto* not_bool = detail::block(ctx, func, "notbool");
+        auto* is_float = detail::block(ctx, func, "float");
+        auto* error = detail::block(ctx, func, "typeerror");
+        builder.CreateCondBr(dyn_has_tag(builder, value, DYN_TAG_INT), is_int, not_int);
+
+        builder.SetInsertPoint(is_int);
+        builder.CreateRet(dyn_int_payload(builder, value));
+
+        builder.SetInsertPoint(not_int);
+        builder.CreateCondBr(dyn_has_tag(builder, value, DYN_TAG_BOOL), is_bool, not_bool);
+
+        builder.SetInsertPoint(is_bool);
+        builder.CreateRet(builder.CreateAnd(value, 1));
+
+        builder.SetInsertPoint(not_bool);
+        builder.CreateCondBr(builder.CreateAnd(explicit_conversion, dyn_is_double(builder, value)), is_float, error);
+
+        builder.SetInsertPoint(is_float);
+        llvm::Value* as_double = builder.CreateBitCast(value, builder.getDoubleTy());
+        builder.CreateRet(builder.CreateIntrinsic(llvm::Intrinsic::fptosi_sat, {builder.getInt64Ty(), builder.getDoubleTy()},
+                                                  {as_double}));
+
+        builder.SetInsertPoint(error);
+        detail::trap(builder);
+        return func;
+    }
+
+    // double __sere_dyn_to_float(i64 value): a double from any number. Traps on anything else.
+    inline llvm::Function* dyn_to_float_function(CodeGenContext& ctx) {
+        auto& builder = ctx.builder;
+        bool created;
+        llvm::Function* func = detail::dyn_helper(*ctx.get_module(), "__sere_dyn_to_float", builder.getDoubleTy(),
+                                                  {builder.getInt64Ty()}, created);
+        if (!created) return func;
+        llvm::IRBuilderBase::InsertPointGuard guard(builder);
+        llvm::Value* value = func->getArg(0);
+
+        builder.SetInsertPoint(detail::block(ctx, func, "entry"));
+        auto* is_float = detail::block(ctx, func, "float");
+        auto* not_float = detail::block(ctx, func, "notfloat");
+        auto* is_int = detail::block(ctx, func, "int");
+        auto* error = detail::block(ctx, func, "typeerror");
+        builder.CreateCondBr(dyn_is_double(builder, value), is_float, not_float);
+
+        builder.SetInsertPoint(is_float);
+        builder.CreateRet(builder.CreateBitCast(value, builder.getDoubleTy()));
+
+        builder.SetInsertPoint(not_float);
+        llvm::Value* tag = dyn_tag(builder, value);
+        builder.CreateCondBr(builder.CreateOr(builder.CreateICmpEQ(tag, builder.getInt64(DYN_TAG_INT)),
+                                              builder.CreateICmpEQ(tag, builder.getInt64(DYN_TAG_BOOL))),
+                             is_int, error);
+
+        builder.SetInsertPoint(is_int);
+        builder.CreateRet(builder.CreateSIToFP(dyn_int_payload(builder, value), builder.getDoubleTy()));
+
+        builder.SetInsertPoint(error);
+        detail::trap(builder);
+        return func;
+    }
+
+    //
+    // i1 __sere_dyn_truth(i64 value): Python's truth test. Zero, 0.0, false,
+    // "" and none are false; NaN is true.
+    //
+    inline llvm::Function* dyn_truth_function(CodeGenContext& ctx) {
+        auto& builder = ctx.builder;
+        bool created;
+        llvm::Function* func = detail::dyn_helper(*ctx.get_module(), "__sere_dyn_truth", builder.getInt1Ty(),
+                                                  {builder.getInt64Ty()}, created);
+        if (!created) return func;
+        llvm::IRBuilderBase::InsertPointGuard guard(builder);
+        llvm::Value* value = func->getArg(0);
+
+        builder.SetInsertPoint(detail::block(ctx, func, "entry"));
+        auto* is_str = detail::block(ctx, func, "str");
+        auto* not_str = detail::block(ctx, func, "notstr");
+        builder.CreateCondBr(dyn_has_tag(builder, value, DYN_TAG_STR), is_str, not_str);
+
+        builder.SetInsertPoint(is_str);
+        llvm::Value* chars = builder.CreateIntToPtr(builder.CreateAnd(value, DYN_PAYLOAD_MASK), builder.getInt8PtrTy());
+        builder.CreateRet(builder.CreateICmpNE(builder.CreateLoad(builder.getInt8Ty(), chars), builder.getInt8(0)));
+
+        // ±0.0 and every tag with a zero payload (0, false, none) are false
+        builder.SetInsertPoint(not_str);
+        llvm::Value* double_zero = builder.CreateICmpEQ(builder.CreateShl(value, 1), builder.getInt64(0));
+        llvm::Value* tagged_zero = builder.CreateAnd(builder.CreateICmpUGE(value, builder.getInt64(static_cast<uint64_t>(DYN_TAG_INT) << 48)),
+                                                     builder.CreateICmpEQ(builder.CreateAnd(value, DYN_PAYLOAD_MASK), builder.getInt64(0)));
+        builder.CreateRet(builder.CreateNot(builder.CreateOr(double_zero, tagged_zero)));
+        return func;
+    }
+
+    //
+    // i64 __sere_dyn_binop(i32 op, i64 a, i64 b): any DynOp on any two
+    // values. Ints (and bools) stay ints unless the result leaves 48 bits
+    // or is a true power with a negative exponent; otherwise both sides are
+    // doubles. Only `==` and `!=` accept non-numbers: strings compare by
+    // contents, other values by type and payload.
+    //
+    inline llvm::Function* dyn_binop_function(CodeGenContext& ctx) {
+        auto& builder = ctx.builder;
+        auto* i64 = builder.getInt64Ty();
+        auto* f64 = builder.getDoubleTy();
+        bool created;
+        llvm::Function* func = detail::dyn_helper(*ctx.get_module(), "__sere_dyn_binop", i64,
+                                                  {builder.getInt32Ty(), i64, i64}, created);
+        if (!created) return func;
+        llvm::IRBuilderBase::InsertPointGuard guard(builder);
+        llvm::IRBuilderBase::FastMathFlagGuard fast_math_guard(builder);
+        builder.clearFastMathFlags();
+        llvm::Value* op = func->getArg(0);
+        llvm::Value* a = func->getArg(1);
+        llvm::Value* b = func->getArg(2);
+        op->setName("op");
+        a->setName("a");
+        b->setName("b");
+
+        builder.SetInsertPoint(detail::block(ctx, func, "entry"));
+        auto* numeric = detail::block(ctx, func, "numeric");
+        auto* other = detail::block(ctx, func, "other");
+        auto* int_ops = detail::block(ctx, func, "intops");
+        auto* error = detail::block(ctx, func, "typeerror");
+        auto* float_ops = llvm::BasicBlock::Create(ctx.llvm_ctx, "floatops"); // sealed once the int overflows branch to it
+
+        // Numbers are the doubles, ints and bools: every tag below str
+        llvm::Value* numbers = builder.getInt64(static_cast<uint64_t>(DYN_TAG_STR) << 48);
+        builder.CreateCondBr(builder.CreateAnd(builder.CreateICmpULT(a, numbers), builder.CreateICmpULT(b, numbers)),
+                             numeric, other);
+
+        // ----- == and != on anything else
+        builder.SetInsertPoint(other);
+        auto* equality = detail::block(ctx, func, "equality");
+        llvm::Value* is_eq = builder.CreateICmpEQ(op, builder.getInt32(static_cast<int32_t>(DynOp::EQ)));
+        llvm::Value* is_ne = builder.CreateICmpEQ(op, builder.getInt32(static_cast<int32_t>(DynOp::NE)));
+        builder.CreateCondBr(builder.CreateOr(is_eq, is_ne), equality, error);
+
+        builder.SetInsertPoint(equality);
+        auto* strings = detail::block(ctx, func, "strings");
+        auto* bits = detail::block(ctx, func, "bits");
+        builder.CreateCondBr(builder.CreateAnd(dyn_has_tag(builder, a, DYN_TAG_STR), dyn_has_tag(builder, b, DYN_TAG_STR)),
+                             strings, bits);
+
+        builder.SetInsertPoint(strings);
+        llvm::FunctionCallee strcmp = ctx.get_module()->getOrInsertFunction(
+            "strcmp", llvm::FunctionType::get(builder.getInt32Ty(), {builder.getInt8PtrTy(), builder.getInt8PtrTy()}, false));
+        auto pointer = [&](llvm::Value* value) {
+            return builder.CreateIntToPtr(builder.CreateAnd(value, DYN_PAYLOAD_MASK), builder.getInt8PtrTy());
+        };
+        llvm::Value* same_text = builder.CreateICmpEQ(builder.CreateCall(strcmp, {pointer(a), pointer(b)}), builder.getInt32(0));
+        builder.CreateRet(box_bool(builder, builder.CreateXor(same_text, is_ne)));
+
+        builder.SetInsertPoint(bits);
+        builder.CreateRet(box_bool(builder, builder.CreateXor(builder.CreateICmpEQ(a, b), is_ne)));
+
+        builder.SetInsertPoint(error);
+        detail::trap(builder);
+
+        // ----- Numbers: ints unless either side is a double
+        builder.SetInsertPoint(numeric);
+        auto as_int = [&](llvm::Value* value) {
+            return builder.CreateSelect(dyn_has_tag(builder, value, DYN_TAG_BOOL), builder.CreateAnd(value, 1),
+                                        dyn_int_payload(builder, value));
+        };
+        llvm::Value* ia = as_int(a);
+        llvm::Value* ib = as_int(b);
+        builder.CreateCondBr(builder.CreateOr(dyn_is_double(builder, a), dyn_is_double(builder, b)), float_ops, int_ops);
+
+        builder.SetInsertPoint(int_ops);
+        llvm::SwitchInst* int_switch = builder.CreateSwitch(op, error, 13);
+        std::vector<llvm::BasicBlock*> overflows; // int results that need the float path
+        auto int_case = [&](DynOp which, const char* name) {
+            auto* block = detail::block(ctx, func, name);
+            int_switch->addCase(builder.getInt32(static_cast<int32_t>(which)), block);
+            builder.SetInsertPoint(block);
+        };
+        auto int_result = [&](llvm::Value* result, llvm::Value* fits) {
+            auto* done = detail::block(ctx, func, "int.done");
+            builder.CreateCondBr(fits, done, float_ops);
+            overflows.push_back(builder.GetInsertBlock());
+            builder.SetInsertPoint(done);
+            builder.CreateRet(dyn_with_tag(builder, result, DYN_TAG_INT));
+        };
+        int_case(DynOp::ADD, "int.add");
+        {
+            llvm::Value* sum = builder.CreateAdd(ia, ib);
+            int_result(sum, dyn_fits(builder, sum));
+        }
+        int_case(DynOp::SUB, "int.sub");
+        {
+            llvm::Value* difference = builder.CreateSub(ia, ib);
+            int_result(difference, dyn_fits(builder, difference));
+        }
+        int_case(DynOp::MUL, "int.mul");
+        {
+            llvm::Value* product = builder.CreateBinaryIntrinsic(llvm::Intrinsic::smul_with_overflow, ia, ib);
+            llvm::Value* value = builder.CreateExtractValue(product, 0);
+            int_result(value, builder.CreateAnd(builder.CreateNot(builder.CreateExtractValue(product, 1)), dyn_fits(builder, value)));
+        }
+        int_case(DynOp::DIV, "int.div");
+        {
+            llvm::Value* quotient = true_div(ctx, ia, ib);
+            int_result(quotient, dyn_fits(builder, quotient));
+        }
+        int_case(DynOp::FLOOR_DIV, "int.floordiv");
+        {
+            llvm::Value* quotient = floor_div(ctx, ia, ib);
+            int_result(quotient, dyn_fits(builder, quotient));
+        }
+        int_case(DynOp::MOD, "int.mod");
+        builder.CreateRet(dyn_with_tag(builder, floor_mod(ctx, ia, ib), DYN_TAG_INT));
+        int_case(DynOp::POW, "int.pow");
+        {
+            // Exact while the result fits; beyond that (or for negative exponents) it is a float, as x ** -1 is in Python
+            llvm::Value* estimate = builder.CreateBinaryIntrinsic(llvm::Intrinsic::pow, builder.CreateSIToFP(ia, f64),
+                                                                  builder.CreateSIToFP(ib, f64));
+            llvm::Value* small = builder.CreateFCmpOLT(builder.CreateUnaryIntrinsic(llvm::Intrinsic::fabs, estimate),
+                                                       llvm::ConstantFP::get(f64, static_cast<double>(1ull << 47)));
+            auto* exact = detail::block(ctx, func, "int.pow.exact");
+            builder.CreateCondBr(builder.CreateAnd(small, builder.CreateICmpSGE(ib, builder.getInt64(0))), exact, float_ops);
+            overflows.push_back(builder.GetInsertBlock());
+            builder.SetInsertPoint(exact);
+            builder.CreateRet(dyn_with_tag(builder, power(ctx, ia, ib), DYN_TAG_INT));
+        }
+        const std::pair<DynOp, llvm::CmpInst::Predicate> int_compares[] = {
+            {DynOp::LT, llvm::CmpInst::ICMP_SLT}, {DynOp::LE, llvm::CmpInst::ICMP_SLE},
+            {DynOp::GT, llvm::CmpInst::ICMP_SGT}, {DynOp::GE, llvm::CmpInst::ICMP_SGE},
+            {DynOp::EQ, llvm::CmpInst::ICMP_EQ},  {DynOp::NE, llvm::CmpInst::ICMP_NE},
+        };
+        for (const auto& [which, predicate] : int_compares) {
+            int_case(which, "int.cmp");
+            builder.CreateRet(box_bool(builder, builder.CreateICmp(predicate, ia, ib)));
+        }
+
+        // ----- Doubles (ints and bools converted)
+        float_ops->insertInto(func);
+        ctx.ssa.seal_block(float_ops);
+        builder.SetInsertPoint(float_ops);
+        auto as_float = [&](llvm::Value* value, llvm::Value* as_integer) {
+            return builder.CreateSelect(dyn_is_double(builder, value), builder.CreateBitCast(value, f64),
+                                        builder.CreateSIToFP(as_integer, f64));
+        };
+        llvm::Value* fa = as_float(a, ia);
+        llvm::Value* fb = as_float(b, ib);
+        llvm::SwitchInst* float_switch = builder.CreateSwitch(op, error, 13);
+        auto float_case = [&](DynOp which, const char* name, llvm::Value* (*emit)(CodeGenContext&, llvm::Value*, llvm::Value*)) {
+            auto* block = detail::block(ctx, func, name);
+            float_switch->addCase(builder.getInt32(static_cast<int32_t>(which)), block);
+            builder.SetInsertPoint(block);
+            builder.CreateRet(box_float(builder, emit(ctx, fa, fb)));
+        };
+        float_case(DynOp::ADD, "float.add", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return c.builder.CreateFAdd(x, y); });
+        float_case(DynOp::SUB, "float.sub", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return c.builder.CreateFSub(x, y); });
+        float_case(DynOp::MUL, "float.mul", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return c.builder.CreateFMul(x, y); });
+        float_case(DynOp::DIV, "float.div", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return c.builder.CreateFDiv(x, y); });
+        float_case(DynOp::FLOOR_DIV, "float.floordiv", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return floor_div(c, x, y); });
+        float_case(DynOp::MOD, "float.mod", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return floor_mod(c, x, y); });
+        float_case(DynOp::POW, "float.pow", [](CodeGenContext& c, llvm::Value* x, llvm::Value* y) { return power(c, x, y); });
+        const std::pair<DynOp, llvm::CmpInst::Predicate> float_compares[] = {
+            {DynOp::LT, llvm::CmpInst::FCMP_OLT}, {DynOp::LE, llvm::CmpInst::FCMP_OLE},
+            {DynOp::GT, llvm::CmpInst::FCMP_OGT}, {DynOp::GE, llvm::CmpInst::FCMP_OGE},
+            {DynOp::EQ, llvm::CmpInst::FCMP_OEQ}, {DynOp::NE, llvm::CmpInst::FCMP_UNE},
+        };
+        for (const auto& [which, predicate] : float_compares) {
+            auto* block = detail::block(ctx, func, "float.cmp");
+            float_switch->addCase(builder.getInt32(static_cast<int32_t>(which)), block);
+            builder.SetInsertPoint(block);
+            builder.CreateRet(box_bool(builder, builder.CreateFCmp(predicate, fa, fb)));
+        }
+        return func;
+    }
+
+    //
+    // `a op b` on two `dyn` values. Two ints, or two doubles, are handled
+    // inline when the operator allows (an int result must fit in 48
+    // bits); anything else goes through __sere_dyn_binop. Comparisons
+    // give an i1, everything else a `dyn`.
+    //
+    inline llvm::Value* dyn_binary(CodeGenContext& ctx, DynOp op, llvm::Value* a, llvm::Value* b) {
+        auto& builder = ctx.builder;
+        auto* i64 = builder.getInt64Ty();
+        llvm::Function* func = builder.GetInsertBlock()->getParent();
+        llvm::MDNode* likely = llvm::MDBuilder(ctx.llvm_ctx).createBranchWeights(1u << 10, 1);
+
+        auto* int_block = llvm::BasicBlock::Create(ctx.llvm_ctx, "dyn.int", func);
+        auto* not_int = llvm::BasicBlock::Create(ctx.llvm_ctx, "dyn.notint", func);
+        auto* float_block = llvm::BasicBlock::Create(ctx.llvm_ctx, "dyn.float", func);
+        auto* slow_block = llvm::BasicBlock::Create(ctx.llvm_ctx, "dyn.slow", func);
+        auto* done = llvm::BasicBlock::Create(ctx.llvm_ctx, "dyn.done", func);
+        llvm::Value* both_int = builder.CreateAnd(dyn_has_tag(builder, a, DYN_TAG_INT), dyn_has_tag(builder, b, DYN_TAG_INT));
+        builder.CreateCondBr(both_int, int_block, not_int)->setMetadata(llvm::LLVMContext::MD_prof, likely);
+
+        std::vector<std::pair<llvm::Value*, llvm::BasicBlock*>> results;
+
+        // Both ints: 48-bit operands can't overflow i64 for + and -
+        ctx.ssa.seal_block(int_block);
+        builder.SetInsertPoint(int_block);
+        llvm::Value* ia = dyn_int_payload(builder, a);
+        llvm::Value* ib = dyn_int_payload(builder, b);
+        llvm::Value* int_result = nullptr;
+        llvm::Value* fits = builder.getTrue();
+        // A zero divisor takes the slow path, which traps; 1 stands in for it here
+        llvm::Value* nonzero = nullptr;
+        llvm::Value* divisor = nullptr;
+        if (op == DynOp::DIV || op == DynOp::FLOOR_DIV || op == DynOp::MOD) {
+            nonzero = builder.CreateICmpNE(ib, builder.getInt64(0));
+            divisor = builder.CreateSelect(nonzero, ib, builder.getInt64(1));
+        }
+        switch (op) {
+            case DynOp::ADD: int_result = builder.CreateAdd(ia, ib); break;
+            case DynOp::SUB: int_result = builder.CreateSub(ia, ib); break;
+            case DynOp::MUL: {
+                llvm::Value* product = builder.CreateBinaryIntrinsic(llvm::Intrinsic::smul_with_overflow, ia, ib);
+                int_result = builder.CreateExtractValue(product, 0);
+                fits = builder.CreateNot(builder.CreateExtractValue(product, 1));
+                break;
+            }
+            case DynOp::DIV: int_result = builder.CreateSDiv(ia, divisor); fits = nonzero; break;
+            case DynOp::FLOOR_DIV: {
+                llvm::Value* remainder = builder.CreateSRem(ia, divisor);
+                int_result = builder.CreateSub(builder.CreateSDiv(ia, divisor),
+                                               builder.CreateZExt(signs_differ(builder, remainder, divisor), i64));
+                fits = nonzero;
+                break;
+            }
+            case DynOp::MOD: {
+                llvm::Value* remainder = builder.CreateSRem(ia, divisor);
+                int_result = builder.CreateSelect(signs_differ(builder, remainder, divisor),
+                                                  builder.CreateAdd(remainder, divisor), remainder);
+                fits = nonzero;
+                break;
+            }
+            case DynOp::POW: fits = nullptr; break; // always out of line
+            case DynOp::LT: int_result = box_bool(builder, builder.CreateICmpSLT(ia, ib)); break;
+            case DynOp::LE: int_result = box_bool(builder, builder.CreateICmpSLE(ia, ib)); break;
+            case DynOp::GT: int_result = box_bool(builder, builder.CreateICmpSGT(ia, ib)); break;
+            case DynOp::GE: int_result = box_bool(builder, builder.CreateICmpSGE(ia, ib)); break;
+            case DynOp::EQ: int_result = box_bool(builder, builder.CreateICmpEQ(ia, ib)); break;
+            case DynOp::NE: int_result = box_bool(builder, builder.CreateICmpNE(ia, ib)); break;
+        }
+        if (!fits)
+            builder.CreateBr(slow_block);
+        else {
+            if (!is_comparison(op)) {
+                fits = builder.CreateAnd(fits, dyn_fits(builder, int_result));
+                int_result = dyn_with_tag(builder, int_result, DYN_TAG_INT);
+            }
+            builder.CreateCondBr(fits, done, slow_block)->setMetadata(llvm::LLVMContext::MD_prof, likely);
+            results.emplace_back(int_result, int_block);
+        }
+
+        ctx.ssa.seal_block(not_int);
+        builder.SetInsertPoint(not_int);
+        llvm::Value* both_float = builder.CreateAnd(dyn_is_double(builder, a), dyn_is_double(builder, b));
+        builder.CreateCondBr(both_float, float_block, slow_block);
+
+        // Both doubles: IEEE arithmetic, as for `float`
+        ctx.ssa.seal_block(float_block);
+        builder.SetInsertPoint(float_block);
+        llvm::Value* fa = builder.CreateBitCast(a, builder.getDoubleTy());
+        llvm::Value* fb = builder.CreateBitCast(b, builder.getDoubleTy());
+        llvm::Value* float_result = nullptr;
+        switch (op) {
+            case DynOp::ADD: float_result = builder.CreateFAdd(fa, fb); break;
+            case DynOp::SUB: float_result = builder.CreateFSub(fa, fb); break;
+            case DynOp::MUL: float_result = builder.CreateFMul(fa, fb); break;
+            case DynOp::DIV: float_result = builder.CreateFDiv(fa, fb); break;
+            case DynOp::FLOOR_DIV: float_result = floor_div(ctx, fa, fb); break;
+            case DynOp::MOD: float_result = floor_mod(ctx, fa, fb); break;
+            case DynOp::POW: float_result = power(ctx, fa, fb); break;
+            case DynOp::LT: float_result = builder.CreateFCmpOLT(fa, fb); break;
+            case DynOp::LE: float_result = builder.CreateFCmpOLE(fa, fb); break;
+            case DynOp::GT: float_result = builder.CreateFCmpOGT(fa, fb); break;
+            case DynOp::GE: float_result = builder.CreateFCmpOGE(fa, fb); break;
+            case DynOp::EQ: float_result = builder.CreateFCmpOEQ(fa, fb); break;
+            case DynOp::NE: float_result = builder.CreateFCmpUNE(fa, fb); break;
+        }
+        float_result = is_comparison(op) ? box_bool(builder, float_result) : box_float(builder, float_result);
+        builder.CreateBr(done);
+        results.emplace_back(float_result, builder.GetInsertBlock());
+
+        ctx.ssa.seal_block(slow_block);
+        builder.SetInsertPoint(slow_block);
+        llvm::Value* slow_result = builder.CreateCall(dyn_binop_function(ctx),
+                                                      {builder.getInt32(static_cast<int32_t>(op)), a, b}, "dyn.slow");
+        builder.CreateBr(done);
+        results.emplace_back(slow_result, slow_block);
+
+        ctx.ssa.seal_block(done);
+        builder.SetInsertPoint(done);
+        llvm::PHINode* result = builder.CreatePHI(i64, results.size(), "dyn.result");
+        for (const auto& [value, block] : results)
+            result->addIncoming(value, block);
+        if (is_comparison(op))
+            return builder.CreateTrunc(result, builder.getInt1Ty(), "dyn.cmp");
+        return result;
+    }
+
+    inline llvm::Value* dyn_truth(CodeGenContext& ctx, llvm::Value* value) {
+        return ctx.builder.CreateCall(dyn_truth_function(ctx), {value}, "tobool");
+    }
+
+    // An i64 from an int or bool `value` (or, `explicit_conversion`, a double)
+    inline llvm::Value* unbox_int(CodeGenContext& ctx, llvm::Value* value, bool explicit_conversion) {
+        auto& builder = ctx.builder;
+        llvm::Value* is_int = dyn_has_tag(builder, value, DYN_TAG_INT);
+        llvm::Value* payload = dyn_int_payload(builder, value);
+        if (auto* known = llvm::dyn_cast<llvm::ConstantInt>(is_int); known && known->isOne())
+            return payload;
+        llvm::BasicBlock* fast = builder.GetInsertBlock();
+        llvm::Function* func = fast->getParent();
+        auto* slow = llvm::BasicBlock::Create(ctx.llvm_ctx, "unbox.slow", func);
+        auto* done = llvm::BasicBlock::Create(ctx.llvm_ctx, "unbox.done", func);
+        builder.CreateCondBr(is_int, done, slow)
+            ->setMetadata(llvm::LLVMContext::MD_prof, llvm::MDBuilder(ctx.llvm_ctx).createBranchWeights(1u << 10, 1));
+        ctx.ssa.seal_block(slow);
+        builder.SetInsertPoint(slow);
+        llvm::Value* converted = builder.CreateCall(dyn_to_int_function(ctx), {value, builder.getInt1(explicit_conversion)});
+        builder.CreateBr(done);
+        ctx.ssa.seal_block(done);
+        builder.SetInsertPoint(done);
+        llvm::PHINode* result = builder.CreatePHI(builder.getInt64Ty(), 2, "unbox");
+        result->addIncoming(payload, fast);
+        result->addIncoming(converted, slow);
+        return result;
+    }
+
+    // A double from any numeric `value`
+    inline llvm::Value* unbox_float(CodeGenContext& ctx, llvm::Value* value) {
+        auto& builder = ctx.builder;
+        llvm::BasicBlock* fast = builder.GetInsertBlock();
+        llvm::Function* func = fast->getParent();
+        auto* slow = llvm::BasicBlock::Create(ctx.llvm_ctx, "unbox.slow", func);
+        auto* done = llvm::BasicBlock::Create(ctx.llvm_ctx, "unbox.done", func);
+        llvm::Value* as_double = builder.CreateBitCast(value, builder.getDoubleTy());
+        builder.CreateCondBr(dyn_is_double(builder, value), done, slow)
+            ->setMetadata(llvm::LLVMContext::MD_prof, llvm::MDBuilder(ctx.llvm_ctx).createBranchWeights(1u << 10, 1));
+        ctx.ssa.seal_block(slow);
+        builder.SetInsertPoint(slow);
+        llvm::Value* converted = builder.CreateCall(dyn_to_float_function(ctx), {value});
+        builder.CreateBr(done);
+        ctx.ssa.seal_block(done);
+        builder.SetInsertPoint(done);
+        llvm::PHINode* result = builder.CreatePHI(builder.getDoubleTy(), 2, "unbox");
+        result->addIncoming(as_double, fast);
+        result->addIncoming(converted, slow);
+        return result;
+    }
+
+    // The string of a str `value`; traps on anything else
+    inline llvm::Value* unbox_str(CodeGenContext& ctx, llvm::Value* value) {
+        auto& builder = ctx.builder;
+        ctx.trap_if(builder.CreateNot(dyn_has_tag(builder, value, DYN_TAG_STR)), "unbox.typeerror");
+        return builder.CreateIntToPtr(builder.CreateAnd(value, DYN_PAYLOAD_MASK), builder.getInt8PtrTy(), "unbox");
+    }
+
+} // namespace SereIR
+
+#endif // IR_DYNAMIC_HPP
@@ -0,0 +1,198 @@
+#ifndef IR_EFFECTS_HPP
+#define IR_EFFECTS_HPP
+
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/Analysis/CFG.h>
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/BuildLibCalls.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+//
+// Purity and effect inference. Walks the module's call graph bottom-up,
+// one strongly connected component at a time, and records what each
+// function is guaranteed not to do as LLVM attributes, so calls can be
+// CSE'd, hoisted out of loops and deleted when unused.
+//
+// Sere code has no exceptions, heap or indirect calls, so most functions
+// come out nounwind and nofree; a function touching no memory is
+// readnone. A `while` loop may not terminate and so prevents willreturn;
+// counted `for` loops carry llvm.loop.mustprogress and don't. A trap
+// (division by zero) is a way out of the program that first writes out
+// the output buffer: it reads memory, and the flush it calls is part of it.
+//
+// Imports form a DAG, so a callee in another module can never call back
+// into this one: recursion is a cycle in this module's call graph.
+//
+namespace SereIR {
+
+    // Guarantees about a function; a set bit is a promise. Stored in module interfaces.
+    enum EffectBits : uint32_t {
+        EFFECT_READNONE   = 1u << 0,
+        EFFECT_READONLY   = 1u << 1,
+        EFFECT_NOUNWIND   = 1u << 2,
+        EFFECT_NORECURSE  = 1u << 3,
+        EFFECT_WILLRETURN = 1u << 4,
+        EFFECT_NOFREE     = 1u << 5,
+    };
+
+    inline void apply_effects(llvm::Function& func, uint32_t effects) {
+        if (effects & EFFECT_READNONE) func.setDoesNotAccessMemory();
+        else if (effects & EFFECT_READONLY) func.setOnlyReadsMemory();
+        if (effects & EFFECT_NOUNWIND) func.setDoesNotThrow();
+        if (effects & EFFECT_NORECURSE) func.setDoesNotRecurse();
+        if (effects & EFFECT_WILLRETURN) func.addFnAttr(llvm::Attribute::WillReturn);
+        if (effects & EFFECT_NOFREE) func.addFnAttr(llvm::Attribute::NoFree);
+    }
+
+    namespace detail {
+
+        // What may happen; the complement of EffectBits, so summaries merge by OR.
+        struct EffectSummary {
+            bool reads = false;
+            bool writes = false;
+            bool unwinds = false;
+            bool recurses = false;
+            bool may_not_return = false;
+            bool frees = false;
+
+            void merge(const EffectSummary& other) {
+                reads |= other.reads;
+                writes |= other.writes;
+                unwinds |= other.unwinds;
+                recurses |= other.recurses;
+                may_not_return |= other.may_not_return;
+                frees |= other.frees;
+            }
+
+            uint32_t bits() const {
+                uint32_t effects = 0;
+                if (!reads && !writes) effects |= EFFECT_READNONE;
+                if (!writes) effects |= EFFECT_READONLY;
+                if (!unwinds) effects |= EFFECT_NOUNWIND;
+                if (!recurses) effects |= EFFECT_NORECURSE;
+                if (!may_not_return) effects |= EFFECT_WILLRETURN;
+                if (!frees) effects |= EFFECT_NOFREE;
+                return effects;
+            }
+        };
+
+        // A declaration (libc, intrinsic, other Sere module) as its attributes describe it.
+        inline EffectSummary declared_effects(const llvm::Function& callee) {
+            EffectSummary summary;
+            summary.reads = !callee.doesNotAccessMemory();
+            summary.writes = !callee.onlyReadsMemory();
+            summary.unwinds = !callee.doesNotThrow();
+            summary.recurses = false; // see above: nothing outside calls back in
+            summary.may_not_return = !callee.hasFnAttribute(llvm::Attribute::WillReturn);
+            summary.frees = !callee.hasFnAttribute(llvm::Attribute::NoFree);
+            return summary;
+        }
+
+        inline bool has_must_progress(const llvm::Instruction* terminator) {
+            llvm::MDNode* loop = terminator->getMetadata(llvm::LLVMContext::MD_loop);
+            if (!loop) return false;
+            for (const llvm::MDOperand& op : loop->operands())
+                if (auto* hint = llvm::dyn_cast_or_null<llvm::MDNode>(op.get()))
+                    if (hint->getNumOperands() > 0)
+                        if (auto* name = llvm::dyn_cast<llvm::MDString>(hint->getOperand(0)))
+                            if (name->getString() == "llvm.loop.mustprogress") return true;
+            return false;
+        }
+
+        // The flush Std/Standard.hpp puts in front of each trap (flush_output_before_traps)
+        inline bool is_trap_flush(const llvm::CallBase& call) {
+            auto* next = llvm::dyn_cast_or_null<llvm::CallInst>(call.getNextNode());
+            return next && next->getIntrinsicID() == llvm::Intrinsic::trap && call.getCalledFunction() &&
+                   call.getCalledFunction()->getName() == "__sere_flush_stdout";
+        }
+
+        // Effects of `func`'s own instructions; calls into `scc` are left to the caller.
+        inline EffectSummary local_effects(const llvm::Function& func,
+                                           const std::unordered_map<const llvm::Function*, EffectSummary>& known,
+                                           const llvm::SmallPtrSetImpl<const llvm::Function*>& scc) {
+            EffectSummary summary;
+            llvm::SmallVector<std::pair<const llvm::BasicBlock*, const llvm::BasicBlock*>, 4> back_edges;
+            llvm::FindFunctionBackedges(func, back_edges);
+            for (const auto& edge : back_edges)
+                if (!has_must_progress(edge.first->getTerminator())) summary.may_not_return = true;
+
+            for (const llvm::Instruction& inst : llvm::instructions(func)) {
+                if (auto* load = llvm::dyn_cast<llvm::LoadInst>(&inst)) {
+                    auto* global = llvm::dyn_cast<llvm::GlobalVariable>(load->getPointerOperand()->stripPointerCasts());
+                    if (load->isVolatile()) summary.writes = true;
+                    if (!global || !global->isConstant()) summary.reads = true;
+                } else if (llvm::isa<llvm::StoreInst>(inst) || llvm::isa<llvm::AtomicRMWInst>(inst) ||
+                           llvm::isa<llvm::AtomicCmpXchgInst>(inst) || llvm::isa<llvm::FenceInst>(inst)) {
+                    summary.reads = summary.writes = true;
+                } else if (auto* call = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+                    const llvm::Function* callee = call->getCalledFunction();
+                    if (!callee) { // an ifunc or dispatch pointer (@multiversion): assume anything
+                        summary.merge(EffectSummary{true, true, true, false, true, true});
+                        continue;
+                    }
+                    if (scc.count(callee)) continue;
+                    if (callee->getIntrinsicID() == llvm::Intrinsic::trap) {
+                        summary.may_not_return = true;
+                        summary.reads = true;
+                        continue;
+                    }
+                    if (is_trap_flush(*call)) continue;
+                    auto found = known.find(callee);
+                    summary.merge(found != known.end() ? found->second : declared_effects(*callee));
+                }
+            }
+            return summary;
+        }
+
+    } // namespace detail
+
+    //
+    // Annotates every function the module defines and returns the
+    // guarantees by symbol name (for module interfaces). Declarations of
+    // known C library functions get LLVM's usual attributes first.
+    //
+    inline std::unordered_map<std::string, uint32_t> infer_effects(llvm::Module& module) {
+        llvm::TargetLibraryInfoImpl tli_impl(llvm::Triple(module.getTargetTriple()));
+        llvm::TargetLibraryInfo tli(tli_impl);
+        for (llvm::Function& func : module)
+            if (func.isDeclaration() && !func.isIntrinsic()) llvm::inferLibFuncAttributes(func, tli);
+
+        std::unordered_map<const llvm::Function*, detail::EffectSummary> known;
+        std::unordered_map<std::string, uint32_t> effects;
+        llvm::CallGraph graph(module);
+        for (auto scc = llvm::scc_begin(&graph); !scc.isAtEnd(); ++scc) {
+            llvm::SmallPtrSet<const llvm::Function*, 4> members;
+            for (llvm::CallGraphNode* node : *scc)
+                if (node->getFunction() && !node->getFunction()->isDeclaration()) members.insert(node->getFunction());
+            if (members.empty()) continue;
+
+            detail::EffectSummary summary;
+            summary.recurses = scc.hasCycle();
+            if (summary.recurses) summary.may_not_return = true; // recursion depth isn't bounded
+            for (const llvm::Function* func : members)
+                summary.merge(detail::local_effects(*func, known, members));
+
+            for (const llvm::Function* func : members) {
+                known[func] = summary;
+                uint32_t bits = summary.bits();
+                apply_effects(const_cast<llvm::Function&>(*func), bits);
+                effects[func->getName().str()] = bits;
+            }
+        }
+        return effects;
+    }
+
+} // namespace SereIR
+
+#endif // IR_EFFECTS_HPP
@@ -0,0 +1,465 @@
+#ifndef IR_FORMAT_HPP
+#define IR_FORMAT_HPP
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Module.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./CodeGenContext.hpp"
+#include "./Dynamic.hpp"
+#include "../Parser/AST/Midlevel/ConstValue.hpp"
+
+//
+// What print writes: its arguments one after another, straight into the
+// output buffer of Std/Standard.hpp, each by a formatter picked for its
+// static type at compile time. Nothing parses a format at run time. ints
+// are written in decimal two digits at a time, floats as the shortest
+// %.Ng that reads back as the same value (SereParser::format_real), bools
+// as True or False, `dyn` values by their tag. Constants are formatted
+// while lowering (const_format) and merged with the text around them, so
+// `print("n =", 3)` is one copy of "n = 3\n". The helpers are internal
+// to each module, like __sere_ipow; the buffer is shared.
+//
+namespace SereIR {
+
+    inline constexpr uint64_t STDOUT_BUFFER_SIZE = 64 * 1024;
+    inline const char* const FLUSH_STDOUT = "__sere_flush_stdout";
+
+    // Thread-local state shared by the modules of a program
+    inline llvm::GlobalVariable* runtime_global(llvm::Module& module, llvm::Type* type, const std::string& name) {
+        if (auto* existing = module.getGlobalVariable(name)) return existing;
+        return new llvm::GlobalVariable(module, type, false, llvm::GlobalValue::LinkOnceODRLinkage,
+                                        llvm::Constant::getNullValue(type), name, nullptr,
+                                        llvm::GlobalValue::InitialExecTLSModel);
+    }
+
+    inline llvm::ArrayType* stdout_buffer_type(llvm::LLVMContext& context) {
+        return llvm::ArrayType::get(llvm::Type::getInt8Ty(context), STDOUT_BUFFER_SIZE);
+    }
+
+    inline llvm::GlobalVariable* stdout_buffer(llvm::Module& module) {
+        return runtime_global(module, stdout_buffer_type(module.getContext()), "__sere_stdout_buffer");
+    }
+
+    // Bytes of the buffer in use
+    inline llvm::GlobalVariable* stdout_used(llvm::Module& module) {
+        return runtime_global(module, llvm::Type::getInt64Ty(module.getContext()), "__sere_stdout_used");
+    }
+
+    // One thing to write: a value of `kind`, and its value when it is a constant
+    struct OutputPiece {
+        llvm::Value* value = nullptr;
+        Runtime::SereTypeKind kind = Runtime::SereTypeKind::NONE;
+        std::optional<SereParser::ConstValue> constant;
+    };
+
+    namespace detail {
+
+        inline llvm::Function* format_helper(llvm::Module& module, const char* name, llvm::ArrayRef<llvm::Type*> params, bool& created) {
+            created = false;
+            if (llvm::Function* existing = module.getFunction(name)) return existing;
+            created = true;
+            auto* func = llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(module.getContext()), params, false),
+                                                llvm::GlobalValue::InternalLinkage, name, module);
+            func->addFnAttr(llvm::Attribute::NoUnwind);
+            return func;
+        }
+
+        inline llvm::Constant* table(llvm::Module& module, const char* name, llvm::Constant* data) {
+            if (auto* existing = module.getGlobalVariable(name, true)) return existing;
+            auto* global = new llvm::GlobalVariable(module, data->getType(), true, llvm::GlobalValue::PrivateLinkage, data, name);
+            global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+            return global;
+        }
+
+        inline llvm::FunctionCallee flush_stdout(llvm::Module& module) {
+            return module.getOrInsertFunction(FLUSH_STDOUT, llvm::Type::getVoidTy(module.getContext()));
+        }
+
+        // Flushes the buffer unless `room` more bytes fit; the offset to write at
+        inline llvm::Value* reserve(llvm::IRBuilder<>& builder, llvm::Module& module, uint64_t room) {
+            llvm::GlobalVariable* used = stdout_used(module);
+            llvm::Function* func = builder.GetInsertBlock()->getParent();
+            auto* full = llvm::BasicBlock::Create(module.getContext(), "full", func);
+            auto* ready = llvm::BasicBlock::Create(module.getContext(), "ready", func);
+            llvm::Value* fits = builder.CreateICmpULE(builder.CreateLoad(builder.getInt64Ty(), used),
+                                                      builder.getInt64(STDOUT_BUFFER_SIZE - room));
+            builder.CreateCondBr(fits, ready, full, llvm::MDBuilder(module.getContext()).createBranchWeights(1u << 20, 1));
+            builder.SetInsertPoint(full);
+            builder.CreateCall(flush_stdout(module));
+            builder.CreateBr(ready);
+            builder.SetInsertPoint(ready);
+            return builder.CreateLoad(builder.getInt64Ty(), used, "used");
+        }
+
+        inline llvm::Value* buffer_at(llvm::IRBuilder<>& builder, llvm::Module& module, llvm::Value* offset) {
+            return builder.CreateInBoundsGEP(stdout_buffer_type(module.getContext()), stdout_buffer(module), {builder.getInt64(0), offset});
+        }
+
+        //
+        // void __sere_append_slow(i8* text, i64 length): an append that does
+        // not fit what is left of the buffer. The buffer is flushed; text
+        // longer than all of it is written directly.
+        //
+        inline llvm::Function* append_slow_function(llvm::Module& module) {
+            auto& context = module.getContext();
+            auto* i64 = llvm::Type::getInt64Ty(context);
+            auto* i8ptr = llvm::Type::getInt8PtrTy(context);
+            bool created;
+            llvm::Function* func = format_helper(module, "__sere_append_slow", {i8ptr, i64}, created);
+            if (!created) return func;
+            func->addFnAttr(llvm::Attribute::NoInline);
+            func->addFnAttr(llvm::Attribute::Cold);
+            llvm::Value* text = func->getArg(0);
+            llvm::Value* length = func->getArg(1);
+            auto* entry = llvm::BasicBlock::Create(context, "entry", func);
+            auto* copy = llvm::BasicBlock::Create(context, "copy", func);
+            auto* direct = llvm::BasicBlock::Create(context, "direct", func);
+            llvm::IRBuilder<> builder(entry);
+            builder.CreateCall(flush_stdout(module));
+            builder.CreateCondBr(builder.CreateICmpULT(length, builder.getInt64(STDOUT_BUFFER_SIZE)), copy, direct);
+
+            builder.SetInsertPoint(copy);
+            builder.CreateMemCpy(buffer_at(builder, module, builder.getInt64(0)), llvm::MaybeAlign(1), text, llvm::MaybeAlign(1), length);
+            builder.CreateStore(length, stdout_used(module));
+            builder.CreateRetVoid();
+
+            builder.SetInsertPoint(direct);
+            builder.CreateCall(module.getOrInsertFunction("__sere_write_all", builder.getVoidTy(), i8ptr, i64), {text, length});
+            builder.CreateRetVoid();
+            return func;
+        }
+
+        //
+        // `length` bytes at `text` into the buffer: a bounds check and a
+        // memcpy, of a constant length for constant text. Returns the
+        // blocks it created; `builder` is left in the last.
+        //
+        inline std::array<llvm::BasicBlock*, 3> append(llvm::IRBuilder<>& builder, llvm::Module& module, llvm::Value* text,
+                                                       llvm::Value* length) {
+            auto& context = module.getContext();
+            llvm::GlobalVariable* used = stdout_used(module);
+            llvm::Function* func = builder.GetInsertBlock()->getParent();
+            auto* copy = llvm::BasicBlock::Create(context, "append.copy", func);
+            auto* slow = llvm::BasicBlock::Create(context, "append.slow", func);
+            auto* done = llvm::BasicBlock::Create(context, "append.done", func);
+
+            llvm::Value* start = builder.CreateLoad(builder.getInt64Ty(), used, "used");
+            llvm::Value* end = builder.CreateAdd(start, length, "end");
+            builder.CreateCondBr(builder.CreateICmpULE(end, builder.getInt64(STDOUT_BUFFER_SIZE)), copy, slow,
+                                 llvm::MDBuilder(context).createBranchWeights(1u << 20, 1));
+
+            builder.SetInsertPoint(copy);
+            builder.CreateMemCpy(buffer_at(builder, module, start), llvm::MaybeAlign(1), text, llvm::MaybeAlign(1), length);
+            builder.CreateStore(end, used);
+            builder.CreateBr(done);
+
+            builder.SetInsertPoint(slow);
+            builder.CreateCall(append_slow_function(module), {text, length});
+            builder.CreateBr(done);
+
+            builder.SetInsertPoint(done);
+            return {copy, slow, done};
+        }
+
+        inline llvm::Value* string_length(llvm::IRBuilder<>& builder, llvm::Module& module, llvm::Value* text) {
+            return builder.CreateCall(module.getOrInsertFunction("strlen", builder.getInt64Ty(), builder.getInt8PtrTy()), {text}, "length");
+        }
+
+        inline void append_bool(llvm::IRBuilder<>& builder, llvm::Module& module, llvm::Value* truth, std::vector<llvm::BasicBlock*>& created) {
+            llvm::Value* text = builder.CreateSelect(truth, builder.CreateGlobalStringPtr("True", ".true", 0, &module),
+                                                     builder.CreateGlobalStringPtr("False", ".false", 0, &module));
+            auto blocks = append(builder, module, text, builder.CreateSelect(truth, builder.getInt64(4), builder.getInt64(5)));
+            created.insert(created.end(), blocks.begin(), blocks.end());
+        }
+
+    } // namespace detail
+
+    //
+    // void __sere_append_int(i64 value, i1 signed): `value` in decimal.
+    // The digits are counted first (from the bit length, corrected by one
+    // comparison) and written from the last, two at a time from a table of
+    // "00".."99", straight into the buffer.
+    //
+    inline llvm::Function* append_int_function(llvm::Module& module) {
+        auto& context = module.getContext();
+        auto* i8 = llvm::Type::getInt8Ty(context);
+        auto* i16 = llvm::Type::getInt16Ty(context);
+        auto* i64 = llvm::Type::getInt64Ty(context);
+        bool created;
+        llvm::Function* func = detail::format_helper(module, "__sere_append_int", {i64, llvm::Type::getInt1Ty(context)}, created);
+        if (!created) return func;
+        llvm::Value* value = func->getArg(0);
+        llvm::Value* is_signed = func->getArg(1);
+        value->setName("value");
+        is_signed->setName("signed");
+
+        std::string pairs;
+        for (int i = 0; i < 100; ++i) pairs += {static_cast<char>('0' + i / 10), static_cast<char>('0' + i % 10)};
+        std::vector<uint64_t> powers{1};
+        while (powers.size() < 20) powers.push_back(powers.back() * 10);
+        llvm::Constant* pair_table = detail::table(module, "__sere_digit_pairs", llvm::ConstantDataArray::getString(context, pairs, false));
+        llvm::Constant* power_table = detail::table(module, "__sere_powers_of_ten", llvm::ConstantDataArray::get(context, powers));
+        auto* pair_type = llvm::ArrayType::get(i8, 200);
+        auto* power_type = llvm::ArrayType::get(i64, 20);
+
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", func));
+        auto* loop = llvm::BasicBlock::Create(context, "loop", func);
+        auto* pair = llvm::BasicBlock::Create(context, "pair", func);
+        auto* last = llvm::BasicBlock::Create(context, "last", func);
+        auto* two = llvm::BasicBlock::Create(context, "two", func);
+        auto* one = llvm::BasicBlock::Create(context, "one", func);
+        auto* done = llvm::BasicBlock::Create(context, "done", func);
+        auto store_pair = [&](llvm::Value* index, llvm::Value* at) {
+            llvm::Value* from = builder.CreateInBoundsGEP(pair_type, pair_table, {builder.getInt64(0), builder.CreateShl(index, 1)});
+            llvm::Value* digits = builder.CreateAlignedLoad(i16, builder.CreateBitCast(from, i16->getPointerTo()), llvm::MaybeAlign(1));
+            builder.CreateAlignedStore(digits, builder.CreateBitCast(detail::buffer_at(builder, module, at), i16->getPointerTo()),
+                                       llvm::MaybeAlign(1));
+        };
+
+        // 20 bytes hold -2**63 and 2**64-1
+        llvm::Value* start = detail::reserve(builder, module, 20);
+        llvm::Value* negative = builder.CreateAnd(is_signed, builder.CreateICmpSLT(value, builder.getInt64(0)), "negative");
+        llvm::Value* magnitude = builder.CreateSelect(negative, builder.CreateNeg(value), value, "magnitude");
+        llvm::Value* odd = builder.CreateOr(magnitude, 1);
+        llvm::Value* bits = builder.CreateSub(builder.getInt64(64), builder.CreateIntrinsic(llvm::Intrinsic::ctlz, {i64}, {odd, builder.getTrue()}));
+        llvm::Value* guess = builder.CreateLShr(builder.CreateMul(bits, builder.getInt64(1233)), 12); // about log10(2**bits)
+        llvm::Value* power = builder.CreateLoad(i64, builder.CreateInBoundsGEP(power_type, power_table, {builder.getInt64(0), guess}));
+        llvm::Value* digits = builder.CreateAdd(guess, builder.CreateZExt(builder.CreateICmpUGE(odd, power), i64), "digits");
+        llvm::Value* end = builder.CreateAdd(builder.CreateAdd(start, builder.CreateZExt(negative, i64)), digits, "end");
+        // A sign nothing else overwrites only when there is one
+        builder.CreateStore(builder.getInt8('-'), detail::buffer_at(builder, module, start));
+        llvm::BasicBlock* entry_end = builder.GetInsertBlock();
+        builder.CreateBr(loop);
+
+        builder.SetInsertPoint(loop);
+        llvm::PHINode* at = builder.CreatePHI(i64, 2, "at");
+        llvm::PHINode* rest = builder.CreatePHI(i64, 2, "rest");
+        at->addIncoming(end, entry_end);
+        rest->addIncoming(magnitude, entry_end);
+        builder.CreateCondBr(builder.CreateICmpUGE(rest, builder.getInt64(100)), pair, last);
+
+        builder.SetInsertPoint(pair);
+        llvm::Value* quotient = builder.CreateUDiv(rest, builder.getInt64(100));
+        llvm::Value* next_at = builder.CreateSub(at, builder.getInt64(2));
+        store_pair(builder.CreateSub(rest, builder.CreateMul(quotient, builder.getInt64(100))), next_at);
+        at->addIncoming(next_at, pair);
+        rest->addIncoming(quotient, pair);
+        builder.CreateBr(loop);
+
+        builder.SetInsertPoint(last);
+        builder.CreateCondBr(builder.CreateICmpUGE(rest, builder.getInt64(10)), two, one);
+
+        builder.SetInsertPoint(two);
+        store_pair(rest, builder.CreateSub(at, builder.getInt64(2)));
+        builder.CreateBr(done);
+
+        builder.SetInsertPoint(one);
+        builder.CreateStore(builder.CreateAdd(builder.CreateTrunc(rest, i8), builder.getInt8('0')),
+                            detail::buffer_at(builder, module, builder.CreateSub(at, builder.getInt64(1))));
+        builder.CreateBr(done);
+
+        builder.SetInsertPoint(done);
+        builder.CreateStore(end, stdout_used(module));
+        builder.CreateRetVoid();
+        return func;
+    }
+
+    //
+    // void __sere_append_float(double value, i1 single): SereParser::format_real
+    // with the same libc calls: snprintf at increasing precision until
+    // strtod gives the value back (as an f32 when `single`).
+    //
+    inline llvm::Function* append_float_function(llvm::Module& module) {
+        auto& context = module.getContext();
+        auto* i32 = llvm::Type::getInt32Ty(context);
+        auto* i64 = llvm::Type::getInt64Ty(context);
+        auto* i8ptr = llvm::Type::getInt8PtrTy(context);
+        auto* f64 = llvm::Type::getDoubleTy(context);
+        bool created;
+        llvm::Function* func = detail::format_helper(module, "__sere_append_float", {f64, llvm::Type::getInt1Ty(context)}, created);
+        if (!created) return func;
+        llvm::Value* value = func->getArg(0);
+        llvm::Value* single = func->getArg(1);
+        value->setName("value");
+        single->setName("single");
+        llvm::FunctionCallee snprintf = module.getOrInsertFunction("snprintf", llvm::FunctionType::get(i32, {i8ptr, i64, i8ptr}, true));
+        llvm::FunctionCallee strtod = module.getOrInsertFunction("strtod", f64, i8ptr, i8ptr->getPointerTo());
+        llvm::FunctionCallee strspn = module.getOrInsertFunction("strspn", i64, i8ptr, i8ptr);
+
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", func));
+        auto* nan = llvm::BasicBlock::Create(context, "nan", func);
+        auto* number = llvm::BasicBlock::Create(context, "number", func);
+        auto* loop = llvm::BasicBlock::Create(context, "loop", func);
+        auto* formatted = llvm::BasicBlock::Create(context, "formatted", func);
+        auto* point = llvm::BasicBlock::Create(context, "point", func);
+        auto* done = llvm::BasicBlock::Create(context, "done", func);
+
+        const uint64_t room = 32;
+        llvm::Value* start = detail::reserve(builder, module, room);
+        llvm::Value* text = detail::buffer_at(builder, module, start);
+        builder.CreateCondBr(builder.CreateFCmpUNO(value, value), nan, number);
+
+        // Not "-nan": the sign of a NaN is not something Python prints
+        builder.SetInsertPoint(nan);
+        builder.CreateMemCpy(text, llvm::MaybeAlign(1), builder.CreateGlobalStringPtr("nan", ".nan", 0, &module), llvm::MaybeAlign(1), 3);
+        builder.CreateStore(builder.CreateAdd(start, builder.getInt64(3)), stdout_used(module));
+        builder.CreateRetVoid();
+
+        builder.SetInsertPoint(number);
+        llvm::Value* format = builder.CreateGlobalStringPtr("%.*g", ".realfmt", 0, &module);
+        llvm::Value* most = builder.CreateSelect(single, builder.getInt32(9), builder.getInt32(17));
+        llvm::Value* fewest = builder.CreateSelect(single, builder.getInt32(6), builder.getInt32(15));
+        llvm::Value* narrow = builder.CreateFPTrunc(value, builder.getFloatTy());
+        builder.CreateBr(loop);
+
+        builder.SetInsertPoint(loop);
+        llvm::PHINode* digits = builder.CreatePHI(i32, 2, "digits");
+        digits->addIncoming(fewest, number);
+        llvm::Value* length = builder.CreateCall(snprintf, {text, builder.getInt64(room), format, digits, value}, "length");
+        llvm::Value* back = builder.CreateCall(strtod, {text, llvm::ConstantPointerNull::get(i8ptr->getPointerTo())}, "back");
+        llvm::Value* same = builder.CreateSelect(single, builder.CreateFCmpOEQ(builder.CreateFPTrunc(back, builder.getFloatTy()), narrow),
+                                                 builder.CreateFCmpOEQ(back, value));
+        digits->addIncoming(builder.CreateAdd(digits, builder.getInt32(1)), loop);
+        builder.CreateCondBr(builder.CreateOr(same, builder.CreateICmpEQ(digits, most)), formatted, loop);
+
+        builder.SetInsertPoint(formatted);
+        llvm::Value* written = builder.CreateZExt(length, i64);
+        llvm::Value* integral = builder.CreateICmpEQ(
+            builder.CreateCall(strspn, {text, builder.CreateGlobalStringPtr("-0123456789", ".intchars", 0, &module)}), written);
+        builder.CreateCondBr(integral, point, done);
+
+        builder.SetInsertPoint(point);
+        llvm::Value* after = builder.CreateInBoundsGEP(builder.getInt8Ty(), text, written);
+        builder.CreateStore(builder.getInt8('.'), after);
+        builder.CreateStore(builder.getInt8('0'), builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), after, 1));
+        llvm::Value* pointed = builder.CreateAdd(written, builder.getInt64(2));
+        builder.CreateBr(done);
+
+        builder.SetInsertPoint(done);
+        llvm::PHINode* total = builder.CreatePHI(i64, 2, "total");
+        total->addIncoming(written, formatted);
+        total->addIncoming(pointed, point);
+        builder.CreateStore(builder.CreateAdd(start, total), stdout_used(module));
+        builder.CreateRetVoid();
+        return func;
+    }
+
+    //
+    // void __sere_append_dyn(i64 value): a `dyn` value by its tag, with
+    // the formatter of that type.
+    //
+    inline llvm::Function* append_dyn_function(llvm::Module& module) {
+        auto& context = module.getContext();
+        auto* i64 = llvm::Type::getInt64Ty(context);
+        bool created;
+        llvm::Function* func = detail::format_helper(module, "__sere_append_dyn", {i64}, created);
+        if (!created) return func;
+        llvm::Value* value = func->getArg(0);
+        value->setName("value");
+
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", func));
+        auto* real = llvm::BasicBlock::Create(context, "float", func);
+        auto* tagged = llvm::BasicBlock::Create(context, "tagged", func);
+        auto* integer = llvm::BasicBlock::Create(context, "int", func);
+        auto* truth = llvm::BasicBlock::Create(context, "bool", func);
+        auto* text = llvm::BasicBlock::Create(context, "str", func);
+        auto* none = llvm::BasicBlock::Create(context, "none", func);
+        builder.CreateCondBr(dyn_is_double(builder, value), real, tagged);
+
+        builder.SetInsertPoint(real);
+        builder.CreateCall(append_float_function(module), {builder.CreateBitCast(value, builder.getDoubleTy()), builder.getFalse()});
+        builder.CreateRetVoid();
+
+        builder.SetInsertPoint(tagged);
+        llvm::SwitchInst* by_tag = builder.CreateSwitch(dyn_tag(builder, value), none, 3);
+        by_tag->addCase(builder.getInt64(DYN_TAG_INT), integer);
+        by_tag->addCase(builder.getInt64(DYN_TAG_BOOL), truth);
+        by_tag->addCase(builder.getInt64(DYN_TAG_STR), text);
+
+        builder.SetInsertPoint(integer);
+        builder.CreateCall(append_int_function(module), {dyn_int_payload(builder, value), builder.getTrue()});
+        builder.CreateRetVoid();
+
+        builder.SetInsertPoint(truth);
+        std::vector<llvm::BasicBlock*> unused;
+        detail::append_bool(builder, module, builder.CreateTrunc(value, builder.getInt1Ty()), unused);
+        builder.CreateRetVoid();
+
+        builder.SetInsertPoint(text);
+        llvm::Value* chars = builder.CreateIntToPtr(builder.CreateAnd(value, DYN_PAYLOAD_MASK), builder.getInt8PtrTy());
+        detail::append(builder, module, chars, detail::string_length(builder, module, chars));
+        builder.CreateRetVoid();
+
+        builder.SetInsertPoint(none);
+        detail::append(builder, module, builder.CreateGlobalStringPtr("None", ".none", 0, &module), builder.getInt64(4));
+        builder.CreateRetVoid();
+        return func;
+    }
+
+    //
+    // Writes `pieces` at ctx.builder, in order and with nothing between
+    // them: print and f-strings put in their own separators. Runs of
+    // constants become one constant append.
+    //
+    inline void emit_output(CodeGenContext& ctx, const std::vector<OutputPiece>& pieces) {
+        using Runtime::SereTypeKind;
+        auto& builder = ctx.builder;
+        llvm::Module& module = *ctx.get_module();
+        std::vector<llvm::BasicBlock*> created;
+        std::string text;
+        auto append = [&](llvm::Value* chars, llvm::Value* length) {
+            auto blocks = detail::append(builder, module, chars, length);
+            created.insert(created.end(), blocks.begin(), blocks.end());
+        };
+        auto flush_text = [&]() {
+            if (text.empty()) return;
+            append(ctx.constants.string(module, text), builder.getInt64(text.size()));
+            text.clear();
+        };
+
+        for (const OutputPiece& piece : pieces) {
+            if (piece.constant) {
+                text += SereParser::const_format(*piece.constant);
+                continue;
+            }
+            if (piece.kind == SereTypeKind::NONE) {
+                text += "None";
+                continue;
+            }
+            flush_text();
+            llvm::Value* value = piece.value;
+            if (piece.kind == SereTypeKind::STRING)
+                append(value, detail::string_length(builder, module, value));
+            else if (piece.kind == SereTypeKind::BOOL)
+                detail::append_bool(builder, module, value, created);
+            else if (Runtime::is_integer(piece.kind))
+                builder.CreateCall(append_int_function(module),
+                                   {builder.CreateIntCast(value, builder.getInt64Ty(), Runtime::is_signed(piece.kind)),
+                                    builder.getInt1(Runtime::is_signed(piece.kind))});
+            else if (Runtime::is_float(piece.kind))
+                builder.CreateCall(append_float_function(module),
+                                   {builder.CreateFPCast(value, builder.getDoubleTy()), builder.getInt1(piece.kind == SereTypeKind::F32)});
+            else if (piece.kind == SereTypeKind::DYNAMIC)
+                builder.CreateCall(append_dyn_function(module), {value});
+            else
+                throw std::runtime_error("Cannot print a value of type " + Runtime::to_string(piece.kind) + ".");
+        }
+        flush_text();
+        for (llvm::BasicBlock* block : created) ctx.ssa.seal_block(block);
+    }
+
+} // namespace SereIR
+
+#endif // IR_FORMAT_HPP
@@ -2,6 +2,10 @@
 #define IR_HPP
 
 #include "./CodeGenContext.hpp"
+#include "./Arith.hpp"
+#include "./Dynamic.hpp"
+#include "./Effects.hpp"
+#include "./Format.hpp"
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Value.h>
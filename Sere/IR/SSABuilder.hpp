@@ -0,0 +1,162 @@
+#ifndef IR_SSABUILDER_HPP
+#define IR_SSABUILDER_HPP
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Type.h>
+#include <llvm/IR/ValueHandle.h>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace SereIR {
+
+    //
+    // On-the-fly SSA construction (Braun et al., "Simple and Efficient
+    // Construction of Static Single Assignment Form", CC 2013).
+    //
+    // Codegen writes a variable's new value into the current block and reads
+    // it back through the CFG: a read in a block without a local definition
+    // looks through its predecessors, placing phis only where control flow
+    // merges. A block whose predecessors may still grow (loop headers) stays
+    // unsealed; its reads get operandless phis that seal_block() completes.
+    // Trivial phis (all operands the same value or the phi itself) are
+    // removed as soon as they are complete.
+    //
+    // State is keyed by block and function, so a function defined in the
+    // middle of top-level code does not disturb the module initializer.
+    //
+    class SSABuilder {
+    public:
+        void reset() {
+            current_def_.clear();
+            incomplete_phis_.clear();
+            sealed_.clear();
+            types_.clear();
+        }
+
+        // Fixes a variable's type for the function; false if it already had one.
+        bool declare(llvm::Function* func, const std::string& var, llvm::Type* type) {
+            return types_[func].emplace(var, type).second;
+        }
+
+        // The declared type, or null when `var` is not a variable of `func`.
+        llvm::Type* type_of(llvm::Function* func, const std::string& var) const {
+            auto fn = types_.find(func);
+            if (fn == types_.end()) return nullptr;
+            auto found = fn->second.find(var);
+            return found == fn->second.end() ? nullptr : found->second;
+        }
+
+        void write_variable(const std::string& var, llvm::BasicBlock* block, llvm::Value* value) {
+            current_def_[block][var] = value;
+        }
+
+        llvm::Value* read_variable(const std::string& var, llvm::BasicBlock* block) {
+            auto defs = current_def_.find(block);
+            if (defs != current_def_.end()) {
+                auto found = defs->second.find(var);
+                if (found != defs->second.end()) return found->second;
+            }
+            return read_variable_recursive(var, block);
+        }
+
+        // All predecessors of `block` exist now; completes its pending phis.
+        void seal_block(llvm::BasicBlock* block) {
+            auto pending = incomplete_phis_.find(block);
+            if (pending != incomplete_phis_.end()) {
+                auto phis = std::move(pending->second);
+                incomplete_phis_.erase(pending);
+                for (auto& [var, phi] : phis) add_phi_operands(var, phi);
+            }
+            sealed_.insert(block);
+        }
+
+        bool is_sealed(llvm::BasicBlock* block) const { return sealed_.count(block) != 0; }
+
+    private:
+        llvm::Value* read_variable_recursive(const std::string& var, llvm::BasicBlock* block) {
+            llvm::Type* type = type_of(block->getParent(), var);
+            llvm::Value* value;
+            if (!sealed_.count(block)) {
+                // Incomplete CFG: operands are added once the block is sealed
+                llvm::PHINode* phi = new_phi(type, var, block);
+                incomplete_phis_[block].emplace_back(var, phi);
+                value = phi;
+            } else if (llvm::BasicBlock* pred = block->getSinglePredecessor()) {
+                value = read_variable(var, pred); // no phi needed
+            } else if (llvm::pred_empty(block)) {
+                value = llvm::UndefValue::get(type); // read before any assignment on this path
+            } else {
+                // Break potential cycles with an operandless phi
+                llvm::PHINode* phi = new_phi(type, var, block);
+                write_variable(var, block, phi);
+                value = add_phi_operands(var, phi);
+            }
+            write_variable(var, block, value);
+            return value;
+        }
+
+        llvm::Value* add_phi_operands(const std::string& var, llvm::PHINode* phi) {
+            llvm::BasicBlock* block = phi->getParent();
+            for (llvm::BasicBlock* pred : llvm::predecessors(block))
+                phi->addIncoming(read_variable(var, pred), pred);
+            return try_remove_trivial_phi(phi);
+        }
+
+        llvm::Value* try_remove_trivial_phi(llvm::PHINode* phi) {
+            llvm::Value* same = nullptr;
+            for (llvm::Value* op : phi->incoming_values()) {
+                if (op == same || op == phi) continue; // unique value or self-reference
+                if (same) return phi;                  // merges at least two values: not trivial
+                same = op;
+            }
+            if (!same) same = llvm::UndefValue::get(phi->getType()); // unreachable or in the entry block
+
+            // Weak handles: removing one user may erase another
+            std::vector<llvm::WeakVH> phi_users;
+            for (llvm::User* user : phi->users())
+                if (llvm::isa<llvm::PHINode>(user) && user != phi) phi_users.emplace_back(user);
+
+            phi->replaceAllUsesWith(same);
+            for (auto& [block, defs] : current_def_)
+                for (auto& [name, value] : defs)
+                    if (value == phi) value = same;
+            phi->eraseFromParent();
+
+            // Users may have become trivial in turn
+            for (llvm::WeakVH& handle : phi_users)
+                if (auto* user = llvm::dyn_cast_or_null<llvm::PHINode>(handle))
+                    if (!is_incomplete(user)) try_remove_trivial_phi(user);
+            return same;
+        }
+
+        bool is_incomplete(llvm::PHINode* phi) const {
+            auto pending = incomplete_phis_.find(phi->getParent());
+            if (pending == incomplete_phis_.end()) return false;
+            for (const auto& entry : pending->second)
+                if (entry.second == phi) return true;
+            return false;
+        }
+
+        static llvm::PHINode* new_phi(llvm::Type* type, const std::string& var, llvm::BasicBlock* block) {
+            if (llvm::Instruction* first = block->getFirstNonPHI())
+                return llvm::PHINode::Create(type, 0, var, first);
+            return llvm::PHINode::Create(type, 0, var, block);
+        }
+
+        std::unordered_map<llvm::BasicBlock*, std::unordered_map<std::string, llvm::Value*>> current_def_;
+        std::unordered_map<llvm::BasicBlock*, std::vector<std::pair<std::string, llvm::PHINode*>>> incomplete_phis_;
+        std::unordered_set<llvm::BasicBlock*> sealed_;
+        std::unordered_map<llvm::Function*, std::unordered_map<std::string, llvm::Type*>> types_;
+    };
+
+} // namespace SereIR
+
+#endif // IR_SSABUILDER_HPP
@@ -2,6 +2,7 @@
 #define SEREPARSER_AST_HPP
 
 #include <string>
+#include <cstdint>
 #include <stdexcept>
 #include <utility>
 #include <variant>
@@ -16,6 +17,8 @@
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/LLVMContext.h>
 
+#include "./Midlevel/Environments.hpp"
+
 
 namespace SereParser {
 
@@ -53,14 +56,18 @@ public:
         : value_(std::monostate{}), type_(SereObjectType::NONE),
           symbol_type_(SereSymbolType::NOT_SYMBOLIC), llvm_value_(nullptr), llvm_dirty_(true) {}
 
-    explicit SereObject(int integerValue) noexcept
+    explicit SereObject(int64_t integerValue) noexcept
         : value_(integerValue), type_(SereObjectType::INTEGER),
           symbol_type_(SereSymbolType::NOT_SYMBOLIC), llvm_value_(nullptr), llvm_dirty_(true) {}
 
-    explicit SereObject(float floatValue) noexcept
+    explicit SereObject(int integerValue) noexcept : SereObject(static_cast<int64_t>(integerValue)) {}
+
+    explicit SereObject(double floatValue) noexcept
         : value_(floatValue), type_(SereObjectType::FLOAT),
           symbol_type_(SereSymbolType::NOT_SYMBOLIC), llvm_value_(nullptr), llvm_dirty_(true) {}
 
+    explicit SereObject(float floatValue) noexcept : SereObject(static_cast<double>(floatValue)) {}
+
     explicit SereObject(bool boolValue) noexcept
         : value_(boolValue), type_(SereObjectType::BOOLEAN),
           symbol_type_(SereSymbolType::NOT_SYMBOLIC), llvm_value_(nullptr), llvm_dirty_(true) {}
@@ -77,7 +84,7 @@ public:
     // --- Copy/move/default ---
     SereObject(const SereObject& other)
         : value_(other.value_), type_(other.type_), symbol_type_(other.symbol_type_),
-          symbol_name_(other.symbol_name_), llvm_value_(nullptr), llvm_dirty_(true) {}
+          symbol_name_(other.symbol_name_), llvm_value_(nullptr), llvm_dirty_(true), kind_(other.kind_) {}
 
     SereObject& operator=(const SereObject& other) {
         if (this != &other) {
@@ -87,13 +94,15 @@ public:
             symbol_name_ = other.symbol_name_;
             llvm_value_ = nullptr;
             llvm_dirty_ = true;
+            kind_ = other.kind_;
         }
         return *this;
     }
 
     SereObject(SereObject&& other) noexcept
         : value_(std::move(other.value_)), type_(other.type_), symbol_type_(other.symbol_type_),
-          symbol_name_(std::move(other.symbol_name_)), llvm_value_(other.llvm_value_), llvm_dirty_(other.llvm_dirty_) {
+          symbol_name_(std::move(other.symbol_name_)), llvm_value_(other.llvm_value_), llvm_dirty_(other.llvm_dirty_),
+          kind_(other.kind_) {
         other.llvm_value_ = nullptr;
         other.llvm_dirty_ = true;
     }
@@ -106,6 +115,7 @@ public:
             symbol_name_ = std::move(other.symbol_name_);
             llvm_value_ = other.llvm_value_;
             llvm_dirty_ = other.llvm_dirty_;
+            kind_ = other.kind_;
             other.llvm_value_ = nullptr;
             other.llvm_dirty_ = true;
         }
@@ -139,10 +149,10 @@ public:
 
         switch (type_) {
             case SereObjectType::INTEGER:
-                llvm_value_ = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), getInteger(), true);
+                llvm_value_ = llvm::ConstantInt::get(llvm::Type::getInt64Ty(*context), getInteger(), true);
                 break;
             case SereObjectType::FLOAT:
-                llvm_value_ = llvm::ConstantFP::get(llvm::Type::getFloatTy(*context), getFloat());
+                llvm_value_ = llvm::ConstantFP::get(llvm::Type::getDoubleTy(*context), getFloat());
                 break;
             case SereObjectType::BOOLEAN:
                 llvm_value_ = llvm::ConstantInt::get(llvm::Type::getInt1Ty(*context), getBoolean());
@@ -159,6 +169,16 @@ public:
         return llvm_value_;
     }
     void setLLVMValue(llvm::Value* v) noexcept { llvm_value_ = v; llvm_dirty_ = false; }
+    void setLLVMValue(llvm::Value* v, Runtime::SereTypeKind kind) noexcept { setLLVMValue(v); kind_ = kind; }
+
+    // Sere type of the lowered value (signedness and width that LLVM types
+    // don't carry); UNKNOWN when only the LLVM type says what it is.
+    Runtime::SereTypeKind getKind() const noexcept { return kind_; }
+    // An integer literal is an `int` unless only u64 can hold it (the parser marks those)
+    Runtime::SereTypeKind integerLiteralKind() const noexcept {
+        return kind_ == Runtime::SereTypeKind::U64 ? kind_ : Runtime::SereTypeKind::INT;
+    }
+    void setKind(Runtime::SereTypeKind kind) noexcept { kind_ = kind; }
 
     // --- Operators for Preprocessing & Compilation ---
     void perform_add(const SereObject& other) {
@@ -198,7 +218,7 @@ public:
             if (other.getInteger() < 0)
                 throw std::invalid_argument("Cannot multiply string by negative integer.");
             std::string result;
-            for (int i = 0; i < other.getInteger(); ++i) result += getString();
+            for (int64_t i = 0; i < other.getInteger(); ++i) result += getString();
             setValue(std::move(result));
         } else if (type_ == SereObjectType::FLOAT && other.type_ == SereObjectType::FLOAT) {
             setValue(getFloat() * other.getFloat());
@@ -247,15 +267,15 @@ public:
     }
 
     // --- Value Accessors ---
-    int getInteger() const {
+    int64_t getInteger() const {
         if (type_ != SereObjectType::INTEGER)
             throw std::logic_error("Not an integer type.");
-        return std::get<int>(value_);
+        return std::get<int64_t>(value_);
     }
-    float getFloat() const {
+    double getFloat() const {
         if (type_ != SereObjectType::FLOAT)
             throw std::logic_error("Not a float type.");
-        return std::get<float>(value_);
+        return std::get<double>(value_);
     }
     const std::string& getString() const {
         if (type_ != SereObjectType::STRING)
@@ -269,8 +289,10 @@ public:
     }
 
     // --- Value Setters (internal/private use) ---
-    void setValue(int v)    { value_ = v; type_ = SereObjectType::INTEGER; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
-    void setValue(float v)  { value_ = v; type_ = SereObjectType::FLOAT; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
+    void setValue(int64_t v) { value_ = v; type_ = SereObjectType::INTEGER; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
+    void setValue(int v)    { setValue(static_cast<int64_t>(v)); }
+    void setValue(double v) { value_ = v; type_ = SereObjectType::FLOAT; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
+    void setValue(float v)  { setValue(static_cast<double>(v)); }
     void setValue(bool v)   { value_ = v; type_ = SereObjectType::BOOLEAN; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
     void setValue(const std::string& v) { value_ = v; type_ = SereObjectType::STRING; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
     void setValue(std::string&& v) { value_ = std::move(v); type_ = SereObjectType::STRING; symbol_type_ = SereSymbolType::NOT_SYMBOLIC; markLLVMDirty(); }
@@ -307,8 +329,8 @@ public:
     // Returns a string suitable for IR representation (e.g. for symbol tables, SSA, etc)
     virtual std::string toIRString() const {
         switch (type_) {
-            case SereObjectType::INTEGER: return "i32 " + std::to_string(getInteger());
-            case SereObjectType::FLOAT:   return "f32 " + std::to_string(getFloat());
+            case SereObjectType::INTEGER: return "i64 " + std::to_string(getInteger());
+            case SereObjectType::FLOAT:   return "f64 " + std::to_string(getFloat());
             case SereObjectType::STRING:  return "str \"" + getString() + "\"";
             case SereObjectType::BOOLEAN: return std::string("bool ") + (getBoolean() ? "true" : "false");
             case SereObjectType::SYMBOLIC: return "<sym:" + symbol_name_ + ">";
@@ -319,12 +341,13 @@ public:
 protected:
     void markLLVMDirty() noexcept { llvm_dirty_ = true; }
 
-    std::variant<std::monostate, int, float, std::string, bool> value_;
+    std::variant<std::monostate, int64_t, double, std::string, bool> value_;
     SereObjectType type_;
     SereSymbolType symbol_type_;
     std::string symbol_name_; // Only set for SYMBOLIC types
     llvm::Value* llvm_value_ = nullptr; // LLVM IR value for this object, if any
     bool llvm_dirty_ = true; // True if llvm_value_ needs to be regenerated
+    Runtime::SereTypeKind kind_ = Runtime::SereTypeKind::UNKNOWN;
 };
 
 // === Symbolic SereObject Subclasses for IR Conversion ===
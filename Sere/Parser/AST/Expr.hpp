@@ -104,6 +104,19 @@ namespace SereParser {
         }
     };
 
+    // f"...{expr}...": str literals and the expressions between them, written one after another
+    class FormatExprAST : public ExprAST {
+    public:
+        const std::vector<std::shared_ptr<ExprAST>> parts;
+
+        explicit FormatExprAST(std::vector<std::shared_ptr<ExprAST>> parts)
+            : parts(std::move(parts)) {}
+
+        SereObject accept(ExprVisitor<SereObject>& visitor) const override {
+            return visitor.visit_format(*this);
+        }
+    };
+
     class GroupExprAST : public ExprAST {
     public:
         const std::shared_ptr<ExprAST> expr;
@@ -0,0 +1,387 @@
+#ifndef MIDLEVEL_CONSTVALUE_HPP
+#define MIDLEVEL_CONSTVALUE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "./Environments.hpp"
+#include "../../../Scanner/TokenType.hpp"
+
+namespace SereParser {
+
+    //
+    // A value known at compile time, with the arithmetic lowering emits for
+    // it (IR/Arith.hpp): ints wrap at their width, `/` truncates, `//` and
+    // `%` floor, floats are IEEE at their own precision (an f32 result is
+    // rounded to f32). What would trap or is rejected when lowered (division
+    // by zero, i64 min / -1, int ** negative int) gives nothing, and the
+    // expression is left to lowering.
+    //
+    struct ConstValue {
+        Runtime::SereTypeKind kind = Runtime::SereTypeKind::NONE;
+        uint64_t bits = 0; // ints and bools, zero-extended from the type's width
+        double real = 0;   // floats; an f32 holds a value f32 represents
+        std::string text;  // str
+
+        static ConstValue of_int(Runtime::SereTypeKind kind, uint64_t bits) {
+            ConstValue value;
+            value.kind = kind;
+            unsigned width = Runtime::type_info(kind).bits;
+            value.bits = width < 64 ? bits & ((uint64_t(1) << width) - 1) : bits;
+            return value;
+        }
+
+        static ConstValue of_float(Runtime::SereTypeKind kind, double real) {
+            ConstValue value;
+            value.kind = kind;
+            value.real = Runtime::type_info(kind).bits == 32 ? static_cast<double>(static_cast<float>(real)) : real;
+            return value;
+        }
+
+        static ConstValue of_bool(bool truth) {
+            ConstValue value;
+            value.kind = Runtime::SereTypeKind::BOOL;
+            value.bits = truth;
+            return value;
+        }
+
+        static ConstValue of_str(std::string text) {
+            ConstValue value;
+            value.kind = Runtime::SereTypeKind::STRING;
+            value.text = std::move(text);
+            return value;
+        }
+
+        // The int's value, sign-extended when its type is signed
+        int64_t as_signed() const {
+            unsigned width = Runtime::type_info(kind).bits;
+            if (width >= 64 || !Runtime::is_signed(kind)) return static_cast<int64_t>(bits);
+            uint64_t sign = uint64_t(1) << (width - 1);
+            return static_cast<int64_t>((bits ^ sign) - sign);
+        }
+
+        // As a condition (CodeGenContext::truth_value): NaN is true
+        bool truth() const {
+            if (kind == Runtime::SereTypeKind::STRING) return !text.empty();
+            if (Runtime::is_float(kind)) return real != 0.0;
+            return bits != 0;
+        }
+
+        // Tells values (with their types) apart in memo tables
+        std::string key() const {
+            std::string prefix = Runtime::to_string(kind) + ":";
+            if (kind == Runtime::SereTypeKind::STRING) return prefix + std::to_string(text.size()) + ":" + text;
+            uint64_t raw = bits;
+            if (Runtime::is_float(kind)) std::memcpy(&raw, &real, sizeof raw);
+            return prefix + std::to_string(raw);
+        }
+    };
+
+    namespace detail {
+
+        inline bool is_f32(Runtime::SereTypeKind kind) { return kind == Runtime::SereTypeKind::F32; }
+
+        // compiler-rt's __powidf2, which llvm.powi expands to
+        inline double powi(double base, int32_t exp, bool single) {
+            double result = 1;
+            float result_f = 1, base_f = static_cast<float>(base);
+            for (int64_t n = exp;;) {
+                if (n & 1) {
+                    result *= base;
+                    result_f *= base_f;
+                }
+                n /= 2;
+                if (n == 0) break;
+                base *= base;
+                base_f *= base_f;
+            }
+            if (single) return exp < 0 ? 1 / result_f : result_f;
+            return exp < 0 ? 1 / result : result;
+        }
+
+        // SereIR::power on floats: integral exponents use powi
+        inline double float_power(double base, double exp, bool exp_integral, bool single) {
+            if (exp_integral && exp >= INT32_MIN && exp <= INT32_MAX)
+                return powi(base, static_cast<int32_t>(exp), single);
+            return single ? std::pow(static_cast<float>(base), static_cast<float>(exp)) : std::pow(base, exp);
+        }
+
+        // SereIR::float_floor_divmod: Python's float_divmod, {a // b, a % b}
+        template <typename F>
+        std::pair<F, F> float_floor_divmod(F a, F b) {
+            F mod = std::fmod(a, b);
+            F div = (a - mod) / b;
+            if (mod != 0) {
+                if ((mod < 0) != (b < 0)) {
+                    mod += b;
+                    div -= 1;
+                }
+            } else {
+                mod = std::copysign(F(0), b);
+            }
+            if (div == 0) return {std::copysign(F(0), a / b), mod};
+            F floordiv = std::floor(div);
+            if (div - floordiv > F(0.5)) floordiv += 1;
+            return {floordiv, mod};
+        }
+
+        inline bool compare(SereLexer::TokenType op, int order) {
+            using SereLexer::TokenType;
+            switch (op) {
+            case TokenType::TOKEN_LESS: return order < 0;
+            case TokenType::TOKEN_LESS_EQUAL: return order <= 0;
+            case TokenType::TOKEN_GREATER: return order > 0;
+            case TokenType::TOKEN_GREATER_EQUAL: return order >= 0;
+            case TokenType::TOKEN_EQUAL_EQUAL: return order == 0;
+            default: return order != 0;
+            }
+        }
+
+    } // namespace detail
+
+    inline bool is_comparison_op(SereLexer::TokenType op) {
+        using SereLexer::TokenType;
+        return op == TokenType::TOKEN_LESS || op == TokenType::TOKEN_LESS_EQUAL || op == TokenType::TOKEN_GREATER ||
+               op == TokenType::TOKEN_GREATER_EQUAL || op == TokenType::TOKEN_EQUAL_EQUAL || op == TokenType::TOKEN_BANG_EQUAL;
+    }
+
+    // Whether a literal `value` holds in `to` (the literal case of converts_implicitly).
+    inline bool const_fits(const ConstValue &value, Runtime::SereTypeKind to) {
+        const Runtime::TypeInfo &info = Runtime::type_info(to);
+        if (!info.bits) return false;
+        if (Runtime::is_float(value.kind)) return info.is_float;
+        if (!Runtime::is_integer(value.kind)) return false;
+        int64_t v = value.as_signed();
+        bool negative = Runtime::is_signed(value.kind) && v < 0; // a u64 literal above 2**63-1 is not
+        uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+        if (info.is_float) {
+            unsigned mantissa = info.bits == 32 ? 24 : 53;
+            return magnitude < (uint64_t(1) << mantissa);
+        }
+        if (info.is_signed) {
+            if (!negative && magnitude > static_cast<uint64_t>(INT64_MAX)) return false;
+            return info.bits == 64 || (v >= -(int64_t(1) << (info.bits - 1)) && v < (int64_t(1) << (info.bits - 1)));
+        }
+        return !negative && (info.bits == 64 || magnitude < (uint64_t(1) << info.bits));
+    }
+
+    // `value` as a `to`, as convert_value does it; nothing for str and `dyn`.
+    inline std::optional<ConstValue> const_convert(const ConstValue &value, Runtime::SereTypeKind to) {
+        using Runtime::SereTypeKind;
+        if (value.kind == to) return value;
+        if (to == SereTypeKind::BOOL && (Runtime::is_numeric(value.kind) || value.kind == SereTypeKind::STRING))
+            return ConstValue::of_bool(value.truth());
+        const Runtime::TypeInfo &target = Runtime::type_info(to);
+        if (!target.bits) return std::nullopt;
+        if (value.kind == SereTypeKind::BOOL)
+            return target.is_float ? ConstValue::of_float(to, static_cast<double>(value.bits)) : ConstValue::of_int(to, value.bits);
+        if (!Runtime::is_numeric(value.kind)) return std::nullopt;
+
+        if (Runtime::is_float(value.kind)) {
+            if (target.is_float) return ConstValue::of_float(to, value.real);
+            // fptosi.sat / fptoui.sat: truncate, saturate at the bounds, NaN is 0
+            double real = std::trunc(value.real);
+            if (std::isnan(real)) return ConstValue::of_int(to, 0);
+            if (target.is_signed) {
+                double low = -std::ldexp(1.0, target.bits - 1), high = std::ldexp(1.0, target.bits - 1);
+                if (real <= low) return ConstValue::of_int(to, static_cast<uint64_t>(INT64_MIN >> (64 - target.bits)));
+                if (real >= high) return ConstValue::of_int(to, (uint64_t(1) << (target.bits - 1)) - 1);
+                return ConstValue::of_int(to, static_cast<uint64_t>(static_cast<int64_t>(real)));
+            }
+            double high = std::ldexp(1.0, target.bits);
+            if (real <= 0) return ConstValue::of_int(to, 0);
+            if (real >= high) return ConstValue::of_int(to, ~uint64_t(0));
+            return ConstValue::of_int(to, static_cast<uint64_t>(real));
+        }
+
+        const bool source_signed = Runtime::is_signed(value.kind);
+        if (target.is_float) {
+            // Rounded once, straight to the target precision
+            if (target.bits == 32)
+                return ConstValue::of_float(to, source_signed ? static_cast<float>(value.as_signed()) : static_cast<float>(value.bits));
+            return ConstValue::of_float(to, source_signed ? static_cast<double>(value.as_signed()) : static_cast<double>(value.bits));
+        }
+        return ConstValue::of_int(to, source_signed ? static_cast<uint64_t>(value.as_signed()) : value.bits);
+    }
+
+    // -value; ints wrap.
+    inline std::optional<ConstValue> const_negate(const ConstValue &value) {
+        if (Runtime::is_float(value.kind)) return ConstValue::of_float(value.kind, -value.real);
+        if (Runtime::is_integer(value.kind)) return ConstValue::of_int(value.kind, 0 - value.bits);
+        return std::nullopt;
+    }
+
+    //
+    // `a op b` for operands already converted to their common type, or a
+    // float raised to an int power. Comparisons give bools; NaN compares
+    // unequal to everything. Lowering raises floats with powi only when the
+    // exponent is a constant there (`literal_exponent`), else with pow.
+    //
+    inline std::optional<ConstValue> const_binary(SereLexer::TokenType op, const ConstValue &a, const ConstValue &b,
+                                                  bool literal_exponent = true) {
+        using SereLexer::TokenType;
+        const Runtime::SereTypeKind kind = a.kind;
+
+        if (Runtime::is_float(kind) && Runtime::is_integer(b.kind)) {
+            if (op != TokenType::TOKEN_DOUBLE_STAR) return std::nullopt;
+            bool integral = literal_exponent && (Runtime::is_signed(b.kind) || b.bits < (uint64_t(1) << 63));
+            double exp = Runtime::is_signed(b.kind) ? static_cast<double>(b.as_signed()) : static_cast<double>(b.bits);
+            return ConstValue::of_float(kind, detail::float_power(a.real, exp, integral, detail::is_f32(kind)));
+        }
+        if (a.kind != b.kind) return std::nullopt;
+
+        if (Runtime::is_float(kind)) {
+            const bool single = detail::is_f32(kind);
+            double x = a.real, y = b.real;
+            if (is_comparison_op(op)) {
+                if (std::isnan(x) || std::isnan(y)) return ConstValue::of_bool(op == TokenType::TOKEN_BANG_EQUAL);
+                return ConstValue::of_bool(detail::compare(op, x < y ? -1 : x > y ? 1 : 0));
+            }
+            switch (op) {
+            case TokenType::TOKEN_PLUS: return ConstValue::of_float(kind, single ? double(float(x) + float(y)) : x + y);
+            case TokenType::TOKEN_MINUS: return ConstValue::of_float(kind, single ? double(float(x) - float(y)) : x - y);
+            case TokenType::TOKEN_STAR: return ConstValue::of_float(kind, single ? double(float(x) * float(y)) : x * y);
+            case TokenType::TOKEN_SLASH: return ConstValue::of_float(kind, single ? double(float(x) / float(y)) : x / y);
+            case TokenType::TOKEN_DOUBLE_SLASH:
+            case TokenType::TOKEN_PERCENT: {
+                std::pair<double, double> result = single ? std::pair<double, double>(detail::float_floor_divmod<float>(float(x), float(y)))
+                                                          : detail::float_floor_divmod<double>(x, y);
+                return ConstValue::of_float(kind, op == TokenType::TOKEN_DOUBLE_SLASH ? result.first : result.second);
+            }
+            case TokenType::TOKEN_DOUBLE_STAR: {
+                bool integral = literal_exponent && std::trunc(y) == y && std::abs(y) < (1 << 16);
+                return ConstValue::of_float(kind, detail::float_power(x, y, integral, single));
+            }
+            default: return std::nullopt;
+            }
+        }
+
+        if (kind == Runtime::SereTypeKind::BOOL) {
+            if (!is_comparison_op(op)) return std::nullopt;
+            return ConstValue::of_bool(detail::compare(op, a.bits < b.bits ? -1 : a.bits > b.bits ? 1 : 0));
+        }
+        if (!Runtime::is_integer(kind)) return std::nullopt;
+
+        const bool is_signed = Runtime::is_signed(kind);
+        const int64_t x = a.as_signed(), y = b.as_signed();
+        const int64_t type_min = Runtime::type_info(kind).bits == 64 ? INT64_MIN : -(int64_t(1) << (Runtime::type_info(kind).bits - 1));
+        if (is_comparison_op(op)) {
+            int order = is_signed ? (x < y ? -1 : x > y) : (a.bits < b.bits ? -1 : a.bits > b.bits);
+            return ConstValue::of_bool(detail::compare(op, order));
+        }
+        switch (op) {
+        case TokenType::TOKEN_PLUS: return ConstValue::of_int(kind, a.bits + b.bits);
+        case TokenType::TOKEN_MINUS: return ConstValue::of_int(kind, a.bits - b.bits);
+        case TokenType::TOKEN_STAR: return ConstValue::of_int(kind, a.bits * b.bits);
+        case TokenType::TOKEN_SLASH:
+        case TokenType::TOKEN_DOUBLE_SLASH:
+        case TokenType::TOKEN_PERCENT: {
+            if (b.bits == 0) return std::nullopt;
+            if (!is_signed) {
+                uint64_t r = op == TokenType::TOKEN_PERCENT ? a.bits % b.bits : a.bits / b.bits;
+                return ConstValue::of_int(kind, r);
+            }
+            if (x == type_min && y == -1) return std::nullopt; // overflows; a hardware trap when lowered
+            int64_t quotient = x / y, remainder = x % y;
+            bool adjust = remainder != 0 && ((remainder < 0) != (y < 0));
+            if (op == TokenType::TOKEN_SLASH) return ConstValue::of_int(kind, static_cast<uint64_t>(quotient));
+            if (op == TokenType::TOKEN_DOUBLE_SLASH) return ConstValue::of_int(kind, static_cast<uint64_t>(quotient - adjust));
+            return ConstValue::of_int(kind, static_cast<uint64_t>(adjust ? remainder + y : remainder));
+        }
+        case TokenType::TOKEN_DOUBLE_STAR: {
+            if (is_signed && y < 0) return std::nullopt;
+            uint64_t result = 1, square = a.bits;
+            for (uint64_t n = b.bits; n; n >>= 1) {
+                if (n & 1) result *= square;
+                square *= square;
+            }
+            return ConstValue::of_int(kind, result);
+        }
+        default: return std::nullopt;
+        }
+    }
+
+    //
+    // Whether integer `a op b` (`+`, `-`, `*`, `**`) leaves the type rather
+    // than wrapping: what --checked-arith traps on (SereIR::checked_arith,
+    // SereIR::power). Operands of one type; anything else never overflows.
+    //
+    inline bool const_overflows(SereLexer::TokenType op, const ConstValue &a, const ConstValue &b) {
+        using SereLexer::TokenType;
+        if (!Runtime::is_integer(a.kind) || a.kind != b.kind) return false;
+        if (op == TokenType::TOKEN_DOUBLE_STAR) {
+            if (Runtime::is_signed(b.kind) && b.as_signed() < 0) return false; // an error of its own
+            // Square-and-multiply as SereIR::power does it, squaring only while exponent bits remain
+            ConstValue result = ConstValue::of_int(a.kind, 1), square = a;
+            for (uint64_t n = b.bits; n; n >>= 1) {
+                if (n & 1) {
+                    if (const_overflows(TokenType::TOKEN_STAR, result, square)) return true;
+                    result = *const_binary(TokenType::TOKEN_STAR, result, square);
+                }
+                if (n >> 1) {
+                    if (const_overflows(TokenType::TOKEN_STAR, square, square)) return true;
+                    square = *const_binary(TokenType::TOKEN_STAR, square, square);
+                }
+            }
+            return false;
+        }
+        if (op != TokenType::TOKEN_PLUS && op != TokenType::TOKEN_MINUS && op != TokenType::TOKEN_STAR) return false;
+        const unsigned width = Runtime::type_info(a.kind).bits;
+        if (Runtime::is_signed(a.kind)) {
+            int64_t x = a.as_signed(), y = b.as_signed(), r = 0;
+            bool wrapped = op == TokenType::TOKEN_PLUS    ? __builtin_add_overflow(x, y, &r)
+                           : op == TokenType::TOKEN_MINUS ? __builtin_sub_overflow(x, y, &r)
+                                                          : __builtin_mul_overflow(x, y, &r);
+            return wrapped || (width < 64 && (r < -(int64_t(1) << (width - 1)) || r >= (int64_t(1) << (width - 1))));
+        }
+        uint64_t r = 0;
+        bool wrapped = op == TokenType::TOKEN_PLUS    ? __builtin_add_overflow(a.bits, b.bits, &r)
+                       : op == TokenType::TOKEN_MINUS ? __builtin_sub_overflow(a.bits, b.bits, &r)
+                                                      : __builtin_mul_overflow(a.bits, b.bits, &r);
+        return wrapped || (width < 64 && (r >> width) != 0);
+    }
+
+    // -value as 0 - value: the minimum of a signed type, any nonzero unsigned value
+    inline bool const_negate_overflows(const ConstValue &value) {
+        return const_overflows(SereLexer::TokenType::TOKEN_MINUS, ConstValue::of_int(value.kind, 0), value);
+    }
+
+    //
+    // A float as print writes it: the shortest of %.15g, %.16g and %.17g
+    // (%.6g to %.9g for an f32) that reads back as the same value, with
+    // ".0" after an integral one, as Python prints it. The run-time
+    // formatter (IR/Format.hpp) makes the same calls.
+    //
+    inline std::string format_real(double real, bool single) {
+        if (std::isnan(real)) return "nan";
+        char text[32];
+        for (int digits = single ? 6 : 15;; ++digits) {
+            std::snprintf(text, sizeof text, "%.*g", digits, real);
+            double back = std::strtod(text, nullptr);
+            bool same = single ? static_cast<float>(back) == static_cast<float>(real) : back == real;
+            if (same || digits == (single ? 9 : 17)) break;
+        }
+        std::string formatted = text;
+        if (formatted.find_first_not_of("-0123456789") == std::string::npos) formatted += ".0";
+        return formatted;
+    }
+
+    // The text print writes for `value`
+    inline std::string const_format(const ConstValue &value) {
+        using Runtime::SereTypeKind;
+        if (value.kind == SereTypeKind::STRING) return value.text;
+        if (value.kind == SereTypeKind::BOOL) return value.bits ? "True" : "False";
+        if (value.kind == SereTypeKind::NONE) return "None";
+        if (Runtime::is_float(value.kind)) return format_real(value.real, detail::is_f32(value.kind));
+        return Runtime::is_signed(value.kind) ? std::to_string(value.as_signed()) : std::to_string(value.bits);
+    }
+
+} // namespace SereParser
+
+#endif // MIDLEVEL_CONSTVALUE_HPP
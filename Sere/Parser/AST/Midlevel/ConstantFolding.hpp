@@ -0,0 +1,253 @@
+#ifndef MIDLEVEL_CONSTANTFOLDING_HPP
+#define MIDLEVEL_CONSTANTFOLDING_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../Expr.hpp"
+#include "../Stat.hpp"
+#include "./ConstValue.hpp"
+
+namespace SereParser {
+
+    //
+    // Folds constant subexpressions of the AST before anything else sees
+    // it (lowering, hashing for the object cache): arithmetic and
+    // comparisons of literals by the rules lowering applies to them (see
+    // ExprVisitor::visit_binary, ConstValue), `not`, unary minus, `and`/`or`
+    // with a literal left side, concatenation of str literals, and the
+    // literal parts of an f-string, formatted as print writes them (an
+    // f-string of nothing else is a str literal).
+    //
+    // A folded number is a literal again and adapts like one: in
+    // `x + (60 * 60)` with a u16 `x` the 3600 is a u16, and `b: u8 = 200 + 100`
+    // is rejected as a literal that does not fit. Whatever would fail or
+    // trap when lowered is left alone, so lowering still reports it; with
+    // `checked_arith` that includes integer arithmetic that overflows.
+    //
+    class ConstantFolder {
+    public:
+        explicit ConstantFolder(bool checked_arith = false) : checked_arith_(checked_arith) {}
+
+        std::vector<std::shared_ptr<StatAST>> fold(const std::vector<std::shared_ptr<StatAST>>& stats) {
+            std::vector<std::shared_ptr<StatAST>> folded;
+            folded.reserve(stats.size());
+            for (const auto& s : stats) folded.push_back(stat(s));
+            return folded;
+        }
+
+        // The node itself when nothing in it folds
+        std::shared_ptr<StatAST> stat(const std::shared_ptr<StatAST>& node) {
+            if (!node) return node;
+
+            if (auto fn = std::dynamic_pointer_cast<FunctionStatAST>(node)) {
+                auto body = stat(fn->body);
+                if (body == fn->body) return node;
+                return std::make_shared<FunctionStatAST>(fn->name, fn->params, body, fn->type_annotation, fn->decorators);
+            } else if (auto block = std::dynamic_pointer_cast<BlockStatAST>(node)) {
+                bool changed = false;
+                std::vector<std::shared_ptr<StatAST>> statements;
+                for (const auto& s : block->statements) {
+                    statements.push_back(stat(s));
+                    changed |= statements.back() != s;
+                }
+                return changed ? std::make_shared<BlockStatAST>(std::move(statements)) : node;
+            } else if (auto ret = std::dynamic_pointer_cast<ReturnStatAST>(node)) {
+                auto value = expr(ret->value);
+                return value == ret->value ? node : std::make_shared<ReturnStatAST>(value);
+            } else if (auto assign = std::dynamic_pointer_cast<AssignStatAST>(node)) {
+                auto initializer = expr(assign->initializer);
+                if (initializer == assign->initializer) return node;
+                return std::make_shared<AssignStatAST>(assign->name, initializer, assign->type_annotation);
+            } else if (auto if_stat = std::dynamic_pointer_cast<IfStatAST>(node)) {
+                auto condition = expr(if_stat->condition);
+                auto then_branch = stat(if_stat->then_branch);
+                auto else_branch = stat(if_stat->else_branch);
+                if (condition == if_stat->condition && then_branch == if_stat->then_branch && else_branch == if_stat->else_branch)
+                    return node;
+                return std::make_shared<IfStatAST>(condition, then_branch, else_branch);
+            } else if (auto while_stat = std::dynamic_pointer_cast<WhileStatAST>(node)) {
+                auto condition = expr(while_stat->condition);
+                auto body = stat(while_stat->body);
+                if (condition == while_stat->condition && body == while_stat->body) return node;
+                return std::make_shared<WhileStatAST>(condition, body);
+            } else if (auto for_stat = std::dynamic_pointer_cast<ForStatAST>(node)) {
+                auto start = expr(for_stat->start);
+                auto stop = expr(for_stat->stop);
+                auto step = expr(for_stat->step);
+                auto body = stat(for_stat->body);
+                if (start == for_stat->start && stop == for_stat->stop && step == for_stat->step && body == for_stat->body)
+                    return node;
+                return std::make_shared<ForStatAST>(for_stat->var, start, stop, step, body);
+            } else if (auto expr_stat = std::dynamic_pointer_cast<ExprStatAST>(node)) {
+                auto value = expr(expr_stat->expr);
+                return value == expr_stat->expr ? node : std::make_shared<ExprStatAST>(value);
+            }
+            return node; // imports, classes
+        }
+
+        std::shared_ptr<ExprAST> expr(const std::shared_ptr<ExprAST>& node) {
+            if (!node) return node;
+
+            if (auto bin = std::dynamic_pointer_cast<BinaryExprAST>(node)) {
+                auto left = expr(bin->left);
+                auto right = expr(bin->right);
+                if (auto folded = binary(bin->op.type, *left, *right)) return folded;
+                if (left == bin->left && right == bin->right) return node;
+                return std::make_shared<BinaryExprAST>(bin->op, left, right);
+            } else if (auto logical = std::dynamic_pointer_cast<LogicalExprAST>(node)) {
+                auto left = expr(logical->left);
+                auto right = expr(logical->right);
+                // As lowering decides it: the left value, or the right expression as it is
+                auto known = value_of(*left);
+                if (known && known->kind != Runtime::SereTypeKind::STRING) {
+                    const bool is_and = logical->op.type == SereLexer::TokenType::TOKEN_AND;
+                    return known->truth() != is_and ? left : right;
+                }
+                if (left == logical->left && right == logical->right) return node;
+                return std::make_shared<LogicalExprAST>(logical->op, left, right);
+            } else if (auto unary = std::dynamic_pointer_cast<UnaryExprAST>(node)) {
+                auto operand = expr(unary->operand);
+                if (auto value = value_of(*operand)) {
+                    switch (unary->op.type) {
+                    case SereLexer::TokenType::TOKEN_MINUS:
+                        if (value->kind == Runtime::SereTypeKind::U64) { // a literal above 2**63-1: only -2**63 has a type
+                            if (value->bits != uint64_t(1) << 63)
+                                throw std::runtime_error("Integer literal -" + std::to_string(value->bits) + " does not fit in int.");
+                            return literal(ConstValue::of_int(Runtime::SereTypeKind::INT, value->bits));
+                        }
+                        if (Runtime::is_numeric(value->kind) && !(checked_arith_ && const_negate_overflows(*value)))
+                            return literal(*const_negate(*value));
+                        break;
+                    case SereLexer::TokenType::TOKEN_PLUS:
+                        if (Runtime::is_numeric(value->kind)) return operand;
+                        break;
+                    case SereLexer::TokenType::TOKEN_BANG:
+                    case SereLexer::TokenType::TOKEN_NOT:
+                        return literal(ConstValue::of_bool(!value->truth()));
+                    default:
+                        break;
+                    }
+                }
+                return operand == unary->operand ? node : std::make_shared<UnaryExprAST>(unary->op, operand);
+            } else if (auto group = std::dynamic_pointer_cast<GroupExprAST>(node)) {
+                auto inner = expr(group->expr);
+                if (value_of(*inner)) return inner;
+                return inner == group->expr ? node : std::make_shared<GroupExprAST>(inner);
+            } else if (auto call = std::dynamic_pointer_cast<CallExprAST>(node)) {
+                bool changed = false;
+                std::vector<std::shared_ptr<ExprAST>> arguments;
+                for (const auto& argument : call->arguments) {
+                    arguments.push_back(expr(argument));
+                    changed |= arguments.back() != argument;
+                }
+                if (!changed) return node;
+                SereLexer::TokenBase callee = call->callee;
+                return std::make_shared<CallExprAST>(callee, std::move(arguments));
+            } else if (auto format = std::dynamic_pointer_cast<FormatExprAST>(node)) {
+                bool changed = false;
+                std::vector<std::shared_ptr<ExprAST>> parts;
+                std::optional<std::string> text; // of the literals since the last other part
+                auto end_text = [&]() {
+                    if (text) parts.push_back(literal(ConstValue::of_str(*text)));
+                    text.reset();
+                };
+                for (const auto& part : format->parts) {
+                    auto folded = expr(part);
+                    auto value = value_of(*folded);
+                    if (!value) {
+                        end_text();
+                        changed |= folded != part;
+                        parts.push_back(folded);
+                        continue;
+                    }
+                    changed |= text.has_value() || value->kind != Runtime::SereTypeKind::STRING;
+                    text = text.value_or("") + const_format(*value);
+                }
+                end_text();
+                if (parts.empty()) return literal(ConstValue::of_str(""));
+                if (parts.size() == 1 && value_of(*parts[0])) return parts[0];
+                return changed ? std::make_shared<FormatExprAST>(std::move(parts)) : node;
+            }
+            return node;
+        }
+
+    private:
+        // The value of a literal; ints and floats are the untyped `int` (or u64, above 2**63-1) and `float`
+        static std::optional<ConstValue> value_of(const ExprAST& node) {
+            auto lit = dynamic_cast<const LiteralExprAST*>(&node);
+            if (!lit) return std::nullopt;
+            switch (lit->value.getType()) {
+            case SereObjectType::INTEGER:
+                return ConstValue::of_int(lit->value.integerLiteralKind(), static_cast<uint64_t>(lit->value.getInteger()));
+            case SereObjectType::FLOAT:
+                return ConstValue::of_float(Runtime::SereTypeKind::FLOAT, lit->value.getFloat());
+            case SereObjectType::BOOLEAN:
+                return ConstValue::of_bool(lit->value.getBoolean());
+            case SereObjectType::STRING:
+                return ConstValue::of_str(lit->value.getString());
+            default:
+                return std::nullopt;
+            }
+        }
+
+        static std::shared_ptr<ExprAST> literal(const ConstValue& value) {
+            switch (value.kind) {
+            case Runtime::SereTypeKind::INT: return std::make_shared<LiteralExprAST>(SereObject(value.as_signed()));
+            case Runtime::SereTypeKind::U64: {
+                if (value.bits <= static_cast<uint64_t>(INT64_MAX)) // an int literal again
+                    return std::make_shared<LiteralExprAST>(SereObject(value.as_signed()));
+                SereObject object(value.as_signed());
+                object.setKind(Runtime::SereTypeKind::U64);
+                return std::make_shared<LiteralExprAST>(object);
+            }
+            case Runtime::SereTypeKind::FLOAT: return std::make_shared<LiteralExprAST>(SereObject(value.real));
+            case Runtime::SereTypeKind::BOOL: return std::make_shared<LiteralExprAST>(SereObject(value.bits != 0));
+            case Runtime::SereTypeKind::STRING: return std::make_shared<LiteralExprAST>(SereObject(value.text));
+            default: return nullptr;
+            }
+        }
+
+        // Literal `left op right` as one literal, or null
+        std::shared_ptr<ExprAST> binary(SereLexer::TokenType op, const ExprAST& left, const ExprAST& right) const {
+            using Runtime::SereTypeKind;
+            auto a = value_of(left), b = value_of(right);
+            if (!a || !b) return nullptr;
+            if (a->kind == SereTypeKind::STRING || b->kind == SereTypeKind::STRING) {
+                if (op != SereLexer::TokenType::TOKEN_PLUS || a->kind != b->kind) return nullptr;
+                return literal(ConstValue::of_str(a->text + b->text));
+            }
+
+            // An int meets a u64 literal as a u64 when it fits one, as in lowering
+            if (a->kind != b->kind && Runtime::is_integer(a->kind) && Runtime::is_integer(b->kind)) {
+                auto& narrow = a->kind == SereTypeKind::U64 ? b : a;
+                if (!const_fits(*narrow, SereTypeKind::U64)) return nullptr;
+                narrow = ConstValue::of_int(SereTypeKind::U64, narrow->bits);
+            }
+
+            // An int and a float meet as floats when the int fits one; a float ** int stays so
+            std::optional<ConstValue> result;
+            if (a->kind != b->kind && op == SereLexer::TokenType::TOKEN_DOUBLE_STAR && a->kind == SereTypeKind::FLOAT)
+                result = const_binary(op, *a, *b);
+            else if (a->kind != b->kind) {
+                if (a->kind == SereTypeKind::BOOL || b->kind == SereTypeKind::BOOL) return nullptr;
+                auto x = const_convert(*a, SereTypeKind::FLOAT), y = const_convert(*b, SereTypeKind::FLOAT);
+                if (x && y) result = const_binary(op, *x, *y);
+            } else if (!(checked_arith_ && const_overflows(op, *a, *b)))
+                result = const_binary(op, *a, *b);
+            return result ? literal(*result) : nullptr;
+        }
+
+        bool checked_arith_;
+    };
+
+    inline std::vector<std::shared_ptr<StatAST>> fold_constants(const std::vector<std::shared_ptr<StatAST>>& stats,
+                                                                bool checked_arith = false) {
+        return ConstantFolder(checked_arith).fold(stats);
+    }
+
+} // namespace SereParser
+
+#endif // MIDLEVEL_CONSTANTFOLDING_HPP
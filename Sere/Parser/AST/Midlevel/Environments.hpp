@@ -10,27 +10,83 @@
 
 namespace Runtime {
 
-    // TypeKind for semantic/type checking
+    // TypeKind for semantic/type checking. `int` is i64 and `float` is f64;
+    // `dyn` holds a value whose type is only known at run time (IR/Dynamic.hpp).
     enum class SereTypeKind {
-        INT,
-        FLOAT,
+        I8, I16, I32, INT,
+        U8, U16, U32, U64,
+        F32, FLOAT,
         STRING,
         BOOL,
         NONE,
+        DYNAMIC,
         UNKNOWN
     };
 
+    //
+    // The type table: every kind's name, width and signedness, in enum
+    // order. Names are what annotations and module interfaces spell;
+    // "i64", "f64" and "string" are accepted as aliases.
+    //
+    struct TypeInfo {
+        SereTypeKind kind;
+        const char *name;
+        unsigned bits;   // 0 for non-numeric kinds
+        bool is_signed;
+        bool is_float;
+    };
+
+    inline constexpr TypeInfo TYPE_TABLE[] = {
+        {SereTypeKind::I8,      "i8",      8,  true,  false},
+        {SereTypeKind::I16,     "i16",     16, true,  false},
+        {SereTypeKind::I32,     "i32",     32, true,  false},
+        {SereTypeKind::INT,     "int",     64, true,  false},
+        {SereTypeKind::U8,      "u8",      8,  false, false},
+        {SereTypeKind::U16,     "u16",     16, false, false},
+        {SereTypeKind::U32,     "u32",     32, false, false},
+        {SereTypeKind::U64,     "u64",     64, false, false},
+        {SereTypeKind::F32,     "f32",     32, true,  true},
+        {SereTypeKind::FLOAT,   "float",   64, true,  true},
+        {SereTypeKind::STRING,  "str",     0,  false, false},
+        {SereTypeKind::BOOL,    "bool",    0,  false, false},
+        {SereTypeKind::NONE,    "none",    0,  false, false},
+        {SereTypeKind::DYNAMIC, "dyn",     0,  false, false},
+        {SereTypeKind::UNKNOWN, "unknown", 0,  false, false},
+    };
+
+    inline const TypeInfo &type_info(SereTypeKind kind) {
+        return TYPE_TABLE[static_cast<size_t>(kind)];
+    }
+
+    // UNKNOWN for names that are not types
+    inline SereTypeKind kind_from_name(const std::string &name) {
+        if (name == "i64") return SereTypeKind::INT;
+        if (name == "f64") return SereTypeKind::FLOAT;
+        if (name == "string") return SereTypeKind::STRING;
+        for (const auto &info : TYPE_TABLE)
+            if (info.kind != SereTypeKind::UNKNOWN && name == info.name) return info.kind;
+        return SereTypeKind::UNKNOWN;
+    }
+
+    inline bool is_integer(SereTypeKind kind) { return type_info(kind).bits && !type_info(kind).is_float; }
+    inline bool is_float(SereTypeKind kind) { return type_info(kind).is_float; }
+    inline bool is_numeric(SereTypeKind kind) { return type_info(kind).bits != 0; }
+    inline bool is_signed(SereTypeKind kind) { return type_info(kind).is_signed; }
+
+    // Whether every value of `from` is also a value of `to`.
+    inline bool widens_to(SereTypeKind from, SereTypeKind to) {
+        if (from == to) return true;
+        const TypeInfo &a = type_info(from), &b = type_info(to);
+        if (!a.bits || !b.bits) return false;
+        if (a.is_float) return b.is_float && b.bits >= a.bits;
+        if (b.is_float) return a.bits < (b.bits == 32 ? 24u : 53u); // within the mantissa
+        if (a.is_signed == b.is_signed) return b.bits >= a.bits;
+        return !a.is_signed && b.bits > a.bits; // unsigned into a wider signed type
+    }
+
     // Utility for type-to-string conversion
     inline std::string to_string(SereTypeKind kind) {
-        switch (kind) {
-            case SereTypeKind::INT:     return "int";
-            case SereTypeKind::FLOAT:   return "float";
-            case SereTypeKind::STRING:  return "str";
-            case SereTypeKind::BOOL:    return "bool";
-            case SereTypeKind::NONE:    return "none";
-            case SereTypeKind::UNKNOWN: return "unknown";
-        }
-        return "unknown";
+        return type_info(kind).name;
     }
 
     // Type environment for semantic analysis (scoped)
@@ -0,0 +1,76 @@
+#ifndef MIDLEVEL_MODULEINTERFACE_HPP
+#define MIDLEVEL_MODULEINTERFACE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Runtime {
+
+    // Signature of an exported function, in Sere type names ("int", "str", ...).
+    struct FunctionSignature {
+        std::string name;
+        std::vector<std::string> param_types;
+        std::string return_type;  // "none" when unannotated
+        uint32_t effects = 0;     // SereIR::EffectBits, inferred when the module is compiled
+
+        std::string to_string() const {
+            std::string text = name + "(";
+            for (size_t i = 0; i < param_types.size(); ++i) {
+                if (i) text += ", ";
+                text += param_types[i];
+            }
+            return text + ") -> " + return_type;
+        }
+    };
+
+    // What importers of a module may see and call.
+    struct ModuleInterface {
+        std::string name;       // dotted module name, e.g. "util.strings"
+        std::string init_name;  // symbol running the module's top-level statements
+        std::vector<FunctionSignature> functions;
+        std::string inline_bitcode;  // available_externally bodies of small exports, may be empty
+
+        const FunctionSignature* find(const std::string& fn) const {
+            for (const auto& sig : functions)
+                if (sig.name == fn) return &sig;
+            return nullptr;
+        }
+
+        // Canonical text; equal text means dependents need no rebuild.
+        // Inlinable bodies and effects are part of it since importers'
+        // code depends on them.
+        std::string fingerprint() const {
+            std::string text = name + "\n" + init_name + "\n";
+            for (const auto& sig : functions) text += sig.to_string() + " " + std::to_string(sig.effects) + "\n";
+            return text + inline_bitcode;
+        }
+    };
+
+    // Interfaces visible to the module currently being lowered, by module name.
+    using InterfaceTable = std::unordered_map<std::string, ModuleInterface>;
+
+    // Top-level functions other than `main` and `_private` ones are exported.
+    inline bool is_exported_name(const std::string& fn) {
+        return fn != "main" && fn.rfind('_', 0) != 0;
+    }
+
+    // Each dotted segment is length-prefixed, so `a.b` (__init_1a1b__) and
+    // `a_b` (__init_3a_b__) get distinct symbols, neither of them "__init__".
+    inline std::string init_symbol_for(const std::string& module_name) {
+        std::string symbol = "__init_";
+        size_t start = 0;
+        while (true) {
+            size_t dot = module_name.find('.', start);
+            std::string segment = module_name.substr(start, dot == std::string::npos ? std::string::npos : dot - start);
+            symbol += std::to_string(segment.size()) + segment;
+            if (dot == std::string::npos) break;
+            start = dot + 1;
+        }
+        return symbol + "__";
+    }
+
+} // namespace Runtime
+
+#endif // MIDLEVEL_MODULEINTERFACE_HPP
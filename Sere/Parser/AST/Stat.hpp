@@ -67,6 +67,13 @@ namespace SereParser
         }
     };
 
+    // `@name` or `@name(1, 2)` above a def
+    struct Decorator
+    {
+        std::string name;
+        std::vector<int> args;
+    };
+
     // Function statement
     class FunctionStatAST : public StatAST
     {
@@ -75,6 +82,7 @@ namespace SereParser
         const std::vector<std::shared_ptr<VariableExprAST>> params;
         const std::shared_ptr<StatAST> body;
         const std::shared_ptr<TypeAnnotationExprAST> type_annotation;
+        const std::vector<Decorator> decorators; // lines above the def, in source order
 
         FunctionStatAST(const SereLexer::TokenBase &name,
                         std::vector<std::shared_ptr<VariableExprAST>> params,
@@ -84,8 +92,25 @@ namespace SereParser
         FunctionStatAST(const SereLexer::TokenBase &name,
                         std::vector<std::shared_ptr<VariableExprAST>> params,
                         std::shared_ptr<StatAST> body,
-                        std::shared_ptr<TypeAnnotationExprAST> return_type)
-            : name(name), params(std::move(params)), body(std::move(body)), type_annotation(std::move(return_type)) {}
+                        std::shared_ptr<TypeAnnotationExprAST> return_type,
+                        std::vector<Decorator> decorators = {})
+            : name(name), params(std::move(params)), body(std::move(body)), type_annotation(std::move(return_type)),
+              decorators(std::move(decorators)) {}
+
+        bool has_decorator(const std::string &decorator) const
+        {
+            for (const auto &d : decorators)
+                if (d.name == decorator) return true;
+            return false;
+        }
+
+        // Some parameter has no type: the function is specialized per argument types.
+        bool is_generic() const
+        {
+            for (const auto &param : params)
+                if (!param->type_annotation) return true;
+            return false;
+        }
 
         SereObject accept(StatVisitor<SereObject> &visitor) const override
         {
@@ -129,6 +154,29 @@ namespace SereParser
         }
     };
 
+    // Counted loop: `for var in range(start, stop[, step])`
+    class ForStatAST : public StatAST
+    {
+    public:
+        const SereLexer::TokenBase var;
+        const std::shared_ptr<ExprAST> start;
+        const std::shared_ptr<ExprAST> stop;
+        const std::shared_ptr<ExprAST> step; // null means 1
+        const std::shared_ptr<StatAST> body;
+
+        ForStatAST(const SereLexer::TokenBase &var,
+                   std::shared_ptr<ExprAST> start,
+                   std::shared_ptr<ExprAST> stop,
+                   std::shared_ptr<ExprAST> step,
+                   std::shared_ptr<StatAST> body)
+            : var(var), start(std::move(start)), stop(std::move(stop)), step(std::move(step)), body(std::move(body)) {}
+
+        SereObject accept(StatVisitor<SereObject> &visitor) const override
+        {
+            return visitor.visit_for(*this);
+        }
+    };
+
     // Variable statement
     class AssignStatAST : public StatAST
     {
@@ -152,6 +200,28 @@ namespace SereParser
         }
     };
 
+    // Import statement: `import a.b [as c]` or `from a.b import x [as y], ...`
+    class ImportStatAST : public StatAST
+    {
+    public:
+        const std::string module_name;
+        const std::string alias;                                         // `import m as alias`
+        const std::vector<std::pair<std::string, std::string>> names;    // `from m import name as alias`
+
+        ImportStatAST(std::string module_name, std::string alias)
+            : module_name(std::move(module_name)), alias(std::move(alias)) {}
+
+        ImportStatAST(std::string module_name, std::vector<std::pair<std::string, std::string>> names)
+            : module_name(std::move(module_name)), names(std::move(names)) {}
+
+        bool is_from_import() const { return !names.empty(); }
+
+        SereObject accept(StatVisitor<SereObject> &visitor) const override
+        {
+            return visitor.visit_import(*this);
+        }
+    };
+
     // Return statement
     class ReturnStatAST : public StatAST
     {
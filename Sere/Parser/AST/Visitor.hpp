@@ -9,8 +9,11 @@
 #include "./Expr.hpp"
 #include "./Midlevel/SymbolTable.hpp"
 #include "./Midlevel/Environments.hpp"
+#include "./Midlevel/ModuleInterface.hpp"
+#include "./Midlevel/ConstValue.hpp"
 #include "../Builtins.hpp"
 #include "../../IR/IR.hpp"
+#include "../../SIR/SIR.hpp"
 
 #include <typeinfo>
 #include <stdexcept>
@@ -18,7 +21,12 @@
 #include <iostream>
 #include <utility>
 #include <string>
+#include <unordered_set>
+#include <optional>
+#include <llvm/Analysis/ValueTracking.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Linker/Linker.h>
 //
 // Attribute Macros
 //
@@ -83,59 +91,290 @@ namespace SereParser
     class RT
     {
     public:
-        static inline SereIR::CodeGenContext ctx = SereIR::CodeGenContext();
+        // Per thread, so independent modules can be lowered concurrently.
+        static inline thread_local SereIR::CodeGenContext ctx = SereIR::CodeGenContext();
 
-        static inline Runtime::SymbolTable global = Runtime::SymbolTable();
-        static inline std::shared_ptr<Runtime::TypeEnvironment> global_type_env = std::make_shared<Runtime::TypeEnvironment>();
-    };
+        static inline thread_local Runtime::SymbolTable global = Runtime::SymbolTable();
+        static inline thread_local std::shared_ptr<Runtime::TypeEnvironment> global_type_env = std::make_shared<Runtime::TypeEnvironment>();
 
-    inline llvm::Type *typename_to_llvm_type(const std::string &type_name)
-    {
-        if (type_name == "int")
-            return llvm::Type::getInt64Ty(RT::ctx.llvm_ctx);
-        if (type_name == "float")
-            return llvm::Type::getFloatTy(RT::ctx.llvm_ctx);
-        if (type_name == "bool")
-            return llvm::Type::getInt1Ty(RT::ctx.llvm_ctx);
-        if (type_name == "str")
-            return llvm::Type::getInt8PtrTy(RT::ctx.llvm_ctx);
-        if (type_name == "none")
-            return llvm::Type::getVoidTy(RT::ctx.llvm_ctx);
-        throw std::runtime_error("Unknown type for LLVM conversion: " + type_name);
-    }
+        // Interfaces of modules the current module may import, and the
+        // names its import statements bound (alias -> module / function).
+        static inline thread_local Runtime::InterfaceTable interfaces = Runtime::InterfaceTable();
+        static inline thread_local std::unordered_map<std::string, std::string> module_aliases;
+        static inline thread_local std::unordered_map<std::string, std::string> function_aliases;
+
+        // Sere-level signatures of callable functions by symbol name; LLVM
+        // types alone can't tell an i32 from a u32.
+        static inline thread_local std::unordered_map<std::string, Runtime::FunctionSignature> signatures;
+
+        // Functions with untyped parameters by symbol name; see StatVisitor::specialize.
+        static inline thread_local std::unordered_map<std::string, const class FunctionStatAST *> generics;
+
+        // Lowered function bodies by symbol (specializations included), with
+        // the variable types lowering gave them; see CompileTimeEvaluator.
+        struct Definition
+        {
+            const class FunctionStatAST *ast;
+            std::unordered_map<std::string, Runtime::SereTypeKind> variables;
+        };
+        static inline thread_local std::unordered_map<std::string, Definition> definitions;
+        // Compile-time calls by symbol and arguments; empty where the call must run
+        static inline thread_local std::unordered_map<std::string, std::optional<ConstValue>> evaluations;
+
+        // Function bodies lowered through SIR (kept for --emit=sir) and the pass pipeline they run
+        static inline thread_local SereSIR::Module sir;
+
+        // Whether exported functions keep external linkage; only modules
+        // other modules import have exports. Everything else is internal.
+        static inline thread_local bool exports = false;
+
+        // Drops per-compilation state; the LLVMContext and library cache stay warm.
+        static void reset(const std::string &module_name = "__module__", const std::string &init_name = "__init__",
+                          bool module_exports = false)
+        {
+            ctx.reset(module_name, init_name);
+            exports = module_exports;
+            global = Runtime::SymbolTable();
+            global_type_env = std::make_shared<Runtime::TypeEnvironment>();
+            module_aliases.clear();
+            function_aliases.clear();
+            signatures.clear();
+            generics.clear();
+            definitions.clear();
+            evaluations.clear();
+            sir = SereSIR::Module();
+        }
+
+        // Maps a callee as written (`f`, `alias`, `mod.f`) to its symbol name.
+        static std::string resolve_function_name(const std::string &written)
+        {
+            auto dot = written.rfind('.');
+            if (dot != std::string::npos)
+            {
+                std::string qualifier = written.substr(0, dot);
+                std::string fn = written.substr(dot + 1);
+                auto mod = module_aliases.find(qualifier);
+                if (mod == module_aliases.end())
+                    throw std::runtime_error("'" + qualifier + "' is not an imported module.");
+                auto iface = interfaces.find(mod->second);
+                if (iface == interfaces.end() || !iface->second.find(fn))
+                    throw std::runtime_error("Module '" + mod->second + "' has no function '" + fn + "'.");
+                return _sanitize_name_impl_(fn);
+            }
+            auto alias = function_aliases.find(written);
+            if (alias != function_aliases.end())
+                return _sanitize_name_impl_(alias->second);
+            return _sanitize_name_impl_(written);
+        }
+    };
 
     inline llvm::Type *typekind_to_llvm_type(Runtime::SereTypeKind kind)
     {
+        const Runtime::TypeInfo &info = Runtime::type_info(kind);
+        if (info.is_float)
+            return info.bits == 32 ? llvm::Type::getFloatTy(RT::ctx.llvm_ctx) : llvm::Type::getDoubleTy(RT::ctx.llvm_ctx);
+        if (info.bits)
+            return llvm::Type::getIntNTy(RT::ctx.llvm_ctx, info.bits);
         switch (kind)
         {
-        case Runtime::SereTypeKind::INT:
-            return llvm::Type::getInt64Ty(RT::ctx.llvm_ctx);
-        case Runtime::SereTypeKind::FLOAT:
-            return llvm::Type::getFloatTy(RT::ctx.llvm_ctx);
         case Runtime::SereTypeKind::BOOL:
             return llvm::Type::getInt1Ty(RT::ctx.llvm_ctx);
         case Runtime::SereTypeKind::STRING:
             return llvm::Type::getInt8PtrTy(RT::ctx.llvm_ctx);
         case Runtime::SereTypeKind::NONE:
             return llvm::Type::getVoidTy(RT::ctx.llvm_ctx);
+        case Runtime::SereTypeKind::DYNAMIC:
+            return llvm::Type::getInt64Ty(RT::ctx.llvm_ctx); // NaN-boxed, see IR/Dynamic.hpp
         default:
             throw std::runtime_error("Unknown SereTypeKind for LLVM conversion.");
         }
     }
 
+    inline llvm::Type *typename_to_llvm_type(const std::string &type_name)
+    {
+        Runtime::SereTypeKind kind = Runtime::kind_from_name(type_name);
+        if (kind == Runtime::SereTypeKind::UNKNOWN)
+            throw std::runtime_error("Unknown type for LLVM conversion: " + type_name);
+        return typekind_to_llvm_type(kind);
+    }
+
     inline Runtime::SereTypeKind parse_type_annotation(const std::string &type_name)
     {
-        if (type_name == "int")
-            return Runtime::SereTypeKind::INT;
-        if (type_name == "float")
-            return Runtime::SereTypeKind::FLOAT;
-        if (type_name == "bool")
+        return Runtime::kind_from_name(type_name); // UNKNOWN for unknown types
+    }
+
+    // Symbol of a generic function's specialization for `params`.
+    inline std::string specialization_name(const std::string &symbol, const std::vector<Runtime::SereTypeKind> &params)
+    {
+        std::string name = symbol;
+        for (Runtime::SereTypeKind kind : params)
+            name += "." + Runtime::to_string(kind);
+        return name;
+    }
+
+    // What a value of LLVM type `type` is when nothing says otherwise (ints are signed).
+    inline Runtime::SereTypeKind default_kind_of(llvm::Type *type)
+    {
+        if (type->isIntegerTy(1))
             return Runtime::SereTypeKind::BOOL;
-        if (type_name == "str" || type_name == "string")
+        if (type->isIntegerTy())
+        {
+            switch (type->getIntegerBitWidth())
+            {
+            case 8: return Runtime::SereTypeKind::I8;
+            case 16: return Runtime::SereTypeKind::I16;
+            case 32: return Runtime::SereTypeKind::I32;
+            case 64: return Runtime::SereTypeKind::INT;
+            default: return Runtime::SereTypeKind::UNKNOWN;
+            }
+        }
+        if (type->isFloatTy())
+            return Runtime::SereTypeKind::F32;
+        if (type->isDoubleTy())
+            return Runtime::SereTypeKind::FLOAT;
+        if (type->isPointerTy())
             return Runtime::SereTypeKind::STRING;
-        if (type_name == "none")
+        if (type->isVoidTy())
             return Runtime::SereTypeKind::NONE;
-        return Runtime::SereTypeKind::UNKNOWN; // Default case for unknown types
+        return Runtime::SereTypeKind::UNKNOWN;
+    }
+
+    inline Runtime::SereTypeKind kind_of(SereObject &value)
+    {
+        if (value.getKind() != Runtime::SereTypeKind::UNKNOWN)
+            return value.getKind();
+        llvm::Value *llvm_value = value.getLLVMValue(&RT::ctx.llvm_ctx);
+        return llvm_value ? default_kind_of(llvm_value->getType()) : Runtime::SereTypeKind::UNKNOWN;
+    }
+
+    // `value` as an i1 for a branch; a `dyn` value is tested by its run-time type.
+    inline llvm::Value *truth_of(SereObject &value)
+    {
+        llvm::Value *llvm_value = value.getLLVMValue(&RT::ctx.llvm_ctx);
+        if (kind_of(value) == Runtime::SereTypeKind::DYNAMIC)
+            return SereIR::dyn_truth(RT::ctx, llvm_value);
+        return RT::ctx.truth_value(llvm_value);
+    }
+
+    //
+    // Whether `value` (of kind `from`) may be used as a `to` without an
+    // explicit conversion: when no information is lost, or when it is a
+    // literal whose value the type holds (a float literal may round to f32).
+    // Anything converts to and from `dyn`; the latter is checked at run time.
+    //
+    inline bool converts_implicitly(llvm::Value *value, Runtime::SereTypeKind from, Runtime::SereTypeKind to, bool literal)
+    {
+        if (Runtime::widens_to(from, to))
+            return true;
+        if (to == Runtime::SereTypeKind::DYNAMIC || (from == Runtime::SereTypeKind::DYNAMIC && to != Runtime::SereTypeKind::NONE))
+            return true;
+        if (!literal || !Runtime::is_numeric(to))
+            return false;
+        const Runtime::TypeInfo &info = Runtime::type_info(to);
+        if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(value))
+        {
+            const llvm::APInt &bits = constant->getValue();
+            const bool negative = Runtime::is_signed(from) && bits.isNegative(); // a u64 literal above 2**63-1 is not
+            if (info.is_float)
+                return (negative ? bits.abs() : bits).getActiveBits() <= (info.bits == 32 ? 24u : 53u);
+            if (info.is_signed)
+                return (negative || !bits.isNegative()) && bits.isSignedIntN(info.bits);
+            return !negative && bits.isIntN(info.bits);
+        }
+        return llvm::isa<llvm::ConstantFP>(value) && info.is_float;
+    }
+
+    //
+    // `value` of kind `from` as a `to`. Integers wrap or extend by their
+    // signedness; floats become ints by truncation, saturating at the
+    // type's bounds (NaN gives 0), as in Rust, so it is never undefined.
+    //
+    // Values are boxed into `dyn` as they are; out of it, the type is
+    // checked at run time and a mismatch traps. Implicitly a `dyn` only
+    // becomes an int if it holds an int (or bool); `explicit_conversion`
+    // (`int(x)`) also accepts a float.
+    //
+    inline llvm::Value *convert_value(llvm::Value *value, Runtime::SereTypeKind from, Runtime::SereTypeKind to,
+                                      bool explicit_conversion = false)
+    {
+        using Runtime::SereTypeKind;
+        if (from == to)
+            return value;
+        auto &builder = RT::ctx.builder;
+        if (to == SereTypeKind::DYNAMIC)
+        {
+            if (Runtime::is_float(from))
+                return SereIR::box_float(builder, value);
+            if (Runtime::is_integer(from))
+                return SereIR::box_int(builder, builder.CreateIntCast(value, builder.getInt64Ty(), Runtime::is_signed(from)),
+                                       Runtime::is_signed(from) || Runtime::type_info(from).bits < 64);
+            switch (from)
+            {
+            case SereTypeKind::BOOL: return SereIR::box_bool(builder, value);
+            case SereTypeKind::STRING: return SereIR::box_str(builder, value);
+            case SereTypeKind::NONE: return SereIR::box_none(builder);
+            default: throw std::runtime_error("Cannot convert " + Runtime::to_string(from) + " to dyn.");
+            }
+        }
+        if (from == SereTypeKind::DYNAMIC)
+        {
+            if (to == SereTypeKind::BOOL)
+                return SereIR::dyn_truth(RT::ctx, value);
+            if (to == SereTypeKind::STRING)
+                return SereIR::unbox_str(RT::ctx, value);
+            if (Runtime::is_float(to))
+                return convert_value(SereIR::unbox_float(RT::ctx, value), SereTypeKind::FLOAT, to);
+            if (Runtime::is_integer(to))
+                return convert_value(SereIR::unbox_int(RT::ctx, value, explicit_conversion), SereTypeKind::INT, to);
+            throw std::runtime_error("Cannot convert dyn to " + Runtime::to_string(to) + ".");
+        }
+        if (to == SereTypeKind::BOOL)
+            return RT::ctx.truth_value(value);
+        llvm::Type *type = typekind_to_llvm_type(to);
+        const Runtime::TypeInfo &source = Runtime::type_info(from);
+        const Runtime::TypeInfo &target = Runtime::type_info(to);
+        if (from == Runtime::SereTypeKind::BOOL && target.bits)
+            return target.is_float ? builder.CreateUIToFP(value, type) : builder.CreateZExt(value, type);
+        if (!source.bits || !target.bits)
+            throw std::runtime_error("Cannot convert " + Runtime::to_string(from) + " to " + Runtime::to_string(to) + ".");
+        if (source.is_float && target.is_float)
+            return builder.CreateFPCast(value, type);
+        if (source.is_float)
+            return builder.CreateIntrinsic(target.is_signed ? llvm::Intrinsic::fptosi_sat : llvm::Intrinsic::fptoui_sat,
+                                           {type, value->getType()}, {value});
+        if (target.is_float)
+            return source.is_signed ? builder.CreateSIToFP(value, type) : builder.CreateUIToFP(value, type);
+        return builder.CreateIntCast(value, type, source.is_signed);
+    }
+
+    // `value` of kind `kind` when it is a constant: a number, a bool or a pooled string.
+    inline std::optional<ConstValue> constant_value(llvm::Value *value, Runtime::SereTypeKind kind)
+    {
+        if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(value))
+        {
+            if (kind == Runtime::SereTypeKind::BOOL)
+                return ConstValue::of_bool(!constant->isZero());
+            if (Runtime::is_integer(kind))
+                return ConstValue::of_int(kind, constant->getZExtValue());
+        }
+        if (auto *constant = llvm::dyn_cast<llvm::ConstantFP>(value))
+            if (Runtime::is_float(kind))
+                return ConstValue::of_float(kind, kind == Runtime::SereTypeKind::F32 ? constant->getValueAPF().convertToFloat()
+                                                                                     : constant->getValueAPF().convertToDouble());
+        llvm::StringRef text;
+        if (kind == Runtime::SereTypeKind::STRING && llvm::isa<llvm::Constant>(value) && llvm::getConstantStringInfo(value, text))
+            return ConstValue::of_str(text.str());
+        return std::nullopt;
+    }
+
+    inline llvm::Constant *to_constant(const ConstValue &value)
+    {
+        if (value.kind == Runtime::SereTypeKind::STRING)
+            return RT::ctx.constants.string(*RT::ctx.get_module(), value.text);
+        llvm::Type *type = typekind_to_llvm_type(value.kind);
+        if (Runtime::is_float(value.kind))
+            return llvm::ConstantFP::get(type, value.real);
+        return llvm::ConstantInt::get(type, value.bits);
     }
 
     //
@@ -174,7 +413,7 @@ namespace SereParser
             switch (obj.getType())
             {
             case SereObjectType::INTEGER:
-                return Runtime::SereTypeKind::INT;
+                return obj.integerLiteralKind();
             case SereObjectType::FLOAT:
                 return Runtime::SereTypeKind::FLOAT;
             case SereObjectType::STRING:
@@ -183,6 +422,8 @@ namespace SereParser
                 return Runtime::SereTypeKind::BOOL;
             case SereObjectType::NONE:
                 return Runtime::SereTypeKind::NONE;
+            case SereObjectType::DYNAMIC:
+                return Runtime::SereTypeKind::DYNAMIC;
             default:
                 return Runtime::SereTypeKind::UNKNOWN;
             }
@@ -193,20 +434,41 @@ namespace SereParser
             return env->get_(name);
         }
 
+        //
+        // The type both operands of `op` are converted to. Mixed numeric
+        // types promote to the narrowest type that holds every value of
+        // both: i8 + i32 is i32, u8 + i8 is i16, u16 + f32 is f32. An int
+        // too wide for the float's mantissa gives a float (i64 + f32 is
+        // float), as does any float with a float. Signed with unsigned of the
+        // same or greater width has no common type beyond i64 (i64 + u64).
+        //
         Runtime::SereTypeKind check_binary(Runtime::SereTypeKind left, Runtime::SereTypeKind right, const std::string &op)
         {
-            if (left == right)
+            using Runtime::SereTypeKind;
+            const bool comparison = op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=";
+            if (left == right && (Runtime::is_numeric(left) || (comparison && left == SereTypeKind::BOOL)))
                 return left;
-            if ((left == Runtime::SereTypeKind::INT && right == Runtime::SereTypeKind::FLOAT) ||
-                (left == Runtime::SereTypeKind::FLOAT && right == Runtime::SereTypeKind::INT))
-                return Runtime::SereTypeKind::FLOAT;
+            if (Runtime::is_numeric(left) && Runtime::is_numeric(right))
+            {
+                if (Runtime::widens_to(left, right))
+                    return right;
+                if (Runtime::widens_to(right, left))
+                    return left;
+                if (Runtime::is_float(left) || Runtime::is_float(right))
+                    return SereTypeKind::FLOAT;
+                for (SereTypeKind wider : {SereTypeKind::I16, SereTypeKind::I32, SereTypeKind::INT})
+                    if (Runtime::widens_to(left, wider) && Runtime::widens_to(right, wider))
+                        return wider;
+                throw std::runtime_error("Type error: " + Runtime::to_string(left) + " " + op + " " + Runtime::to_string(right) +
+                                         " has no common type; convert one side explicitly, e.g. int(x).");
+            }
             throw std::runtime_error("Type error: invalid operands for " + op + ": " +
                                      Runtime::to_string(left) + " and " + Runtime::to_string(right));
         }
 
         Runtime::SereTypeKind check_unary(Runtime::SereTypeKind operand, const std::string &op)
         {
-            if (op == "-" && (operand == Runtime::SereTypeKind::INT || operand == Runtime::SereTypeKind::FLOAT))
+            if ((op == "-" || op == "+") && Runtime::is_numeric(operand))
                 return operand;
             if (op == "!" && operand == Runtime::SereTypeKind::BOOL)
                 return Runtime::SereTypeKind::BOOL;
@@ -218,6 +480,20 @@ namespace SereParser
             env->set(name, rhs_type);
         }
 
+        // The type of a value that may come from either of two places (say,
+        // two returns): numbers promote, anything else is only known at run time.
+        Runtime::SereTypeKind unify(Runtime::SereTypeKind a, Runtime::SereTypeKind b, const std::string &what)
+        {
+            if (a == b)
+                return a;
+            if (Runtime::is_numeric(a) && Runtime::is_numeric(b))
+                return check_binary(a, b, what);
+            if (a == Runtime::SereTypeKind::NONE || b == Runtime::SereTypeKind::NONE ||
+                a == Runtime::SereTypeKind::UNKNOWN || b == Runtime::SereTypeKind::UNKNOWN)
+                throw std::runtime_error("Type error: " + what + " is both " + Runtime::to_string(a) + " and " + Runtime::to_string(b) + ".");
+            return Runtime::SereTypeKind::DYNAMIC;
+        }
+
         void debug_dump_env() const
         {
             std::cout << "[TypeChecker] Current Environment:\n";
@@ -228,8 +504,27 @@ namespace SereParser
         }
 
         std::shared_ptr<Runtime::TypeEnvironment> env;
+        // Unannotated variables of the function being lowered that are assigned values of incompatible types
+        std::unordered_set<std::string> dynamic_variables;
     };
 
+    template <typename R>
+    class StatVisitor;
+
+    template <typename R>
+    class CompileTimeEvaluator;
+
+} // namespace SereParser
+
+namespace SereSIR
+{
+    template <typename R>
+    class Lowering;
+} // namespace SereSIR
+
+namespace SereParser
+{
+
     //
     // ===============================
     // ExprVisitor Template
@@ -241,6 +536,7 @@ namespace SereParser
     public:
         virtual ~ExprVisitor() = default;
         std::shared_ptr<TypeChecker> type_checker;
+        StatVisitor<R> *statements = nullptr; // lowers specializations of generic functions; set by the StatVisitor
 
         explicit ExprVisitor(std::shared_ptr<TypeChecker> checker)
             : type_checker(std::move(checker))
@@ -253,6 +549,7 @@ namespace SereParser
         SEREPARSER_NODISCARD virtual R visit_literal(const class LiteralExprAST &expr) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_logical(const class LogicalExprAST &expr) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_call(const class CallExprAST &expr) SEREPARSER_NOEXCEPT;
+        SEREPARSER_NODISCARD virtual R visit_format(const class FormatExprAST &expr) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_group(const class GroupExprAST &expr) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_super(const class SuperExprAST &expr) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_self(const class SelfExprAST &expr) SEREPARSER_NOEXCEPT;
@@ -262,6 +559,23 @@ namespace SereParser
         {
             return expr.accept(*this);
         }
+
+        // An int or float literal, possibly signed or parenthesized: its type is not fixed yet.
+        static bool is_untyped_literal(const class ExprAST &expr);
+
+        static SereIR::DynOp dyn_op(SereLexer::TokenType op);
+
+        // Whether `expr` may be evaluated even when the program would not
+        // have evaluated it: no calls, nothing that can trap, and at most
+        // `budget` nodes. `variable_kind` gives the type of a variable.
+        template <typename KindOf>
+        static bool is_speculatable(const class ExprAST &expr, int &budget, const KindOf &variable_kind);
+
+        // A call of the core library's print, which lowering expands (SereIR::emit_output)
+        static bool is_print(const class CallExprAST &expr);
+
+    private:
+        R visit_print(const class CallExprAST &expr);
     };
 
     //
@@ -277,11 +591,13 @@ namespace SereParser
         std::shared_ptr<ExprVisitor<R>> expr_visitor;
         std::shared_ptr<TypeChecker> type_checker;
 
+        // Shares the expression visitor's checker: both must see the same variable types.
         explicit StatVisitor(std::shared_ptr<ExprVisitor<R>> expr_visitor_)
             : expr_visitor(std::move(expr_visitor_)),
-              type_checker(std::make_shared<TypeChecker>())
+              type_checker(expr_visitor->type_checker)
         {
             type_checker->set_env(RT::global_type_env);
+            expr_visitor->statements = this;
         }
 
         SEREPARSER_NODISCARD virtual R visit_block(const class BlockStatAST &stat) SEREPARSER_NOEXCEPT;
@@ -290,13 +606,21 @@ namespace SereParser
         SEREPARSER_NODISCARD virtual R visit_function(const class FunctionStatAST &stat) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_if(const class IfStatAST &stat) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_while(const class WhileStatAST &stat) SEREPARSER_NOEXCEPT;
+        SEREPARSER_NODISCARD virtual R visit_for(const class ForStatAST &stat) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_return(const class ReturnStatAST &stat) SEREPARSER_NOEXCEPT;
         SEREPARSER_NODISCARD virtual R visit_assign(const class AssignStatAST &stat) SEREPARSER_NOEXCEPT;
+        SEREPARSER_NODISCARD virtual R visit_import(const class ImportStatAST &stat) SEREPARSER_NOEXCEPT;
 
         SEREPARSER_NODISCARD R accept_statement(class StatAST &stat)
         {
             return stat.accept(this);
         }
+
+        llvm::Function *specialize(const class FunctionStatAST &func, const std::vector<Runtime::SereTypeKind> &params);
+
+    protected:
+        llvm::Function *lower_function(const class FunctionStatAST &func, const std::string &symbol,
+                                       const Runtime::FunctionSignature &signature, bool external);
     };
 
     //
@@ -320,21 +644,48 @@ namespace SereParser
         if (!left_llvm || !right_llvm)
             throw std::runtime_error("BinaryExprAST: LLVM values are not valid.");
 
-        // Semantic Type Check (assumed to return some type info, like enum or LLVM type)
-        auto left_type = left_llvm->getType();
-        auto right_type = right_llvm->getType();
+        Runtime::SereTypeKind left_kind = kind_of(left_val);
+        Runtime::SereTypeKind right_kind = kind_of(right_val);
+
+        // With a `dyn` operand the types are checked at run time
+        if (left_kind == Runtime::SereTypeKind::DYNAMIC || right_kind == Runtime::SereTypeKind::DYNAMIC)
+        {
+            SereIR::DynOp op = dyn_op(expr.op.type);
+            llvm::Value *result = SereIR::dyn_binary(RT::ctx, op,
+                                                     convert_value(left_llvm, left_kind, Runtime::SereTypeKind::DYNAMIC),
+                                                     convert_value(right_llvm, right_kind, Runtime::SereTypeKind::DYNAMIC));
+            left_val.setLLVMValue(result, SereIR::is_comparison(op) ? Runtime::SereTypeKind::BOOL : Runtime::SereTypeKind::DYNAMIC);
+            return left_val;
+        }
 
-        if (left_type != right_type) {
-            throw std::runtime_error("Type mismatch in binary operation.");
+        // A float may be raised to an int power
+        if (expr.op.type == SereLexer::TokenType::TOKEN_DOUBLE_STAR && Runtime::is_float(left_kind) && Runtime::is_integer(right_kind))
+        {
+            left_val.setLLVMValue(SereIR::power(RT::ctx, left_llvm, right_llvm, Runtime::is_signed(right_kind)), left_kind);
+            return left_val;
         }
 
-        bool isFloat = left_type->isFloatingPointTy();
+        // A literal takes the other operand's type when it holds the value: `x + 1` stays a u8
+        Runtime::SereTypeKind left_as = left_kind, right_as = right_kind;
+        if (is_untyped_literal(*expr.left) && converts_implicitly(left_llvm, left_kind, right_kind, true))
+            left_as = right_kind;
+        else if (is_untyped_literal(*expr.right) && converts_implicitly(right_llvm, right_kind, left_kind, true))
+            right_as = left_kind;
+        Runtime::SereTypeKind kind = type_checker->check_binary(left_as, right_as, expr.op.lexeme);
+        left_llvm = convert_value(left_llvm, left_kind, kind);
+        right_llvm = convert_value(right_llvm, right_kind, kind);
+
+        bool isFloat = Runtime::is_float(kind);
+        bool isSigned = Runtime::is_signed(kind);
+        left_val.setKind(kind);
 
         switch (expr.op.type)
         {
             case SereLexer::TokenType::TOKEN_PLUS:
                 if (isFloat)
                     left_val.setLLVMValue(RT::ctx.builder.CreateFAdd(left_llvm, right_llvm, "add_tmp"));
+                else if (RT::ctx.checked_arith)
+                    left_val.setLLVMValue(SereIR::checked_arith(RT::ctx, llvm::Instruction::Add, left_llvm, right_llvm, isSigned, "add_tmp"));
                 else
                     left_val.setLLVMValue(RT::ctx.builder.CreateAdd(left_llvm, right_llvm, "add_tmp"));
                 break;
@@ -342,6 +693,8 @@ namespace SereParser
             case SereLexer::TokenType::TOKEN_MINUS:
                 if (isFloat)
                     left_val.setLLVMValue(RT::ctx.builder.CreateFSub(left_llvm, right_llvm, "sub_tmp"));
+                else if (RT::ctx.checked_arith)
+                    left_val.setLLVMValue(SereIR::checked_arith(RT::ctx, llvm::Instruction::Sub, left_llvm, right_llvm, isSigned, "sub_tmp"));
                 else
                     left_val.setLLVMValue(RT::ctx.builder.CreateSub(left_llvm, right_llvm, "sub_tmp"));
                 break;
@@ -349,16 +702,68 @@ namespace SereParser
             case SereLexer::TokenType::TOKEN_STAR:
                 if (isFloat)
                     left_val.setLLVMValue(RT::ctx.builder.CreateFMul(left_llvm, right_llvm, "mul_tmp"));
+                else if (RT::ctx.checked_arith)
+                    left_val.setLLVMValue(SereIR::checked_arith(RT::ctx, llvm::Instruction::Mul, left_llvm, right_llvm, isSigned, "mul_tmp"));
                 else
                     left_val.setLLVMValue(RT::ctx.builder.CreateMul(left_llvm, right_llvm, "mul_tmp"));
                 break;
 
             case SereLexer::TokenType::TOKEN_SLASH:
-                if (isFloat)
-                    left_val.setLLVMValue(RT::ctx.builder.CreateFDiv(left_llvm, right_llvm, "div_tmp"));
-                else
-                    // Assuming signed integer division here, use CreateUDiv if unsigned
-                    left_val.setLLVMValue(RT::ctx.builder.CreateSDiv(left_llvm, right_llvm, "div_tmp"));
+                // Ints divide truncating (C-like); `//` is Python's floor division
+                left_val.setLLVMValue(SereIR::true_div(RT::ctx, left_llvm, right_llvm, isSigned));
+                break;
+
+            case SereLexer::TokenType::TOKEN_DOUBLE_SLASH:
+                left_val.setLLVMValue(SereIR::floor_div(RT::ctx, left_llvm, right_llvm, isSigned));
+                break;
+
+            case SereLexer::TokenType::TOKEN_PERCENT:
+                left_val.setLLVMValue(SereIR::floor_mod(RT::ctx, left_llvm, right_llvm, isSigned));
+                break;
+
+            case SereLexer::TokenType::TOKEN_DOUBLE_STAR:
+                left_val.setLLVMValue(SereIR::power(RT::ctx, left_llvm, right_llvm, isSigned, RT::ctx.checked_arith));
+                break;
+
+            // Comparisons yield bool; NaN compares unequal to everything, as in Python
+            case SereLexer::TokenType::TOKEN_LESS:
+                left_val.setLLVMValue(isFloat ? RT::ctx.builder.CreateFCmpOLT(left_llvm, right_llvm, "lt_tmp")
+                                              : RT::ctx.builder.CreateICmp(isSigned ? llvm::CmpInst::ICMP_SLT : llvm::CmpInst::ICMP_ULT,
+                                                                           left_llvm, right_llvm, "lt_tmp"),
+                                      Runtime::SereTypeKind::BOOL);
+                break;
+
+            case SereLexer::TokenType::TOKEN_LESS_EQUAL:
+                left_val.setLLVMValue(isFloat ? RT::ctx.builder.CreateFCmpOLE(left_llvm, right_llvm, "le_tmp")
+                                              : RT::ctx.builder.CreateICmp(isSigned ? llvm::CmpInst::ICMP_SLE : llvm::CmpInst::ICMP_ULE,
+                                                                           left_llvm, right_llvm, "le_tmp"),
+                                      Runtime::SereTypeKind::BOOL);
+                break;
+
+            case SereLexer::TokenType::TOKEN_GREATER:
+                left_val.setLLVMValue(isFloat ? RT::ctx.builder.CreateFCmpOGT(left_llvm, right_llvm, "gt_tmp")
+                                              : RT::ctx.builder.CreateICmp(isSigned ? llvm::CmpInst::ICMP_SGT : llvm::CmpInst::ICMP_UGT,
+                                                                           left_llvm, right_llvm, "gt_tmp"),
+                                      Runtime::SereTypeKind::BOOL);
+                break;
+
+            case SereLexer::TokenType::TOKEN_GREATER_EQUAL:
+                left_val.setLLVMValue(isFloat ? RT::ctx.builder.CreateFCmpOGE(left_llvm, right_llvm, "ge_tmp")
+                                              : RT::ctx.builder.CreateICmp(isSigned ? llvm::CmpInst::ICMP_SGE : llvm::CmpInst::ICMP_UGE,
+                                                                           left_llvm, right_llvm, "ge_tmp"),
+                                      Runtime::SereTypeKind::BOOL);
+                break;
+
+            case SereLexer::TokenType::TOKEN_EQUAL_EQUAL:
+                left_val.setLLVMValue(isFloat ? RT::ctx.builder.CreateFCmpOEQ(left_llvm, right_llvm, "eq_tmp")
+                                              : RT::ctx.builder.CreateICmpEQ(left_llvm, right_llvm, "eq_tmp"),
+                                      Runtime::SereTypeKind::BOOL);
+                break;
+
+            case SereLexer::TokenType::TOKEN_BANG_EQUAL:
+                left_val.setLLVMValue(isFloat ? RT::ctx.builder.CreateFCmpUNE(left_llvm, right_llvm, "ne_tmp")
+                                              : RT::ctx.builder.CreateICmpNE(left_llvm, right_llvm, "ne_tmp"),
+                                      Runtime::SereTypeKind::BOOL);
                 break;
 
             default:
@@ -381,36 +786,18 @@ namespace SereParser
         {
         case SereObjectType::INTEGER:
             value.setLLVMValue(
-                llvm::ConstantInt::get(RT::ctx.llvm_ctx, llvm::APInt(64, value.getInteger())));
+                llvm::ConstantInt::get(RT::ctx.llvm_ctx, llvm::APInt(64, value.getInteger(), /*isSigned=*/true)),
+                value.integerLiteralKind());
             break;
         case SereObjectType::FLOAT:
             value.setLLVMValue(
-                llvm::ConstantFP::get(RT::ctx.llvm_ctx, llvm::APFloat(value.getFloat())));
+                llvm::ConstantFP::get(RT::ctx.llvm_ctx, llvm::APFloat(value.getFloat())),
+                Runtime::SereTypeKind::FLOAT);
             break;
-        case SereObjectType::STRING: {
-            llvm::Constant *str_const = llvm::ConstantDataArray::getString(RT::ctx.llvm_ctx, value.getString(), true);
-            
-            llvm::GlobalVariable *str_global = new llvm::GlobalVariable(
-                *RT::ctx.get_module(),
-                str_const->getType(),
-                false,
-                llvm::GlobalValue::PrivateLinkage,
-                str_const,
-                ".str"
-            );
-
-            llvm::Constant *zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(RT::ctx.llvm_ctx), 0);
-            llvm::Constant *indices[] = { zero, zero };
-            
-            llvm::Constant *str_ptr = llvm::ConstantExpr::getGetElementPtr(
-                str_const->getType(),
-                str_global,
-                indices
-            );
-
-            value.setLLVMValue(str_ptr); // ✅ now it's a valid i8* pointer
+        case SereObjectType::STRING:
+            // One shared global per distinct literal in the module
+            value.setLLVMValue(RT::ctx.constants.string(*RT::ctx.get_module(), value.getString()));
             break;
-        }
         case SereObjectType::BOOLEAN:
             value.setLLVMValue(
                 llvm::ConstantInt::get(RT::ctx.llvm_ctx, llvm::APInt(1, value.getBoolean())));
@@ -443,13 +830,38 @@ namespace SereParser
 
         R val = expr.operand->accept(*this);
         llvm::Value *operand_llvm = val.getLLVMValue(&RT::ctx.llvm_ctx);
+        Runtime::SereTypeKind kind = kind_of(val);
 
         switch (expr.op.type)
         {
         case SereLexer::TokenType::TOKEN_MINUS:
-            val.setLLVMValue(RT::ctx.builder.CreateFNeg(operand_llvm, "neg_tmp"));
+            if (kind == Runtime::SereTypeKind::DYNAMIC)
+            {
+                // x * -1 keeps the sign of a float zero, as -x does
+                val.setLLVMValue(SereIR::dyn_binary(RT::ctx, SereIR::DynOp::MUL, operand_llvm,
+                                                    SereIR::box_int(RT::ctx.builder, RT::ctx.builder.getInt64(-1))),
+                                 kind);
+                break;
+            }
+            type_checker->check_unary(kind, expr.op.lexeme);
+            if (Runtime::is_float(kind))
+                val.setLLVMValue(RT::ctx.builder.CreateFNeg(operand_llvm, "neg_tmp"), kind);
+            else if (RT::ctx.checked_arith)
+                val.setLLVMValue(SereIR::checked_arith(RT::ctx, llvm::Instruction::Sub, llvm::ConstantInt::get(operand_llvm->getType(), 0),
+                                                       operand_llvm, Runtime::is_signed(kind), "neg_tmp"),
+                                 kind);
+            else
+                val.setLLVMValue(RT::ctx.builder.CreateNeg(operand_llvm, "neg_tmp"), kind);
+            break;
+        case SereLexer::TokenType::TOKEN_PLUS:
+            if (kind != Runtime::SereTypeKind::DYNAMIC)
+                type_checker->check_unary(kind, expr.op.lexeme);
+            break;
         case SereLexer::TokenType::TOKEN_BANG:
-            val.setLLVMValue(RT::ctx.builder.CreateNot(operand_llvm, "not_tmp"));
+        case SereLexer::TokenType::TOKEN_NOT:
+            val.setLLVMValue(RT::ctx.builder.CreateNot(truth_of(val), "not_tmp"),
+                             Runtime::SereTypeKind::BOOL);
+            break;
         default:
             throw std::invalid_argument("UnaryExprAST: Invalid operator.");
         }
@@ -461,38 +873,254 @@ namespace SereParser
     {
         ASSERT_MUST_RETURN_SERE_OBJECT;
 
-        llvm::Value *var_ptr = RT::ctx.get_named_value(SANITIZE_NAME(expr.name.lexeme));
-        if (!var_ptr)
+        const std::string name = SANITIZE_NAME(expr.name.lexeme);
+        if (!RT::ctx.variable_type(name))
         {
             throw std::runtime_error("LLVM variable '" + expr.name.lexeme + "' not found in current scope.");
         }
-       
-
-        llvm::Value *loaded = RT::ctx.builder.CreateLoad(var_ptr->getType()->getPointerElementType(), var_ptr, SANITIZE_NAME(expr.name.lexeme));
 
         SereObject result;
-        result.setLLVMValue(loaded);
+        result.setLLVMValue(RT::ctx.read_variable(name), type_checker->check_variable(name));
         return result;
     }
-    // --- Not-yet-implemented visit_* methods ---
+    template <typename R>
+    bool ExprVisitor<R>::is_untyped_literal(const ExprAST &expr)
+    {
+        if (auto literal = dynamic_cast<const LiteralExprAST *>(&expr))
+            return literal->value.getType() == SereObjectType::INTEGER || literal->value.getType() == SereObjectType::FLOAT;
+        if (auto group = dynamic_cast<const GroupExprAST *>(&expr))
+            return is_untyped_literal(*group->expr);
+        if (auto unary = dynamic_cast<const UnaryExprAST *>(&expr))
+            return (unary->op.type == SereLexer::TokenType::TOKEN_MINUS || unary->op.type == SereLexer::TokenType::TOKEN_PLUS) &&
+                   is_untyped_literal(*unary->operand);
+        return false;
+    }
+
+    template <typename R>
+    SereIR::DynOp ExprVisitor<R>::dyn_op(SereLexer::TokenType op)
+    {
+        using SereLexer::TokenType;
+        switch (op)
+        {
+        case TokenType::TOKEN_PLUS: return SereIR::DynOp::ADD;
+        case TokenType::TOKEN_MINUS: return SereIR::DynOp::SUB;
+        case TokenType::TOKEN_STAR: return SereIR::DynOp::MUL;
+        case TokenType::TOKEN_SLASH: return SereIR::DynOp::DIV;
+        case TokenType::TOKEN_DOUBLE_SLASH: return SereIR::DynOp::FLOOR_DIV;
+        case TokenType::TOKEN_PERCENT: return SereIR::DynOp::MOD;
+        case TokenType::TOKEN_DOUBLE_STAR: return SereIR::DynOp::POW;
+        case TokenType::TOKEN_LESS: return SereIR::DynOp::LT;
+        case TokenType::TOKEN_LESS_EQUAL: return SereIR::DynOp::LE;
+        case TokenType::TOKEN_GREATER: return SereIR::DynOp::GT;
+        case TokenType::TOKEN_GREATER_EQUAL: return SereIR::DynOp::GE;
+        case TokenType::TOKEN_EQUAL_EQUAL: return SereIR::DynOp::EQ;
+        case TokenType::TOKEN_BANG_EQUAL: return SereIR::DynOp::NE;
+        default: throw std::invalid_argument("BinaryExprAST: Invalid operator.");
+        }
+    }
+
+    template <typename R>
+    template <typename KindOf>
+    bool ExprVisitor<R>::is_speculatable(const ExprAST &expr, int &budget, const KindOf &variable_kind)
+    {
+        using SereLexer::TokenType;
+        if (--budget < 0)
+            return false;
+        if (dynamic_cast<const LiteralExprAST *>(&expr))
+            return true;
+        if (auto variable = dynamic_cast<const VariableExprAST *>(&expr))
+        {
+            // dyn operations trap on a type mismatch
+            const Runtime::SereTypeKind kind = variable_kind(SANITIZE_NAME(variable->name.lexeme));
+            return kind != Runtime::SereTypeKind::DYNAMIC && kind != Runtime::SereTypeKind::UNKNOWN;
+        }
+        if (auto group = dynamic_cast<const GroupExprAST *>(&expr))
+            return is_speculatable(*group->expr, budget, variable_kind);
+        if (auto unary = dynamic_cast<const UnaryExprAST *>(&expr))
+        {
+            if (unary->op.type == TokenType::TOKEN_MINUS && RT::ctx.checked_arith)
+                return false; // negating the minimum traps
+            return is_speculatable(*unary->operand, budget, variable_kind);
+        }
+        if (auto logical = dynamic_cast<const LogicalExprAST *>(&expr))
+            return is_speculatable(*logical->left, budget, variable_kind) && is_speculatable(*logical->right, budget, variable_kind);
+        if (auto binary = dynamic_cast<const BinaryExprAST *>(&expr))
+        {
+            switch (binary->op.type)
+            {
+            case TokenType::TOKEN_SLASH:
+            case TokenType::TOKEN_DOUBLE_SLASH:
+            case TokenType::TOKEN_PERCENT:
+            {
+                // Integer division traps on zero (and overflows on -1); only known divisors are safe
+                auto divisor = dynamic_cast<const LiteralExprAST *>(binary->right.get());
+                if (!divisor)
+                    return false;
+                if (divisor->value.getType() == SereObjectType::INTEGER &&
+                    (divisor->value.getInteger() == 0 || divisor->value.getInteger() == -1))
+                    return false;
+                break;
+            }
+            case TokenType::TOKEN_DOUBLE_STAR:
+                // __sere_ipow traps on a negative exponent, and --checked-arith on overflow
+                if (!dynamic_cast<const LiteralExprAST *>(binary->right.get()) || RT::ctx.checked_arith)
+                    return false;
+                break;
+            case TokenType::TOKEN_PLUS:
+            case TokenType::TOKEN_MINUS:
+            case TokenType::TOKEN_STAR:
+                if (RT::ctx.checked_arith)
+                    return false; // traps on integer overflow
+                break;
+            default:
+                break;
+            }
+            return is_speculatable(*binary->left, budget, variable_kind) && is_speculatable(*binary->right, budget, variable_kind);
+        }
+        return false; // calls and anything newer
+    }
+
+    //
+    // `a and b` / `a or b` evaluate `b` only when `a` does not already decide
+    // the result, which is then `a` or `b` itself (Python semantics); with
+    // operands of different types it is their truth value instead. A cheap,
+    // side-effect free `b` is evaluated unconditionally and picked with a
+    // `select`, which is cheaper than a branch. A literal `a` is decided here.
+    // With --pgo-use the profile attaches weights to both forms.
+    //
     template <typename R>
     R ExprVisitor<R>::visit_logical(const LogicalExprAST &expr) SEREPARSER_NOEXCEPT
     {
         ASSERT_MUST_RETURN_SERE_OBJECT;
-        SEREPARSER_UNUSED(expr);
-        throw std::runtime_error("visit_logical not implemented.");
+        auto &builder = RT::ctx.builder;
+        const bool is_and = expr.op.type == SereLexer::TokenType::TOKEN_AND;
+        if (!is_and && expr.op.type != SereLexer::TokenType::TOKEN_OR)
+            throw std::invalid_argument("LogicalExprAST: Invalid operator.");
+
+        SereObject left_val = expr.left->accept(*this);
+        llvm::Value *left = left_val.getLLVMValue(&RT::ctx.llvm_ctx);
+        if (!left)
+            throw std::runtime_error("LogicalExprAST: LLVM values are not valid.");
+        llvm::Value *left_truth = truth_of(left_val);
+
+        if (auto *known = llvm::dyn_cast<llvm::ConstantInt>(left_truth))
+        {
+            if (known->isOne() != is_and)
+                return left_val; // `False and b`, `True or b`: b is never evaluated
+            return expr.right->accept(*this);
+        }
+
+        SereObject result;
+        const Runtime::SereTypeKind left_kind = kind_of(left_val);
+        int budget = 6;
+        if (is_speculatable(*expr.right, budget, [this](const std::string &name)
+                            { return type_checker->check_variable(name); }))
+        {
+            SereObject right_val = expr.right->accept(*this);
+            llvm::Value *right = right_val.getLLVMValue(&RT::ctx.llvm_ctx);
+            Runtime::SereTypeKind kind = left_kind;
+            if (kind_of(right_val) != left_kind)
+            {
+                left = left_truth;
+                right = truth_of(right_val);
+                kind = Runtime::SereTypeKind::BOOL;
+            }
+            result.setLLVMValue(is_and ? builder.CreateSelect(left_truth, right, left, "and_tmp")
+                                       : builder.CreateSelect(left_truth, left, right, "or_tmp"),
+                                kind);
+            return result;
+        }
+
+        llvm::BasicBlock *left_block = builder.GetInsertBlock();
+        llvm::Function *func = left_block->getParent();
+        llvm::BasicBlock *right_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, is_and ? "and.rhs" : "or.rhs", func);
+        llvm::BasicBlock *merge_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, is_and ? "and.end" : "or.end");
+        if (is_and)
+            builder.CreateCondBr(left_truth, right_block, merge_block);
+        else
+            builder.CreateCondBr(left_truth, merge_block, right_block);
+
+        RT::ctx.ssa.seal_block(right_block);
+        builder.SetInsertPoint(right_block);
+        SereObject right_val = expr.right->accept(*this);
+        llvm::Value *right = right_val.getLLVMValue(&RT::ctx.llvm_ctx);
+        if (!right)
+            throw std::runtime_error("LogicalExprAST: LLVM values are not valid.");
+        const bool same_type = kind_of(right_val) == left_kind;
+        if (!same_type)
+            right = truth_of(right_val);
+        llvm::BasicBlock *right_end = builder.GetInsertBlock(); // `b` may have branched itself
+        builder.CreateBr(merge_block);
+
+        merge_block->insertInto(func);
+        RT::ctx.ssa.seal_block(merge_block);
+        builder.SetInsertPoint(merge_block);
+        llvm::PHINode *phi = builder.CreatePHI(right->getType(), 2, is_and ? "and_tmp" : "or_tmp");
+        phi->addIncoming(same_type ? left : left_truth, left_block);
+        phi->addIncoming(right, right_end);
+        result.setLLVMValue(phi, same_type ? left_kind : Runtime::SereTypeKind::BOOL);
+        return result;
     }
 
     template <typename R>
     R ExprVisitor<R>::visit_call(const CallExprAST &expr) SEREPARSER_NOEXCEPT
     {
         ASSERT_MUST_RETURN_SERE_OBJECT;
-        
-        llvm::Function *callee = RT::ctx.module->getFunction(SANITIZE_NAME(expr.callee.lexeme));
-        if (!callee) {
+        if (is_print(expr))
+            return visit_print(expr);
+
+        const std::string symbol = RT::resolve_function_name(expr.callee.lexeme);
+        llvm::Function *callee = RT::ctx.module->getFunction(symbol);
+        auto generic = RT::generics.find(symbol);
+        const bool is_generic = !callee && generic != RT::generics.end();
+
+        // `T(x)` converts explicitly, unless a function of that name exists
+        Runtime::SereTypeKind conversion = Runtime::kind_from_name(expr.callee.lexeme);
+        if (!callee && !is_generic &&
+            (Runtime::is_numeric(conversion) || conversion == Runtime::SereTypeKind::BOOL || conversion == Runtime::SereTypeKind::DYNAMIC))
+        {
+            if (expr.arguments.size() != 1)
+                throw std::runtime_error(expr.callee.lexeme + "() takes exactly one argument.");
+            SereObject value = expr.arguments[0]->accept(*this);
+            llvm::Value *value_llvm = value.getLLVMValue(&RT::ctx.llvm_ctx);
+            if (!value_llvm)
+                throw std::runtime_error("Invalid LLVM value for argument in conversion.");
+            SereObject result;
+            result.setLLVMValue(convert_value(value_llvm, kind_of(value), conversion, true), conversion);
+            return result;
+        }
+        if (!callee && !is_generic) {
             throw std::runtime_error(SANITIZE_NAME(expr.callee.lexeme) + " is not defined in the current scope.");
         }
 
+        if (is_generic && expr.arguments.size() != generic->second->params.size()) {
+            throw std::runtime_error("argument count mismatch in function call to " + SANITIZE_NAME(expr.callee.lexeme));
+        }
+        std::vector<SereObject> values;
+        for (const auto &argExpr : expr.arguments) {
+            values.push_back(argExpr->accept(*this));
+            if (!values.back().getLLVMValue(&RT::ctx.llvm_ctx)) {
+                throw std::runtime_error("Invalid LLVM value for argument in function call.");
+            }
+        }
+
+        // A generic function is specialized for the argument types (annotated parameters keep theirs)
+        if (is_generic) {
+            const FunctionStatAST &func = *generic->second;
+            std::vector<Runtime::SereTypeKind> params;
+            for (size_t i = 0; i < values.size(); ++i) {
+                Runtime::SereTypeKind kind = func.params[i]->type_annotation
+                    ? parse_type_annotation(SANITIZE_NAME(func.params[i]->type_annotation->name.lexeme))
+                    : kind_of(values[i]);
+                if (!Runtime::is_numeric(kind) && kind != Runtime::SereTypeKind::BOOL && kind != Runtime::SereTypeKind::STRING &&
+                    kind != Runtime::SereTypeKind::DYNAMIC)
+                    throw std::runtime_error("Argument " + std::to_string(i) + " of call to " + SANITIZE_NAME(expr.callee.lexeme) +
+                                             " has no value type (" + Runtime::to_string(kind) + ").");
+                params.push_back(kind);
+            }
+            callee = statements->specialize(func, params);
+        }
+
         llvm::FunctionType *func_type = callee->getFunctionType();
         unsigned expected_count = func_type->getNumParams();
         bool isVarArg = func_type->isVarArg();
@@ -501,30 +1129,116 @@ namespace SereParser
             throw std::runtime_error("argument count mismatch in function call to " + SANITIZE_NAME(expr.callee.lexeme));
         }
 
+        auto signature = RT::signatures.find(callee->getName().str());
+        const Runtime::FunctionSignature *sig = signature != RT::signatures.end() ? &signature->second : nullptr;
+
+        // Arguments convert like assignments: losslessly, or literals that fit
         std::vector<llvm::Value*> argsV;
-        for (const auto& argExpr : expr.arguments) {
-            auto argVal = argExpr->accept(*this);
+        for (unsigned i = 0; i < expr.arguments.size(); ++i) {
+            SereObject &argVal = values[i];
             llvm::Value *val = argVal.getLLVMValue(&RT::ctx.llvm_ctx);
-            if (!val) {
-                throw std::runtime_error("Invalid LLVM value for argument in function call.");
+            if (i < expected_count) {
+                Runtime::SereTypeKind from = kind_of(argVal);
+                Runtime::SereTypeKind to = sig ? Runtime::kind_from_name(sig->param_types[i])
+                                               : default_kind_of(func_type->getParamType(i));
+                if (from != to) {
+                    if (!converts_implicitly(val, from, to, is_untyped_literal(*expr.arguments[i])))
+                        throw std::runtime_error("Argument " + std::to_string(i) + " of call to " + SANITIZE_NAME(expr.callee.lexeme) +
+                                                 " is " + Runtime::to_string(from) + ", expected " + Runtime::to_string(to) +
+                                                 "; convert it explicitly, e.g. " + Runtime::to_string(to) + "(x).");
+                    val = convert_value(val, from, to);
+                }
             }
             argsV.push_back(val);
         }
 
-        for (unsigned i = 0; i < expected_count; ++i) {
-            llvm::Type *expected_type = func_type->getParamType(i);
-            llvm::Value *arg_value = argsV[i];
-            if (arg_value->getType() != expected_type) {
-                throw std::runtime_error("Argument " + std::to_string(i) + " type mismatch in function call to " + SANITIZE_NAME(expr.callee.lexeme));
-            }
+        // A Sere function of constants is evaluated now when it can be (see CompileTimeEvaluator)
+        if (sig && sig->param_types.size() == argsV.size() && !callee->hasFnAttribute(llvm::Attribute::NoInline))
+        {
+            std::vector<ConstValue> constants;
+            for (unsigned i = 0; i < argsV.size(); ++i)
+                if (auto value = constant_value(argsV[i], Runtime::kind_from_name(sig->param_types[i])))
+                    constants.push_back(*value);
+            if (constants.size() == argsV.size())
+                if (auto value = CompileTimeEvaluator<R>(type_checker).call(callee->getName().str(), constants))
+                {
+                    SereObject result;
+                    result.setLLVMValue(to_constant(*value), value->kind);
+                    return result;
+                }
         }
 
         llvm::Value *call_inst = RT::ctx.builder.CreateCall(callee, argsV);
         SereObject result;
-        result.setLLVMValue(call_inst);
+        result.setLLVMValue(call_inst, sig ? Runtime::kind_from_name(sig->return_type) : default_kind_of(call_inst->getType()));
         return result;
     }
 
+    template <typename R>
+    bool ExprVisitor<R>::is_print(const CallExprAST &expr)
+    {
+        llvm::Function *callee = RT::ctx.module->getFunction(RT::resolve_function_name(expr.callee.lexeme));
+        return callee && callee->getName() == "print" && callee->hasLinkOnceODRLinkage(); // see SereLib::include_lib
+    }
+
+    //
+    // print(a, b, ...): every argument by the formatter of its type, a
+    // space between them and a newline after; an f-string argument is its
+    // parts. What is constant is formatted now. A single str keeps the
+    // library's print, which copies it and the newline in one go.
+    //
+    template <typename R>
+    R ExprVisitor<R>::visit_print(const CallExprAST &expr)
+    {
+        std::vector<SereIR::OutputPiece> pieces;
+        auto text = [&](const std::string &constant) {
+            SereIR::OutputPiece piece;
+            piece.kind = Runtime::SereTypeKind::STRING;
+            piece.constant = ConstValue::of_str(constant);
+            pieces.push_back(piece);
+        };
+        auto value = [&](const ExprAST &part) {
+            auto literal = dynamic_cast<const LiteralExprAST *>(&part);
+            if (literal && literal->value.getType() == SereObjectType::NONE)
+                return text("None");
+            SereObject object = part.accept(*this);
+            SereIR::OutputPiece piece;
+            piece.value = object.getLLVMValue(&RT::ctx.llvm_ctx);
+            if (!piece.value)
+                throw std::runtime_error("Invalid LLVM value for argument in function call.");
+            piece.kind = kind_of(object);
+            piece.constant = constant_value(piece.value, piece.kind);
+            pieces.push_back(piece);
+        };
+        for (size_t i = 0; i < expr.arguments.size(); ++i)
+        {
+            if (i > 0)
+                text(" ");
+            if (auto format = dynamic_cast<const FormatExprAST *>(expr.arguments[i].get()))
+                for (const auto &part : format->parts)
+                    value(*part);
+            else
+                value(*expr.arguments[i]);
+        }
+        text("\n");
+
+        if (pieces.size() == 2 && !pieces[0].constant && pieces[0].kind == Runtime::SereTypeKind::STRING)
+            RT::ctx.builder.CreateCall(RT::ctx.module->getFunction("print"), {pieces[0].value});
+        else
+            SereIR::emit_output(RT::ctx, pieces);
+        return SereObject();
+    }
+
+    // An f-string the constant folder could not turn into a literal
+    template <typename R>
+    R ExprVisitor<R>::visit_format(const FormatExprAST &expr) SEREPARSER_NOEXCEPT
+    {
+        ASSERT_MUST_RETURN_SERE_OBJECT;
+        SEREPARSER_UNUSED(expr);
+        throw std::runtime_error("An f-string of run-time values can only be printed (there are no run-time strings yet).");
+    }
+
+    // --- Not-yet-implemented visit_* methods ---
     template <typename R>
     R ExprVisitor<R>::visit_super(const SuperExprAST &expr) SEREPARSER_NOEXCEPT
     {
@@ -542,92 +1256,780 @@ namespace SereParser
 
     //
     // ===============================
-    // StatVisitor Implementations
+    // Local type inference
     // ===============================
     //
+    // Return types of generic functions, one tuple of parameter types at a
+    // time. A pass over the body gives every expression a type by the rules
+    // lowering uses; assignments fix variable types and each return adds a
+    // constraint, solved by unifying them (TypeChecker::unify). A recursive
+    // call first assumes nothing (UNKNOWN, which poisons what it reaches)
+    // and the pass repeats with the answer until it stops changing.
+    //
+    // The same pass finds the variables that gradual typing makes `dyn`:
+    // an unannotated variable later assigned a value its first one's type
+    // cannot hold (`x = 0` ... `x = "none yet"`). Code that reads them
+    // changes type in turn, so the pass repeats until that set is stable.
+    //
     template <typename R>
-    R StatVisitor<R>::visit_assign(const AssignStatAST &stat) SEREPARSER_NOEXCEPT
+    class TypeInference
     {
-        ASSERT_MUST_RETURN_SERE_OBJECT;
-
-        const std::string name = SANITIZE_NAME(stat.name.lexeme);
-        SereObject value = stat.initializer ? stat.initializer->accept(*expr_visitor) : SereObject();
-        llvm::Value *value_llvm = value.getLLVMValue(&RT::ctx.llvm_ctx);
-        if (!value_llvm)
+    public:
+        explicit TypeInference(std::shared_ptr<TypeChecker> checker)
+            : checker_(std::move(checker))
         {
-            throw std::runtime_error("Assign: invalid LLVM value.");
         }
 
-        llvm::Value *alloc = RT::ctx.get_named_value(name);
-
-        Runtime::SereTypeKind inferred_type = type_checker->check_literal(value);
-        llvm::Type *inferred_llvm_type = value.getLLVMValue(&RT::ctx.llvm_ctx)->getType();
-
-        if (!alloc)
+        Runtime::SereTypeKind return_kind(const FunctionStatAST &func, const std::vector<Runtime::SereTypeKind> &params)
         {
-            if (!RT::ctx.function)
-                throw std::runtime_error("Assign: No function context.");
-            llvm::IRBuilder<> tmp_builder(&RT::ctx.function->getEntryBlock(), RT::ctx.function->getEntryBlock().begin());
-
-            // Optional explicit annotation
-            if (stat.type_annotation)
+            const std::string symbol = specialization_name(SANITIZE_NAME(func.name.lexeme), params);
+            auto known = RT::signatures.find(symbol);
+            if (known != RT::signatures.end())
+                return parse_type_annotation(known->second.return_type);
+            if (func.type_annotation)
+                return parse_type_annotation(SANITIZE_NAME(func.type_annotation->name.lexeme));
+            auto assumed = assumptions_.find(symbol);
+            if (assumed != assumptions_.end())
             {
-                auto annotated_type = SANITIZE_NAME(stat.type_annotation->name.lexeme);
-                llvm::Type *annotated_llvm_type = typename_to_llvm_type(annotated_type);
-                Runtime::SereTypeKind annotated_sere_type = parse_type_annotation(annotated_type);
+                recursed_ = true;
+                return assumed->second;
+            }
 
-                if (annotated_sere_type != inferred_type)
+            Runtime::SereTypeKind kind = Runtime::SereTypeKind::UNKNOWN;
+            for (int round = 0;; ++round)
+            {
+                assumptions_[symbol] = kind;
+                Scope outer = std::move(scope_);
+                bool outer_recursed = std::exchange(recursed_, false);
+                body(func, params);
+                Runtime::SereTypeKind found = solve(func);
+                bool recursed = recursed_;
+                scope_ = std::move(outer);
+                recursed_ = outer_recursed || recursed;
+
+                if (found == kind || !recursed)
                 {
-                    throw std::runtime_error("Type annotation mismatch for variable '" + name + "'");
+                    kind = found;
+                    break;
                 }
-
-                inferred_type = annotated_sere_type;
-                inferred_llvm_type = annotated_llvm_type;
+                if (round == 8) // a lattice this small settles long before
+                    throw std::runtime_error("Cannot infer the return type of '" + func.name.lexeme + "'; annotate it.");
+                kind = found;
             }
-
-            alloc = tmp_builder.CreateAlloca(inferred_llvm_type, nullptr, name);
-            type_checker->check_assign(name, inferred_type);
-
-            RT::ctx.set_named_value(name, alloc);
+            assumptions_.erase(symbol);
+            if (kind == Runtime::SereTypeKind::UNKNOWN)
+                throw std::runtime_error("Cannot infer the return type of '" + func.name.lexeme + "' (it only returns its own result); annotate it.");
+            return kind;
         }
 
-        if (!alloc->getType()->isPointerTy()) {
-            throw std::runtime_error("Alloc for variable '" + name + "' is not a pointer type!");
+        // The variables of `func`'s body that must be `dyn` for these parameter types.
+        std::unordered_set<std::string> dynamic_variables(const FunctionStatAST &func, const std::vector<Runtime::SereTypeKind> &params)
+        {
+            Scope outer = std::move(scope_);
+            body(func, params);
+            std::unordered_set<std::string> found = std::move(scope_.dynamic);
+            scope_ = std::move(outer);
+            return found;
         }
 
-        // Cast value_llvm if necessary to match alloc type
-        llvm::Type *dest_type = alloc->getType()->getPointerElementType();
-        if (value_llvm->getType() != dest_type)
+    private:
+        // An expression's type; `literal` holds the value of an untyped literal, which may still adapt.
+        struct Typed
         {
-            // Try a basic cast — this is simplified for numeric types only
-            if (value_llvm->getType()->isIntegerTy() && dest_type->isIntegerTy())
+            Runtime::SereTypeKind kind;
+            llvm::Constant *literal = nullptr;
+        };
+
+        struct Scope
+        {
+            std::unordered_map<std::string, Runtime::SereTypeKind> variables;
+            std::vector<Typed> returns;
+            std::unordered_set<std::string> params;
+            std::unordered_set<std::string> dynamic;
+        };
+
+        // One pass over the body into a fresh scope_, repeated while variables become `dyn`.
+        void body(const FunctionStatAST &func, const std::vector<Runtime::SereTypeKind> &params)
+        {
+            std::unordered_set<std::string> dynamic;
+            for (;;)
             {
-                value_llvm = RT::ctx.builder.CreateTruncOrBitCast(value_llvm, dest_type, name + "_cast");
+                scope_ = Scope();
+                for (size_t i = 0; i < params.size(); ++i)
+                {
+                    const std::string name = SANITIZE_NAME(func.params[i]->name.lexeme);
+                    scope_.variables[name] = params[i];
+                    scope_.params.insert(name);
+                }
+                for (const std::string &name : dynamic)
+                    scope_.variables[name] = Runtime::SereTypeKind::DYNAMIC;
+                scope_.dynamic = dynamic;
+                statement(*func.body);
+                if (scope_.dynamic.size() == dynamic.size())
+                    return;
+                dynamic = scope_.dynamic;
             }
-            else if (value_llvm->getType()->isFloatingPointTy() && dest_type->isFloatingPointTy())
+        }
+
+        // The return type: non-literal returns unify, literals adapt to them when they fit.
+        Runtime::SereTypeKind solve(const FunctionStatAST &func)
+        {
+            const std::string what = "the return value of '" + func.name.lexeme + "'";
+            Runtime::SereTypeKind kind = Runtime::SereTypeKind::UNKNOWN;
+            bool any = false;
+            for (const Typed &ret : scope_.returns)
             {
-                value_llvm = RT::ctx.builder.CreateFPCast(value_llvm, dest_type, name + "_cast");
+                any = true;
+                if (!ret.literal && ret.kind != Runtime::SereTypeKind::UNKNOWN)
+                    kind = kind == Runtime::SereTypeKind::UNKNOWN ? ret.kind : checker_->unify(kind, ret.kind, what);
             }
-            else
+            for (const Typed &ret : scope_.returns)
             {
-            /*
-                llvm::errs() << "Assigning to variable '" << name << "'\n";
-                llvm::errs() << "Value type: "; value_llvm->getType()->print(llvm::errs());
-                llvm::errs() << "\nDestination type: "; dest_type->print(llvm::errs());
-                llvm::errs() << "\n";
-            */
-                throw std::runtime_error("Cannot cast value for assignment to variable '" + name + "'");
+                if (!ret.literal)
+                    continue;
+                if (kind == Runtime::SereTypeKind::UNKNOWN)
+                    kind = ret.kind;
+                else if (!converts_implicitly(ret.literal, ret.kind, kind, true))
+                    kind = checker_->unify(kind, ret.kind, what);
             }
+            return any ? kind : Runtime::SereTypeKind::NONE;
         }
 
-        RT::ctx.builder.CreateStore(value_llvm, alloc);
-        value.setLLVMValue(value_llvm);
-        return value;
-    }
+        static bool poisoned(const Typed &a, const Typed &b)
+        {
+            return a.kind == Runtime::SereTypeKind::UNKNOWN || b.kind == Runtime::SereTypeKind::UNKNOWN;
+        }
 
-    template <typename R>
-    R StatVisitor<R>::visit_expr(const ExprStatAST &stat) SEREPARSER_NOEXCEPT
-    {
+        static bool dynamic(const Typed &a, const Typed &b)
+        {
+            return a.kind == Runtime::SereTypeKind::DYNAMIC || b.kind == Runtime::SereTypeKind::DYNAMIC;
+        }
+
+        void statement(const StatAST &stat)
+        {
+            if (auto block = dynamic_cast<const BlockStatAST *>(&stat))
+            {
+                for (const auto &inner : block->statements)
+                    statement(*inner);
+            }
+            else if (auto assign = dynamic_cast<const AssignStatAST *>(&stat))
+            {
+                Typed value = expression(*assign->initializer);
+                const std::string name = SANITIZE_NAME(assign->name.lexeme);
+                auto &variable = scope_.variables.try_emplace(name, Runtime::SereTypeKind::UNKNOWN).first->second;
+                if (assign->type_annotation)
+                    variable = parse_type_annotation(SANITIZE_NAME(assign->type_annotation->name.lexeme));
+                else if (variable == Runtime::SereTypeKind::UNKNOWN)
+                    variable = value.kind; // the first assignment decides
+                else if (value.kind != Runtime::SereTypeKind::UNKNOWN && !scope_.params.count(name) &&
+                         !converts_implicitly(value.literal, value.kind, variable, value.literal != nullptr))
+                {
+                    variable = Runtime::SereTypeKind::DYNAMIC;
+                    scope_.dynamic.insert(name);
+                }
+            }
+            else if (auto branch = dynamic_cast<const IfStatAST *>(&stat))
+            {
+                statement(*branch->then_branch);
+                if (branch->else_branch)
+                    statement(*branch->else_branch);
+            }
+            else if (auto loop = dynamic_cast<const WhileStatAST *>(&stat))
+            {
+                statement(*loop->body);
+            }
+            else if (auto range = dynamic_cast<const ForStatAST *>(&stat))
+            {
+                auto &variable = scope_.variables.try_emplace(SANITIZE_NAME(range->var.lexeme), Runtime::SereTypeKind::UNKNOWN).first->second;
+                if (variable == Runtime::SereTypeKind::UNKNOWN)
+                {
+                    Runtime::SereTypeKind kind = Runtime::SereTypeKind::UNKNOWN;
+                    bool typed = false;
+                    for (const auto &bound : {range->start, range->stop, range->step})
+                    {
+                        if (!bound)
+                            continue;
+                        Typed value = expression(*bound);
+                        if (value.literal)
+                            continue;
+                        if (value.kind == Runtime::SereTypeKind::DYNAMIC)
+                            value.kind = Runtime::SereTypeKind::INT; // unboxed by visit_for
+                        kind = typed ? (poisoned({kind}, value) ? Runtime::SereTypeKind::UNKNOWN : checker_->check_binary(kind, value.kind, "range()"))
+                                     : value.kind;
+                        typed = true;
+                    }
+                    variable = typed ? kind : Runtime::SereTypeKind::INT;
+                }
+                statement(*range->body);
+            }
+            else if (auto ret = dynamic_cast<const ReturnStatAST *>(&stat))
+            {
+                if (ret->value)
+                    scope_.returns.push_back(expression(*ret->value));
+            }
+            // Expression statements, nested definitions and imports constrain nothing
+        }
+
+        Typed expression(const ExprAST &expr)
+        {
+            using Runtime::SereTypeKind;
+            if (auto literal = dynamic_cast<const LiteralExprAST *>(&expr))
+            {
+                switch (literal->value.getType())
+                {
+                case SereObjectType::INTEGER:
+                    return {literal->value.integerLiteralKind(),
+                            llvm::ConstantInt::get(llvm::Type::getInt64Ty(RT::ctx.llvm_ctx), literal->value.getInteger(), true)};
+                case SereObjectType::FLOAT:
+                    return {SereTypeKind::FLOAT, llvm::ConstantFP::get(llvm::Type::getDoubleTy(RT::ctx.llvm_ctx), literal->value.getFloat())};
+                default:
+                    return {checker_->check_literal(literal->value)};
+                }
+            }
+            if (auto group = dynamic_cast<const GroupExprAST *>(&expr))
+                return expression(*group->expr);
+            if (auto variable = dynamic_cast<const VariableExprAST *>(&expr))
+            {
+                auto found = scope_.variables.find(SANITIZE_NAME(variable->name.lexeme));
+                if (found == scope_.variables.end())
+                    throw std::runtime_error("LLVM variable '" + variable->name.lexeme + "' not found in current scope.");
+                return {found->second};
+            }
+            if (auto unary = dynamic_cast<const UnaryExprAST *>(&expr))
+            {
+                Typed operand = expression(*unary->operand);
+                if (unary->op.type == SereLexer::TokenType::TOKEN_BANG || unary->op.type == SereLexer::TokenType::TOKEN_NOT)
+                    return {SereTypeKind::BOOL};
+                if (operand.kind == SereTypeKind::UNKNOWN || operand.kind == SereTypeKind::DYNAMIC)
+                    return {operand.kind};
+                checker_->check_unary(operand.kind, unary->op.lexeme);
+                if (operand.literal && unary->op.type == SereLexer::TokenType::TOKEN_MINUS)
+                    operand.literal = Runtime::is_float(operand.kind) ? llvm::ConstantExpr::getFNeg(operand.literal)
+                                                                       : llvm::ConstantExpr::getNeg(operand.literal);
+                return operand;
+            }
+            if (auto logical = dynamic_cast<const LogicalExprAST *>(&expr))
+            {
+                Typed left = expression(*logical->left), right = expression(*logical->right);
+                if (poisoned(left, right))
+                    return {SereTypeKind::UNKNOWN};
+                return {left.kind == right.kind ? left.kind : SereTypeKind::BOOL};
+            }
+            if (auto binary = dynamic_cast<const BinaryExprAST *>(&expr))
+                return binary_expression(*binary);
+            if (auto call = dynamic_cast<const CallExprAST *>(&expr))
+                return call_expression(*call);
+            if (auto format = dynamic_cast<const FormatExprAST *>(&expr))
+            {
+                for (const auto &part : format->parts)
+                    expression(*part);
+                return {SereTypeKind::STRING};
+            }
+            throw std::runtime_error("Cannot infer the type of this expression.");
+        }
+
+        Typed binary_expression(const BinaryExprAST &expr)
+        {
+            using Runtime::SereTypeKind;
+            Typed left = expression(*expr.left), right = expression(*expr.right);
+            const SereLexer::TokenType op = expr.op.type;
+            const bool comparison = op == SereLexer::TokenType::TOKEN_LESS || op == SereLexer::TokenType::TOKEN_LESS_EQUAL ||
+                                    op == SereLexer::TokenType::TOKEN_GREATER || op == SereLexer::TokenType::TOKEN_GREATER_EQUAL ||
+                                    op == SereLexer::TokenType::TOKEN_EQUAL_EQUAL || op == SereLexer::TokenType::TOKEN_BANG_EQUAL;
+            if (poisoned(left, right))
+                return {comparison ? SereTypeKind::BOOL : SereTypeKind::UNKNOWN};
+            if (dynamic(left, right))
+                return {comparison ? SereTypeKind::BOOL : SereTypeKind::DYNAMIC};
+            if (op == SereLexer::TokenType::TOKEN_DOUBLE_STAR && Runtime::is_float(left.kind) && Runtime::is_integer(right.kind))
+                return {left.kind};
+
+            // As in visit_binary: a literal takes the other operand's type when it holds the value
+            SereTypeKind left_as = left.kind, right_as = right.kind;
+            if (left.literal && converts_implicitly(left.literal, left.kind, right.kind, true))
+                left_as = right.kind;
+            else if (right.literal && converts_implicitly(right.literal, right.kind, left.kind, true))
+                right_as = left.kind;
+            SereTypeKind kind = checker_->check_binary(left_as, right_as, expr.op.lexeme);
+            return {comparison ? SereTypeKind::BOOL : kind};
+        }
+
+        Typed call_expression(const CallExprAST &expr)
+        {
+            using Runtime::SereTypeKind;
+            const std::string symbol = RT::resolve_function_name(expr.callee.lexeme);
+            std::vector<Typed> args;
+            for (const auto &arg : expr.arguments)
+                args.push_back(expression(*arg));
+
+            auto signature = RT::signatures.find(symbol);
+            if (signature != RT::signatures.end())
+                return {parse_type_annotation(signature->second.return_type)};
+            if (llvm::Function *callee = RT::ctx.module->getFunction(symbol))
+                return {default_kind_of(callee->getReturnType())};
+            auto generic = RT::generics.find(symbol);
+            if (generic != RT::generics.end())
+            {
+                const FunctionStatAST &func = *generic->second;
+                if (args.size() != func.params.size())
+                    throw std::runtime_error("argument count mismatch in function call to " + SANITIZE_NAME(expr.callee.lexeme));
+                std::vector<SereTypeKind> params;
+                for (size_t i = 0; i < args.size(); ++i)
+                {
+                    if (func.params[i]->type_annotation)
+                        params.push_back(parse_type_annotation(SANITIZE_NAME(func.params[i]->type_annotation->name.lexeme)));
+                    else if (args[i].kind == SereTypeKind::UNKNOWN)
+                        return {SereTypeKind::UNKNOWN};
+                    else
+                        params.push_back(args[i].kind);
+                }
+                return {return_kind(func, params)};
+            }
+            SereTypeKind conversion = Runtime::kind_from_name(expr.callee.lexeme);
+            if (Runtime::is_numeric(conversion) || conversion == SereTypeKind::BOOL || conversion == SereTypeKind::DYNAMIC)
+                return {conversion};
+            throw std::runtime_error(SANITIZE_NAME(expr.callee.lexeme) + " is not defined in the current scope.");
+        }
+
+        std::shared_ptr<TypeChecker> checker_;
+        Scope scope_;
+        std::unordered_map<std::string, Runtime::SereTypeKind> assumptions_; // functions being inferred, by symbol
+        bool recursed_ = false;                                              // an assumption was used
+    };
+
+    //
+    // ===============================
+    // Compile-time evaluation
+    // ===============================
+    //
+    // A call of a Sere function whose arguments are all constants runs
+    // here, during lowering, on the function's AST, and becomes its
+    // result: configuration values and lookup tables computed in Sere cost
+    // nothing at run time. The interpreter types like lowering (literals
+    // adapt, operands promote, variables keep the types lowering gave
+    // them) and computes like the emitted code (ConstValue), so the call's
+    // value and type don't change.
+    //
+    // Only pure code runs: anything else (print and other library calls,
+    // imports, `dyn`) gives up, as do traps, STEP_BUDGET statements and
+    // expressions, or MAX_DEPTH nested calls. The call is then emitted as
+    // usual. Results, and top-level give-ups, are kept in RT::evaluations.
+    //
+    template <typename R>
+    class CompileTimeEvaluator
+    {
+    public:
+        static constexpr long STEP_BUDGET = 100000;
+        static constexpr int MAX_DEPTH = 64;
+
+        explicit CompileTimeEvaluator(std::shared_ptr<TypeChecker> checker)
+            : checker_(std::move(checker))
+        {
+        }
+
+        // `symbol(args)` with `args` of the parameter types; empty when the call must happen at run time.
+        std::optional<ConstValue> call(const std::string &symbol, const std::vector<ConstValue> &args)
+        {
+            const std::string key = call_key(symbol, args);
+            auto known = RT::evaluations.find(key);
+            if (known != RT::evaluations.end())
+                return known->second;
+            std::optional<ConstValue> result;
+            try
+            {
+                result = invoke(symbol, args);
+            }
+            catch (const GiveUp &)
+            {
+            }
+            catch (const std::runtime_error &)
+            {
+            }
+            RT::evaluations[key] = result;
+            return result;
+        }
+
+    private:
+        struct GiveUp
+        {
+        };
+
+        // A value and whether its expression is an untyped literal (ExprVisitor::is_untyped_literal)
+        struct Typed
+        {
+            ConstValue value;
+            bool literal = false;
+        };
+
+        struct Frame
+        {
+            const RT::Definition *definition;
+            Runtime::SereTypeKind return_kind;
+            std::unordered_map<std::string, ConstValue> variables;
+            std::optional<ConstValue> result;
+        };
+
+        static std::string call_key(const std::string &symbol, const std::vector<ConstValue> &args)
+        {
+            std::string key = symbol + "(";
+            for (const ConstValue &arg : args)
+                key += arg.key() + ",";
+            return key + ")";
+        }
+
+        void step()
+        {
+            if (--steps_ < 0)
+                throw GiveUp();
+        }
+
+        static ConstValue converted(const ConstValue &value, Runtime::SereTypeKind to)
+        {
+            if (value.kind == Runtime::SereTypeKind::DYNAMIC || to == Runtime::SereTypeKind::DYNAMIC)
+                throw GiveUp();
+            auto result = const_convert(value, to);
+            if (!result)
+                throw GiveUp();
+            return *result;
+        }
+
+        ConstValue invoke(const std::string &symbol, const std::vector<ConstValue> &args)
+        {
+            step();
+            auto known = RT::evaluations.find(call_key(symbol, args));
+            if (known != RT::evaluations.end() && known->second)
+                return *known->second;
+            auto definition = RT::definitions.find(symbol); // only complete (lowered) bodies are listed
+            auto signature = RT::signatures.find(symbol);
+            if (definition == RT::definitions.end() || signature == RT::signatures.end() || depth_ >= MAX_DEPTH)
+                throw GiveUp();
+            const FunctionStatAST &func = *definition->second.ast;
+            for (const auto &variable : definition->second.variables)
+                if (variable.second == Runtime::SereTypeKind::DYNAMIC)
+                    throw GiveUp();
+
+            Frame frame{&definition->second, Runtime::kind_from_name(signature->second.return_type), {}, std::nullopt};
+            if (!Runtime::is_numeric(frame.return_kind) && frame.return_kind != Runtime::SereTypeKind::BOOL &&
+                frame.return_kind != Runtime::SereTypeKind::STRING)
+                throw GiveUp();
+            for (size_t i = 0; i < func.params.size() && i < args.size(); ++i)
+                frame.variables[SANITIZE_NAME(func.params[i]->name.lexeme)] = args[i];
+
+            ++depth_;
+            execute(*func.body, frame);
+            --depth_;
+            if (!frame.result)
+            {
+                // Falling off the end returns zero (see StatVisitor::lower_function)
+                if (frame.return_kind == Runtime::SereTypeKind::STRING)
+                    throw GiveUp();
+                frame.result = converted(ConstValue::of_int(Runtime::SereTypeKind::INT, 0), frame.return_kind);
+            }
+            RT::evaluations[call_key(symbol, args)] = frame.result;
+            return *frame.result;
+        }
+
+        Runtime::SereTypeKind variable_kind(const Frame &frame, const std::string &name) const
+        {
+            auto found = frame.definition->variables.find(name);
+            if (found == frame.definition->variables.end())
+                throw GiveUp();
+            return found->second;
+        }
+
+        // Runs `stat`; true once the function has returned
+        bool execute(const StatAST &stat, Frame &frame)
+        {
+            step();
+            if (auto block = dynamic_cast<const BlockStatAST *>(&stat))
+            {
+                for (const auto &inner : block->statements)
+                    if (execute(*inner, frame))
+                        return true;
+                return false;
+            }
+            if (auto expr_stat = dynamic_cast<const ExprStatAST *>(&stat))
+            {
+                evaluate(*expr_stat->expr, frame);
+                return false;
+            }
+            if (auto assign = dynamic_cast<const AssignStatAST *>(&stat))
+            {
+                if (!assign->initializer)
+                    throw GiveUp();
+                const std::string name = SANITIZE_NAME(assign->name.lexeme);
+                frame.variables[name] = converted(evaluate(*assign->initializer, frame).value, variable_kind(frame, name));
+                return false;
+            }
+            if (auto branch = dynamic_cast<const IfStatAST *>(&stat))
+            {
+                if (evaluate(*branch->condition, frame).value.truth())
+                    return execute(*branch->then_branch, frame);
+                return branch->else_branch && execute(*branch->else_branch, frame);
+            }
+            if (auto loop = dynamic_cast<const WhileStatAST *>(&stat))
+            {
+                while (evaluate(*loop->condition, frame).value.truth())
+                    if (execute(*loop->body, frame))
+                        return true;
+                return false;
+            }
+            if (auto range = dynamic_cast<const ForStatAST *>(&stat))
+                return execute_for(*range, frame);
+            if (auto ret = dynamic_cast<const ReturnStatAST *>(&stat))
+            {
+                if (!ret->value)
+                    throw GiveUp();
+                frame.result = converted(evaluate(*ret->value, frame).value, frame.return_kind);
+                return true;
+            }
+            throw GiveUp(); // nested definitions, imports, classes
+        }
+
+        // The trip count and induction of StatVisitor::visit_for, in the loop variable's type
+        bool execute_for(const ForStatAST &range, Frame &frame)
+        {
+            const std::string name = SANITIZE_NAME(range.var.lexeme);
+            const Runtime::SereTypeKind kind = variable_kind(frame, name);
+            ConstValue start = converted(evaluate(*range.start, frame).value, kind);
+            ConstValue stop = converted(evaluate(*range.stop, frame).value, kind);
+            ConstValue step_value = range.step ? converted(evaluate(*range.step, frame).value, kind)
+                                               : ConstValue::of_int(kind, 1);
+            if (step_value.bits == 0)
+                throw GiveUp(); // traps
+            const bool descending = Runtime::is_signed(kind) && step_value.as_signed() < 0;
+            const bool nonempty = descending ? start.as_signed() > stop.as_signed()
+                                             : (Runtime::is_signed(kind) ? start.as_signed() < stop.as_signed() : start.bits < stop.bits);
+            if (!nonempty)
+                return false;
+            const ConstValue distance = ConstValue::of_int(kind, descending ? start.bits - stop.bits : stop.bits - start.bits);
+            const ConstValue magnitude = ConstValue::of_int(kind, descending ? 0 - step_value.bits : step_value.bits);
+            const uint64_t trips = (distance.bits - 1) / magnitude.bits + 1;
+
+            ConstValue value = start;
+            for (uint64_t trip = 0; trip < trips; ++trip)
+            {
+                frame.variables[name] = value;
+                if (execute(*range.body, frame))
+                    return true;
+                value = ConstValue::of_int(kind, value.bits + step_value.bits);
+            }
+            return false;
+        }
+
+        Typed evaluate(const ExprAST &expr, Frame &frame)
+        {
+            step();
+            if (auto literal = dynamic_cast<const LiteralExprAST *>(&expr))
+            {
+                switch (literal->value.getType())
+                {
+                case SereObjectType::INTEGER:
+                    return {ConstValue::of_int(literal->value.integerLiteralKind(), static_cast<uint64_t>(literal->value.getInteger())), true};
+                case SereObjectType::FLOAT:
+                    return {ConstValue::of_float(Runtime::SereTypeKind::FLOAT, literal->value.getFloat()), true};
+                case SereObjectType::BOOLEAN:
+                    return {ConstValue::of_bool(literal->value.getBoolean())};
+                case SereObjectType::STRING:
+                    return {ConstValue::of_str(literal->value.getString())};
+                default:
+                    throw GiveUp();
+                }
+            }
+            if (auto variable = dynamic_cast<const VariableExprAST *>(&expr))
+            {
+                auto found = frame.variables.find(SANITIZE_NAME(variable->name.lexeme));
+                if (found == frame.variables.end())
+                    throw GiveUp(); // not assigned on this path
+                return {found->second};
+            }
+            if (auto group = dynamic_cast<const GroupExprAST *>(&expr))
+                return evaluate(*group->expr, frame);
+            if (auto unary = dynamic_cast<const UnaryExprAST *>(&expr))
+            {
+                Typed operand = evaluate(*unary->operand, frame);
+                switch (unary->op.type)
+                {
+                case SereLexer::TokenType::TOKEN_MINUS:
+                    if (RT::ctx.checked_arith && const_negate_overflows(operand.value))
+                        throw GiveUp(); // traps when run
+                    if (auto negated = const_negate(operand.value))
+                        return {*negated, operand.literal};
+                    throw GiveUp();
+                case SereLexer::TokenType::TOKEN_PLUS:
+                    if (!Runtime::is_numeric(operand.value.kind))
+                        throw GiveUp();
+                    return operand;
+                case SereLexer::TokenType::TOKEN_BANG:
+                case SereLexer::TokenType::TOKEN_NOT:
+                    return {ConstValue::of_bool(!operand.value.truth())};
+                default:
+                    throw GiveUp();
+                }
+            }
+            if (auto binary = dynamic_cast<const BinaryExprAST *>(&expr))
+                return evaluate_binary(*binary, frame);
+            if (auto logical = dynamic_cast<const LogicalExprAST *>(&expr))
+            {
+                // The operand that decides, or both truth values when their types differ (ExprVisitor::visit_logical)
+                const bool is_and = logical->op.type == SereLexer::TokenType::TOKEN_AND;
+                Typed left = evaluate(*logical->left, frame);
+                const bool decided = left.value.truth() != is_and;
+                if (decided && left.value.kind == Runtime::SereTypeKind::BOOL)
+                    return {left.value};
+                Typed right = evaluate(*logical->right, frame);
+                if (right.value.kind != left.value.kind)
+                    return {ConstValue::of_bool(decided ? left.value.truth() : right.value.truth())};
+                return {decided ? left.value : right.value};
+            }
+            if (auto call = dynamic_cast<const CallExprAST *>(&expr))
+                return evaluate_call(*call, frame);
+            throw GiveUp();
+        }
+
+        // ExprVisitor::visit_binary without the IR
+        Typed evaluate_binary(const BinaryExprAST &expr, Frame &frame)
+        {
+            Typed left = evaluate(*expr.left, frame);
+            Typed right = evaluate(*expr.right, frame);
+            Runtime::SereTypeKind left_kind = left.value.kind, right_kind = right.value.kind;
+            std::optional<ConstValue> result;
+            if (expr.op.type == SereLexer::TokenType::TOKEN_DOUBLE_STAR && Runtime::is_float(left_kind) && Runtime::is_integer(right_kind))
+                result = const_binary(expr.op.type, left.value, right.value, right.literal);
+            else
+            {
+                Runtime::SereTypeKind left_as = left_kind, right_as = right_kind;
+                if (left.literal && const_fits(left.value, right_kind))
+                    left_as = right_kind;
+                else if (right.literal && const_fits(right.value, left_kind))
+                    right_as = left_kind;
+                Runtime::SereTypeKind kind = checker_->check_binary(left_as, right_as, expr.op.lexeme);
+                ConstValue a = converted(left.value, kind), b = converted(right.value, kind);
+                if (RT::ctx.checked_arith && const_overflows(expr.op.type, a, b))
+                    throw GiveUp(); // traps when run
+                result = const_binary(expr.op.type, a, b, right.literal);
+            }
+            if (!result)
+                throw GiveUp();
+            return {*result};
+        }
+
+        // Sere functions and `T(x)` conversions; everything else has effects or is out of reach
+        Typed evaluate_call(const CallExprAST &expr, Frame &frame)
+        {
+            const std::string symbol = RT::resolve_function_name(expr.callee.lexeme);
+            const bool defined = RT::ctx.module->getFunction(symbol) != nullptr;
+            auto generic = RT::generics.find(symbol);
+            const bool is_generic = !defined && generic != RT::generics.end();
+
+            std::vector<ConstValue> args;
+            for (const auto &argument : expr.arguments)
+                args.push_back(evaluate(*argument, frame).value);
+
+            Runtime::SereTypeKind conversion = Runtime::kind_from_name(expr.callee.lexeme);
+            if (!defined && !is_generic && (Runtime::is_numeric(conversion) || conversion == Runtime::SereTypeKind::BOOL))
+            {
+                if (args.size() != 1)
+                    throw GiveUp();
+                return {converted(args[0], conversion)};
+            }
+
+            std::string callee = symbol;
+            if (is_generic)
+            {
+                const FunctionStatAST &func = *generic->second;
+                if (func.params.size() != args.size())
+                    throw GiveUp();
+                std::vector<Runtime::SereTypeKind> params;
+                for (size_t i = 0; i < args.size(); ++i)
+                    params.push_back(func.params[i]->type_annotation
+                                         ? parse_type_annotation(SANITIZE_NAME(func.params[i]->type_annotation->name.lexeme))
+                                         : args[i].kind);
+                callee = specialization_name(symbol, params);
+            }
+            auto signature = RT::signatures.find(callee);
+            if (signature == RT::signatures.end() || signature->second.param_types.size() != args.size())
+                throw GiveUp();
+            for (size_t i = 0; i < args.size(); ++i)
+                args[i] = converted(args[i], Runtime::kind_from_name(signature->second.param_types[i]));
+            return {invoke(callee, args)};
+        }
+
+        std::shared_ptr<TypeChecker> checker_;
+        long steps_ = STEP_BUDGET;
+        int depth_ = 0;
+    };
+
+    //
+    // ===============================
+    // StatVisitor Implementations
+    // ===============================
+    //
+    template <typename R>
+    R StatVisitor<R>::visit_assign(const AssignStatAST &stat) SEREPARSER_NOEXCEPT
+    {
+        ASSERT_MUST_RETURN_SERE_OBJECT;
+
+        const std::string name = SANITIZE_NAME(stat.name.lexeme);
+        SereObject value = stat.initializer ? stat.initializer->accept(*expr_visitor) : SereObject();
+        llvm::Value *value_llvm = value.getLLVMValue(&RT::ctx.llvm_ctx);
+        if (!value_llvm)
+        {
+            throw std::runtime_error("Assign: invalid LLVM value.");
+        }
+
+        llvm::Type *dest_type = RT::ctx.variable_type(name);
+        Runtime::SereTypeKind value_kind = kind_of(value);
+        Runtime::SereTypeKind dest_kind;
+
+        if (!dest_type)
+        {
+            if (!RT::ctx.function)
+                throw std::runtime_error("Assign: No function context.");
+
+            // A variable has the type of its annotation, else of its first value (or is `dyn`, see TypeInference)
+            dest_kind = type_checker->dynamic_variables.count(name) ? Runtime::SereTypeKind::DYNAMIC : value_kind;
+            if (stat.type_annotation)
+            {
+                dest_kind = parse_type_annotation(SANITIZE_NAME(stat.type_annotation->name.lexeme));
+                if (dest_kind == Runtime::SereTypeKind::UNKNOWN)
+                    throw std::runtime_error("Unknown type '" + stat.type_annotation->name.lexeme + "' for variable '" + name + "'.");
+            }
+            dest_type = typekind_to_llvm_type(dest_kind);
+            type_checker->check_assign(name, dest_kind);
+
+            RT::ctx.declare_variable(name, dest_type);
+        }
+        else
+        {
+            dest_kind = type_checker->check_variable(name);
+            if (dest_kind == Runtime::SereTypeKind::UNKNOWN)
+                dest_kind = default_kind_of(dest_type);
+        }
+
+        // Only conversions that lose nothing happen implicitly
+        if (value_kind != dest_kind)
+        {
+            const bool literal = stat.initializer && ExprVisitor<R>::is_untyped_literal(*stat.initializer);
+            if (literal && Runtime::is_numeric(dest_kind) && !converts_implicitly(value_llvm, value_kind, dest_kind, true))
+                throw std::runtime_error("Literal assigned to '" + name + "' does not fit in " + Runtime::to_string(dest_kind) + ".");
+            if (!converts_implicitly(value_llvm, value_kind, dest_kind, literal))
+                throw std::runtime_error("Cannot assign " + Runtime::to_string(value_kind) + " to variable '" + name + "' of type " +
+                                         Runtime::to_string(dest_kind) + "; convert explicitly, e.g. " +
+                                         Runtime::to_string(dest_kind) + "(x).");
+            value_llvm = convert_value(value_llvm, value_kind, dest_kind);
+        }
+
+        // A new SSA value for the variable; no memory is involved
+        if (!value_llvm->hasName() && llvm::isa<llvm::Instruction>(value_llvm))
+            value_llvm->setName(name);
+        RT::ctx.assign_variable(name, value_llvm);
+        value.setLLVMValue(value_llvm, dest_kind);
+        return value;
+    }
+
+    template <typename R>
+    R StatVisitor<R>::visit_expr(const ExprStatAST &stat) SEREPARSER_NOEXCEPT
+    {
         ASSERT_MUST_RETURN_SERE_OBJECT;
         if (!stat.expr)
             throw std::invalid_argument("ExprStatAST: expr is null.");
@@ -637,21 +2039,15 @@ namespace SereParser
     template <typename R>
     R StatVisitor<R>::visit_block(const BlockStatAST &stat) SEREPARSER_NOEXCEPT
     {
-        // Never push/pop scope for the outermost block!
-        static bool seen_first_block = false;
-        bool should_push = seen_first_block;
-        if (!seen_first_block)
-            seen_first_block = true;
-
-        if (should_push)
-            type_checker->push_scope();
+        // Blocks don't open a scope: as in Python, a variable belongs to its function
         SereObject last_value;
         for (auto &statement : stat.statements)
         {
+            // Nothing after a return runs
+            if (RT::ctx.builder.GetInsertBlock()->getTerminator())
+                break;
             last_value = statement->accept(*this);
         }
-        if (should_push)
-            type_checker->pop_scope();
         return last_value;
     }
 
@@ -675,91 +2071,466 @@ namespace SereParser
             func_name = "__main__";
         func_name = SANITIZE_NAME(func_name);
 
-        std::vector<llvm::Type *> arg_types;
-        for (const auto &param : func.params)
+        // Nothing is emitted for a generic function until a call gives it types
+        if (func.is_generic())
         {
-            if (!param->type_annotation)
-                throw std::runtime_error("Function parameter '" + param->name.lexeme + "' is missing type annotation.");
-
-            llvm::Type *kind = typename_to_llvm_type(SANITIZE_NAME(param->type_annotation->name.lexeme));
-            if (!kind)
-            {
-                throw std::runtime_error("Function parameter '" + param->name.lexeme + "' has an invalid type.");
-            }
-            arg_types.push_back(kind);
+            if (is_main)
+                throw std::runtime_error("main() cannot have untyped parameters.");
+            RT::generics[func_name] = &func;
+            return SereObject();
         }
-        llvm::Type *return_type = llvm::Type::getVoidTy(RT::ctx.llvm_ctx);
-        if (func.type_annotation)
+
+        Runtime::FunctionSignature signature;
+        signature.name = func.name.lexeme;
+        for (const auto &param : func.params)
+            signature.param_types.push_back(SANITIZE_NAME(param->type_annotation->name.lexeme));
+        signature.return_type = func.type_annotation ? SANITIZE_NAME(func.type_annotation->name.lexeme) : "none";
+
+        bool external = is_main || (RT::exports && Runtime::is_exported_name(func.name.lexeme));
+        llvm::Function *llvm_func = lower_function(func, func_name, signature, external);
+        if (is_main)
+            RT::ctx.entry_point = llvm_func;
+
+        SereObject obj;
+        obj.setLLVMValue(llvm_func);
+        return obj;
+    }
+
+    //
+    // The specialization of generic `func` for parameters of types `params`,
+    // emitted on first use. Its symbol spells the types (`add.i32.float`),
+    // so each distinct tuple is lowered once per module.
+    //
+    template <typename R>
+    llvm::Function *StatVisitor<R>::specialize(const FunctionStatAST &func, const std::vector<Runtime::SereTypeKind> &params)
+    {
+        const std::string symbol = specialization_name(SANITIZE_NAME(func.name.lexeme), params);
+        if (llvm::Function *existing = RT::ctx.module->getFunction(symbol))
+            return existing;
+
+        Runtime::FunctionSignature signature;
+        signature.name = func.name.lexeme;
+        for (Runtime::SereTypeKind kind : params)
+            signature.param_types.push_back(Runtime::to_string(kind));
+        signature.return_type = func.type_annotation ? SANITIZE_NAME(func.type_annotation->name.lexeme)
+                                                     : Runtime::to_string(TypeInference<R>(type_checker).return_kind(func, params));
+        return lower_function(func, symbol, signature, false);
+    }
+
+    // Emits `func`'s body as `symbol` with the types of `signature`.
+    template <typename R>
+    llvm::Function *StatVisitor<R>::lower_function(const FunctionStatAST &func, const std::string &symbol,
+                                                   const Runtime::FunctionSignature &signature, bool external)
+    {
+        std::vector<llvm::Type *> arg_types;
+        for (size_t idx = 0; idx < func.params.size(); ++idx)
         {
-            return_type = typename_to_llvm_type(SANITIZE_NAME(func.type_annotation->name.lexeme));
-            if (!return_type)
-            {
-                throw std::runtime_error("Function return type '" + func.type_annotation->name.lexeme + "' is invalid.");
-            }
+            Runtime::SereTypeKind kind = parse_type_annotation(signature.param_types[idx]);
+            if (kind == Runtime::SereTypeKind::UNKNOWN || kind == Runtime::SereTypeKind::NONE)
+                throw std::runtime_error("Function parameter '" + func.params[idx]->name.lexeme + "' has an invalid type.");
+            arg_types.push_back(typekind_to_llvm_type(kind));
         }
+        if (parse_type_annotation(signature.return_type) == Runtime::SereTypeKind::UNKNOWN)
+            throw std::runtime_error("Function return type '" + signature.return_type + "' is invalid.");
+        llvm::Type *return_type = typename_to_llvm_type(signature.return_type);
+        RT::signatures[symbol] = signature; // before the body, for recursive calls
         llvm::FunctionType *func_type = llvm::FunctionType::get(
             return_type, arg_types, false // Not varargs
         );
 
-        llvm::Function *llvm_func = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, func_name, RT::ctx.module.get());
+        llvm::Function *llvm_func = llvm::Function::Create(
+            func_type, external ? llvm::Function::ExternalLinkage : llvm::Function::InternalLinkage,
+            symbol, RT::ctx.module.get());
 
-        if (is_main)
-            RT::ctx.entry_point = llvm_func;
+        // Top-level code (or the caller of a specialization) continues afterwards
+        llvm::BasicBlock *outer_block = RT::ctx.builder.GetInsertBlock();
+        std::shared_ptr<Runtime::TypeEnvironment> outer_env = type_checker->env;
+        llvm::Function *outer_function = RT::ctx.function;
+        SereIR::LoopHints outer_hints = RT::ctx.loop_hints;
+        llvm::FastMathFlags outer_fast_math = RT::ctx.builder.getFastMathFlags();
+        RT::ctx.loop_hints = SereIR::LoopHints();
+        RT::ctx.builder.clearFastMathFlags();
 
-        llvm::BasicBlock *entry = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "entry", llvm_func);
-        RT::ctx.builder.SetInsertPoint(entry);
-        RT::ctx.function = llvm_func;
+        for (const auto &decorator : func.decorators)
+        {
+            const std::string where = "'@" + decorator.name + "' on function '" + func.name.lexeme + "'";
+            auto arguments = [&](size_t most) {
+                if (decorator.args.size() > most)
+                    throw std::runtime_error("Too many arguments to " + where + ".");
+                for (int arg : decorator.args)
+                    if (arg < 1) throw std::runtime_error("Arguments to " + where + " must be positive.");
+            };
+            auto conflicts = [&](const char *other) {
+                if (func.has_decorator(other))
+                    throw std::runtime_error("Decorator " + where + " conflicts with '@" + other + "'.");
+            };
+            arguments(decorator.name == "unroll" || decorator.name == "vectorize" ? 1 : 0);
+
+            if (decorator.name == "multiversion")
+                llvm_func->addFnAttr("sere-multiversion"); // cloned per ISA level at emission
+            else if (decorator.name == "inline")
+            {
+                conflicts("noinline");
+                llvm_func->addFnAttr(llvm::Attribute::AlwaysInline);
+            }
+            else if (decorator.name == "noinline")
+                llvm_func->addFnAttr(llvm::Attribute::NoInline);
+            else if (decorator.name == "hot")
+            {
+                conflicts("cold");
+                llvm_func->addFnAttr(llvm::Attribute::Hot);
+                llvm_func->setSectionPrefix("hot"); // .text.hot
+            }
+            else if (decorator.name == "cold")
+            {
+                // Like clang's __attribute__((cold)): out of the way and small
+                llvm_func->addFnAttr(llvm::Attribute::Cold);
+                llvm_func->addFnAttr(llvm::Attribute::OptimizeForSize);
+                llvm_func->setSectionPrefix("unlikely"); // .text.unlikely
+            }
+            else if (decorator.name == "fastmath")
+            {
+                // Flags on every float instruction of the body; attributes for the backend
+                llvm::FastMathFlags fast;
+                fast.setFast();
+                RT::ctx.builder.setFastMathFlags(fast);
+                for (const char *attr : {"unsafe-fp-math", "no-infs-fp-math", "no-nans-fp-math",
+                                         "no-signed-zeros-fp-math", "approx-func-fp-math"})
+                    llvm_func->addFnAttr(attr, "true");
+            }
+            else if (decorator.name == "unroll")
+                RT::ctx.loop_hints.unroll = decorator.args.empty() ? -1 : decorator.args[0];
+            else if (decorator.name == "vectorize")
+            {
+                int width = decorator.args.empty() ? -1 : decorator.args[0];
+                if (width > 0 && (width & (width - 1)) != 0)
+                    throw std::runtime_error("Vector width of " + where + " must be a power of two.");
+                RT::ctx.loop_hints.vectorize = width;
+            }
+            else
+                throw std::runtime_error("Unknown decorator " + where + ".");
+        }
 
-        RT::ctx.push_scope();
+        RT::ctx.function = llvm_func;
+        type_checker->set_env(RT::global_type_env);
         type_checker->push_scope();
 
-        for (unsigned idx = 0; idx < llvm_func->arg_size(); ++idx)
+        // Inference only helps here; where it gives up, lowering reports the error
+        std::vector<Runtime::SereTypeKind> param_kinds;
+        for (const std::string &param : signature.param_types)
+            param_kinds.push_back(parse_type_annotation(param));
+        std::unordered_set<std::string> outer_dynamic = std::move(type_checker->dynamic_variables);
+        try
         {
-            auto &arg = *llvm_func->getArg(idx);
-            auto param = func.params[idx];
-            const std::string param_name = SANITIZE_NAME(param->name.lexeme);
-            arg.setName(param_name);
-
-            llvm::AllocaInst *alloca = RT::ctx.builder.CreateAlloca(arg.getType(), nullptr, param_name);
-            RT::ctx.builder.CreateStore(&arg, alloca);
-            RT::ctx.set_named_value(param_name, alloca);
+            type_checker->dynamic_variables = TypeInference<R>(type_checker).dynamic_variables(func, param_kinds);
+        }
+        catch (const std::runtime_error &)
+        {
+            type_checker->dynamic_variables.clear();
         }
 
-        func.body->accept(*this);
+        // Through SIR when it models all the body does; else directly, from a clean scope
+        if (!SereSIR::Lowering<R>(*this).lower(func, symbol, signature, llvm_func))
+        {
+            type_checker->set_env(RT::global_type_env);
+            type_checker->push_scope();
 
-        llvm::BasicBlock* current_block = RT::ctx.builder.GetInsertBlock();
-        if (!current_block->getTerminator()) {
-            if (return_type->isVoidTy()) {
-                RT::ctx.builder.CreateRetVoid();
-            } else if (return_type->isIntegerTy()) {
-                RT::ctx.builder.CreateRet(llvm::ConstantInt::get(return_type, 0));
-            } else if (return_type->isFloatingPointTy()) {
-                RT::ctx.builder.CreateRet(llvm::ConstantFP::get(return_type, 0.0));
-            } else if (return_type->isPointerTy()) {
-                RT::ctx.builder.CreateRet(llvm::Constant::getNullValue(return_type));
-            } else {
-                throw std::runtime_error("Unhandled return type for default return.");
+            llvm::BasicBlock *entry = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "entry", llvm_func);
+            RT::ctx.builder.SetInsertPoint(entry);
+            RT::ctx.ssa.seal_block(entry);
+            RT::ctx.push_scope();
+
+            for (unsigned idx = 0; idx < llvm_func->arg_size(); ++idx)
+            {
+                auto &arg = *llvm_func->getArg(idx);
+                auto param = func.params[idx];
+                const std::string param_name = SANITIZE_NAME(param->name.lexeme);
+                arg.setName(param_name);
+
+                RT::ctx.declare_variable(param_name, arg.getType());
+                RT::ctx.assign_variable(param_name, &arg);
+                type_checker->check_assign(param_name, Runtime::kind_from_name(signature.param_types[idx]));
             }
-        }
-        RT::ctx.pop_scope();
-        type_checker->pop_scope();
 
-        SereObject obj;
-        obj.setLLVMValue(llvm_func);
-        return obj;
+            func.body->accept(*this);
+
+            llvm::BasicBlock* current_block = RT::ctx.builder.GetInsertBlock();
+            if (!current_block->getTerminator()) {
+                if (return_type->isVoidTy()) {
+                    RT::ctx.mark_tail_call();
+                    RT::ctx.builder.CreateRetVoid();
+                } else if (return_type->isIntegerTy()) {
+                    RT::ctx.builder.CreateRet(llvm::ConstantInt::get(return_type, 0));
+                } else if (return_type->isFloatingPointTy()) {
+                    RT::ctx.builder.CreateRet(llvm::ConstantFP::get(return_type, 0.0));
+                } else if (return_type->isPointerTy()) {
+                    RT::ctx.builder.CreateRet(llvm::Constant::getNullValue(return_type));
+                } else {
+                    throw std::runtime_error("Unhandled return type for default return.");
+                }
+            }
+            RT::definitions[symbol] = RT::Definition{&func, type_checker->env->table};
+            RT::ctx.pop_scope();
+        }
+        type_checker->set_env(outer_env);
+        type_checker->dynamic_variables = std::move(outer_dynamic);
+
+        RT::ctx.function = outer_function;
+        RT::ctx.loop_hints = outer_hints;
+        RT::ctx.builder.setFastMathFlags(outer_fast_math);
+        if (outer_block)
+            RT::ctx.builder.SetInsertPoint(outer_block);
+        return llvm_func;
     }
 
     template <typename R>
     R StatVisitor<R>::visit_if(const IfStatAST &stat) SEREPARSER_NOEXCEPT
     {
-        SEREPARSER_UNUSED(stat);
-        throw std::runtime_error("visit_if not implemented.");
+        ASSERT_MUST_RETURN_SERE_OBJECT;
+        SereObject condition_value = stat.condition->accept(*expr_visitor);
+        llvm::Value *condition = truth_of(condition_value);
+
+        llvm::Function *func = RT::ctx.builder.GetInsertBlock()->getParent();
+        llvm::BasicBlock *then_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "if.then", func);
+        llvm::BasicBlock *merge_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "if.end");
+        llvm::BasicBlock *else_block = stat.else_branch
+            ? llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "if.else") : merge_block;
+        RT::ctx.builder.CreateCondBr(condition, then_block, else_block);
+
+        // Each arm has exactly one predecessor, so it is sealed right away
+        RT::ctx.ssa.seal_block(then_block);
+        RT::ctx.builder.SetInsertPoint(then_block);
+        stat.then_branch->accept(*this);
+        if (!RT::ctx.builder.GetInsertBlock()->getTerminator())
+            RT::ctx.builder.CreateBr(merge_block);
+
+        if (stat.else_branch)
+        {
+            else_block->insertInto(func);
+            RT::ctx.ssa.seal_block(else_block);
+            RT::ctx.builder.SetInsertPoint(else_block);
+            stat.else_branch->accept(*this);
+            if (!RT::ctx.builder.GetInsertBlock()->getTerminator())
+                RT::ctx.builder.CreateBr(merge_block);
+        }
+
+        // Without predecessors (both arms return) the block stays unreachable
+        merge_block->insertInto(func);
+        RT::ctx.ssa.seal_block(merge_block);
+        RT::ctx.builder.SetInsertPoint(merge_block);
+        return SereObject();
     }
+
     template <typename R>
     R StatVisitor<R>::visit_while(const WhileStatAST &stat) SEREPARSER_NOEXCEPT
     {
-        SEREPARSER_UNUSED(stat);
-        throw std::runtime_error("visit_while not implemented.");
+        ASSERT_MUST_RETURN_SERE_OBJECT;
+        llvm::Function *func = RT::ctx.builder.GetInsertBlock()->getParent();
+        llvm::BasicBlock *cond_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "while.cond", func);
+        llvm::BasicBlock *body_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "while.body");
+        llvm::BasicBlock *end_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "while.end");
+        RT::ctx.builder.CreateBr(cond_block);
+
+        // The header stays unsealed until the back edge exists
+        RT::ctx.builder.SetInsertPoint(cond_block);
+        SereObject condition_value = stat.condition->accept(*expr_visitor);
+        llvm::Value *condition = truth_of(condition_value);
+        RT::ctx.builder.CreateCondBr(condition, body_block, end_block);
+
+        body_block->insertInto(func);
+        RT::ctx.ssa.seal_block(body_block);
+        RT::ctx.builder.SetInsertPoint(body_block);
+        stat.body->accept(*this);
+        if (!RT::ctx.builder.GetInsertBlock()->getTerminator())
+        {
+            llvm::BranchInst *back_edge = RT::ctx.builder.CreateBr(cond_block);
+            back_edge->setMetadata(llvm::LLVMContext::MD_loop, RT::ctx.loop_id(false));
+        }
+        RT::ctx.ssa.seal_block(cond_block);
+
+        end_block->insertInto(func);
+        RT::ctx.ssa.seal_block(end_block);
+        RT::ctx.builder.SetInsertPoint(end_block);
+        return SereObject();
+    }
+
+    //
+    // `for i in range(start, stop, step)` becomes a counted loop: the trip
+    // count is computed once in the preheader, a zero-based counter runs up
+    // to it and `i` is a second induction variable. The body is only
+    // entered through a guard, so the loop is already in the rotated,
+    // bottom-tested shape the vectorizer and unroller expect, and nothing
+    // is allocated for the range.
+    //
+    template <typename R>
+    R StatVisitor<R>::visit_for(const ForStatAST &stat) SEREPARSER_NOEXCEPT
+    {
+        ASSERT_MUST_RETURN_SERE_OBJECT;
+        auto &builder = RT::ctx.builder;
+        struct Bound
+        {
+            llvm::Value *value;
+            Runtime::SereTypeKind kind;
+            bool literal;
+        };
+        auto bound = [&](const std::shared_ptr<ExprAST> &expr, const char *what) {
+            SereObject object = expr->accept(*expr_visitor);
+            llvm::Value *value = object.getLLVMValue(&RT::ctx.llvm_ctx);
+            Runtime::SereTypeKind kind = kind_of(object);
+            if (value && kind == Runtime::SereTypeKind::DYNAMIC)
+            {
+                value = convert_value(value, kind, Runtime::SereTypeKind::INT);
+                kind = Runtime::SereTypeKind::INT;
+            }
+            if (!value || !Runtime::is_integer(kind))
+                throw std::runtime_error(std::string("range() ") + what + " must be an integer.");
+            return Bound{value, kind, ExprVisitor<R>::is_untyped_literal(*expr)};
+        };
+        std::vector<Bound> bounds = {bound(stat.start, "start"), bound(stat.stop, "stop")};
+        if (stat.step)
+            bounds.push_back(bound(stat.step, "step"));
+
+        // The loop runs in the bounds' common type; literals take the others' type
+        const std::string name = SANITIZE_NAME(stat.var.lexeme);
+        Runtime::SereTypeKind kind = Runtime::SereTypeKind::UNKNOWN;
+        for (const Bound &b : bounds)
+            if (!b.literal)
+                kind = kind == Runtime::SereTypeKind::UNKNOWN ? b.kind : type_checker->check_binary(kind, b.kind, "range()");
+        if (RT::ctx.variable_type(name))
+        {
+            Runtime::SereTypeKind existing = type_checker->check_variable(name);
+            if (!Runtime::is_integer(existing))
+                throw std::runtime_error("Loop variable '" + name + "' is not an integer.");
+            kind = kind == Runtime::SereTypeKind::UNKNOWN ? existing : type_checker->check_binary(kind, existing, "range()");
+            if (kind != existing)
+                throw std::runtime_error("Loop variable '" + name + "' is " + Runtime::to_string(existing) + " but range() is " +
+                                         Runtime::to_string(kind) + ".");
+        }
+        if (kind == Runtime::SereTypeKind::UNKNOWN)
+            kind = Runtime::SereTypeKind::INT;
+        for (Bound &b : bounds)
+        {
+            if (b.literal && !converts_implicitly(b.value, b.kind, kind, true))
+                throw std::runtime_error("range() bound does not fit in " + Runtime::to_string(kind) + ".");
+            b.value = convert_value(b.value, b.kind, kind);
+        }
+        llvm::Type *int_type = typekind_to_llvm_type(kind);
+        const bool is_signed = Runtime::is_signed(kind);
+        llvm::Value *start = bounds[0].value;
+        llvm::Value *stop = bounds[1].value;
+        llvm::Value *step = stat.step ? bounds[2].value : llvm::ConstantInt::get(int_type, 1);
+
+        if (!RT::ctx.variable_type(name))
+        {
+            RT::ctx.declare_variable(name, int_type);
+            type_checker->check_assign(name, kind);
+        }
+
+        llvm::Function *func = builder.GetInsertBlock()->getParent();
+        auto *step_const = llvm::dyn_cast<llvm::ConstantInt>(step);
+        if (step_const && step_const->isZero())
+            throw std::runtime_error("range() step must not be zero.");
+        if (!step_const) // Python raises ValueError
+            RT::ctx.trap_if(builder.CreateICmpEQ(step, llvm::ConstantInt::get(int_type, 0)), "for.zerostep");
+
+        llvm::Value *nonempty = SereIR::range_nonempty(RT::ctx, start, stop, step, is_signed);
+
+        llvm::BasicBlock *preheader = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "for.ph", func);
+        llvm::BasicBlock *body_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "for.body");
+        llvm::BasicBlock *latch_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "for.inc");
+        llvm::BasicBlock *end_block = llvm::BasicBlock::Create(RT::ctx.llvm_ctx, "for.end");
+        builder.CreateCondBr(nonempty, preheader, end_block);
+
+        // The trip count is computed once, before the loop (SereIR::range_trips)
+        RT::ctx.ssa.seal_block(preheader);
+        builder.SetInsertPoint(preheader);
+        llvm::Value *trips = SereIR::range_trips(RT::ctx, start, stop, step, is_signed);
+        builder.CreateBr(body_block);
+
+        body_block->insertInto(func);
+        builder.SetInsertPoint(body_block);
+        llvm::PHINode *index = builder.CreatePHI(int_type, 2, "for.index");
+        llvm::PHINode *value = builder.CreatePHI(int_type, 2, name);
+        index->addIncoming(llvm::ConstantInt::get(int_type, 0), preheader);
+        value->addIncoming(start, preheader);
+        RT::ctx.assign_variable(name, value);
+        stat.body->accept(*this);
+        if (!builder.GetInsertBlock()->getTerminator())
+            builder.CreateBr(latch_block);
+
+        latch_block->insertInto(func);
+        RT::ctx.ssa.seal_block(latch_block);
+        builder.SetInsertPoint(latch_block);
+        // The last step may leave the type's range, but its result is never used
+        llvm::Value *next_index = builder.CreateAdd(index, llvm::ConstantInt::get(int_type, 1), "for.index.next", /*HasNUW=*/true);
+        llvm::Value *next_value = builder.CreateAdd(value, step, name + ".next", /*HasNUW=*/!is_signed, /*HasNSW=*/is_signed);
+        llvm::BranchInst *back_edge = builder.CreateCondBr(builder.CreateICmpEQ(next_index, trips, "for.done"),
+                                                           end_block, body_block);
+        back_edge->setMetadata(llvm::LLVMContext::MD_loop, RT::ctx.loop_id(true));
+        index->addIncoming(next_index, latch_block);
+        value->addIncoming(next_value, latch_block);
+        RT::ctx.ssa.seal_block(body_block);
+
+        end_block->insertInto(func);
+        RT::ctx.ssa.seal_block(end_block);
+        builder.SetInsertPoint(end_block);
+        return SereObject();
+    }
+
+    template <typename R>
+    R StatVisitor<R>::visit_import(const ImportStatAST &stat) SEREPARSER_NOEXCEPT
+    {
+        ASSERT_MUST_RETURN_SERE_OBJECT;
+        auto found = RT::interfaces.find(stat.module_name);
+        if (found == RT::interfaces.end())
+            throw std::runtime_error("Cannot resolve import '" + stat.module_name + "' (imports need 'sere build').");
+        const Runtime::ModuleInterface &iface = found->second;
+
+        auto declare = [](const Runtime::FunctionSignature &sig) {
+            std::vector<llvm::Type *> arg_types;
+            for (const auto &param : sig.param_types)
+                arg_types.push_back(typename_to_llvm_type(param));
+            auto *func_type = llvm::FunctionType::get(typename_to_llvm_type(sig.return_type), arg_types, false);
+            RT::ctx.module->getOrInsertFunction(SANITIZE_NAME(sig.name), func_type);
+            RT::signatures[SANITIZE_NAME(sig.name)] = sig;
+        };
+
+        if (stat.is_from_import())
+        {
+            for (const auto &[name, alias] : stat.names)
+            {
+                const Runtime::FunctionSignature *sig = iface.find(name);
+                if (!sig)
+                    throw std::runtime_error("Module '" + stat.module_name + "' has no function '" + name + "'.");
+                declare(*sig);
+                if (alias != name)
+                    RT::function_aliases[alias] = name;
+            }
+        }
+        else
+        {
+            for (const auto &sig : iface.functions)
+                declare(sig);
+            RT::module_aliases[stat.alias] = stat.module_name;
+        }
+
+        // Small exported bodies ride along as available_externally definitions
+        // so the optimizer may inline them; only the declared ones are linked.
+        if (!iface.inline_bitcode.empty())
+        {
+            auto bodies = llvm::parseBitcodeFile(llvm::MemoryBufferRef(iface.inline_bitcode, iface.name), RT::ctx.llvm_ctx);
+            if (!bodies)
+                throw std::runtime_error("Corrupt interface for module '" + stat.module_name + "': " + llvm::toString(bodies.takeError()));
+            if (llvm::Linker::linkModules(*RT::ctx.module, std::move(*bodies), llvm::Linker::Flags::LinkOnlyNeeded))
+                throw std::runtime_error("Cannot link inlinable bodies of module '" + stat.module_name + "'.");
+            RT::ctx.constants.adopt(*RT::ctx.module);
+        }
+
+        // What the exporting module inferred; lets calls to it be hoisted and CSE'd here
+        for (const auto &sig : iface.functions)
+            if (llvm::Function *func = RT::ctx.module->getFunction(SANITIZE_NAME(sig.name)))
+                SereIR::apply_effects(*func, sig.effects);
+        return SereObject();
     }
 
     template <typename R>
@@ -776,12 +2547,30 @@ namespace SereParser
                 throw std::runtime_error("ReturnStatAST: Return value LLVM is not valid.");
             }
 
+            auto signature = RT::signatures.find(RT::ctx.function->getName().str());
+            if (signature != RT::signatures.end())
+            {
+                Runtime::SereTypeKind from = kind_of(return_value);
+                Runtime::SereTypeKind to = Runtime::kind_from_name(signature->second.return_type);
+                if (from != to && to != Runtime::SereTypeKind::NONE)
+                {
+                    if (!converts_implicitly(return_llvm, from, to, ExprVisitor<R>::is_untyped_literal(*stat.value)))
+                        throw std::runtime_error("Function '" + signature->second.name + "' returns " + Runtime::to_string(to) +
+                                                 ", not " + Runtime::to_string(from) + "; convert explicitly, e.g. " +
+                                                 Runtime::to_string(to) + "(x).");
+                    return_llvm = convert_value(return_llvm, from, to);
+                    return_value.setLLVMValue(return_llvm, to);
+                }
+            }
+
+            RT::ctx.mark_tail_call(return_llvm);
             RT::ctx.builder.CreateRet(return_llvm);
 
             return return_value;
         }
         else
         {
+            RT::ctx.mark_tail_call();
             RT::ctx.builder.CreateRetVoid();
             return SereObject(); // Return void
         }
@@ -789,4 +2578,6 @@ namespace SereParser
 
 } // namespace SereParser
 
+#include "../../SIR/Lowering.hpp"
+
 #endif // PARSER_AST_VISITOR_HPP
\ No newline at end of file
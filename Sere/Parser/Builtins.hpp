@@ -91,8 +91,8 @@ namespace BuiltIn {
     }
 
     inline llvm::Type* to_llvm_type(const SereType::Ptr& type, llvm::LLVMContext& context) {
-        if (type == INT) return llvm::Type::getInt32Ty(context);
-        if (type == FLOAT) return llvm::Type::getFloatTy(context);
+        if (type == INT) return llvm::Type::getInt64Ty(context);
+        if (type == FLOAT) return llvm::Type::getDoubleTy(context);
         if (type == BOOL) return llvm::Type::getInt1Ty(context);
         if (type == STR) return llvm::Type::getInt8PtrTy(context);
         if (type == NONE) return llvm::Type::getVoidTy(context);
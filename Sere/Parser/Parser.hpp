@@ -153,26 +153,54 @@ private:
     std::shared_ptr<StatAST> statement() {
         if (check(SereLexer::TOKEN_DEF)) {
             return funcdef_stmt();
+        } else if (check(SereLexer::TOKEN_AT)) {
+            return decorated_stmt();
         } else if (check(SereLexer::TOKEN_RETURN)) {
             return return_stmt();
         } else if (check(SereLexer::TOKEN_IF)) {
-            //return if_stmt();
+            return if_stmt();
         } else if (check(SereLexer::TOKEN_WHILE)) {
-            //return while_stmt();
+            return while_stmt();
+        } else if (check(SereLexer::TOKEN_FOR)) {
+            return for_stmt();
         } else if (check(SereLexer::TOKEN_CLASS)) {
             //return class_stmt();
         } else if (check(SereLexer::TOKEN_IMPORT) || check(SereLexer::TOKEN_FROM)) {
-            //return import_stmt();
+            return import_stmt();
         } else if (check(SereLexer::TOKEN_IDENTIFIER)) {
             if (lookAheadIs(SereLexer::TOKEN_EQUAL) || lookAheadIs(SereLexer::TOKEN_COLON)) {
                 return assignment_stmt();
             }
+            if (current_ + 1 < tokens_.size() && compound_operator(tokens_[current_ + 1]->type) != SereLexer::TOKEN_EOF) {
+                return compound_assignment_stmt();
+            }
         }
         return expr_stmt();
     }
 
     // ===================== Function Definition =====================
-    std::shared_ptr<StatAST> funcdef_stmt() {
+    // `@name` or `@name(<int>, ...)` lines, each on its own line, directly above a def.
+    std::shared_ptr<StatAST> decorated_stmt() {
+        std::vector<Decorator> decorators;
+        while (match({SereLexer::TOKEN_AT})) {
+            Decorator decorator;
+            decorator.name = consume(SereLexer::TOKEN_IDENTIFIER, "Expected decorator name after '@'.")->lexeme;
+            if (match({SereLexer::TOKEN_LEFT_PAREN})) {
+                do {
+                    decorator.args.push_back(consume(SereLexer::TOKEN_INTEGER, "Expected integer decorator argument.")->literal.INTEGER);
+                } while (match({SereLexer::TOKEN_COMMA}));
+                consume(SereLexer::TOKEN_RIGHT_PAREN, "Expected ')' after decorator arguments.");
+            }
+            decorators.push_back(std::move(decorator));
+            expectFreshLine();
+            skipNewlines();
+        }
+        if (!check(SereLexer::TOKEN_DEF))
+            throw ParserError(peek(), "Expected 'def' after decorator.");
+        return funcdef_stmt(std::move(decorators));
+    }
+
+    std::shared_ptr<StatAST> funcdef_stmt(std::vector<Decorator> decorators = {}) {
         auto def_tok = consume(SereLexer::TOKEN_DEF, "Expected 'def' keyword.");
         auto name = consume(SereLexer::TOKEN_IDENTIFIER, "Expected function name after 'def'.");
         consume(SereLexer::TOKEN_LEFT_PAREN, "Expected '(' after function name.");
@@ -196,7 +224,96 @@ private:
         }
         consume(SereLexer::TOKEN_COLON, "Expected ':' after function signature.");
         auto body = block_stmt();
-        return std::make_shared<FunctionStatAST>(*name, params, body, return_type);
+        return std::make_shared<FunctionStatAST>(*name, params, body, return_type, std::move(decorators));
+    }
+
+    // ===================== Import Statement =====================
+    std::string dotted_name(const std::string& what) {
+        std::string name = consume(SereLexer::TOKEN_IDENTIFIER, "Expected " + what + ".")->lexeme;
+        while (match({SereLexer::TOKEN_DOT})) {
+            name += "." + consume(SereLexer::TOKEN_IDENTIFIER, "Expected name after '.'.")->lexeme;
+        }
+        return name;
+    }
+
+    std::shared_ptr<StatAST> import_stmt() {
+        if (match({SereLexer::TOKEN_FROM})) {
+            std::string module_name = dotted_name("module name after 'from'");
+            consume(SereLexer::TOKEN_IMPORT, "Expected 'import' after module name.");
+            std::vector<std::pair<std::string, std::string>> names;
+            do {
+                std::string name = consume(SereLexer::TOKEN_IDENTIFIER, "Expected name to import.")->lexeme;
+                std::string alias = name;
+                if (match({SereLexer::TOKEN_AS})) {
+                    alias = consume(SereLexer::TOKEN_IDENTIFIER, "Expected alias after 'as'.")->lexeme;
+                }
+                names.emplace_back(name, alias);
+            } while (match({SereLexer::TOKEN_COMMA}));
+            expectStatementEnd();
+            return std::make_shared<ImportStatAST>(module_name, std::move(names));
+        }
+
+        consume(SereLexer::TOKEN_IMPORT, "Expected 'import' keyword.");
+        std::string module_name = dotted_name("module name after 'import'");
+        std::string alias = module_name;
+        if (match({SereLexer::TOKEN_AS})) {
+            alias = consume(SereLexer::TOKEN_IDENTIFIER, "Expected alias after 'as'.")->lexeme;
+        }
+        expectStatementEnd();
+        return std::make_shared<ImportStatAST>(module_name, alias);
+    }
+
+    // ===================== Control Flow =====================
+    // `elif` chains nest as the else branch of the preceding `if`.
+    std::shared_ptr<StatAST> if_stmt() {
+        if (!match({SereLexer::TOKEN_IF, SereLexer::TOKEN_ELIF}))
+            throw ParserError(peek(), "Expected 'if' keyword.");
+        auto condition = expression();
+        consume(SereLexer::TOKEN_COLON, "Expected ':' after condition.");
+        auto then_branch = block_stmt();
+        std::shared_ptr<StatAST> else_branch = nullptr;
+        skipNewlines();
+        if (check(SereLexer::TOKEN_ELIF)) {
+            else_branch = if_stmt();
+        } else if (match({SereLexer::TOKEN_ELSE})) {
+            consume(SereLexer::TOKEN_COLON, "Expected ':' after 'else'.");
+            else_branch = block_stmt();
+        }
+        return std::make_shared<IfStatAST>(condition, then_branch, else_branch);
+    }
+
+    std::shared_ptr<StatAST> while_stmt() {
+        consume(SereLexer::TOKEN_WHILE, "Expected 'while' keyword.");
+        auto condition = expression();
+        consume(SereLexer::TOKEN_COLON, "Expected ':' after condition.");
+        auto body = block_stmt();
+        return std::make_shared<WhileStatAST>(condition, body);
+    }
+
+    // Only `range(...)` is iterable so far: `for i in range([start,] stop[, step]):`
+    std::shared_ptr<StatAST> for_stmt() {
+        consume(SereLexer::TOKEN_FOR, "Expected 'for' keyword.");
+        auto var = consume(SereLexer::TOKEN_IDENTIFIER, "Expected loop variable after 'for'.");
+        consume(SereLexer::TOKEN_IN, "Expected 'in' after loop variable.");
+        auto iterable = consume(SereLexer::TOKEN_IDENTIFIER, "Expected 'range(...)' after 'in'.");
+        if (iterable->lexeme != "range")
+            throw ParserError(iterable, "Only 'range(...)' can be iterated.");
+        consume(SereLexer::TOKEN_LEFT_PAREN, "Expected '(' after 'range'.");
+        std::vector<std::shared_ptr<ExprAST>> args;
+        if (!check(SereLexer::TOKEN_RIGHT_PAREN)) {
+            do {
+                args.push_back(expression());
+            } while (match({SereLexer::TOKEN_COMMA}));
+        }
+        consume(SereLexer::TOKEN_RIGHT_PAREN, "Expected ')' after range arguments.");
+        if (args.empty() || args.size() > 3)
+            throw ParserError(iterable, "range() takes 1 to 3 arguments.");
+        consume(SereLexer::TOKEN_COLON, "Expected ':' after for clause.");
+        auto body = block_stmt();
+
+        if (args.size() == 1) args.insert(args.begin(), std::make_shared<LiteralExprAST>(SereObject(0)));
+        std::shared_ptr<ExprAST> step = args.size() == 3 ? args[2] : nullptr;
+        return std::make_shared<ForStatAST>(*var, args[0], args[1], step, body);
     }
 
     // ===================== Return Statement =====================
@@ -242,6 +359,31 @@ private:
         return std::make_shared<AssignStatAST>(*name, value, type);
     }
 
+    // `x op= e` is `x = x op e`; the variable is read once.
+    static SereLexer::TokenType compound_operator(SereLexer::TokenType type) {
+        switch (type) {
+            case SereLexer::TOKEN_PLUS_EQUAL:         return SereLexer::TOKEN_PLUS;
+            case SereLexer::TOKEN_MINUS_EQUAL:        return SereLexer::TOKEN_MINUS;
+            case SereLexer::TOKEN_STAR_EQUAL:         return SereLexer::TOKEN_STAR;
+            case SereLexer::TOKEN_SLASH_EQUAL:        return SereLexer::TOKEN_SLASH;
+            case SereLexer::TOKEN_DOUBLE_SLASH_EQUAL: return SereLexer::TOKEN_DOUBLE_SLASH;
+            case SereLexer::TOKEN_PERCENT_EQUAL:      return SereLexer::TOKEN_PERCENT;
+            case SereLexer::TOKEN_DOUBLE_STAR_EQUAL:  return SereLexer::TOKEN_DOUBLE_STAR;
+            default:                                  return SereLexer::TOKEN_EOF;
+        }
+    }
+
+    std::shared_ptr<StatAST> compound_assignment_stmt() {
+        auto name = consume(SereLexer::TOKEN_IDENTIFIER, "Expected variable name.");
+        auto op_tok = advance();
+        std::string lexeme = op_tok->lexeme.substr(0, op_tok->lexeme.size() - 1); // "+=" -> "+"
+        SereLexer::TokenBase op(compound_operator(op_tok->type), lexeme, op_tok->literal, op_tok->line, op_tok->column);
+        auto value = expression();
+        expectStatementEnd();
+        auto target = std::make_shared<VariableExprAST>(*name);
+        return std::make_shared<AssignStatAST>(*name, std::make_shared<BinaryExprAST>(op, target, value));
+    }
+
     // ===================== Expression Statement =====================
     std::shared_ptr<StatAST> expr_stmt() {
         auto expr = expression();
@@ -256,7 +398,7 @@ private:
         while (match({SereLexer::TOKEN_OR})) {
             auto op = previous();
             auto right = and_test();
-            expr = std::make_shared<BinaryExprAST>(op.get(), expr, right);
+            expr = std::make_shared<LogicalExprAST>(op.get(), expr, right);
         }
         return expr;
     }
@@ -265,7 +407,7 @@ private:
         while (match({SereLexer::TOKEN_AND})) {
             auto op = previous();
             auto right = not_test();
-            expr = std::make_shared<BinaryExprAST>(op.get(), expr, right);
+            expr = std::make_shared<LogicalExprAST>(op.get(), expr, right);
         }
         return expr;
     }
@@ -299,7 +441,8 @@ private:
     }
     std::shared_ptr<ExprAST> term() {
         auto expr = factor();
-        while (match({SereLexer::TOKEN_STAR, SereLexer::TOKEN_SLASH})) {
+        while (match({SereLexer::TOKEN_STAR, SereLexer::TOKEN_SLASH,
+                      SereLexer::TOKEN_DOUBLE_SLASH, SereLexer::TOKEN_PERCENT})) {
             auto op = previous();
             auto right = factor();
             expr = std::make_shared<BinaryExprAST>(op.get(), expr, right);
@@ -316,13 +459,28 @@ private:
     }
     std::shared_ptr<ExprAST> power() {
         auto expr = call();
-        // "**" operator could be added here if needed
+        // Right-associative and tighter than a unary minus on its left: -2**2 == -4
+        if (match({SereLexer::TOKEN_DOUBLE_STAR})) {
+            auto op = previous();
+            auto right = factor();
+            expr = std::make_shared<BinaryExprAST>(op.get(), expr, right);
+        }
         return expr;
     }
     std::shared_ptr<ExprAST> call() {
         
         if (match({SereLexer::TOKEN_IDENTIFIER})) {
             auto callee = *previous();
+            // Qualified call through an imported module: `mod.fn(...)`
+            if (check(SereLexer::TOKEN_DOT) && lookAheadIs(SereLexer::TOKEN_IDENTIFIER)) {
+                std::string qualified = callee.lexeme;
+                while (check(SereLexer::TOKEN_DOT) && lookAheadIs(SereLexer::TOKEN_IDENTIFIER)) {
+                    advance();
+                    qualified += "." + advance()->lexeme;
+                }
+                consume(SereLexer::TOKEN_LEFT_PAREN, "Expected '(' after qualified name.");
+                return finish_call(SereLexer::TokenBase(SereLexer::TOKEN_IDENTIFIER, qualified, callee.literal, callee.line, callee.column));
+            }
             while (true) {
                 if (match({SereLexer::TOKEN_LEFT_PAREN})) {
                     return finish_call(callee);
@@ -349,9 +507,14 @@ private:
         if (match({SereLexer::TOKEN_TRUE})) return std::make_shared<LiteralExprAST>(SereObject(true));
         if (match({SereLexer::TOKEN_FALSE})) return std::make_shared<LiteralExprAST>(SereObject(false));
         if (match({SereLexer::TOKEN_NONE})) return std::make_shared<LiteralExprAST>(SereObject());
-        if (match({SereLexer::TOKEN_INTEGER})) return std::make_shared<LiteralExprAST>(SereObject(previous()->literal.INTEGER));
+        if (match({SereLexer::TOKEN_INTEGER})) {
+            SereObject value(previous()->literal.INTEGER);
+            if (previous()->literal.INTEGER_U64) value.setKind(Runtime::SereTypeKind::U64);
+            return std::make_shared<LiteralExprAST>(value);
+        }
         if (match({SereLexer::TOKEN_FLOAT}))   return std::make_shared<LiteralExprAST>(SereObject(previous()->literal.FLOAT));
         if (match({SereLexer::TOKEN_STRING}))  return std::make_shared<LiteralExprAST>(SereObject(previous()->literal.STRING));
+        if (match({SereLexer::TOKEN_FSTRING})) return fstring(previous());
         if (match({SereLexer::TOKEN_IDENTIFIER})) {return std::make_shared<VariableExprAST>(*previous());}
         if (match({SereLexer::TOKEN_LEFT_PAREN})) {
             auto expr = expression();
@@ -360,6 +523,62 @@ private:
         }
         throw ParserError(peek(), "Expected expression.");
     }
+
+    // f"...": the text around the replacement fields as str literals, `{{` and `}}` as braces, and each field's expression
+    std::shared_ptr<ExprAST> fstring(const std::shared_ptr<SereLexer::TokenBase>& token) {
+        const std::string body = token->literal.STRING;
+        std::vector<std::shared_ptr<ExprAST>> parts;
+        std::string text;
+        for (size_t i = 0; i < body.size(); ++i) {
+            const char c = body[i];
+            if ((c == '{' || c == '}') && i + 1 < body.size() && body[i + 1] == c) {
+                text += c;
+                ++i;
+                continue;
+            }
+            SERE_ASSERT(c != '}', token, "Single '}' in f-string.");
+            if (c != '{') {
+                text += c;
+                continue;
+            }
+            size_t end = i + 1;
+            int depth = 1;
+            char nested = 0;
+            for (; end < body.size(); ++end) {
+                const char d = body[end];
+                if (nested) {
+                    if (d == nested) nested = 0;
+                } else if (d == '\'' || d == '"') {
+                    nested = d;
+                } else if (d == '{') {
+                    ++depth;
+                } else if (d == '}' && --depth == 0) {
+                    break;
+                } else if (d == ':' && depth == 1) {
+                    throw ParserError(token, "Format specs in f-strings are not supported.");
+                }
+            }
+            SERE_ASSERT(end < body.size(), token, "Expected '}' in f-string.");
+            if (!text.empty()) parts.push_back(std::make_shared<LiteralExprAST>(SereObject(text)));
+            text.clear();
+            parts.push_back(fstring_field(token, body.substr(i + 1, end - i - 1)));
+            i = end;
+        }
+        if (!text.empty()) parts.push_back(std::make_shared<LiteralExprAST>(SereObject(text)));
+        return std::make_shared<FormatExprAST>(std::move(parts));
+    }
+
+    // The expression of a replacement field, scanned and parsed on its own
+    std::shared_ptr<ExprAST> fstring_field(const std::shared_ptr<SereLexer::TokenBase>& token, const std::string& source) {
+        const size_t first = source.find_first_not_of(" \t\n");
+        SERE_ASSERT(first != std::string::npos, token, "Empty expression in f-string.");
+        SereLexer::TokenList tokens = SereLexer::Scanner(source.substr(first).c_str()).tokenize();
+        Parser parser(tokens);
+        auto expr = parser.expression();
+        parser.skipNewlines();
+        SERE_ASSERT(parser.isAtEnd(), token, "Expected '}' after the expression in f-string.");
+        return expr;
+    }
 };
 
 } // namespace SereParser
@@ -0,0 +1,376 @@
+#ifndef SIR_ANALYSIS_HPP
+#define SIR_ANALYSIS_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "./SIR.hpp"
+
+namespace SereSIR {
+
+    // not (x op y), for integers
+    inline SereLexer::TokenType negated(SereLexer::TokenType op) {
+        using SereLexer::TokenType;
+        switch (op) {
+        case TokenType::TOKEN_LESS: return TokenType::TOKEN_GREATER_EQUAL;
+        case TokenType::TOKEN_LESS_EQUAL: return TokenType::TOKEN_GREATER;
+        case TokenType::TOKEN_GREATER: return TokenType::TOKEN_LESS_EQUAL;
+        case TokenType::TOKEN_GREATER_EQUAL: return TokenType::TOKEN_LESS;
+        case TokenType::TOKEN_EQUAL_EQUAL: return TokenType::TOKEN_BANG_EQUAL;
+        default: return TokenType::TOKEN_EQUAL_EQUAL;
+        }
+    }
+
+    //
+    // The dominator tree of a function's reachable blocks (Cooper, Harvey
+    // and Kennedy, "A Simple, Fast Dominance Algorithm"). Computed once;
+    // a pass that changes the CFG computes a new one.
+    //
+    class Dominators {
+    public:
+        explicit Dominators(const Function& fn) {
+            std::vector<Block*> order = fn.reverse_postorder();
+            if (order.empty()) return;
+            for (size_t i = 0; i < order.size(); ++i) number_[order[i]] = static_cast<unsigned>(i);
+            idom_[order.front()] = order.front();
+            for (bool changed = true; changed;) {
+                changed = false;
+                for (size_t i = 1; i < order.size(); ++i) {
+                    Block* block = order[i];
+                    const Block* dom = nullptr;
+                    for (Block* pred : block->preds) {
+                        if (!idom_.count(pred)) continue; // not processed yet, or unreachable
+                        dom = dom ? intersect(pred, dom) : pred;
+                    }
+                    if (dom && idom_[block] != dom) {
+                        idom_[block] = dom;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        bool reachable(const Block* block) const { return number_.count(block) != 0; }
+
+        // The immediate dominator; the entry is its own
+        const Block* idom(const Block* block) const { return idom_.at(block); }
+
+        // Whether every path from the entry to `b` passes through `a` (so `a` dominates itself)
+        bool dominates(const Block* a, const Block* b) const {
+            if (!reachable(a) || !reachable(b)) return false;
+            for (;;) {
+                if (a == b) return true;
+                const Block* up = idom_.at(b);
+                if (up == b) return false; // the entry
+                b = up;
+            }
+        }
+
+        // Whether `def` has been computed wherever `user` runs; a phi uses its operands at the end of the incoming block
+        bool available(const Instr* def, const Instr* user, size_t operand) const {
+            if (def->is_value()) return true;
+            if (user->op == Opcode::PHI) {
+                const Block* from = user->blocks[operand];
+                return def->parent == from || dominates(def->parent, from);
+            }
+            if (def->parent != user->parent) return dominates(def->parent, user->parent);
+            for (const auto& instr : user->parent->instrs) {
+                if (instr.get() == def) return true;
+                if (instr.get() == user) return false;
+            }
+            return false;
+        }
+
+    private:
+        const Block* intersect(const Block* a, const Block* b) const {
+            while (a != b) {
+                while (number_.at(a) > number_.at(b)) a = idom_.at(a);
+                while (number_.at(b) > number_.at(a)) b = idom_.at(b);
+            }
+            return a;
+        }
+
+        std::unordered_map<const Block*, unsigned> number_;
+        std::unordered_map<const Block*, const Block*> idom_;
+    };
+
+    //
+    // The range of every integer value of a function: an interval holding
+    // each value it can take, by abstract interpretation over the CFG in
+    // reverse postorder until nothing changes. What narrows it:
+    //   - constants; anything else starts out as its type's range,
+    //   - arithmetic on ranges, exact unless the result may wrap (a
+    //     checked result is whatever did not trap),
+    //   - the variable of a range() loop, between start and stop,
+    //   - branches: under `if i < n`, i is below n's maximum, and the
+    //     fact holds in every block the edge dominates.
+    // A phi that keeps growing (a `while` counter) is widened to its
+    // type's bound on the side it grows, so the fixpoint is reached fast.
+    //
+    class Ranges {
+    public:
+        using Wide = __int128; // holds both i64 and u64 bounds, and their sums
+        struct Interval {
+            Wide lo, hi;
+            bool operator==(const Interval& other) const { return lo == other.lo && hi == other.hi; }
+        };
+
+        explicit Ranges(const Function& fn) {
+            std::vector<Block*> order = fn.reverse_postorder();
+            if (order.empty()) return;
+            Dominators dominators(fn);
+            std::unordered_map<const Instr*, unsigned> growth;
+            for (bool changed = true; changed;) {
+                changed = false;
+                for (Block* block : order) {
+                    Facts facts = block == order.front() ? Facts() : facts_[dominators.idom(block)];
+                    if (block->preds.size() == 1) {
+                        const Block* pred = block->preds[0];
+                        const Instr* branch = pred->terminator();
+                        if (branch->op == Opcode::CONDBR && branch->blocks[0] != branch->blocks[1])
+                            assume(*branch->operands[0], branch->blocks[0] == block, pred, facts);
+                    }
+                    facts_[block] = std::move(facts);
+
+                    for (const auto& instr : block->instrs) {
+                        if (!Runtime::is_integer(instr->type)) continue;
+                        auto next = transfer(*instr, block);
+                        if (!next) continue;
+                        auto known = values_.find(instr.get());
+                        if (known == values_.end()) {
+                            values_.emplace(instr.get(), *next);
+                            changed = true;
+                            continue;
+                        }
+                        Interval grown = hull(known->second, *next);
+                        if (grown == known->second) continue;
+                        if (instr->op == Opcode::PHI && ++growth[instr.get()] > 2) {
+                            const Interval type = of_type(instr->type);
+                            if (grown.lo < known->second.lo) grown.lo = type.lo;
+                            if (grown.hi > known->second.hi) grown.hi = type.hi;
+                        }
+                        known->second = grown;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        // The range of integer `value` where `block` runs
+        Interval at(const Instr* value, const Block* block) const {
+            Interval range = of_type(value->type);
+            if (value->is_constant()) {
+                Wide c = constant(value->constant);
+                return {c, c};
+            }
+            auto known = values_.find(value);
+            if (known != values_.end()) range = known->second;
+            auto facts = facts_.find(block);
+            if (facts != facts_.end()) {
+                auto fact = facts->second.find(value);
+                if (fact != facts->second.end()) range = {std::max(range.lo, fact->second.lo), std::min(range.hi, fact->second.hi)};
+            }
+            return range;
+        }
+
+        static Interval of_type(SereTypeKind kind) {
+            const unsigned bits = Runtime::type_info(kind).bits;
+            if (kind == SereTypeKind::BOOL || !bits) return {0, 1};
+            if (Runtime::is_signed(kind)) return {-(Wide(1) << (bits - 1)), (Wide(1) << (bits - 1)) - 1};
+            return {0, (Wide(1) << bits) - 1};
+        }
+
+        static bool fits(const Interval& range, SereTypeKind kind) {
+            const Interval type = of_type(kind);
+            return range.lo >= type.lo && range.hi <= type.hi;
+        }
+
+        // a op b over all values of the ranges (+ - *), without wrapping
+        static Interval arith(SereLexer::TokenType op, const Interval& a, const Interval& b) {
+            using SereLexer::TokenType;
+            if (op == TokenType::TOKEN_PLUS) return {a.lo + b.lo, a.hi + b.hi};
+            if (op == TokenType::TOKEN_MINUS) return {a.lo - b.hi, a.hi - b.lo};
+            const Wide corners[] = {product(a.lo, b.lo), product(a.lo, b.hi), product(a.hi, b.lo), product(a.hi, b.hi)};
+            return {*std::min_element(std::begin(corners), std::end(corners)), *std::max_element(std::begin(corners), std::end(corners))};
+        }
+
+    private:
+        using Facts = std::unordered_map<const Instr*, Interval>;
+
+        static Wide constant(const ConstValue& value) {
+            return Runtime::is_signed(value.kind) ? Wide(value.as_signed()) : Wide(value.bits);
+        }
+
+        // Saturates far outside any type, so a product too large for Wide still does not fit
+        static Wide product(Wide a, Wide b) {
+            const Wide limit = Wide(1) << 126;
+            Wide result;
+            if (__builtin_mul_overflow(a, b, &result) || result > limit || result < -limit) return (a < 0) != (b < 0) ? -limit : limit;
+            return result;
+        }
+
+        static Interval hull(const Interval& a, const Interval& b) { return {std::min(a.lo, b.lo), std::max(a.hi, b.hi)}; }
+
+        // The range of `instr` from its operands' so far; none for a phi none of whose operands is known yet
+        std::optional<Interval> transfer(const Instr& instr, const Block* block) const {
+            using SereLexer::TokenType;
+            const Interval type = of_type(instr.type);
+            auto operand = [&](size_t i) { return at(instr.operands[i], block); };
+            auto wrapped = [&](const Interval& exact) {
+                if (instr.trapv) return Interval{std::max(exact.lo, type.lo), std::min(exact.hi, type.hi)};
+                return fits(exact, instr.type) ? exact : type;
+            };
+            switch (instr.op) {
+            case Opcode::BINARY: {
+                const Interval a = operand(0), b = operand(1);
+                switch (instr.token) {
+                case TokenType::TOKEN_PLUS:
+                case TokenType::TOKEN_MINUS:
+                case TokenType::TOKEN_STAR:
+                    return wrapped(arith(instr.token, a, b));
+                case TokenType::TOKEN_SLASH:
+                case TokenType::TOKEN_DOUBLE_SLASH: {
+                    if (b.lo <= 0 && b.hi >= 0) return type;
+                    const bool floor = instr.token == TokenType::TOKEN_DOUBLE_SLASH;
+                    auto divide = [&](Wide x, Wide y) {
+                        Wide q = x / y;
+                        return floor && (x % y != 0) && ((x < 0) != (y < 0)) ? q - 1 : q;
+                    };
+                    const Wide corners[] = {divide(a.lo, b.lo), divide(a.lo, b.hi), divide(a.hi, b.lo), divide(a.hi, b.hi)};
+                    return wrapped({*std::min_element(std::begin(corners), std::end(corners)),
+                                    *std::max_element(std::begin(corners), std::end(corners))});
+                }
+                case TokenType::TOKEN_PERCENT:
+                    // Takes the divisor's sign
+                    if (b.lo > 0) return a.lo >= 0 && a.hi < b.lo ? a : Interval{0, b.hi - 1};
+                    if (b.hi < 0) return Interval{b.lo + 1, 0};
+                    return type;
+                default:
+                    return type;
+                }
+            }
+            case Opcode::NEG: {
+                const Interval a = operand(0);
+                return wrapped({-a.hi, -a.lo});
+            }
+            case Opcode::CONVERT: {
+                const SereTypeKind from = instr.operands[0]->type;
+                if (!Runtime::is_integer(from) && from != SereTypeKind::BOOL) return type;
+                const Interval a = operand(0);
+                return fits(a, instr.type) ? a : type;
+            }
+            case Opcode::SELECT:
+                return hull(operand(1), operand(2));
+            case Opcode::PHI: {
+                if (auto loop = loop_variable(instr)) return loop;
+                std::optional<Interval> range;
+                for (size_t i = 0; i < instr.operands.size(); ++i) {
+                    const Instr* op = instr.operands[i];
+                    if (!op->is_value() && !values_.count(op)) continue; // around a back edge, not reached yet
+                    Interval incoming = at(op, instr.blocks[i]);
+                    range = range ? hull(*range, incoming) : incoming;
+                }
+                return range;
+            }
+            default:
+                return type;
+            }
+        }
+
+        //
+        // The variable of a range() loop, as lowering builds it (see
+        // Lowering::for_statement): a phi of `start` from the preheader, which
+        // computed range_trips(start, stop, step), and of itself + step.
+        // In the body it lies from start up to, not including, stop.
+        //
+        std::optional<Interval> loop_variable(const Instr& phi) const {
+            using SereLexer::TokenType;
+            if (phi.operands.size() != 2) return std::nullopt;
+            for (size_t entry = 0; entry < 2; ++entry) {
+                const Instr* start = phi.operands[entry];
+                const Instr* next = phi.operands[1 - entry];
+                if (next->op != Opcode::BINARY || next->token != TokenType::TOKEN_PLUS || !next->no_wrap || next->operands[0] != &phi)
+                    continue;
+                const Block* preheader = phi.blocks[entry];
+                for (const auto& instr : preheader->instrs) {
+                    if (instr->op != Opcode::RANGE_TRIPS || instr->operands[0] != start || instr->operands[2] != next->operands[1]) continue;
+                    const Interval from = at(start, preheader), to = at(instr->operands[1], preheader);
+                    const Interval step = at(instr->operands[2], preheader);
+                    Interval range;
+                    if (step.lo > 0)
+                        range = {from.lo, to.hi - 1};
+                    else if (step.hi < 0)
+                        range = {to.lo + 1, from.hi};
+                    else
+                        range = {std::min(from.lo, to.lo + 1), std::max(from.hi, to.hi - 1)};
+                    if (range.lo > range.hi) range.hi = range.lo; // the loop never runs
+                    return range;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // Records what `condition` being `holds` says about integers, on entry to a block `from` branches to
+        void assume(const Instr& condition, bool holds, const Block* from, Facts& facts) const {
+            using SereLexer::TokenType;
+            if (condition.op == Opcode::NOT) return assume(*condition.operands[0], !holds, from, facts);
+            if (condition.op == Opcode::SELECT) {
+                const Instr *c = condition.operands[0], *t = condition.operands[1], *f = condition.operands[2];
+                if (holds && f == c) { // c and t
+                    assume(*c, true, from, facts);
+                    assume(*t, true, from, facts);
+                } else if (!holds && t == c) { // c or f
+                    assume(*c, false, from, facts);
+                    assume(*f, false, from, facts);
+                }
+                return;
+            }
+            if (condition.op != Opcode::COMPARE || !Runtime::is_integer(condition.operands[0]->type)) return;
+            const Instr *x = condition.operands[0], *y = condition.operands[1];
+            TokenType op = condition.token;
+            if (!holds) op = negated(op);
+            auto narrow = [&](const Instr* value, Interval range) {
+                if (value->is_constant()) return;
+                auto fact = facts.find(value);
+                if (fact != facts.end()) range = {std::max(range.lo, fact->second.lo), std::min(range.hi, fact->second.hi)};
+                facts[value] = range;
+            };
+            Interval a = at(x, from), b = at(y, from);
+            switch (op) {
+            case TokenType::TOKEN_LESS:
+                narrow(x, {a.lo, std::min(a.hi, b.hi - 1)});
+                narrow(y, {std::max(b.lo, a.lo + 1), b.hi});
+                break;
+            case TokenType::TOKEN_LESS_EQUAL:
+                narrow(x, {a.lo, std::min(a.hi, b.hi)});
+                narrow(y, {std::max(b.lo, a.lo), b.hi});
+                break;
+            case TokenType::TOKEN_GREATER:
+                narrow(x, {std::max(a.lo, b.lo + 1), a.hi});
+                narrow(y, {b.lo, std::min(b.hi, a.hi - 1)});
+                break;
+            case TokenType::TOKEN_GREATER_EQUAL:
+                narrow(x, {std::max(a.lo, b.lo), a.hi});
+                narrow(y, {b.lo, std::min(b.hi, a.hi)});
+                break;
+            case TokenType::TOKEN_EQUAL_EQUAL:
+                narrow(x, {std::max(a.lo, b.lo), std::min(a.hi, b.hi)});
+                narrow(y, {std::max(a.lo, b.lo), std::min(a.hi, b.hi)});
+                break;
+            default: // !=: only an end of a range can be excluded
+                if (b.lo == b.hi) narrow(x, {a.lo + (a.lo == b.lo), a.hi - (a.hi == b.lo)});
+                if (a.lo == a.hi) narrow(y, {b.lo + (b.lo == a.lo), b.hi - (b.hi == a.lo)});
+                break;
+            }
+        }
+
+        std::unordered_map<const Instr*, Interval> values_;
+        std::unordered_map<const Block*, Facts> facts_;
+    };
+
+} // namespace SereSIR
+
+#endif // SIR_ANALYSIS_HPP
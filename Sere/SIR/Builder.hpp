@@ -0,0 +1,259 @@
+#ifndef SIR_BUILDER_HPP
+#define SIR_BUILDER_HPP
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./SIR.hpp"
+
+namespace SereSIR {
+
+    //
+    // Appends instructions to a block of a SIR function. Like LLVM's
+    // IRBuilder it folds what it can as it goes, by Sere's arithmetic
+    // (ConstValue): `-5` is a constant, not a negation of one, so lowering
+    // sees literals as the visitor does. Whatever would trap is emitted.
+    //
+    // Variables become SSA values on the fly, as in SereIR::SSABuilder
+    // (Braun et al.): a read looks through the predecessors and places
+    // phis where control flow merges; an unsealed block's reads get phis
+    // completed by seal().
+    //
+    class Builder {
+    public:
+        explicit Builder(Function& fn) : fn_(fn) {}
+
+        Function& function() { return fn_; }
+        Block* block() const { return block_; }
+        void set_block(Block* block) { block_ = block; }
+        bool terminated() const { return block_->terminator() != nullptr; }
+
+        Instr* constant(const ConstValue& value) { return fn_.constant(value); }
+
+        // `checked`: a division that traps on a zero divisor; `trapv`: + - * ** that traps on overflow
+        Instr* binary(SereLexer::TokenType op, SereTypeKind kind, Instr* a, Instr* b, bool checked = false, bool trapv = false) {
+            if (a->is_constant() && b->is_constant() && !(trapv && SereParser::const_overflows(op, a->constant, b->constant)))
+                if (auto folded = SereParser::const_binary(op, a->constant, b->constant)) return constant(*folded);
+            Instr* instr = append(Opcode::BINARY, kind, {a, b});
+            instr->token = op;
+            instr->checked = checked;
+            instr->trapv = trapv;
+            return instr;
+        }
+
+        Instr* compare(SereLexer::TokenType op, Instr* a, Instr* b) {
+            if (a->is_constant() && b->is_constant())
+                if (auto folded = SereParser::const_binary(op, a->constant, b->constant)) return constant(*folded);
+            Instr* instr = append(Opcode::COMPARE, SereTypeKind::BOOL, {a, b});
+            instr->token = op;
+            return instr;
+        }
+
+        Instr* neg(Instr* a, bool trapv = false) {
+            if (a->is_constant() && !(trapv && SereParser::const_negate_overflows(a->constant)))
+                if (auto folded = SereParser::const_negate(a->constant)) return constant(*folded);
+            Instr* instr = append(Opcode::NEG, a->type, {a});
+            instr->trapv = trapv;
+            return instr;
+        }
+
+        Instr* logical_not(Instr* a) {
+            if (a->is_constant()) return constant(ConstValue::of_bool(!a->constant.truth()));
+            return append(Opcode::NOT, SereTypeKind::BOOL, {a});
+        }
+
+        Instr* convert(Instr* a, SereTypeKind to) {
+            if (a->type == to) return a;
+            if (a->is_constant()) {
+                if (to == SereTypeKind::BOOL) return constant(ConstValue::of_bool(a->constant.truth()));
+                if (auto folded = SereParser::const_convert(a->constant, to)) return constant(*folded);
+            }
+            return append(Opcode::CONVERT, to, {a});
+        }
+
+        // `value` as a condition (CodeGenContext::truth_value)
+        Instr* truth(Instr* value) { return convert(value, SereTypeKind::BOOL); }
+
+        Instr* select(Instr* condition, Instr* a, Instr* b) {
+            if (condition->is_constant()) return condition->constant.truth() ? a : b;
+            return append(Opcode::SELECT, a->type, {condition, a, b});
+        }
+
+        Instr* call(const std::string& callee, SereTypeKind kind, std::vector<Instr*> args) {
+            Instr* instr = append(Opcode::CALL, kind, std::move(args));
+            instr->name = callee;
+            return instr;
+        }
+
+        Instr* print(std::vector<Instr*> pieces) { return append(Opcode::PRINT, SereTypeKind::NONE, std::move(pieces)); }
+
+        void trap_if(Instr* condition, const std::string& label) {
+            if (condition->is_constant() && !condition->constant.truth()) return;
+            append(Opcode::TRAP_IF, SereTypeKind::NONE, {condition})->name = label;
+        }
+
+        Instr* range(Opcode op, Instr* start, Instr* stop, Instr* step) {
+            SereTypeKind kind = op == Opcode::RANGE_TRIPS ? unsigned_of(start->type) : SereTypeKind::BOOL;
+            return append(op, kind, {start, stop, step});
+        }
+
+        Instr* phi(Block* block, SereTypeKind kind, const std::string& name) {
+            auto instr = std::make_unique<Instr>(Opcode::PHI, kind);
+            instr->parent = block;
+            instr->name = name;
+            Instr* phi = instr.get();
+            block->instrs.insert(block->instrs.begin() + static_cast<std::ptrdiff_t>(block->phis().size()), std::move(instr));
+            return phi;
+        }
+
+        void add_incoming(Instr* phi, Instr* value, Block* from) {
+            phi->operands.push_back(value);
+            phi->blocks.push_back(from);
+        }
+
+        void br(Block* target, LoopKind loop = LoopKind::NONE) {
+            Instr* instr = append(Opcode::BR, SereTypeKind::NONE, {});
+            instr->blocks = {target};
+            instr->loop = loop;
+            target->preds.push_back(block_);
+        }
+
+        void condbr(Instr* condition, Block* if_true, Block* if_false, LoopKind loop = LoopKind::NONE) {
+            Instr* instr = append(Opcode::CONDBR, SereTypeKind::NONE, {condition});
+            instr->blocks = {if_true, if_false};
+            instr->loop = loop;
+            if_true->preds.push_back(block_);
+            if_false->preds.push_back(block_);
+        }
+
+        // Without a value in a function that has one, it returns that type's zero
+        void ret(Instr* value = nullptr) {
+            append(Opcode::RET, SereTypeKind::NONE, value ? std::vector<Instr*>{value} : std::vector<Instr*>{});
+        }
+
+        // ===== Variables =====
+
+        void declare(const std::string& var, SereTypeKind kind) { kinds_.emplace(var, kind); }
+
+        // The declared type, or nothing when `var` is not a variable yet
+        std::optional<SereTypeKind> kind_of(const std::string& var) const {
+            auto found = kinds_.find(var);
+            if (found == kinds_.end()) return std::nullopt;
+            return found->second;
+        }
+
+        void write_variable(const std::string& var, Instr* value) {
+            if (value->name.empty() && !value->is_value()) value->name = var;
+            defs_[block_][var] = value;
+        }
+
+        Instr* read_variable(const std::string& var) { return read_variable(var, block_); }
+
+        void seal(Block* block) {
+            auto pending = incomplete_.find(block);
+            if (pending != incomplete_.end()) {
+                auto phis = std::move(pending->second);
+                incomplete_.erase(pending);
+                for (auto& [var, phi] : phis) add_phi_operands(var, phi);
+            }
+            sealed_.insert(block);
+        }
+
+    private:
+        Instr* append(Opcode op, SereTypeKind kind, std::vector<Instr*> operands) {
+            auto instr = std::make_unique<Instr>(op, kind);
+            instr->operands = std::move(operands);
+            instr->parent = block_;
+            block_->instrs.push_back(std::move(instr));
+            return block_->instrs.back().get();
+        }
+
+        Instr* read_variable(const std::string& var, Block* block) {
+            auto defs = defs_.find(block);
+            if (defs != defs_.end()) {
+                auto found = defs->second.find(var);
+                if (found != defs->second.end()) return found->second;
+            }
+            SereTypeKind kind = kinds_.at(var);
+            Instr* value;
+            if (!sealed_.count(block)) {
+                Instr* incomplete = phi(block, kind, var);
+                incomplete_[block].emplace_back(var, incomplete);
+                value = incomplete;
+            } else if (block->preds.size() == 1) {
+                value = read_variable(var, block->preds.front());
+            } else if (block->preds.empty()) {
+                value = fn_.undef(kind); // read before any assignment on this path
+            } else {
+                Instr* merge = phi(block, kind, var);
+                defs_[block][var] = merge;
+                value = add_phi_operands(var, merge);
+            }
+            defs_[block][var] = value;
+            return value;
+        }
+
+        Instr* add_phi_operands(const std::string& var, Instr* merge) {
+            Block* block = merge->parent;
+            for (Block* pred : block->preds) add_incoming(merge, read_variable(var, pred), pred);
+            return try_remove_trivial_phi(merge);
+        }
+
+        Instr* try_remove_trivial_phi(Instr* merge) {
+            Instr* same = nullptr;
+            for (Instr* op : merge->operands) {
+                if (op == same || op == merge) continue;
+                if (same) return merge;
+                same = op;
+            }
+            if (!same) same = fn_.undef(merge->type);
+
+            std::vector<Instr*> users;
+            for (auto& block : fn_.blocks)
+                for (auto& instr : block->instrs)
+                    if (instr->op == Opcode::PHI && instr.get() != merge &&
+                        std::find(instr->operands.begin(), instr->operands.end(), merge) != instr->operands.end())
+                        users.push_back(instr.get());
+
+            fn_.replace_uses(merge, same);
+            for (auto& [block, defs] : defs_)
+                for (auto& [name, value] : defs)
+                    if (value == merge) value = same;
+            merge->parent->erase(merge);
+
+            for (Instr* user : users)
+                if (is_live_phi(user) && !is_incomplete(user)) try_remove_trivial_phi(user);
+            return same;
+        }
+
+        // Whether `phi` is still in its block (removing one phi can remove others)
+        bool is_live_phi(Instr* phi) const {
+            for (auto& block : fn_.blocks)
+                for (auto& instr : block->instrs)
+                    if (instr.get() == phi) return true;
+            return false;
+        }
+
+        bool is_incomplete(Instr* phi) const {
+            auto pending = incomplete_.find(phi->parent);
+            if (pending == incomplete_.end()) return false;
+            for (const auto& entry : pending->second)
+                if (entry.second == phi) return true;
+            return false;
+        }
+
+        Function& fn_;
+        Block* block_ = nullptr;
+        std::unordered_map<std::string, SereTypeKind> kinds_;
+        std::unordered_map<Block*, std::unordered_map<std::string, Instr*>> defs_;
+        std::unordered_map<Block*, std::vector<std::pair<std::string, Instr*>>> incomplete_;
+        std::unordered_set<Block*> sealed_;
+    };
+
+} // namespace SereSIR
+
+#endif // SIR_BUILDER_HPP
@@ -0,0 +1,257 @@
+#ifndef SIR_CODEGEN_HPP
+#define SIR_CODEGEN_HPP
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+
+#include "../Parser/AST/Visitor.hpp"
+#include "./SIR.hpp"
+
+namespace SereSIR {
+
+    //
+    // Emits a verified SIR function as the body of `target`, with the
+    // expansions lowering used to emit directly (IR/Arith.hpp and
+    // convert_value), at RT::ctx.builder: the function's fast-math flags
+    // and loop hints apply. Blocks are emitted in reverse postorder, so
+    // every operand but a phi's exists before its use.
+    //
+    class CodeGen {
+    public:
+        CodeGen(const Function& fn, llvm::Function* target) : fn_(fn), target_(target) {}
+
+        void emit() {
+            auto& builder = SereParser::RT::ctx.builder;
+            for (const Instr* param : fn_.params) target_->getArg(param->index)->setName(param->name);
+            std::vector<Block*> order = fn_.reverse_postorder();
+            for (Block* block : order)
+                blocks_[block] = llvm::BasicBlock::Create(SereParser::RT::ctx.llvm_ctx, block->label, target_);
+            for (Block* block : order) {
+                builder.SetInsertPoint(blocks_[block]);
+                for (const auto& instr : block->instrs) emit(*instr);
+                ends_[block] = builder.GetInsertBlock(); // a trap or a print may have split it
+            }
+            for (auto& [phi, node] : phis_)
+                for (size_t i = 0; i < phi->operands.size(); ++i)
+                    node->addIncoming(value(phi->operands[i]), ends_.at(phi->blocks[i]));
+        }
+
+    private:
+        llvm::Value* value(const Instr* instr) {
+            switch (instr->op) {
+            case Opcode::CONST: return SereParser::to_constant(instr->constant);
+            case Opcode::UNDEF: return llvm::UndefValue::get(SereParser::typekind_to_llvm_type(instr->type));
+            case Opcode::PARAM: return target_->getArg(instr->index);
+            default: return values_.at(instr);
+            }
+        }
+
+        void emit(const Instr& instr) {
+            auto& ctx = SereParser::RT::ctx;
+            auto& builder = ctx.builder;
+            auto operand = [&](size_t i) { return value(instr.operands[i]); };
+            llvm::Value* result = nullptr;
+            switch (instr.op) {
+            case Opcode::BINARY:
+                result = binary(instr, operand(0), operand(1));
+                break;
+            case Opcode::COMPARE:
+                result = compare(instr, operand(0), operand(1));
+                break;
+            case Opcode::NEG:
+                if (instr.trapv)
+                    result = overflow_checked(instr.operands[0]->is_constant() && SereParser::const_negate_overflows(instr.operands[0]->constant),
+                                              llvm::Instruction::Sub, llvm::ConstantInt::get(operand(0)->getType(), 0), operand(0),
+                                              Runtime::is_signed(instr.type), "neg_tmp");
+                else
+                    result = Runtime::is_float(instr.type) ? builder.CreateFNeg(operand(0), "neg_tmp") : builder.CreateNeg(operand(0), "neg_tmp");
+                break;
+            case Opcode::NOT:
+                result = builder.CreateNot(operand(0), "not_tmp");
+                break;
+            case Opcode::CONVERT:
+                result = SereParser::convert_value(operand(0), instr.operands[0]->type, instr.type);
+                break;
+            case Opcode::SELECT:
+                result = builder.CreateSelect(operand(0), operand(1), operand(2));
+                break;
+            case Opcode::CALL: {
+                llvm::Function* callee = ctx.module->getFunction(instr.name);
+                if (!callee) throw std::runtime_error("SIR codegen: no function '" + instr.name + "'.");
+                std::vector<llvm::Value*> args;
+                for (size_t i = 0; i < instr.operands.size(); ++i) args.push_back(operand(i));
+                result = builder.CreateCall(callee, args);
+                break;
+            }
+            case Opcode::PRINT: {
+                std::vector<SereIR::OutputPiece> pieces;
+                for (size_t i = 0; i < instr.operands.size(); ++i) {
+                    SereIR::OutputPiece piece;
+                    piece.value = operand(i);
+                    piece.kind = instr.operands[i]->type;
+                    if (instr.operands[i]->is_constant()) piece.constant = instr.operands[i]->constant;
+                    pieces.push_back(piece);
+                }
+                SereIR::emit_output(ctx, pieces);
+                break;
+            }
+            case Opcode::PHI: {
+                llvm::PHINode* node = builder.CreatePHI(SereParser::typekind_to_llvm_type(instr.type),
+                                                        static_cast<unsigned>(instr.operands.size()));
+                phis_.emplace_back(&instr, node);
+                result = node;
+                break;
+            }
+            case Opcode::TRAP_IF:
+                ctx.trap_if(operand(0), instr.name);
+                break;
+            case Opcode::RANGE_NONEMPTY:
+                result = SereIR::range_nonempty(ctx, operand(0), operand(1), operand(2), Runtime::is_signed(instr.operands[0]->type));
+                break;
+            case Opcode::RANGE_TRIPS:
+                result = SereIR::range_trips(ctx, operand(0), operand(1), operand(2), Runtime::is_signed(instr.operands[0]->type));
+                break;
+            case Opcode::BR:
+                loop(builder.CreateBr(blocks_.at(instr.blocks[0])), instr.loop);
+                break;
+            case Opcode::CONDBR:
+                loop(builder.CreateCondBr(operand(0), blocks_.at(instr.blocks[0]), blocks_.at(instr.blocks[1])), instr.loop);
+                break;
+            case Opcode::RET:
+                if (!instr.operands.empty()) {
+                    ctx.mark_tail_call(operand(0));
+                    builder.CreateRet(operand(0));
+                } else if (target_->getReturnType()->isVoidTy()) {
+                    ctx.mark_tail_call();
+                    builder.CreateRetVoid();
+                } else { // falling off the end
+                    builder.CreateRet(llvm::Constant::getNullValue(target_->getReturnType()));
+                }
+                break;
+            default:
+                throw std::runtime_error("SIR codegen: value in a block.");
+            }
+            if (!result) return;
+            if (!instr.name.empty() && !result->hasName() && llvm::isa<llvm::Instruction>(result) && instr.op != Opcode::CALL)
+                result->setName(instr.name);
+            values_[&instr] = result;
+        }
+
+        llvm::Value* binary(const Instr& instr, llvm::Value* a, llvm::Value* b) {
+            using SereLexer::TokenType;
+            auto& ctx = SereParser::RT::ctx;
+            auto& builder = ctx.builder;
+            const bool is_float = Runtime::is_float(instr.type);
+            const bool is_signed = Runtime::is_signed(instr.type);
+            const bool nuw = instr.no_wrap && !is_signed, nsw = instr.no_wrap && is_signed;
+            auto* divisor = llvm::dyn_cast<llvm::ConstantInt>(b);
+            if (instr.trapv && instr.token != TokenType::TOKEN_DOUBLE_STAR) {
+                const auto op = instr.token == TokenType::TOKEN_PLUS    ? llvm::Instruction::Add
+                                : instr.token == TokenType::TOKEN_MINUS ? llvm::Instruction::Sub
+                                                                        : llvm::Instruction::Mul;
+                const char* name = op == llvm::Instruction::Add ? "add_tmp" : op == llvm::Instruction::Sub ? "sub_tmp" : "mul_tmp";
+                const bool overflows = instr.operands[0]->is_constant() && instr.operands[1]->is_constant() &&
+                                       SereParser::const_overflows(instr.token, instr.operands[0]->constant, instr.operands[1]->constant);
+                return overflow_checked(overflows, op, a, b, is_signed, name);
+            }
+            switch (instr.token) {
+            case TokenType::TOKEN_PLUS:
+                return is_float ? builder.CreateFAdd(a, b, "add_tmp") : builder.CreateAdd(a, b, "add_tmp", nuw, nsw);
+            case TokenType::TOKEN_MINUS:
+                return is_float ? builder.CreateFSub(a, b, "sub_tmp") : builder.CreateSub(a, b, "sub_tmp", nuw, nsw);
+            case TokenType::TOKEN_STAR:
+                return is_float ? builder.CreateFMul(a, b, "mul_tmp") : builder.CreateMul(a, b, "mul_tmp", nuw, nsw);
+            case TokenType::TOKEN_SLASH:
+            case TokenType::TOKEN_DOUBLE_SLASH:
+            case TokenType::TOKEN_PERCENT:
+                if (divisor && divisor->isZero()) {
+                    // Only known to be zero since lowering (a literal zero is an error): it traps when reached
+                    ctx.trap_if(builder.getTrue(), "divzero");
+                    return llvm::PoisonValue::get(a->getType());
+                }
+                if (instr.token == TokenType::TOKEN_SLASH) return SereIR::true_div(ctx, a, b, is_signed, instr.checked);
+                if (instr.token == TokenType::TOKEN_DOUBLE_SLASH) return SereIR::floor_div(ctx, a, b, is_signed, instr.checked);
+                return SereIR::floor_mod(ctx, a, b, is_signed, instr.checked);
+            case TokenType::TOKEN_DOUBLE_STAR: {
+                const bool exp_signed = Runtime::is_signed(instr.operands[1]->type);
+                auto* exponent = llvm::dyn_cast<llvm::ConstantInt>(b);
+                if (!is_float && exponent && exp_signed && exponent->isNegative()) {
+                    // As above: the run-time path, not the error a negative literal exponent is
+                    llvm::Value* result = builder.CreateCall(SereIR::int_pow_function(*ctx.get_module()),
+                                                             {builder.CreateZExtOrTrunc(a, builder.getInt64Ty()),
+                                                              builder.CreateIntCast(b, builder.getInt64Ty(), true)}, "pow_tmp");
+                    return builder.CreateTrunc(result, a->getType());
+                }
+                if (instr.trapv && instr.operands[0]->is_constant() && instr.operands[1]->is_constant() &&
+                    SereParser::const_overflows(instr.token, instr.operands[0]->constant, instr.operands[1]->constant)) {
+                    // As overflow_checked: only constant since lowering, it traps when reached
+                    ctx.trap_if(builder.getTrue(), "overflow");
+                    return llvm::PoisonValue::get(a->getType());
+                }
+                return SereIR::power(ctx, a, b, exp_signed, instr.trapv);
+            }
+            default:
+                throw std::runtime_error("SIR codegen: invalid operator.");
+            }
+        }
+
+        // SereIR::checked_arith, but constants that overflow (`overflows`) only became constant since lowering: they trap when reached
+        static llvm::Value* overflow_checked(bool overflows, llvm::Instruction::BinaryOps op, llvm::Value* a, llvm::Value* b, bool is_signed,
+                                             const char* name) {
+            auto& ctx = SereParser::RT::ctx;
+            if (overflows) {
+                ctx.trap_if(ctx.builder.getTrue(), "overflow");
+                return llvm::PoisonValue::get(a->getType());
+            }
+            return SereIR::checked_arith(ctx, op, a, b, is_signed, name);
+        }
+
+        llvm::Value* compare(const Instr& instr, llvm::Value* a, llvm::Value* b) {
+            using SereLexer::TokenType;
+            auto& builder = SereParser::RT::ctx.builder;
+            const SereTypeKind kind = instr.operands[0]->type;
+            const bool is_signed = Runtime::is_signed(kind);
+            if (Runtime::is_float(kind)) {
+                // NaN compares unequal to everything, as in Python
+                switch (instr.token) {
+                case TokenType::TOKEN_LESS: return builder.CreateFCmpOLT(a, b, "lt_tmp");
+                case TokenType::TOKEN_LESS_EQUAL: return builder.CreateFCmpOLE(a, b, "le_tmp");
+                case TokenType::TOKEN_GREATER: return builder.CreateFCmpOGT(a, b, "gt_tmp");
+                case TokenType::TOKEN_GREATER_EQUAL: return builder.CreateFCmpOGE(a, b, "ge_tmp");
+                case TokenType::TOKEN_EQUAL_EQUAL: return builder.CreateFCmpOEQ(a, b, "eq_tmp");
+                default: return builder.CreateFCmpUNE(a, b, "ne_tmp");
+                }
+            }
+            switch (instr.token) {
+            case TokenType::TOKEN_LESS: return builder.CreateICmp(is_signed ? llvm::CmpInst::ICMP_SLT : llvm::CmpInst::ICMP_ULT, a, b, "lt_tmp");
+            case TokenType::TOKEN_LESS_EQUAL: return builder.CreateICmp(is_signed ? llvm::CmpInst::ICMP_SLE : llvm::CmpInst::ICMP_ULE, a, b, "le_tmp");
+            case TokenType::TOKEN_GREATER: return builder.CreateICmp(is_signed ? llvm::CmpInst::ICMP_SGT : llvm::CmpInst::ICMP_UGT, a, b, "gt_tmp");
+            case TokenType::TOKEN_GREATER_EQUAL: return builder.CreateICmp(is_signed ? llvm::CmpInst::ICMP_SGE : llvm::CmpInst::ICMP_UGE, a, b, "ge_tmp");
+            case TokenType::TOKEN_EQUAL_EQUAL: return builder.CreateICmpEQ(a, b, "eq_tmp");
+            default: return builder.CreateICmpNE(a, b, "ne_tmp");
+            }
+        }
+
+        static void loop(llvm::Instruction* back_edge, LoopKind kind) {
+            if (kind != LoopKind::NONE)
+                back_edge->setMetadata(llvm::LLVMContext::MD_loop, SereParser::RT::ctx.loop_id(kind == LoopKind::COUNTED));
+        }
+
+        const Function& fn_;
+        llvm::Function* target_;
+        std::unordered_map<const Block*, llvm::BasicBlock*> blocks_;
+        std::unordered_map<const Block*, llvm::BasicBlock*> ends_;
+        std::unordered_map<const Instr*, llvm::Value*> values_;
+        std::vector<std::pair<const Instr*, llvm::PHINode*>> phis_;
+    };
+
+} // namespace SereSIR
+
+#endif // SIR_CODEGEN_HPP
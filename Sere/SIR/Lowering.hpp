@@ -0,0 +1,575 @@
+#ifndef SIR_LOWERING_HPP
+#define SIR_LOWERING_HPP
+
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <llvm/IR/Function.h>
+
+#include "../Parser/AST/Visitor.hpp"
+#include "./Builder.hpp"
+#include "./CodeGen.hpp"
+#include "./Passes.hpp"
+#include "./SIR.hpp"
+#include "./Verifier.hpp"
+
+namespace SereSIR {
+
+    //
+    // Lowers a function body AST -> SIR -> passes -> LLVM IR, for
+    // StatVisitor::lower_function. It accepts what the visitor accepts
+    // and types it the same way, with the same error messages; it only
+    // emits into the LLVM function once the SIR is verified, so lowering
+    // can give up at any point before that: on what SIR does not model
+    // (Unsupported: `dyn`, nested definitions, none values) and on errors,
+    // which the visitor then reports as it always has.
+    //
+    template <typename R>
+    class Lowering {
+    public:
+        explicit Lowering(SereParser::StatVisitor<R>& statements)
+            : statements_(statements), checker_(statements.type_checker) {}
+
+        // False when `func` must be lowered directly; `llvm_func` is untouched then
+        bool lower(const SereParser::FunctionStatAST& func, const std::string& symbol, const Runtime::FunctionSignature& signature,
+                   llvm::Function* llvm_func) {
+            auto fn = std::make_unique<Function>();
+            fn->name = symbol;
+            fn->return_type = Runtime::kind_from_name(signature.return_type);
+            signature_ = &signature;
+            try {
+                build(func, signature, *fn);
+            } catch (const Unsupported& e) {
+                SereParser::RT::sir.direct.emplace_back(symbol, e.what());
+                return false;
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            verify(*fn);
+
+            // Calls of it may be evaluated from here on, its own recursive ones included
+            SereParser::RT::definitions[symbol] = SereParser::RT::Definition{&func, checker_->env->table};
+            auto evaluate = [checker = checker_](const std::string& callee, const std::vector<ConstValue>& args) -> std::optional<ConstValue> {
+                llvm::Function* target = SereParser::RT::ctx.module->getFunction(callee);
+                auto sig = SereParser::RT::signatures.find(callee);
+                if (!target || target->hasFnAttribute(llvm::Attribute::NoInline) || sig == SereParser::RT::signatures.end() ||
+                    sig->second.param_types.size() != args.size())
+                    return std::nullopt;
+                return SereParser::CompileTimeEvaluator<R>(checker).call(callee, args);
+            };
+            const auto& pipeline = SereParser::RT::sir.pipeline;
+            const unsigned checks = overflow_checks(*fn);
+            make_pipeline(pipeline ? *pipeline : default_pipeline(), evaluate).run(*fn);
+            SereParser::RT::sir.overflow_checks += checks;
+            SereParser::RT::sir.overflow_checks_kept += overflow_checks(*fn);
+
+            CodeGen(*fn, llvm_func).emit();
+            if (SereParser::RT::sir.keep) SereParser::RT::sir.functions.push_back(std::move(fn));
+            return true;
+        }
+
+    private:
+        using TokenType = SereLexer::TokenType;
+        using Visitor = SereParser::ExprVisitor<R>;
+
+        static unsigned overflow_checks(const Function& fn) {
+            unsigned count = 0;
+            for (const auto& block : fn.blocks)
+                for (const auto& instr : block->instrs) count += instr->trapv;
+            return count;
+        }
+
+        void build(const SereParser::FunctionStatAST& func, const Runtime::FunctionSignature& signature, Function& fn) {
+            if (!checker_->dynamic_variables.empty()) throw Unsupported("dyn variables");
+            if (fn.return_type == SereTypeKind::DYNAMIC) throw Unsupported("dyn return");
+            Builder builder(fn);
+            builder_ = &builder;
+            Block* entry = fn.add_block("entry");
+            builder.set_block(entry);
+            builder.seal(entry);
+            for (size_t i = 0; i < func.params.size(); ++i) {
+                const std::string name = SereParser::_sanitize_name_impl_(func.params[i]->name.lexeme);
+                SereTypeKind kind = Runtime::kind_from_name(signature.param_types[i]);
+                if (kind == SereTypeKind::DYNAMIC) throw Unsupported("dyn parameter");
+                builder.declare(name, kind);
+                builder.write_variable(name, fn.add_param(name, kind));
+                checker_->check_assign(name, kind);
+            }
+            statement(*func.body);
+            if (!builder.terminated()) builder.ret();
+            fn.remove_unreachable_blocks();
+        }
+
+        // ===== Statements =====
+
+        void statement(const SereParser::StatAST& stat) {
+            using namespace SereParser;
+            if (auto block = dynamic_cast<const BlockStatAST*>(&stat)) {
+                for (const auto& inner : block->statements) {
+                    if (builder_->terminated()) break; // nothing after a return runs
+                    statement(*inner);
+                }
+            } else if (auto expr = dynamic_cast<const ExprStatAST*>(&stat))
+                expression(*expr->expr);
+            else if (auto assign = dynamic_cast<const AssignStatAST*>(&stat))
+                assignment(*assign);
+            else if (auto branch = dynamic_cast<const IfStatAST*>(&stat))
+                if_statement(*branch);
+            else if (auto loop = dynamic_cast<const WhileStatAST*>(&stat))
+                while_statement(*loop);
+            else if (auto range = dynamic_cast<const ForStatAST*>(&stat))
+                for_statement(*range);
+            else if (auto ret = dynamic_cast<const ReturnStatAST*>(&stat))
+                return_statement(*ret);
+            else if (dynamic_cast<const FunctionStatAST*>(&stat))
+                throw Unsupported("nested function");
+            else if (dynamic_cast<const ImportStatAST*>(&stat))
+                throw Unsupported("import");
+            else
+                throw Unsupported("class");
+        }
+
+        // StatVisitor::visit_assign
+        void assignment(const SereParser::AssignStatAST& stat) {
+            const std::string name = SereParser::_sanitize_name_impl_(stat.name.lexeme);
+            if (!stat.initializer) throw std::runtime_error("Assign: invalid LLVM value.");
+            Instr* value = expression(*stat.initializer);
+            SereTypeKind dest_kind;
+            if (auto declared = builder_->kind_of(name)) {
+                dest_kind = *declared;
+            } else {
+                dest_kind = value->type;
+                if (stat.type_annotation) {
+                    dest_kind = SereParser::parse_type_annotation(SereParser::_sanitize_name_impl_(stat.type_annotation->name.lexeme));
+                    if (dest_kind == SereTypeKind::UNKNOWN)
+                        throw std::runtime_error("Unknown type '" + stat.type_annotation->name.lexeme + "' for variable '" + name + "'.");
+                }
+                if (dest_kind == SereTypeKind::NONE || dest_kind == SereTypeKind::DYNAMIC) throw Unsupported(Runtime::to_string(dest_kind) + " variable");
+                checker_->check_assign(name, dest_kind);
+                builder_->declare(name, dest_kind);
+            }
+
+            if (value->type != dest_kind) {
+                const bool literal = Visitor::is_untyped_literal(*stat.initializer);
+                if (literal && Runtime::is_numeric(dest_kind) && !converts(value, dest_kind, true))
+                    throw std::runtime_error("Literal assigned to '" + name + "' does not fit in " + Runtime::to_string(dest_kind) + ".");
+                if (!converts(value, dest_kind, literal))
+                    throw std::runtime_error("Cannot assign " + Runtime::to_string(value->type) + " to variable '" + name + "' of type " +
+                                             Runtime::to_string(dest_kind) + "; convert explicitly, e.g. " +
+                                             Runtime::to_string(dest_kind) + "(x).");
+                value = convert(value, dest_kind);
+            }
+            builder_->write_variable(name, value);
+        }
+
+        void if_statement(const SereParser::IfStatAST& stat) {
+            Builder& builder = *builder_;
+            Instr* condition = truth(expression(*stat.condition));
+            Block* then_block = builder.function().add_block("if.then");
+            Block* merge_block = builder.function().add_block("if.end");
+            Block* else_block = stat.else_branch ? builder.function().add_block("if.else") : merge_block;
+            builder.condbr(condition, then_block, else_block);
+
+            builder.seal(then_block);
+            builder.set_block(then_block);
+            statement(*stat.then_branch);
+            if (!builder.terminated()) builder.br(merge_block);
+
+            if (stat.else_branch) {
+                builder.seal(else_block);
+                builder.set_block(else_block);
+                statement(*stat.else_branch);
+                if (!builder.terminated()) builder.br(merge_block);
+            }
+            builder.seal(merge_block);
+            builder.set_block(merge_block);
+        }
+
+        void while_statement(const SereParser::WhileStatAST& stat) {
+            Builder& builder = *builder_;
+            Block* cond_block = builder.function().add_block("while.cond");
+            Block* body_block = builder.function().add_block("while.body");
+            Block* end_block = builder.function().add_block("while.end");
+            builder.br(cond_block);
+
+            // The header stays unsealed until the back edge exists
+            builder.set_block(cond_block);
+            builder.condbr(truth(expression(*stat.condition)), body_block, end_block);
+
+            builder.seal(body_block);
+            builder.set_block(body_block);
+            statement(*stat.body);
+            if (!builder.terminated()) builder.br(cond_block, LoopKind::WHILE);
+            builder.seal(cond_block);
+
+            builder.seal(end_block);
+            builder.set_block(end_block);
+        }
+
+        // StatVisitor::visit_for, in the same shape
+        void for_statement(const SereParser::ForStatAST& stat) {
+            Builder& builder = *builder_;
+            struct Bound {
+                Instr* value;
+                bool literal;
+            };
+            auto bound = [&](const std::shared_ptr<SereParser::ExprAST>& expr, const char* what) {
+                Instr* value = expression(*expr);
+                if (value->type == SereTypeKind::DYNAMIC) throw Unsupported("dyn range()");
+                if (!Runtime::is_integer(value->type)) throw std::runtime_error(std::string("range() ") + what + " must be an integer.");
+                return Bound{value, Visitor::is_untyped_literal(*expr)};
+            };
+            std::vector<Bound> bounds = {bound(stat.start, "start"), bound(stat.stop, "stop")};
+            if (stat.step) bounds.push_back(bound(stat.step, "step"));
+
+            const std::string name = SereParser::_sanitize_name_impl_(stat.var.lexeme);
+            SereTypeKind kind = SereTypeKind::UNKNOWN;
+            for (const Bound& b : bounds)
+                if (!b.literal) kind = kind == SereTypeKind::UNKNOWN ? b.value->type : checker_->check_binary(kind, b.value->type, "range()");
+            auto existing = builder.kind_of(name);
+            if (existing) {
+                if (!Runtime::is_integer(*existing)) throw std::runtime_error("Loop variable '" + name + "' is not an integer.");
+                kind = kind == SereTypeKind::UNKNOWN ? *existing : checker_->check_binary(kind, *existing, "range()");
+                if (kind != *existing)
+                    throw std::runtime_error("Loop variable '" + name + "' is " + Runtime::to_string(*existing) + " but range() is " +
+                                             Runtime::to_string(kind) + ".");
+            }
+            if (kind == SereTypeKind::UNKNOWN) kind = SereTypeKind::INT;
+            for (Bound& b : bounds) {
+                if (b.literal && !converts(b.value, kind, true))
+                    throw std::runtime_error("range() bound does not fit in " + Runtime::to_string(kind) + ".");
+                b.value = convert(b.value, kind);
+            }
+            Instr* start = bounds[0].value;
+            Instr* stop = bounds[1].value;
+            Instr* step = stat.step ? bounds[2].value : builder.constant(ConstValue::of_int(kind, 1));
+            if (!existing) {
+                builder.declare(name, kind);
+                checker_->check_assign(name, kind);
+            }
+
+            if (step->is_constant() && step->constant.bits == 0) throw std::runtime_error("range() step must not be zero.");
+            if (!step->is_constant())
+                builder.trap_if(builder.compare(TokenType::TOKEN_EQUAL_EQUAL, step, builder.constant(ConstValue::of_int(kind, 0))),
+                                "for.zerostep");
+            Instr* nonempty = builder.range(Opcode::RANGE_NONEMPTY, start, stop, step);
+
+            Function& fn = builder.function();
+            Block* preheader = fn.add_block("for.ph");
+            Block* body_block = fn.add_block("for.body");
+            Block* latch_block = fn.add_block("for.inc");
+            Block* end_block = fn.add_block("for.end");
+            builder.condbr(nonempty, preheader, end_block);
+
+            builder.seal(preheader);
+            builder.set_block(preheader);
+            Instr* trips = builder.range(Opcode::RANGE_TRIPS, start, stop, step);
+            builder.br(body_block);
+
+            // A zero-based counter up to the trip count, and the loop variable
+            const SereTypeKind counter = unsigned_of(kind);
+            builder.set_block(body_block);
+            Instr* index = builder.phi(body_block, counter, "for.index");
+            Instr* value = builder.phi(body_block, kind, name);
+            builder.add_incoming(index, builder.constant(ConstValue::of_int(counter, 0)), preheader);
+            builder.add_incoming(value, start, preheader);
+            builder.write_variable(name, value);
+            statement(*stat.body);
+            if (!builder.terminated()) builder.br(latch_block);
+
+            // The last step may leave the type's range, but its result is never used
+            builder.seal(latch_block);
+            builder.set_block(latch_block);
+            Instr* next_index = builder.binary(TokenType::TOKEN_PLUS, counter, index, builder.constant(ConstValue::of_int(counter, 1)));
+            Instr* next_value = builder.binary(TokenType::TOKEN_PLUS, kind, value, step);
+            next_index->no_wrap = next_value->no_wrap = true;
+            next_index->name = "for.index.next";
+            next_value->name = name + ".next";
+            builder.condbr(builder.compare(TokenType::TOKEN_EQUAL_EQUAL, next_index, trips), end_block, body_block, LoopKind::COUNTED);
+            builder.add_incoming(index, next_index, latch_block);
+            builder.add_incoming(value, next_value, latch_block);
+            builder.seal(body_block);
+
+            builder.seal(end_block);
+            builder.set_block(end_block);
+        }
+
+        void return_statement(const SereParser::ReturnStatAST& stat) {
+            const SereTypeKind to = builder_->function().return_type;
+            if (!stat.value) {
+                if (to != SereTypeKind::NONE) throw Unsupported("return without a value");
+                builder_->ret();
+                return;
+            }
+            if (to == SereTypeKind::NONE) throw Unsupported("return of a value from a function returning none");
+            Instr* value = expression(*stat.value);
+            if (value->type != to) {
+                if (!converts(value, to, Visitor::is_untyped_literal(*stat.value)))
+                    throw std::runtime_error("Function '" + signature_->name + "' returns " + Runtime::to_string(to) + ", not " +
+                                             Runtime::to_string(value->type) + "; convert explicitly, e.g. " + Runtime::to_string(to) +
+                                             "(x).");
+                value = convert(value, to);
+            }
+            builder_->ret(value);
+        }
+
+        // ===== Expressions =====
+
+        Instr* expression(const SereParser::ExprAST& expr) {
+            using namespace SereParser;
+            if (auto literal = dynamic_cast<const LiteralExprAST*>(&expr)) {
+                switch (literal->value.getType()) {
+                case SereObjectType::INTEGER:
+                    return builder_->constant(ConstValue::of_int(literal->value.integerLiteralKind(), static_cast<uint64_t>(literal->value.getInteger())));
+                case SereObjectType::FLOAT: return builder_->constant(ConstValue::of_float(SereTypeKind::FLOAT, literal->value.getFloat()));
+                case SereObjectType::BOOLEAN: return builder_->constant(ConstValue::of_bool(literal->value.getBoolean()));
+                case SereObjectType::STRING: return builder_->constant(ConstValue::of_str(literal->value.getString()));
+                default: throw Unsupported("none literal");
+                }
+            }
+            if (auto variable = dynamic_cast<const VariableExprAST*>(&expr)) {
+                const std::string name = SereParser::_sanitize_name_impl_(variable->name.lexeme);
+                if (!builder_->kind_of(name))
+                    throw std::runtime_error("LLVM variable '" + variable->name.lexeme + "' not found in current scope.");
+                return builder_->read_variable(name);
+            }
+            if (auto group = dynamic_cast<const GroupExprAST*>(&expr)) return expression(*group->expr);
+            if (auto unary = dynamic_cast<const UnaryExprAST*>(&expr)) return unary_expression(*unary);
+            if (auto binary = dynamic_cast<const BinaryExprAST*>(&expr)) return binary_expression(*binary);
+            if (auto logical = dynamic_cast<const LogicalExprAST*>(&expr)) return logical_expression(*logical);
+            if (auto call = dynamic_cast<const CallExprAST*>(&expr)) return call_expression(*call);
+            if (dynamic_cast<const FormatExprAST*>(&expr))
+                throw std::runtime_error("An f-string of run-time values can only be printed (there are no run-time strings yet).");
+            throw Unsupported("super or self");
+        }
+
+        Instr* unary_expression(const SereParser::UnaryExprAST& expr) {
+            Instr* value = expression(*expr.operand);
+            if (value->type == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+            switch (expr.op.type) {
+            case TokenType::TOKEN_MINUS: {
+                checker_->check_unary(value->type, expr.op.lexeme);
+                const bool trapv = SereParser::RT::ctx.checked_arith && Runtime::is_integer(value->type);
+                if (trapv && value->is_constant() && SereParser::const_negate_overflows(value->constant))
+                    throw std::runtime_error("Integer overflow.");
+                return builder_->neg(value, trapv);
+            }
+            case TokenType::TOKEN_PLUS:
+                checker_->check_unary(value->type, expr.op.lexeme);
+                return value;
+            case TokenType::TOKEN_BANG:
+            case TokenType::TOKEN_NOT:
+                return builder_->logical_not(truth(value));
+            default:
+                throw std::runtime_error("UnaryExprAST: Invalid operator.");
+            }
+        }
+
+        // ExprVisitor::visit_binary
+        Instr* binary_expression(const SereParser::BinaryExprAST& expr) {
+            Builder& builder = *builder_;
+            Instr* left = expression(*expr.left);
+            Instr* right = expression(*expr.right);
+            if (left->type == SereTypeKind::DYNAMIC || right->type == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+            const TokenType op = expr.op.type;
+
+            // A float may be raised to an int power
+            if (op == TokenType::TOKEN_DOUBLE_STAR && Runtime::is_float(left->type) && Runtime::is_integer(right->type))
+                return builder.binary(op, left->type, left, right);
+
+            // A literal takes the other operand's type when it holds the value: `x + 1` stays a u8
+            SereTypeKind left_as = left->type, right_as = right->type;
+            if (Visitor::is_untyped_literal(*expr.left) && converts(left, right->type, true))
+                left_as = right->type;
+            else if (Visitor::is_untyped_literal(*expr.right) && converts(right, left->type, true))
+                right_as = left->type;
+            const SereTypeKind kind = checker_->check_binary(left_as, right_as, expr.op.lexeme);
+            left = convert(left, kind);
+            right = convert(right, kind);
+            if (SereParser::is_comparison_op(op)) return builder.compare(op, left, right);
+
+            const bool division = op == TokenType::TOKEN_SLASH || op == TokenType::TOKEN_DOUBLE_SLASH || op == TokenType::TOKEN_PERCENT;
+            if (!division && op != TokenType::TOKEN_PLUS && op != TokenType::TOKEN_MINUS && op != TokenType::TOKEN_STAR &&
+                op != TokenType::TOKEN_DOUBLE_STAR)
+                throw std::runtime_error("BinaryExprAST: Invalid operator.");
+            const bool integer = Runtime::is_integer(kind);
+            if (integer && division && right->is_constant() && right->constant.bits == 0)
+                throw std::runtime_error("Integer division by zero.");
+            if (integer && op == TokenType::TOKEN_DOUBLE_STAR && right->is_constant() && Runtime::is_signed(kind) &&
+                right->constant.as_signed() < 0)
+                throw std::runtime_error("Negative exponent needs a float base.");
+            const bool trapv = integer && SereParser::RT::ctx.checked_arith && !division;
+            if (trapv && left->is_constant() && right->is_constant() && SereParser::const_overflows(op, left->constant, right->constant))
+                throw std::runtime_error("Integer overflow.");
+            return builder.binary(op, kind, left, right, integer && division, trapv);
+        }
+
+        // ExprVisitor::visit_logical: the deciding operand, a select, or a branch
+        Instr* logical_expression(const SereParser::LogicalExprAST& expr) {
+            Builder& builder = *builder_;
+            const bool is_and = expr.op.type == TokenType::TOKEN_AND;
+            if (!is_and && expr.op.type != TokenType::TOKEN_OR) throw std::runtime_error("LogicalExprAST: Invalid operator.");
+
+            Instr* left = expression(*expr.left);
+            Instr* left_truth = truth(left);
+            if (left_truth->is_constant()) {
+                if (left_truth->constant.truth() != is_and) return left; // `False and b`, `True or b`: b is never evaluated
+                return expression(*expr.right);
+            }
+
+            int budget = 6;
+            auto variable_kind = [this](const std::string& name) { return builder_->kind_of(name).value_or(SereTypeKind::UNKNOWN); };
+            if (Visitor::is_speculatable(*expr.right, budget, variable_kind)) {
+                Instr* right = expression(*expr.right);
+                if (right->type != left->type) {
+                    left = left_truth;
+                    right = truth(right);
+                }
+                return is_and ? builder.select(left_truth, right, left) : builder.select(left_truth, left, right);
+            }
+
+            Function& fn = builder.function();
+            Block* left_block = builder.block();
+            Block* right_block = fn.add_block(is_and ? "and.rhs" : "or.rhs");
+            Block* merge_block = fn.add_block(is_and ? "and.end" : "or.end");
+            if (is_and)
+                builder.condbr(left_truth, right_block, merge_block);
+            else
+                builder.condbr(left_truth, merge_block, right_block);
+
+            builder.seal(right_block);
+            builder.set_block(right_block);
+            Instr* right = expression(*expr.right);
+            const bool same_type = right->type == left->type;
+            if (!same_type) right = truth(right);
+            Block* right_end = builder.block(); // `b` may have branched itself
+            builder.br(merge_block);
+
+            builder.seal(merge_block);
+            builder.set_block(merge_block);
+            Instr* phi = builder.phi(merge_block, right->type, is_and ? "and" : "or");
+            builder.add_incoming(phi, same_type ? left : left_truth, left_block);
+            builder.add_incoming(phi, right, right_end);
+            return phi;
+        }
+
+        // ExprVisitor::visit_print
+        Instr* print_call(const SereParser::CallExprAST& expr) {
+            std::vector<Instr*> pieces;
+            auto text = [&](const std::string& constant) { pieces.push_back(builder_->constant(ConstValue::of_str(constant))); };
+            for (size_t i = 0; i < expr.arguments.size(); ++i) {
+                if (i > 0) text(" ");
+                if (auto format = dynamic_cast<const SereParser::FormatExprAST*>(expr.arguments[i].get()))
+                    for (const auto& part : format->parts) pieces.push_back(expression(*part));
+                else
+                    pieces.push_back(expression(*expr.arguments[i]));
+            }
+            text("\n");
+            if (pieces.size() == 2 && !pieces[0]->is_constant() && pieces[0]->type == SereTypeKind::STRING)
+                return builder_->call("print", SereTypeKind::NONE, {pieces[0]});
+            return builder_->print(std::move(pieces));
+        }
+
+        // ExprVisitor::visit_call; constant calls are evaluated by the evalcalls pass
+        Instr* call_expression(const SereParser::CallExprAST& expr) {
+            using SereParser::RT;
+            if (Visitor::is_print(expr)) return print_call(expr);
+            const std::string symbol = RT::resolve_function_name(expr.callee.lexeme);
+            llvm::Function* callee = RT::ctx.module->getFunction(symbol);
+            auto generic = RT::generics.find(symbol);
+            const bool is_generic = !callee && generic != RT::generics.end();
+
+            // `T(x)` converts explicitly, unless a function of that name exists
+            SereTypeKind conversion = Runtime::kind_from_name(expr.callee.lexeme);
+            if (!callee && !is_generic && conversion == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+            if (!callee && !is_generic && (Runtime::is_numeric(conversion) || conversion == SereTypeKind::BOOL)) {
+                if (expr.arguments.size() != 1) throw std::runtime_error(expr.callee.lexeme + "() takes exactly one argument.");
+                return convert(expression(*expr.arguments[0]), conversion);
+            }
+            if (!callee && !is_generic) throw std::runtime_error(SereParser::_sanitize_name_impl_(expr.callee.lexeme) + " is not defined in the current scope.");
+            if (is_generic && expr.arguments.size() != generic->second->params.size())
+                throw std::runtime_error("argument count mismatch in function call to " + SereParser::_sanitize_name_impl_(expr.callee.lexeme));
+
+            std::vector<Instr*> values;
+            for (const auto& argument : expr.arguments) values.push_back(expression(*argument));
+
+            // A generic function is specialized for the argument types (annotated parameters keep theirs)
+            if (is_generic) {
+                const SereParser::FunctionStatAST& func = *generic->second;
+                std::vector<SereTypeKind> params;
+                for (size_t i = 0; i < values.size(); ++i) {
+                    SereTypeKind kind = func.params[i]->type_annotation
+                                            ? SereParser::parse_type_annotation(SereParser::_sanitize_name_impl_(func.params[i]->type_annotation->name.lexeme))
+                                            : values[i]->type;
+                    if (kind == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+                    if (!Runtime::is_numeric(kind) && kind != SereTypeKind::BOOL && kind != SereTypeKind::STRING)
+                        throw std::runtime_error("Argument " + std::to_string(i) + " of call to " + SereParser::_sanitize_name_impl_(expr.callee.lexeme) +
+                                                 " has no value type (" + Runtime::to_string(kind) + ").");
+                    params.push_back(kind);
+                }
+                callee = statements_.specialize(func, params);
+            }
+
+            llvm::FunctionType* func_type = callee->getFunctionType();
+            if (func_type->isVarArg()) throw Unsupported("variadic call");
+            if (expr.arguments.size() != func_type->getNumParams())
+                throw std::runtime_error("argument count mismatch in function call to " + SereParser::_sanitize_name_impl_(expr.callee.lexeme));
+            auto signature = RT::signatures.find(callee->getName().str());
+            const Runtime::FunctionSignature* sig = signature != RT::signatures.end() ? &signature->second : nullptr;
+
+            // Arguments convert like assignments: losslessly, or literals that fit
+            for (size_t i = 0; i < values.size(); ++i) {
+                SereTypeKind to = sig ? Runtime::kind_from_name(sig->param_types[i]) : SereParser::default_kind_of(func_type->getParamType(i));
+                if (values[i]->type == to) continue;
+                if (!converts(values[i], to, Visitor::is_untyped_literal(*expr.arguments[i])))
+                    throw std::runtime_error("Argument " + std::to_string(i) + " of call to " + SereParser::_sanitize_name_impl_(expr.callee.lexeme) + " is " +
+                                             Runtime::to_string(values[i]->type) + ", expected " + Runtime::to_string(to) +
+                                             "; convert it explicitly, e.g. " + Runtime::to_string(to) + "(x).");
+                values[i] = convert(values[i], to);
+            }
+            SereTypeKind kind = sig ? Runtime::kind_from_name(sig->return_type) : SereParser::default_kind_of(func_type->getReturnType());
+            if (kind == SereTypeKind::DYNAMIC || kind == SereTypeKind::UNKNOWN) throw Unsupported(Runtime::to_string(kind) + " result");
+            return builder_->call(callee->getName().str(), kind, std::move(values));
+        }
+
+        // ===== Types =====
+
+        // converts_implicitly, for the types SIR has
+        static bool converts(const Instr* value, SereTypeKind to, bool literal) {
+            if (value->type == SereTypeKind::DYNAMIC || to == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+            if (Runtime::widens_to(value->type, to)) return true;
+            return literal && Runtime::is_numeric(to) && value->is_constant() && SereParser::const_fits(value->constant, to);
+        }
+
+        // convert_value, checked here: codegen cannot fail
+        Instr* convert(Instr* value, SereTypeKind to) {
+            const SereTypeKind from = value->type;
+            if (from == to) return value;
+            if (from == SereTypeKind::DYNAMIC || to == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+            const bool valid = to == SereTypeKind::BOOL ? Runtime::is_numeric(from) || from == SereTypeKind::STRING
+                                                        : Runtime::is_numeric(to) && (Runtime::is_numeric(from) || from == SereTypeKind::BOOL);
+            if (!valid) throw std::runtime_error("Cannot convert " + Runtime::to_string(from) + " to " + Runtime::to_string(to) + ".");
+            return builder_->convert(value, to);
+        }
+
+        // truth_of
+        Instr* truth(Instr* value) {
+            if (value->type != SereTypeKind::BOOL && !Runtime::is_numeric(value->type) && value->type != SereTypeKind::STRING) {
+                if (value->type == SereTypeKind::DYNAMIC) throw Unsupported("dyn values");
+                throw std::runtime_error("Value cannot be used as a condition.");
+            }
+            return builder_->truth(value);
+        }
+
+        SereParser::StatVisitor<R>& statements_;
+        std::shared_ptr<SereParser::TypeChecker> checker_;
+        Builder* builder_ = nullptr;
+        const Runtime::FunctionSignature* signature_ = nullptr;
+    };
+
+} // namespace SereSIR
+
+#endif // SIR_LOWERING_HPP
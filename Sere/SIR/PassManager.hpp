@@ -0,0 +1,53 @@
+#ifndef SIR_PASSMANAGER_HPP
+#define SIR_PASSMANAGER_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./SIR.hpp"
+#include "./Verifier.hpp"
+
+namespace SereSIR {
+
+    // A transformation of one function; run() says whether it changed anything.
+    class Pass {
+    public:
+        virtual ~Pass() = default;
+        virtual const char* name() const = 0;
+        virtual bool run(Function& fn) = 0;
+    };
+
+    //
+    // Runs passes in order over a function and verifies it after each
+    // one, so a pass that breaks an invariant is named in the error rather
+    // than surfacing as a broken LLVM module later.
+    //
+    class PassManager {
+    public:
+        void add(std::unique_ptr<Pass> pass) { passes_.push_back(std::move(pass)); }
+
+        bool run(Function& fn) {
+            bool changed = false;
+            for (auto& pass : passes_) {
+                changed |= pass->run(fn);
+                try {
+                    verify(fn);
+                } catch (const std::runtime_error& e) {
+                    throw std::runtime_error(std::string(e.what()) + "\n  (after SIR pass '" + pass->name() + "')");
+                }
+            }
+            return changed;
+        }
+
+        size_t size() const { return passes_.size(); }
+
+    private:
+        std::vector<std::unique_ptr<Pass>> passes_;
+    };
+
+} // namespace SereSIR
+
+#endif // SIR_PASSMANAGER_HPP
@@ -0,0 +1,461 @@
+#ifndef SIR_PASSES_HPP
+#define SIR_PASSES_HPP
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./Analysis.hpp"
+#include "./PassManager.hpp"
+#include "./SIR.hpp"
+
+namespace SereSIR {
+
+    //
+    // Folds instructions of constants by Sere's arithmetic (ConstValue),
+    // phis and selects that can only be one value, and branches on a
+    // constant, whose untaken side is deleted when nothing else reaches
+    // it; adjacent constants a print writes become the one str they
+    // format to. Repeats until nothing changes: a folded branch can make a
+    // phi constant and that another branch.
+    //
+    class ConstantPropagation : public Pass {
+    public:
+        const char* name() const override { return "constprop"; }
+
+        bool run(Function& fn) override {
+            bool changed = false;
+            for (bool progress = true; progress;) {
+                progress = false;
+                for (auto& block : fn.blocks) {
+                    for (size_t i = 0; i < block->instrs.size();) {
+                        Instr* instr = block->instrs[i].get();
+                        if (Instr* value = fold(fn, *instr)) {
+                            fn.replace_uses(instr, value);
+                            block->erase(instr);
+                            progress = true;
+                            continue;
+                        }
+                        if (instr->op == Opcode::TRAP_IF && instr->operands[0]->is_constant() && !instr->operands[0]->constant.truth()) {
+                            block->erase(instr);
+                            progress = true;
+                            continue;
+                        }
+                        if (instr->op == Opcode::PRINT && format_constants(fn, *instr)) progress = true;
+                        if (instr->op == Opcode::CONDBR && instr->operands[0]->is_constant()) {
+                            const bool truth = instr->operands[0]->constant.truth();
+                            Block* taken = instr->blocks[truth ? 0 : 1];
+                            (truth ? instr->blocks[1] : instr->blocks[0])->remove_pred(block.get());
+                            instr->op = Opcode::BR;
+                            instr->operands.clear();
+                            instr->blocks = {taken};
+                            progress = true;
+                        }
+                        ++i;
+                    }
+                }
+                progress |= fn.remove_unreachable_blocks();
+                changed |= progress;
+            }
+            return changed;
+        }
+
+    private:
+        // The value `instr` always has, or null
+        static Instr* fold(Function& fn, const Instr& instr) {
+            auto all_constant = [&] {
+                for (const Instr* op : instr.operands)
+                    if (!op->is_constant()) return false;
+                return !instr.operands.empty();
+            };
+            std::optional<ConstValue> value;
+            switch (instr.op) {
+            case Opcode::BINARY:
+            case Opcode::COMPARE:
+                if (!all_constant()) break;
+                if (instr.trapv && SereParser::const_overflows(instr.token, instr.operands[0]->constant, instr.operands[1]->constant))
+                    break; // traps
+                value = SereParser::const_binary(instr.token, instr.operands[0]->constant, instr.operands[1]->constant);
+                break;
+            case Opcode::NEG:
+                if (!all_constant() || (instr.trapv && SereParser::const_negate_overflows(instr.operands[0]->constant))) break;
+                value = SereParser::const_negate(instr.operands[0]->constant);
+                break;
+            case Opcode::NOT:
+                if (all_constant()) value = ConstValue::of_bool(!instr.operands[0]->constant.truth());
+                break;
+            case Opcode::CONVERT:
+                if (all_constant())
+                    value = instr.type == SereTypeKind::BOOL ? ConstValue::of_bool(instr.operands[0]->constant.truth())
+                                                             : SereParser::const_convert(instr.operands[0]->constant, instr.type);
+                break;
+            case Opcode::SELECT:
+                if (instr.operands[0]->is_constant()) return instr.operands[instr.operands[0]->constant.truth() ? 1 : 2];
+                if (instr.operands[1] == instr.operands[2]) return instr.operands[1];
+                break;
+            case Opcode::RANGE_NONEMPTY:
+            case Opcode::RANGE_TRIPS:
+                if (all_constant()) value = fold_range(instr);
+                break;
+            case Opcode::PHI: {
+                Instr* same = nullptr;
+                for (Instr* op : instr.operands) {
+                    if (op == same || op == &instr) continue;
+                    if (same) return nullptr;
+                    same = op;
+                }
+                return same ? same : fn.undef(instr.type);
+            }
+            default:
+                break;
+            }
+            return value && value->kind == instr.type ? fn.constant(*value) : nullptr;
+        }
+
+        // Replaces each run of constant print operands by its text, unless it already is one str
+        static bool format_constants(Function& fn, Instr& print) {
+            bool changed = false;
+            std::vector<Instr*> operands;
+            for (size_t i = 0; i < print.operands.size();) {
+                size_t end = i;
+                while (end < print.operands.size() && print.operands[end]->is_constant()) ++end;
+                if (end == i) {
+                    operands.push_back(print.operands[i++]);
+                    continue;
+                }
+                if (end - i == 1 && print.operands[i]->type == SereTypeKind::STRING) {
+                    operands.push_back(print.operands[i++]);
+                    continue;
+                }
+                std::string text;
+                for (; i < end; ++i) text += SereParser::const_format(print.operands[i]->constant);
+                operands.push_back(fn.constant(ConstValue::of_str(text)));
+                changed = true;
+            }
+            print.operands = std::move(operands);
+            return changed;
+        }
+
+        // SereIR::range_nonempty and range_trips of constants; the step is not zero
+        static std::optional<ConstValue> fold_range(const Instr& instr) {
+            const ConstValue& start = instr.operands[0]->constant;
+            const ConstValue& stop = instr.operands[1]->constant;
+            const ConstValue& step = instr.operands[2]->constant;
+            if (step.bits == 0) return std::nullopt; // the zero-step trap comes first
+            const bool is_signed = Runtime::is_signed(start.kind);
+            const bool descending = is_signed && step.as_signed() < 0;
+            const bool nonempty = descending ? start.as_signed() > stop.as_signed()
+                                             : (is_signed ? start.as_signed() < stop.as_signed() : start.bits < stop.bits);
+            if (instr.op == Opcode::RANGE_NONEMPTY) return ConstValue::of_bool(nonempty);
+            if (!nonempty) return std::nullopt; // only computed for a range with elements
+            const ConstValue distance = ConstValue::of_int(instr.type, descending ? start.bits - stop.bits : stop.bits - start.bits);
+            const ConstValue magnitude = ConstValue::of_int(instr.type, descending ? 0 - step.bits : step.bits);
+            return ConstValue::of_int(instr.type, (distance.bits - 1) / magnitude.bits + 1);
+        }
+    };
+
+    //
+    // Evaluates calls of Sere functions whose arguments are all constants,
+    // as lowering does for direct calls (CompileTimeEvaluator); constant
+    // propagation first finds more of them. The evaluator says nothing for
+    // calls that must run (@noinline, side effects, out of budget).
+    //
+    class CallEvaluation : public Pass {
+    public:
+        using Evaluator = std::function<std::optional<ConstValue>(const std::string&, const std::vector<ConstValue>&)>;
+
+        explicit CallEvaluation(Evaluator evaluate) : evaluate_(std::move(evaluate)) {}
+
+        const char* name() const override { return "evalcalls"; }
+
+        bool run(Function& fn) override {
+            if (!evaluate_) return false;
+            bool changed = false;
+            for (auto& block : fn.blocks) {
+                for (size_t i = 0; i < block->instrs.size(); ++i) {
+                    Instr* instr = block->instrs[i].get();
+                    if (instr->op != Opcode::CALL) continue;
+                    std::vector<ConstValue> args;
+                    for (const Instr* op : instr->operands)
+                        if (op->is_constant()) args.push_back(op->constant);
+                    if (args.size() != instr->operands.size()) continue;
+                    auto value = evaluate_(instr->name, args);
+                    if (!value || value->kind != instr->type) continue;
+                    fn.replace_uses(instr, fn.constant(*value));
+                    block->erase(instr);
+                    --i;
+                    changed = true;
+                }
+            }
+            return changed;
+        }
+
+    private:
+        Evaluator evaluate_;
+    };
+
+    //
+    // Integer `/`, `//` and `%` trap on a zero divisor. The check goes
+    // where the divisor is known not to be zero:
+    //   - a constant, nonzero divisor,
+    //   - under a branch that tested it: `if n != 0`, `while b > 0`,
+    //     `if d < 0` on a signed d (on the edge that holds),
+    //   - after an earlier division by the same value, which would have
+    //     trapped already.
+    //
+    class DivisorCheckElimination : public Pass {
+    public:
+        const char* name() const override { return "divcheck"; }
+
+        bool run(Function& fn) override {
+            Dominators dominators(fn);
+
+            // Values known nonzero on entry to a block, from the branch into it
+            std::vector<std::pair<const Instr*, const Block*>> guards;
+            for (const auto& block : fn.blocks) {
+                if (block->preds.size() != 1) continue;
+                const Instr* branch = block->preds[0]->terminator();
+                if (branch->op != Opcode::CONDBR || branch->blocks[0] == branch->blocks[1]) continue;
+                if (const Instr* value = nonzero_when(*branch->operands[0], branch->blocks[0] == block.get()))
+                    guards.emplace_back(value, block.get());
+            }
+
+            std::vector<const Instr*> divisions;
+            bool changed = false;
+            for (Block* block : fn.reverse_postorder()) {
+                for (const auto& owned : block->instrs) {
+                    Instr* instr = owned.get();
+                    if (instr->op != Opcode::BINARY || !is_division(instr->token) || !Runtime::is_integer(instr->type)) continue;
+                    const Instr* divisor = instr->operands[1];
+                    bool known = divisor->is_constant() && divisor->constant.bits != 0;
+                    for (const auto& [value, where] : guards)
+                        known = known || (value == divisor && dominators.dominates(where, block));
+                    for (const Instr* earlier : divisions)
+                        known = known || (earlier->operands[1] == divisor && dominators.available(earlier, instr, 0));
+                    if (known && instr->checked) {
+                        instr->checked = false;
+                        changed = true;
+                    }
+                    divisions.push_back(instr);
+                }
+            }
+            return changed;
+        }
+
+    private:
+        static bool is_division(SereLexer::TokenType op) {
+            return op == SereLexer::TokenType::TOKEN_SLASH || op == SereLexer::TokenType::TOKEN_DOUBLE_SLASH ||
+                   op == SereLexer::TokenType::TOKEN_PERCENT;
+        }
+
+        // The integer that cannot be zero where `condition` is `holds`, or null
+        static const Instr* nonzero_when(const Instr& condition, bool holds) {
+            using SereLexer::TokenType;
+            if (condition.op != Opcode::COMPARE || !Runtime::is_integer(condition.operands[0]->type)) return nullptr;
+            const Instr* value = condition.operands[0];
+            const Instr* bound = condition.operands[1];
+            TokenType op = condition.token;
+            if (value->is_constant()) {
+                std::swap(value, bound);
+                op = mirrored(op);
+            }
+            if (!bound->is_constant() || value->is_constant()) return nullptr;
+            if (!holds) op = negated(op);
+
+            const bool is_signed = Runtime::is_signed(bound->type);
+            const int64_t c = bound->constant.as_signed();
+            const bool zero = bound->constant.bits == 0;
+            const bool negative = is_signed && c < 0;
+            switch (op) {
+            case TokenType::TOKEN_BANG_EQUAL: return zero ? value : nullptr;
+            case TokenType::TOKEN_EQUAL_EQUAL: return zero ? nullptr : value;
+            case TokenType::TOKEN_GREATER: return negative ? nullptr : value;
+            case TokenType::TOKEN_GREATER_EQUAL: return negative || zero ? nullptr : value;
+            case TokenType::TOKEN_LESS: return is_signed && (negative || zero) ? value : nullptr;
+            case TokenType::TOKEN_LESS_EQUAL: return negative ? value : nullptr;
+            default: return nullptr;
+            }
+        }
+
+        // `c op x` as `x op' c`
+        static SereLexer::TokenType mirrored(SereLexer::TokenType op) {
+            using SereLexer::TokenType;
+            switch (op) {
+            case TokenType::TOKEN_LESS: return TokenType::TOKEN_GREATER;
+            case TokenType::TOKEN_LESS_EQUAL: return TokenType::TOKEN_GREATER_EQUAL;
+            case TokenType::TOKEN_GREATER: return TokenType::TOKEN_LESS;
+            case TokenType::TOKEN_GREATER_EQUAL: return TokenType::TOKEN_LESS_EQUAL;
+            default: return op;
+            }
+        }
+    };
+
+    //
+    // Drops the overflow check of integer `+`, `-`, `*` and negation
+    // (--checked-arith) where the range of the result, by Ranges, fits
+    // the type: loop counters below their range() stop, sums of small
+    // values, `i + 1` under `i < n`. Such arithmetic is marked as not
+    // wrapping, which LLVM can use in turn.
+    //
+    class OverflowCheckElimination : public Pass {
+    public:
+        const char* name() const override { return "ovfcheck"; }
+
+        bool run(Function& fn) override {
+            Ranges ranges(fn);
+            bool changed = false;
+            for (auto& block : fn.blocks) {
+                for (auto& instr : block->instrs) {
+                    if (!instr->trapv || instr->token == SereLexer::TokenType::TOKEN_DOUBLE_STAR) continue;
+                    Ranges::Interval result;
+                    const Ranges::Interval a = ranges.at(instr->operands[0], block.get());
+                    if (instr->op == Opcode::NEG)
+                        result = {-a.hi, -a.lo};
+                    else
+                        result = Ranges::arith(instr->token, a, ranges.at(instr->operands[1], block.get()));
+                    if (!Ranges::fits(result, instr->type)) continue;
+                    instr->trapv = false;
+                    instr->no_wrap = instr->op == Opcode::BINARY;
+                    changed = true;
+                }
+            }
+            return changed;
+        }
+    };
+
+    //
+    // A function that returns a call of itself, `return f(n - 1, acc * n)`,
+    // loops instead: the entry moves into a new first block, which branches
+    // to it with the parameters, and every such call branches back with its
+    // arguments. The phis that take the parameters' place get them from
+    // the first block and the arguments from each call site. The loop may
+    // not terminate, any more than the recursion would.
+    //
+    class TailRecursionElimination : public Pass {
+    public:
+        const char* name() const override { return "tailrec"; }
+
+        bool run(Function& fn) override {
+            std::vector<Block*> sites;
+            for (auto& block : fn.blocks)
+                if (self_tail_call(fn, *block)) sites.push_back(block.get());
+            if (sites.empty() || !fn.blocks.front()->preds.empty()) return false;
+
+            // The old entry becomes the loop header; labels stay with their code
+            Block* header = fn.blocks.front().get();
+            Block* entry = fn.add_block("tailrec");
+            std::swap(entry->label, header->label);
+            std::rotate(fn.blocks.begin(), fn.blocks.end() - 1, fn.blocks.end());
+            auto br = std::make_unique<Instr>(Opcode::BR, SereTypeKind::NONE);
+            br->blocks = {header};
+            br->parent = entry;
+            entry->instrs.push_back(std::move(br));
+
+            std::vector<Instr*> phis;
+            for (Instr* param : fn.params) {
+                auto phi = std::make_unique<Instr>(Opcode::PHI, param->type);
+                phi->name = param->name;
+                phi->parent = header;
+                phis.push_back(phi.get());
+                header->instrs.insert(header->instrs.begin() + static_cast<std::ptrdiff_t>(phis.size() - 1), std::move(phi));
+            }
+            for (size_t i = 0; i < phis.size(); ++i) fn.replace_uses(fn.params[i], phis[i]);
+            add_edge(header, entry, phis, fn.params);
+
+            for (Block* block : sites) {
+                block->instrs.pop_back(); // ret
+                std::vector<Instr*> args = block->instrs.back()->operands;
+                block->instrs.pop_back(); // call
+                auto back = std::make_unique<Instr>(Opcode::BR, SereTypeKind::NONE);
+                back->blocks = {header};
+                back->parent = block;
+                back->loop = LoopKind::WHILE;
+                block->instrs.push_back(std::move(back));
+                add_edge(header, block, phis, args);
+            }
+            return true;
+        }
+
+    private:
+        // `block` ends in `ret f(...)` (or `f(...)` and `ret` in a function returning nothing)
+        static bool self_tail_call(const Function& fn, const Block& block) {
+            const Instr* ret = block.terminator();
+            if (!ret || ret->op != Opcode::RET || block.instrs.size() < 2) return false;
+            const Instr* call = block.instrs[block.instrs.size() - 2].get();
+            if (call->op != Opcode::CALL || call->name != fn.name || call->operands.size() != fn.params.size()) return false;
+            for (size_t i = 0; i < call->operands.size(); ++i)
+                if (call->operands[i]->type != fn.params[i]->type) return false;
+            if (ret->operands.empty()) return fn.return_type == SereTypeKind::NONE;
+            return ret->operands[0] == call;
+        }
+
+        static void add_edge(Block* header, Block* from, const std::vector<Instr*>& phis, const std::vector<Instr*>& values) {
+            header->preds.push_back(from);
+            for (size_t i = 0; i < phis.size(); ++i) {
+                phis[i]->operands.push_back(values[i]);
+                phis[i]->blocks.push_back(from);
+            }
+        }
+    };
+
+    // Deletes instructions nothing uses and that cannot trap or have effects, and unreachable blocks.
+    class DeadCodeElimination : public Pass {
+    public:
+        const char* name() const override { return "dce"; }
+
+        bool run(Function& fn) override {
+            bool changed = fn.remove_unreachable_blocks();
+            for (bool progress = true; progress;) {
+                progress = false;
+                std::unordered_map<const Instr*, unsigned> uses;
+                for (const auto& block : fn.blocks)
+                    for (const auto& instr : block->instrs)
+                        for (const Instr* op : instr->operands)
+                            if (op != instr.get()) ++uses[op];
+                for (auto& block : fn.blocks) {
+                    for (size_t i = block->instrs.size(); i-- > 0;) {
+                        Instr* instr = block->instrs[i].get();
+                        if (instr->has_side_effects() || uses.count(instr)) continue;
+                        block->erase(instr);
+                        progress = true;
+                    }
+                }
+                changed |= progress;
+            }
+            return changed;
+        }
+    };
+
+    // What runs when --sir-passes does not say
+    inline std::vector<std::string> default_pipeline() {
+        return {"constprop", "evalcalls", "constprop", "tailrec", "divcheck", "ovfcheck", "dce"};
+    }
+
+    inline PassManager make_pipeline(const std::vector<std::string>& names, CallEvaluation::Evaluator evaluate) {
+        PassManager passes;
+        for (const std::string& name : names) {
+            if (name == "constprop")
+                passes.add(std::make_unique<ConstantPropagation>());
+            else if (name == "evalcalls")
+                passes.add(std::make_unique<CallEvaluation>(evaluate));
+            else if (name == "tailrec")
+                passes.add(std::make_unique<TailRecursionElimination>());
+            else if (name == "divcheck")
+                passes.add(std::make_unique<DivisorCheckElimination>());
+            else if (name == "ovfcheck")
+                passes.add(std::make_unique<OverflowCheckElimination>());
+            else if (name == "dce")
+                passes.add(std::make_unique<DeadCodeElimination>());
+            else
+                throw std::runtime_error("Unknown SIR pass '" + name + "' (known: constprop, evalcalls, tailrec, divcheck, ovfcheck, dce).");
+        }
+        return passes;
+    }
+
+} // namespace SereSIR
+
+#endif // SIR_PASSES_HPP
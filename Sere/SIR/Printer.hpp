@@ -0,0 +1,227 @@
+#ifndef SIR_PRINTER_HPP
+#define SIR_PRINTER_HPP
+
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./SIR.hpp"
+
+//
+// The textual form of SIR (--emit=sir), for reading and for testing
+// passes:
+//
+//   fn gcd(%a: int, %b: int) -> int {
+//   entry:
+//     br while.cond
+//   while.cond:                                  ; preds: entry, while.body
+//     %b.1 = phi int [%b, entry], [%a.3, while.body]
+//     ...
+//
+// Values print as %name.n (or %n when they have no name) with n
+// counting instructions, so any line identifies one instruction;
+// constants print inline with their type.
+//
+namespace SereSIR {
+
+    namespace detail {
+
+        inline const char* opcode_name(const Instr& instr) {
+            using SereLexer::TokenType;
+            switch (instr.op) {
+            case Opcode::BINARY:
+                switch (instr.token) {
+                case TokenType::TOKEN_PLUS: return "add";
+                case TokenType::TOKEN_MINUS: return "sub";
+                case TokenType::TOKEN_STAR: return "mul";
+                case TokenType::TOKEN_SLASH: return "div";
+                case TokenType::TOKEN_DOUBLE_SLASH: return "floordiv";
+                case TokenType::TOKEN_PERCENT: return "mod";
+                case TokenType::TOKEN_DOUBLE_STAR: return "pow";
+                default: return "binary?";
+                }
+            case Opcode::COMPARE:
+                switch (instr.token) {
+                case TokenType::TOKEN_LESS: return "lt";
+                case TokenType::TOKEN_LESS_EQUAL: return "le";
+                case TokenType::TOKEN_GREATER: return "gt";
+                case TokenType::TOKEN_GREATER_EQUAL: return "ge";
+                case TokenType::TOKEN_EQUAL_EQUAL: return "eq";
+                case TokenType::TOKEN_BANG_EQUAL: return "ne";
+                default: return "compare?";
+                }
+            case Opcode::NEG: return "neg";
+            case Opcode::NOT: return "not";
+            case Opcode::CONVERT: return "convert";
+            case Opcode::SELECT: return "select";
+            case Opcode::CALL: return "call";
+            case Opcode::PRINT: return "print";
+            case Opcode::PHI: return "phi";
+            case Opcode::TRAP_IF: return "trapif";
+            case Opcode::RANGE_NONEMPTY: return "range.nonempty";
+            case Opcode::RANGE_TRIPS: return "range.trips";
+            case Opcode::BR: return "br";
+            case Opcode::CONDBR: return "condbr";
+            case Opcode::RET: return "ret";
+            default: return "value";
+            }
+        }
+
+        inline std::string quoted(const std::string& text) {
+            std::string out = "\"";
+            for (unsigned char c : text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += static_cast<char>(c);
+                } else if (c < 0x20 || c >= 0x7f) {
+                    char hex[8];
+                    std::snprintf(hex, sizeof hex, "\\%02X", c);
+                    out += hex;
+                } else
+                    out += static_cast<char>(c);
+            }
+            return out + "\"";
+        }
+
+        inline std::string constant_text(const ConstValue& value) {
+            if (value.kind == SereTypeKind::STRING) return quoted(value.text);
+            if (value.kind == SereTypeKind::BOOL) return value.bits ? "true" : "false";
+            if (Runtime::is_float(value.kind)) {
+                char text[32];
+                std::snprintf(text, sizeof text, "%.17g", value.real);
+                return text;
+            }
+            return Runtime::is_signed(value.kind) ? std::to_string(value.as_signed()) : std::to_string(value.bits);
+        }
+
+    } // namespace detail
+
+    class Printer {
+    public:
+        explicit Printer(std::ostream& out) : out_(out) {}
+
+        void print(const Module& module) {
+            if (module.overflow_checks)
+                out_ << "; overflow checks: " << module.overflow_checks - module.overflow_checks_kept << " of "
+                     << module.overflow_checks << " removed\n";
+            for (const auto& [symbol, reason] : module.direct)
+                out_ << "; " << symbol << ": lowered directly (" << reason << ")\n";
+            for (const auto& fn : module.functions) {
+                if (&fn != &module.functions.front() || !module.direct.empty() || module.overflow_checks) out_ << "\n";
+                print(*fn);
+            }
+        }
+
+        void print(const Function& fn) {
+            names_.clear();
+            count_ = 0;
+            out_ << "fn " << fn.name << "(";
+            for (size_t i = 0; i < fn.params.size(); ++i)
+                out_ << (i ? ", " : "") << "%" << fn.params[i]->name << ": " << Runtime::to_string(fn.params[i]->type);
+            out_ << ") -> " << Runtime::to_string(fn.return_type) << " {\n";
+
+            // Numbered in the order printed, so the text reads top to bottom
+            std::vector<Block*> order = fn.reverse_postorder();
+            for (const auto& block : fn.blocks)
+                if (std::find(order.begin(), order.end(), block.get()) == order.end()) order.push_back(block.get());
+            for (Block* block : order)
+                for (const auto& instr : block->instrs)
+                    if (instr->type != SereTypeKind::NONE) name_of(instr.get());
+
+            for (Block* block : order) {
+                std::string label = block->label + ":";
+                out_ << label;
+                if (!block->preds.empty()) {
+                    out_ << std::string(label.size() < 40 ? 40 - label.size() : 1, ' ') << "; preds:";
+                    for (size_t i = 0; i < block->preds.size(); ++i) out_ << (i ? ", " : " ") << block->preds[i]->label;
+                }
+                out_ << "\n";
+                for (const auto& instr : block->instrs) out_ << "  " << text(*instr) << "\n";
+            }
+            out_ << "}\n";
+        }
+
+        std::string text(const Instr& instr) {
+            std::ostringstream line;
+            if (instr.type != SereTypeKind::NONE) line << name_of(&instr) << " = ";
+            line << detail::opcode_name(instr);
+            switch (instr.op) {
+            case Opcode::CALL:
+                if (instr.type != SereTypeKind::NONE) line << " " << Runtime::to_string(instr.type);
+                line << " @" << instr.name << "(";
+                for (size_t i = 0; i < instr.operands.size(); ++i) line << (i ? ", " : "") << operand(instr.operands[i]);
+                line << ")";
+                return line.str();
+            case Opcode::CONVERT:
+                line << " " << operand(instr.operands[0]) << " to " << Runtime::to_string(instr.type);
+                return line.str();
+            case Opcode::PHI:
+                line << " " << Runtime::to_string(instr.type);
+                for (size_t i = 0; i < instr.operands.size(); ++i)
+                    line << (i ? ", [" : " [") << operand(instr.operands[i]) << ", " << instr.blocks[i]->label << "]";
+                return line.str();
+            case Opcode::BINARY:
+            case Opcode::NEG:
+            case Opcode::SELECT:
+                line << " " << Runtime::to_string(instr.type);
+                break;
+            case Opcode::COMPARE:
+            case Opcode::RANGE_NONEMPTY:
+            case Opcode::RANGE_TRIPS:
+                line << " " << Runtime::to_string(instr.operands[0]->type);
+                break;
+            default:
+                break;
+            }
+
+            for (size_t i = 0; i < instr.operands.size(); ++i) line << (i ? ", " : " ") << operand(instr.operands[i]);
+            for (size_t i = 0; i < instr.blocks.size(); ++i)
+                line << (i || !instr.operands.empty() ? ", " : " ") << instr.blocks[i]->label;
+            if (instr.op == Opcode::TRAP_IF) line << " \"" << instr.name << "\"";
+            if (instr.no_wrap) line << " nowrap";
+            if (instr.checked) line << " checked";
+            if (instr.trapv) line << " trapv";
+            if (instr.loop == LoopKind::WHILE) line << " !while";
+            if (instr.loop == LoopKind::COUNTED) line << " !counted";
+            return line.str();
+        }
+
+    private:
+        std::string operand(const Instr* value) {
+            switch (value->op) {
+            case Opcode::CONST:
+                return Runtime::to_string(value->type) + " " + detail::constant_text(value->constant);
+            case Opcode::UNDEF:
+                return Runtime::to_string(value->type) + " undef";
+            case Opcode::PARAM:
+                return "%" + value->name;
+            default:
+                return name_of(value);
+            }
+        }
+
+        const std::string& name_of(const Instr* instr) {
+            auto found = names_.find(instr);
+            if (found != names_.end()) return found->second;
+            std::string number = std::to_string(count_++);
+            return names_[instr] = "%" + (instr->name.empty() ? number : instr->name + "." + number);
+        }
+
+        std::ostream& out_;
+        std::unordered_map<const Instr*, std::string> names_;
+        unsigned count_ = 0;
+    };
+
+    inline std::string to_string(const Function& fn) {
+        std::ostringstream out;
+        Printer(out).print(fn);
+        return out.str();
+    }
+
+} // namespace SereSIR
+
+#endif // SIR_PRINTER_HPP
@@ -0,0 +1,260 @@
+#ifndef SIR_SIR_HPP
+#define SIR_SIR_HPP
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../Parser/AST/Midlevel/ConstValue.hpp"
+#include "../Parser/AST/Midlevel/Environments.hpp"
+#include "../Scanner/TokenType.hpp"
+
+//
+// SIR, the Sere mid-level IR: a typed SSA form between the AST and LLVM
+// IR. Every value has a Sere type (a u32 is not an i32, a str is not a
+// pointer), and instructions keep Sere's operations rather than their
+// expansion: `//` is one floor division that traps on a zero divisor,
+// not the sdiv/srem/select/trap sequence LLVM sees. Language-level
+// passes (Passes.hpp) work on that and SIRCodeGen expands it afterwards.
+//
+// A Function owns its blocks, which own their instructions; constants,
+// parameters and undefined values belong to the function and no block.
+// Functions are small, so uses are found by scanning and not tracked.
+//
+namespace SereSIR {
+
+    using Runtime::SereTypeKind;
+    using SereParser::ConstValue;
+
+    // Lowering reached something SIR does not model; the function is lowered directly.
+    class Unsupported : public std::runtime_error {
+    public:
+        explicit Unsupported(const std::string& what) : std::runtime_error(what) {}
+    };
+
+    enum class Opcode {
+        CONST, UNDEF, PARAM,        // values outside any block
+        BINARY,                     // + - * / // % **, by `token`; both operands of the result type (but float ** int)
+        COMPARE,                    // < <= > >= == !=, of two operands of one type; a bool
+        NEG, NOT, CONVERT, SELECT,  // CONVERT is an implicit or explicit conversion, SELECT picks by a bool
+        CALL,                       // `callee`(operands)
+        PRINT,                      // writes its operands one after another, each formatted by its type (SereIR::emit_output)
+        PHI,                        // one operand per entry of `blocks`, the predecessor it comes from
+        TRAP_IF,                    // stops the program when the bool operand holds
+        RANGE_NONEMPTY,             // range(start, stop, step) has an element
+        RANGE_TRIPS,                // its length, in the unsigned type of the same width
+        BR, CONDBR, RET             // terminators
+    };
+
+    // What a back edge's llvm.loop metadata says (CodeGenContext::loop_id)
+    enum class LoopKind { NONE, WHILE, COUNTED };
+
+    struct Block;
+    struct Function;
+
+    struct Instr {
+        Opcode op;
+        SereTypeKind type = SereTypeKind::NONE; // of the result; NONE when there is none
+        std::vector<Instr*> operands;
+        std::vector<Block*> blocks; // BR, CONDBR: targets (true, false); PHI: incoming blocks
+        Block* parent = nullptr;
+
+        SereLexer::TokenType token = SereLexer::TokenType::TOKEN_EOF; // BINARY, COMPARE
+        ConstValue constant;                                          // CONST
+        std::string name;   // a name for printing; CALL: the callee's symbol; TRAP_IF: the trap's label
+        unsigned index = 0; // PARAM: position
+        bool checked = false; // integer / // %: traps on a zero divisor
+        bool no_wrap = false; // BINARY: cannot overflow (induction variables); nsw or nuw by signedness
+        bool trapv = false;   // integer + - * **, NEG: traps on overflow (--checked-arith)
+        LoopKind loop = LoopKind::NONE;
+
+        Instr(Opcode op_, SereTypeKind type_) : op(op_), type(type_) {}
+
+        bool is_terminator() const { return op == Opcode::BR || op == Opcode::CONDBR || op == Opcode::RET; }
+        bool is_value() const { return op == Opcode::CONST || op == Opcode::UNDEF || op == Opcode::PARAM; }
+        bool is_constant() const { return op == Opcode::CONST; }
+
+        // Whether removing it when unused could change what the program does
+        bool has_side_effects() const {
+            return is_terminator() || op == Opcode::CALL || op == Opcode::PRINT || op == Opcode::TRAP_IF || checked || trapv;
+        }
+    };
+
+    struct Block {
+        std::string label;
+        Function* parent = nullptr;
+        std::vector<std::unique_ptr<Instr>> instrs;
+        std::vector<Block*> preds; // once per incoming edge, in the order phis list them
+
+        Instr* terminator() const {
+            return !instrs.empty() && instrs.back()->is_terminator() ? instrs.back().get() : nullptr;
+        }
+
+        std::vector<Block*> successors() const {
+            Instr* term = terminator();
+            return term ? term->blocks : std::vector<Block*>();
+        }
+
+        std::vector<Instr*> phis() const {
+            std::vector<Instr*> found;
+            for (const auto& instr : instrs) {
+                if (instr->op != Opcode::PHI) break;
+                found.push_back(instr.get());
+            }
+            return found;
+        }
+
+        // Forgets one edge from `pred`, with the phi operands it carried
+        void remove_pred(Block* pred) {
+            auto edge = std::find(preds.begin(), preds.end(), pred);
+            if (edge == preds.end()) return;
+            size_t at = static_cast<size_t>(edge - preds.begin());
+            preds.erase(edge);
+            for (Instr* phi : phis()) {
+                phi->operands.erase(phi->operands.begin() + static_cast<std::ptrdiff_t>(at));
+                phi->blocks.erase(phi->blocks.begin() + static_cast<std::ptrdiff_t>(at));
+            }
+        }
+
+        void erase(Instr* instr) {
+            instrs.erase(std::find_if(instrs.begin(), instrs.end(),
+                                      [&](const std::unique_ptr<Instr>& owned) { return owned.get() == instr; }));
+        }
+    };
+
+    struct Function {
+        std::string name; // the LLVM symbol
+        SereTypeKind return_type = SereTypeKind::NONE;
+        std::vector<Instr*> params;
+        std::vector<std::unique_ptr<Block>> blocks; // the first is the entry
+        std::vector<std::unique_ptr<Instr>> values; // params, constants, undefs
+
+        Block* add_block(const std::string& label) {
+            auto block = std::make_unique<Block>();
+            block->label = unique_label(label);
+            block->parent = this;
+            blocks.push_back(std::move(block));
+            return blocks.back().get();
+        }
+
+        Instr* add_param(const std::string& param, SereTypeKind kind) {
+            auto value = std::make_unique<Instr>(Opcode::PARAM, kind);
+            value->name = param;
+            value->index = static_cast<unsigned>(params.size());
+            params.push_back(value.get());
+            values.push_back(std::move(value));
+            return params.back();
+        }
+
+        // One instance per distinct constant
+        Instr* constant(const ConstValue& value) {
+            auto found = constants_.find(value.key());
+            if (found != constants_.end()) return found->second;
+            auto owned = std::make_unique<Instr>(Opcode::CONST, value.kind);
+            owned->constant = value;
+            Instr* instr = owned.get();
+            values.push_back(std::move(owned));
+            constants_.emplace(value.key(), instr);
+            return instr;
+        }
+
+        Instr* undef(SereTypeKind kind) {
+            auto owned = std::make_unique<Instr>(Opcode::UNDEF, kind);
+            Instr* instr = owned.get();
+            values.push_back(std::move(owned));
+            return instr;
+        }
+
+        void replace_uses(Instr* of, Instr* with) {
+            for (auto& block : blocks)
+                for (auto& instr : block->instrs)
+                    std::replace(instr->operands.begin(), instr->operands.end(), of, with);
+        }
+
+        bool has_uses(const Instr* value) const {
+            for (const auto& block : blocks)
+                for (const auto& instr : block->instrs)
+                    if (std::find(instr->operands.begin(), instr->operands.end(), value) != instr->operands.end())
+                        return true;
+            return false;
+        }
+
+        // Blocks in reverse postorder from the entry; unreachable ones are missing
+        std::vector<Block*> reverse_postorder() const {
+            std::vector<Block*> order;
+            if (blocks.empty()) return order;
+            std::unordered_set<Block*> seen;
+            std::vector<std::pair<Block*, size_t>> stack{{blocks.front().get(), 0}};
+            seen.insert(blocks.front().get());
+            while (!stack.empty()) {
+                auto& [block, next] = stack.back();
+                std::vector<Block*> succs = block->successors();
+                if (next < succs.size()) {
+                    Block* succ = succs[succs.size() - ++next]; // the last successor is finished first, so the first comes first
+                    if (seen.insert(succ).second) stack.emplace_back(succ, 0);
+                    continue;
+                }
+                order.push_back(block);
+                stack.pop_back();
+            }
+            std::reverse(order.begin(), order.end());
+            return order;
+        }
+
+        // Drops blocks the entry cannot reach; true if there were any
+        bool remove_unreachable_blocks() {
+            std::vector<Block*> live = reverse_postorder();
+            std::unordered_set<Block*> reachable(live.begin(), live.end());
+            if (reachable.size() == blocks.size()) return false;
+            for (auto& block : blocks)
+                if (!reachable.count(block.get()))
+                    for (Block* succ : block->successors())
+                        if (reachable.count(succ)) succ->remove_pred(block.get());
+            blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                        [&](const std::unique_ptr<Block>& block) { return !reachable.count(block.get()); }),
+                         blocks.end());
+            return true;
+        }
+
+    private:
+        std::string unique_label(const std::string& label) {
+            unsigned& count = labels_[label];
+            return count++ ? label + "." + std::to_string(count - 1) : label;
+        }
+
+        std::unordered_map<std::string, Instr*> constants_;
+        std::unordered_map<std::string, unsigned> labels_;
+    };
+
+    //
+    // SIR of a compilation: the functions lowered through it, kept only
+    // for --emit=sir, and those lowered directly, with the reason; and
+    // how many overflow checks they had before and after the passes.
+    //
+    struct Module {
+        std::vector<std::unique_ptr<Function>> functions;
+        std::vector<std::pair<std::string, std::string>> direct;
+        unsigned overflow_checks = 0, overflow_checks_kept = 0;
+        bool keep = false;
+        std::optional<std::vector<std::string>> pipeline; // pass names (--sir-passes); the default pipeline when unset
+    };
+
+    // The unsigned type of an integer type's width (u64 for int)
+    inline SereTypeKind unsigned_of(SereTypeKind kind) {
+        switch (Runtime::type_info(kind).bits) {
+        case 8: return SereTypeKind::U8;
+        case 16: return SereTypeKind::U16;
+        case 32: return SereTypeKind::U32;
+        default: return SereTypeKind::U64;
+        }
+    }
+
+} // namespace SereSIR
+
+#endif // SIR_SIR_HPP
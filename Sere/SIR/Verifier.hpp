@@ -0,0 +1,171 @@
+#ifndef SIR_VERIFIER_HPP
+#define SIR_VERIFIER_HPP
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include "./Analysis.hpp"
+#include "./Printer.hpp"
+#include "./SIR.hpp"
+
+namespace SereSIR {
+
+    //
+    // Checks the invariants passes and codegen rely on and throws a
+    // runtime_error naming the first instruction that breaks one:
+    // blocks end in exactly one terminator and start with their phis,
+    // predecessor lists match the branches, phis have one operand per
+    // predecessor, operands have the types their opcode expects and every
+    // use is dominated by its definition.
+    //
+    class Verifier {
+    public:
+        explicit Verifier(const Function& fn) : fn_(fn), printer_(text_) {}
+
+        void verify() {
+            if (fn_.blocks.empty()) fail("function has no blocks");
+            std::unordered_set<const Instr*> defined;
+            for (const auto& value : fn_.values) defined.insert(value.get());
+            for (const auto& block : fn_.blocks)
+                for (const auto& instr : block->instrs) defined.insert(instr.get());
+
+            Dominators dominators(fn_);
+            for (const auto& block : fn_.blocks) {
+                check_edges(*block);
+                bool phis = true;
+                for (const auto& owned : block->instrs) {
+                    const Instr& instr = *owned;
+                    if (instr.parent != block.get()) fail("instruction in the wrong block", &instr);
+                    if (instr.op != Opcode::PHI) phis = false;
+                    else if (!phis) fail("phi after a non-phi instruction", &instr);
+                    if (instr.is_terminator() != (&owned == &block->instrs.back()))
+                        fail(instr.is_terminator() ? "terminator in the middle of a block" : "block does not end in a terminator", &instr);
+                    for (size_t i = 0; i < instr.operands.size(); ++i) {
+                        const Instr* op = instr.operands[i];
+                        if (!op || !defined.count(op)) fail("operand " + std::to_string(i) + " is not a value of this function", &instr);
+                        if (dominators.reachable(block.get()) && !dominators.available(op, &instr, i))
+                            fail("operand " + std::to_string(i) + " does not dominate its use", &instr);
+                    }
+                    check_types(instr);
+                }
+            }
+        }
+
+    private:
+        void check_edges(const Block& block) {
+            std::vector<const Block*> expected;
+            for (const auto& other : fn_.blocks)
+                for (Block* succ : other->successors())
+                    if (succ == &block) expected.push_back(other.get());
+            std::vector<const Block*> actual(block.preds.begin(), block.preds.end());
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            if (expected != actual) fail("predecessors of " + block.label + " do not match the branches to it");
+            for (const Instr* phi : block.phis())
+                if (phi->operands.size() != block.preds.size() || phi->blocks != block.preds)
+                    fail("phi does not have one operand per predecessor", phi);
+            if (block.instrs.empty()) fail("block " + block.label + " is empty");
+        }
+
+        void check_types(const Instr& instr) {
+            auto operand_type = [&](size_t i) { return instr.operands.at(i)->type; };
+            auto expect = [&](bool holds, const char* what) {
+                if (!holds) fail(what, &instr);
+            };
+            auto arity = [&](size_t n) { expect(instr.operands.size() == n, "wrong number of operands"); };
+            switch (instr.op) {
+            case Opcode::BINARY:
+                arity(2);
+                expect(Runtime::is_numeric(instr.type) && operand_type(0) == instr.type, "arithmetic on a non-number or mixed types");
+                if (instr.token == SereLexer::TokenType::TOKEN_DOUBLE_STAR && Runtime::is_float(instr.type))
+                    expect(Runtime::is_numeric(operand_type(1)), "float power of a non-number");
+                else
+                    expect(operand_type(1) == instr.type, "arithmetic on mixed types");
+                expect(!instr.checked || Runtime::is_integer(instr.type), "checked float arithmetic");
+                expect(!instr.trapv || (Runtime::is_integer(instr.type) && (instr.token == SereLexer::TokenType::TOKEN_PLUS ||
+                                                                            instr.token == SereLexer::TokenType::TOKEN_MINUS ||
+                                                                            instr.token == SereLexer::TokenType::TOKEN_STAR ||
+                                                                            instr.token == SereLexer::TokenType::TOKEN_DOUBLE_STAR)),
+                       "overflow check on other than integer + - * **");
+                break;
+            case Opcode::COMPARE:
+                arity(2);
+                expect(instr.type == SereTypeKind::BOOL, "comparison is not a bool");
+                expect(operand_type(0) == operand_type(1), "comparison of mixed types");
+                break;
+            case Opcode::NEG:
+                arity(1);
+                expect(Runtime::is_numeric(instr.type) && operand_type(0) == instr.type, "negation of a non-number");
+                expect(!instr.trapv || Runtime::is_integer(instr.type), "overflow check on a float negation");
+                break;
+            case Opcode::NOT:
+                arity(1);
+                expect(instr.type == SereTypeKind::BOOL && operand_type(0) == SereTypeKind::BOOL, "not of a non-bool");
+                break;
+            case Opcode::CONVERT:
+                arity(1);
+                expect(operand_type(0) != instr.type, "conversion to the same type");
+                break;
+            case Opcode::SELECT:
+                arity(3);
+                expect(operand_type(0) == SereTypeKind::BOOL, "select on a non-bool");
+                expect(operand_type(1) == instr.type && operand_type(2) == instr.type, "select of mixed types");
+                break;
+            case Opcode::PHI:
+                for (const Instr* op : instr.operands) expect(op->type == instr.type, "phi of mixed types");
+                break;
+            case Opcode::TRAP_IF:
+                arity(1);
+                expect(operand_type(0) == SereTypeKind::BOOL, "trap on a non-bool");
+                break;
+            case Opcode::RANGE_NONEMPTY:
+            case Opcode::RANGE_TRIPS:
+                arity(3);
+                expect(Runtime::is_integer(operand_type(0)) && operand_type(1) == operand_type(0) && operand_type(2) == operand_type(0),
+                       "range of mixed or non-integer types");
+                expect(instr.type == (instr.op == Opcode::RANGE_TRIPS ? unsigned_of(operand_type(0)) : SereTypeKind::BOOL),
+                       "range result of the wrong type");
+                break;
+            case Opcode::BR:
+                arity(0);
+                expect(instr.blocks.size() == 1, "br needs one target");
+                break;
+            case Opcode::CONDBR:
+                arity(1);
+                expect(instr.blocks.size() == 2, "condbr needs two targets");
+                expect(operand_type(0) == SereTypeKind::BOOL, "branch on a non-bool");
+                break;
+            case Opcode::RET:
+                expect(instr.operands.size() <= 1, "ret of more than one value");
+                if (!instr.operands.empty())
+                    expect(fn_.return_type != SereTypeKind::NONE && operand_type(0) == fn_.return_type, "ret of the wrong type");
+                break;
+            case Opcode::CALL:
+                break;
+            case Opcode::PRINT:
+                for (const Instr* op : instr.operands)
+                    expect(op->type != SereTypeKind::NONE && op->type != SereTypeKind::UNKNOWN, "print of a value without a type");
+                break;
+            default:
+                fail("value in a block", &instr);
+            }
+        }
+
+        [[noreturn]] void fail(const std::string& what, const Instr* instr = nullptr) {
+            std::string where = instr ? "\n  " + printer_.text(*instr) + (instr->parent ? " (in " + instr->parent->label + ")" : "") : "";
+            throw std::runtime_error("SIR verifier: " + fn_.name + ": " + what + where);
+        }
+
+        const Function& fn_;
+        std::ostringstream text_;
+        Printer printer_;
+    };
+
+    inline void verify(const Function& fn) { Verifier(fn).verify(); }
+
+} // namespace SereSIR
+
+#endif // SIR_VERIFIER_HPP
@@ -203,6 +203,7 @@ private:
         case '&': add_token(match('=') ? TOKEN_AMPERSAND_EQUAL : (match('&') ? TOKEN_DOUBLE_AMPERSAND : TOKEN_AMPERSAND)); break;
         case '^': add_token(match('=') ? TOKEN_CARET_EQUAL : TOKEN_CARET); break;
         case '~': add_token(TOKEN_TILDE); break;
+        case '@': add_token(TOKEN_AT); break;
         case '!': add_token(match('=') ? TOKEN_BANG_EQUAL : TOKEN_BANG); break;
         case '=': add_token(match('=') ? TOKEN_EQUAL_EQUAL : TOKEN_EQUAL); break;
         case '<':
@@ -322,10 +323,11 @@ private:
             }
             try {
                 errno = 0;
-                long long val = std::stoll(num_str, nullptr, base);
-                if (errno == ERANGE || val > std::numeric_limits<int>::max() || val < std::numeric_limits<int>::min())
+                // Scanned as u64; whether the value fits is decided where the literal meets a type
+                unsigned long long val = std::stoull(num_str.substr(2), nullptr, base);
+                if (errno == ERANGE || val > UINT64_MAX)
                     throw std::out_of_range("Integer literal out of range");
-                add_token<int>(TOKEN_INTEGER, static_cast<int>(val));
+                add_token<uint64_t>(TOKEN_INTEGER, static_cast<uint64_t>(val));
             } catch (const std::exception& e) {
                 Error::error(line, std::string("Invalid numeric literal: ") + e.what());
             }
@@ -341,18 +343,20 @@ private:
                 add_token<double>(TOKEN_FLOAT, val);
             } else {
                 errno = 0;
-                long long val = std::stoll(num_str);
-                if (errno == ERANGE || val > std::numeric_limits<int>::max() || val < std::numeric_limits<int>::min())
+                unsigned long long val = std::stoull(num_str);
+                if (errno == ERANGE || val > UINT64_MAX)
                     throw std::out_of_range("Integer literal out of range");
-                add_token<int>(TOKEN_INTEGER, static_cast<int>(val));
+                add_token<uint64_t>(TOKEN_INTEGER, static_cast<uint64_t>(val));
             }
         } catch (const std::exception& e) {
             Error::error(line, std::string("Invalid numeric literal: ") + e.what());
         }
     }
 
-    // Handles single/double/triple quoted strings, escapes, and multi-line
-    void scan_string(char quote_type) {
+    // Handles single/double/triple quoted strings, escapes, and multi-line.
+    // An f-string (`format`) keeps its replacement fields, `{...}` with
+    // any strings in them, as written: the parser reads them.
+    void scan_string(char quote_type, bool format = false) {
         bool triple = false;
         int string_line = line;
         int string_column = column;
@@ -365,12 +369,34 @@ private:
             }
         }
         bool closed = false;
+        int depth = 0;    // of braces in an f-string
+        char nested = 0;  // quote of a string inside a replacement field
         while (!is_at_end()) {
             char c = peek();
             if (!triple && c == '\n') {
                 // Single-line string cannot contain newlines
                 break;
             }
+            if (format && depth == 0 && c == '{' && peek_next() == '{') {
+                value += advance();
+                value += advance();
+                continue;
+            }
+            // Inside a field a nested string takes the other quote, so the
+            // string's own quote still ends a one-line f-string
+            if (format && (depth > 0 || c == '{') && (triple || nested || c != quote_type)) {
+                if (nested) {
+                    if (c == nested) nested = 0;
+                } else if (c == '\'' || c == '"') {
+                    nested = c;
+                } else if (c == '{') {
+                    depth++;
+                } else if (c == '}') {
+                    depth--;
+                }
+                value += advance();
+                continue;
+            }
             if (c == quote_type) {
                 if (triple) {
                     // Only check for triple quote if enough characters remain
@@ -414,7 +440,7 @@ private:
             Error::error(string_line, "Unterminated string literal");
             return;
         }
-        add_token<std::string>(TOKEN_STRING, value);
+        add_token<std::string>(format ? TOKEN_FSTRING : TOKEN_STRING, value);
     }
 
     // Accepts the first character (already read) for correct identifier start
@@ -422,6 +448,10 @@ private:
         std::string text(1, first_char);
         while (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '_')
             text += advance();
+        if ((text == "f" || text == "F") && (peek() == '"' || peek() == '\'')) {
+            scan_string(advance(), true);
+            return;
+        }
         // Check for keyword
         auto it = Tok_keywords.find(text);
         if (it != Tok_keywords.end()) {
@@ -7,6 +7,7 @@
 #include <variant>
 #include <memory>
 #include <any>
+#include <cstdint>
 
 namespace SereLexer {
     
@@ -20,14 +21,18 @@ namespace SereLexer {
     class TokenValue {
         public:
 
-            TokenValue() : INTEGER(0), FLOAT(0.0f), STRING("") {}
-            TokenValue(int value) : INTEGER(value), FLOAT(0.0f), STRING("") {}
+            TokenValue() : INTEGER(0), FLOAT(0.0), STRING("") {}
+            TokenValue(int value) : INTEGER(value), FLOAT(0.0), STRING("") {}
+            TokenValue(int64_t value) : INTEGER(value), FLOAT(0.0), STRING("") {}
+            TokenValue(uint64_t value)
+                : INTEGER(static_cast<int64_t>(value)), INTEGER_U64(value > static_cast<uint64_t>(INT64_MAX)), FLOAT(0.0), STRING("") {}
             TokenValue(float value) : INTEGER(0), FLOAT(value), STRING("") {}
-            TokenValue(double value) : INTEGER(0), FLOAT(static_cast<float>(value)), STRING("") {}
-            TokenValue(const std::string& value) : INTEGER(0), FLOAT(0.0f), STRING(value) {}
+            TokenValue(double value) : INTEGER(0), FLOAT(value), STRING("") {}
+            TokenValue(const std::string& value) : INTEGER(0), FLOAT(0.0), STRING(value) {}
 
-            const int INTEGER;
-            const float FLOAT;
+            const int64_t INTEGER;  // `int` is 64-bit
+            const bool INTEGER_U64 = false; // INTEGER holds the bits of a literal above 2**63-1, which only u64 can hold
+            const double FLOAT;     // `float` is a double
             const std::string STRING;
     };
 
@@ -25,7 +25,7 @@ namespace SereLexer {
         TOKEN_LEFT_BRACKET, TOKEN_RIGHT_BRACKET,
         TOKEN_COMMA, TOKEN_DOT, TOKEN_MINUS, TOKEN_PLUS, TOKEN_SEMICOLON,
         TOKEN_SLASH, TOKEN_STAR, TOKEN_PERCENT, TOKEN_COLON,
-        TOKEN_PIPE, TOKEN_AMPERSAND, TOKEN_CARET, TOKEN_TILDE,
+        TOKEN_PIPE, TOKEN_AMPERSAND, TOKEN_CARET, TOKEN_TILDE, TOKEN_AT,
 
         // Compound/special tokens
         TOKEN_ARROW, // '->'
@@ -43,7 +43,7 @@ namespace SereLexer {
         TOKEN_RIGHT_SHIFT, TOKEN_RIGHT_SHIFT_EQUAL,
 
         // Literals
-        TOKEN_IDENTIFIER, TOKEN_STRING, TOKEN_INTEGER, TOKEN_FLOAT,
+        TOKEN_IDENTIFIER, TOKEN_STRING, TOKEN_FSTRING, TOKEN_INTEGER, TOKEN_FLOAT,
 
         // Keywords (add more as needed)
         TOKEN_AND, TOKEN_AS, TOKEN_ASSERT, TOKEN_BREAK, TOKEN_CLASS, TOKEN_CONTINUE,
@@ -63,7 +63,7 @@ namespace SereLexer {
     };
 
     // Update this value if you add/remove tokens above
-    SERE_STATIC_ASSERT_ENUM_SIZE(89);
+    SERE_STATIC_ASSERT_ENUM_SIZE(91);
 
 }
 
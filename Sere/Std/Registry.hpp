@@ -10,6 +10,8 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Type.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 
 #include "./Standard.hpp"
@@ -28,19 +30,41 @@ namespace SereLib {
         get_library_registry()[lib_name] = std::move(func);
     }
 
+    // Libraries are built once per LLVMContext into a private module and
+    // cloned into every compilation afterwards, so warm sessions skip codegen.
     inline void include_lib(const std::string& lib) {
-        auto &module = *SereParser::RT::ctx.get_module();
+        auto &ctx = SereParser::RT::ctx;
+        auto &module = *ctx.get_module();
 
-        auto &reg = get_library_registry();
-        auto it = reg.find(lib);
-        if (it == reg.end()) {
-            throw std::domain_error("Cannot find library " + lib + " in the std registry.");
-        }        
+        auto cached = ctx.lib_cache.find(lib);
+        if (cached == ctx.lib_cache.end()) {
+            auto &reg = get_library_registry();
+            auto it = reg.find(lib);
+            if (it == reg.end()) {
+                throw std::domain_error("Cannot find library " + lib + " in the std registry.");
+            }
 
-        it->second(module, SereParser::RT::ctx.llvm_ctx);
+            auto lib_module = std::make_unique<llvm::Module>("__lib_" + lib + "__", ctx.llvm_ctx);
+            it->second(*lib_module, ctx.llvm_ctx);
+            cached = ctx.lib_cache.emplace(lib, std::move(lib_module)).first;
+        }
+
+        if (llvm::Linker::linkModules(module, llvm::CloneModule(*cached->second))) {
+            throw std::runtime_error("Failed to link library " + lib + " into " + module.getName().str());
+        }
+        ctx.constants.adopt(module); // literals equal to library strings share them
+
+        for (auto &func : *cached->second) {
+            if (func.isDeclaration()) continue;
+            // Every module carries its own copy; the linker keeps one
+            llvm::Function *linked = module.getFunction(func.getName());
+            linked->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
+            ctx.set_named_value(func.getName().str(), linked);
+        }
     }
 
     inline void load_registry() {
+        if (get_library_registry().count("core")) return; // already loaded
         register_library("core", init_core);
 
     }
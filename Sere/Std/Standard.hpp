@@ -1,85 +1,239 @@
 #ifndef STD_STANDARD_HPP
 #define STD_STANDARD_HPP
 
+#include <cstdint>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Type.h>
 
 #include "../Parser/AST/Visitor.hpp"
+
+//
+// The core library: `print` and the output runtime behind it. Output
+// goes to a 64 KB per-thread buffer rather than through stdio, and
+// reaches stdout with write(2) when the buffer fills up and when the
+// program's entry code returns (flush_output_on_return). The buffer is
+// linkonce_odr, so every module of a program appends to the same one
+// and lines come out in the order they were printed. A trap flushes the
+// buffer before it stops the program (flush_output_before_traps), so
+// what was printed up to a runtime error is not lost. print calls with
+// anything but one str are expanded where they are made (IR/Format.hpp).
+//
 namespace SereLib {
 
-    llvm::Function* declare_printf(llvm::Module& module, llvm::LLVMContext& context);
+    using SereIR::FLUSH_STDOUT;
+    using SereIR::STDOUT_BUFFER_SIZE;
+
+    llvm::Function* define_write_all(llvm::Module& module, llvm::LLVMContext& context);
+    llvm::Function* define_flush_stdout(llvm::Module& module, llvm::LLVMContext& context);
+    llvm::Function* define_print_slow(llvm::Module& module, llvm::LLVMContext& context);
     llvm::Value* print_init_builtin(llvm::Module& module, llvm::LLVMContext& context);
+    void flush_output_on_return(llvm::Module& module, const std::vector<std::string>& entry_points);
+    void flush_output_before_traps(llvm::Module& module);
     void init_core(llvm::Module& module, llvm::LLVMContext& context);
 
-    llvm::Function* declare_printf(llvm::Module& module, llvm::LLVMContext& context) {
-        static llvm::Function* printfFunc = nullptr;
-        if (printfFunc) return printfFunc; // already declared
-
-        llvm::FunctionType* printfType = llvm::FunctionType::get(
-            llvm::Type::getInt32Ty(context),                                  // returns int
-            llvm::PointerType::get(llvm::Type::getInt8Ty(context), 0),        // char*
-            true                                                              // variadic
-        );
+    // void __sere_write_all(i8* data, i64 size): write(2) to stdout until done or it fails
+    llvm::Function* define_write_all(llvm::Module& module, llvm::LLVMContext& context) {
+        llvm::IRBuilder<> builder(context);
+        auto* i64 = builder.getInt64Ty();
+        auto* i8ptr = builder.getInt8PtrTy();
+        llvm::FunctionCallee write = module.getOrInsertFunction("write", i64, builder.getInt32Ty(), i8ptr, i64);
 
-        printfFunc = llvm::Function::Create(
-            printfType, llvm::Function::ExternalLinkage, "printf", &module
-        );
+        auto* write_all = llvm::Function::Create(llvm::FunctionType::get(builder.getVoidTy(), {i8ptr, i64}, false),
+                                                 llvm::Function::ExternalLinkage, "__sere_write_all", &module);
+        auto* entry = llvm::BasicBlock::Create(context, "entry", write_all);
+        auto* loop = llvm::BasicBlock::Create(context, "loop", write_all);
+        auto* next = llvm::BasicBlock::Create(context, "next", write_all);
+        auto* done = llvm::BasicBlock::Create(context, "done", write_all);
 
-        return printfFunc;
+        builder.SetInsertPoint(entry);
+        builder.CreateBr(loop);
+
+        builder.SetInsertPoint(loop);
+        auto* data = builder.CreatePHI(i8ptr, 2, "data");
+        auto* left = builder.CreatePHI(i64, 2, "left");
+        data->addIncoming(write_all->getArg(0), entry);
+        left->addIncoming(write_all->getArg(1), entry);
+        builder.CreateCondBr(builder.CreateICmpEQ(left, builder.getInt64(0)), done, next);
+
+        builder.SetInsertPoint(next);
+        llvm::Value* written = builder.CreateCall(write, {builder.getInt32(1), data, left}, "written");
+        data->addIncoming(builder.CreateGEP(builder.getInt8Ty(), data, written), next);
+        left->addIncoming(builder.CreateSub(left, written), next);
+        builder.CreateCondBr(builder.CreateICmpSGT(written, builder.getInt64(0)), loop, done);
+
+        builder.SetInsertPoint(done);
+        builder.CreateRetVoid();
+        return write_all;
     }
 
-    llvm::Value* print_init_builtin(llvm::Module& module, llvm::LLVMContext& context) {
+    // void __sere_flush_stdout(): writes out and empties the buffer
+    llvm::Function* define_flush_stdout(llvm::Module& module, llvm::LLVMContext& context) {
         llvm::IRBuilder<> builder(context);
+        auto* i64 = builder.getInt64Ty();
+        auto* buffer_ty = SereIR::stdout_buffer_type(context);
+        auto* buffer = SereIR::stdout_buffer(module);
+        auto* used = SereIR::stdout_used(module);
+
+        auto* flush = llvm::Function::Create(llvm::FunctionType::get(builder.getVoidTy(), false),
+                                             llvm::Function::ExternalLinkage, FLUSH_STDOUT, &module);
+        builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", flush));
+        builder.CreateCall(module.getFunction("__sere_write_all"),
+                           {builder.CreateConstInBoundsGEP2_64(buffer_ty, buffer, 0, 0), builder.CreateLoad(i64, used)});
+        builder.CreateStore(builder.getInt64(0), used);
+        builder.CreateRetVoid();
+        return flush;
+    }
 
-        // Function type: void (i8*)
-        llvm::FunctionType* print_ty = llvm::FunctionType::get(
-            llvm::Type::getVoidTy(context),
-            { llvm::Type::getInt8PtrTy(context) }, // single i8* argument
-            false
-        );
-
-        llvm::Function* print_def = llvm::Function::Create(
-            print_ty, llvm::Function::ExternalLinkage, "print", &module
-        );
+    //
+    // void __sere_print_slow(i8* text, i64 length): print for a line that
+    // does not fit what is left of the buffer. The buffer is flushed; a
+    // line longer than all of it is written directly.
+    //
+    llvm::Function* define_print_slow(llvm::Module& module, llvm::LLVMContext& context) {
+        llvm::IRBuilder<> builder(context);
+        auto* i64 = builder.getInt64Ty();
+        auto* i8ptr = builder.getInt8PtrTy();
+        auto* buffer_ty = SereIR::stdout_buffer_type(context);
+        auto* buffer = SereIR::stdout_buffer(module);
+        auto* used = SereIR::stdout_used(module);
+
+        auto* slow = llvm::Function::Create(llvm::FunctionType::get(builder.getVoidTy(), {i8ptr, i64}, false),
+                                            llvm::Function::ExternalLinkage, "__sere_print_slow", &module);
+        slow->addFnAttr(llvm::Attribute::NoInline);
+        slow->addFnAttr(llvm::Attribute::Cold);
+        llvm::Value* text = slow->getArg(0);
+        llvm::Value* length = slow->getArg(1);
+        auto* entry = llvm::BasicBlock::Create(context, "entry", slow);
+        auto* copy = llvm::BasicBlock::Create(context, "copy", slow);
+        auto* direct = llvm::BasicBlock::Create(context, "direct", slow);
 
-        llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", print_def);
         builder.SetInsertPoint(entry);
+        builder.CreateCall(module.getFunction(FLUSH_STDOUT));
+        builder.CreateCondBr(builder.CreateICmpULT(length, builder.getInt64(STDOUT_BUFFER_SIZE)), copy, direct);
+
+        builder.SetInsertPoint(copy);
+        llvm::Value* start = builder.CreateConstInBoundsGEP2_64(buffer_ty, buffer, 0, 0);
+        builder.CreateMemCpy(start, llvm::MaybeAlign(1), text, llvm::MaybeAlign(1), length);
+        builder.CreateStore(builder.getInt8('\n'), builder.CreateInBoundsGEP(builder.getInt8Ty(), start, length));
+        builder.CreateStore(builder.CreateAdd(length, builder.getInt64(1)), used);
+        builder.CreateRetVoid();
 
-        llvm::Function* printf_func = declare_printf(module, context);
+        builder.SetInsertPoint(direct);
+        llvm::Function* write_all = module.getFunction("__sere_write_all");
+        builder.CreateCall(write_all, {text, length});
+        builder.CreateCall(write_all, {builder.CreateGlobalStringPtr("\n", ".newline", 0, &module), builder.getInt64(1)});
+        builder.CreateRetVoid();
+        return slow;
+    }
 
-        llvm::Argument* arg_str = &*print_def->arg_begin();
-        arg_str->setName("_format");
+    //
+    // print(str): the line and its newline are copied into the buffer, or
+    // handed to __sere_print_slow when they do not fit. That leaves a
+    // bounds check and a memcpy to inline, of a constant length for a
+    // literal.
+    //
+    llvm::Value* print_init_builtin(llvm::Module& module, llvm::LLVMContext& context) {
+        llvm::IRBuilder<> builder(context);
+        auto* i8 = builder.getInt8Ty();
+        auto* i64 = builder.getInt64Ty();
+        auto* i8ptr = builder.getInt8PtrTy();
+        auto* buffer_ty = SereIR::stdout_buffer_type(context);
+        auto* buffer = SereIR::stdout_buffer(module);
+        auto* used = SereIR::stdout_used(module);
+        llvm::FunctionCallee strlen = module.getOrInsertFunction("strlen", i64, i8ptr);
 
-        llvm::Constant* format_str = llvm::ConstantDataArray::getString(context, "%s\n", true);
-        llvm::GlobalVariable* format_var = new llvm::GlobalVariable(
-            module,
-            format_str->getType(),
-            true,
-            llvm::GlobalValue::PrivateLinkage,
-            format_str,
-            ".str"
+        llvm::Function* print_def = llvm::Function::Create(
+            llvm::FunctionType::get(builder.getVoidTy(), {i8ptr}, false),
+            llvm::Function::ExternalLinkage, "print", &module
         );
+        llvm::Argument* text = print_def->getArg(0);
+        text->setName("_text");
 
-        llvm::Constant* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0);
-        llvm::Constant* indices[] = { zero, zero };
-        llvm::Constant* format_str_ptr = llvm::ConstantExpr::getGetElementPtr(
-            format_str->getType(), format_var, indices
-        );
+        auto* entry = llvm::BasicBlock::Create(context, "entry", print_def);
+        auto* copy = llvm::BasicBlock::Create(context, "copy", print_def);
+        auto* slow = llvm::BasicBlock::Create(context, "slow", print_def);
 
-        builder.CreateCall(printf_func, { format_str_ptr, arg_str });
+        builder.SetInsertPoint(entry);
+        llvm::Value* length = builder.CreateCall(strlen, {text}, "length");
+        llvm::Value* start = builder.CreateLoad(i64, used, "used");
+        llvm::Value* end = builder.CreateAdd(start, builder.CreateAdd(length, builder.getInt64(1)), "end");
+        llvm::Value* fits = builder.CreateICmpULE(end, builder.getInt64(STDOUT_BUFFER_SIZE));
+        builder.CreateCondBr(fits, copy, slow, llvm::MDBuilder(context).createBranchWeights(1u << 20, 1));
+
+        builder.SetInsertPoint(copy);
+        llvm::Value* dest = builder.CreateInBoundsGEP(buffer_ty, buffer, {builder.getInt64(0), start});
+        builder.CreateMemCpy(dest, llvm::MaybeAlign(1), text, llvm::MaybeAlign(1), length);
+        builder.CreateStore(builder.getInt8('\n'), builder.CreateInBoundsGEP(i8, dest, length));
+        builder.CreateStore(end, used);
+        builder.CreateRetVoid();
+
+        builder.SetInsertPoint(slow);
+        builder.CreateCall(module.getFunction("__sere_print_slow"), {text, length});
         builder.CreateRetVoid();
 
         return print_def;
     }
 
+    //
+    // Flushes the output buffer wherever the given functions (the module's
+    // init, __main__) return, which is where a program ends. Their tail
+    // call, if any, no longer is one.
+    //
+    void flush_output_on_return(llvm::Module& module, const std::vector<std::string>& entry_points) {
+        llvm::Function* flush = module.getFunction(FLUSH_STDOUT);
+        if (!flush) return;
+        for (const auto& name : entry_points) {
+            llvm::Function* func = module.getFunction(name);
+            if (!func || func->isDeclaration()) continue;
+            for (auto& block : *func) {
+                auto* ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator());
+                if (!ret) continue;
+                if (auto* call = block.getTerminatingMustTailCall())
+                    call->setTailCallKind(llvm::CallInst::TCK_None);
+                else if (auto* call = llvm::dyn_cast_or_null<llvm::CallInst>(ret->getPrevNode()))
+                    call->setTailCallKind(llvm::CallInst::TCK_None);
+                llvm::CallInst::Create(flush, "", ret);
+            }
+        }
+    }
+
+    //
+    // Flushes the output buffer right before every llvm.trap the module
+    // contains: division by zero, overflow under --checked-arith, a
+    // negative `**` exponent, a `dyn` type error. The call is cold and
+    // never inlined, so trap paths stay small; infer_effects counts it as
+    // part of the trap.
+    //
+    void flush_output_before_traps(llvm::Module& module) {
+        llvm::Function* flush = module.getFunction(FLUSH_STDOUT);
+        if (!flush) return;
+        std::vector<llvm::CallInst*> traps;
+        for (auto& func : module)
+            for (auto& block : func)
+                for (auto& inst : block)
+                    if (auto* call = llvm::dyn_cast<llvm::CallInst>(&inst))
+                        if (call->getIntrinsicID() == llvm::Intrinsic::trap) traps.push_back(call);
+        for (auto* trap : traps) {
+            auto* call = llvm::CallInst::Create(flush, "", trap);
+            call->addFnAttr(llvm::Attribute::Cold);
+            call->addFnAttr(llvm::Attribute::NoInline);
+        }
+    }
+
     void init_core(llvm::Module& module, llvm::LLVMContext& context) {
-        SereParser::RT::ctx.set_named_value("print", print_init_builtin(module, context));
+        define_write_all(module, context);
+        define_flush_stdout(module, context);
+        define_print_slow(module, context);
+        print_init_builtin(module, context);
     }
 
 }
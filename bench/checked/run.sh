@@ -0,0 +1,28 @@
+#!/bin/sh
+# --checked-arith on the benchmark corpus: how many overflow checks the
+# range analysis removes, and what the rest cost on the loop kernels.
+#   bench/checked/run.sh [path/to/sere] [runs]
+set -e
+SERE=${1:-sere}
+RUNS=${2:-5}
+DIR=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+for file in "$DIR"/*/*.sere; do
+    checks=$("$SERE" compile "$file" --emit=sir --checked-arith | sed -n 's/^; overflow checks: //p')
+    echo "$(basename "$file"): ${checks:-no checks}"
+done
+
+cd "$WORK"
+"$SERE" build "$DIR/loops/loops.sere" -O2 --build-dir=plain.d -o plain
+"$SERE" build "$DIR/loops/loops.sere" -O2 --build-dir=checked.d --checked-arith -o checked
+
+time_runs() {
+    start=$(date +%s%N)
+    i=0
+    while [ $i -lt "$RUNS" ]; do status=0; ./"$1" >/dev/null || status=$?; i=$((i + 1)); done
+    echo "$(( ($(date +%s%N) - start) / RUNS / 1000000 )) ms/run (checksum $status)"
+}
+echo "wrapping: $(time_runs plain)"
+echo "checked:  $(time_runs checked)"
@@ -0,0 +1,50 @@
+/* The same kernels as loops.sere, for `cc -O2`. */
+#include <stdint.h>
+#include <stdio.h>
+
+static int64_t shifts(int64_t n)
+{
+    int64_t s = 0;
+    for (int64_t i = 0; i < n; i++)
+        s = s + i / 8 - i / 32;
+    return s;
+}
+
+static int64_t strided(int64_t n)
+{
+    int64_t s = 0;
+    for (int64_t i = n; i > 0; i -= 3)
+        s = s + i / 5 - i / 11;
+    return s;
+}
+
+static int64_t triangle(int64_t n)
+{
+    int64_t s = 0;
+    for (int64_t i = 0; i < n; i++)
+        for (int64_t j = 0; j < i; j++)
+            s = s + (i + j) / 3;
+    return s;
+}
+
+static int64_t collatz(int64_t n)
+{
+    int64_t total = 0;
+    for (int64_t i = 1; i < n; i++) {
+        int64_t x = i;
+        while (x != 1) {
+            if (x / 2 * 2 == x)
+                x = x / 2;
+            else
+                x = 3 * x + 1;
+            total = total + 1;
+        }
+    }
+    return total;
+}
+
+int main(void)
+{
+    puts("loops");
+    return (int)(shifts(2000000000) + strided(600000000) + triangle(30000) + collatz(1000000));
+}
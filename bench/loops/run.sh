@@ -0,0 +1,24 @@
+#!/bin/sh
+# Loop kernels in Sere vs. the same kernels in C, both at -O2.
+#   bench/loops/run.sh [path/to/sere] [runs] [cc]
+set -e
+SERE=${1:-sere}
+RUNS=${2:-5}
+CC=${3:-cc}
+DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+"$SERE" build "$DIR/loops.sere" -O2 --build-dir=sere.d -o sere_loops
+"$CC" -O2 "$DIR/loops.c" -o c_loops
+
+# Both return the same checksum as their exit status
+time_runs() {
+    start=$(date +%s%N)
+    i=0
+    while [ $i -lt "$RUNS" ]; do status=0; ./"$1" >/dev/null || status=$?; i=$((i + 1)); done
+    echo "$(( ($(date +%s%N) - start) / RUNS / 1000000 )) ms/run (checksum $status)"
+}
+echo "sere: $(time_runs sere_loops)"
+echo "c:    $(time_runs c_loops)"
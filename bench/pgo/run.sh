@@ -0,0 +1,26 @@
+#!/bin/sh
+# Baseline vs. profile-guided build of bench.sere.
+#   bench/pgo/run.sh [path/to/sere] [runs]
+set -e
+SERE=${1:-sere}
+RUNS=${2:-10}
+DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+"$SERE" build "$DIR/bench.sere" -O2 --build-dir=base.d -o base
+"$SERE" build "$DIR/bench.sere" -O2 --build-dir=instr.d -o instr --pgo-instrument
+SERE_PROFILE_FILE=bench.proftext ./instr >/dev/null
+llvm-profdata merge -o bench.profdata bench.proftext
+"$SERE" build "$DIR/bench.sere" -O2 --build-dir=pgo.d -o pgo --pgo-use=bench.profdata
+
+time_runs() {
+    start=$(date +%s%N)
+    i=0
+    while [ $i -lt "$RUNS" ]; do ./"$1" >/dev/null || true; i=$((i + 1)); done
+    echo $(( ($(date +%s%N) - start) / RUNS / 1000000 ))
+}
+echo "baseline: $(time_runs base) ms/run"
+echo "pgo:      $(time_runs pgo) ms/run"
+size base pgo
@@ -0,0 +1,14 @@
+/* The same output through printf, parsing its format string on every call. */
+#include <stdio.h>
+
+static void table(long n) {
+    for (long i = 0; i < n; i++) {
+        printf("row %ld: %ld\n", i, i * 7919 - 1000000);
+        printf("%ld %ld %s\n", i, i * i, i % 3 == 0 ? "True" : "False");
+    }
+}
+
+int main(void) {
+    table(2000000);
+    return 0;
+}
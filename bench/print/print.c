@@ -0,0 +1,16 @@
+/* The same output through printf("%s\n"), as Sere's print did before. */
+#include <stdio.h>
+
+static void log_batch(long n) {
+    for (long i = 0; i < n; i++) {
+        printf("%s\n", "INFO  request handled");
+        printf("%s\n", "DEBUG cache hit");
+        if (i % 16 == 0)
+            printf("%s\n", "WARN  slow backend response, retrying with a fresh connection");
+    }
+}
+
+int main(void) {
+    log_batch(2000000);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/sh
+# print throughput: Sere's buffered output vs. printf in C, both at -O2,
+# written to a file (a pipe or file is where batch jobs log to), for log
+# lines (print.sere) and for formatted numbers (numbers.sere).
+#   bench/print/run.sh [path/to/sere] [runs] [cc]
+set -e
+SERE=${1:-sere}
+RUNS=${2:-5}
+CC=${3:-cc}
+DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+time_runs() {
+    start=$(date +%s%N)
+    i=0
+    while [ $i -lt "$RUNS" ]; do ./"$1" >"$1.out"; i=$((i + 1)); done
+    echo "$(( ($(date +%s%N) - start) / RUNS / 1000000 )) ms/run ($(wc -c <"$1.out") bytes)"
+}
+
+for bench in print numbers; do
+    "$SERE" build "$DIR/$bench.sere" -O2 --build-dir=sere.d -o "sere_$bench"
+    "$CC" -O2 -fno-builtin-printf "$DIR/$bench.c" -o "c_$bench"
+    echo "$bench"
+    echo "  sere:   $(time_runs "sere_$bench")"
+    echo "  printf: $(time_runs "c_$bench")"
+    cmp -s "sere_$bench.out" "c_$bench.out" && echo "  same output" || echo "  OUTPUT DIFFERS"
+done
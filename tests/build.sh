@@ -0,0 +1,18 @@
+#!/bin/sh
+# Builds a multi-module program from tests/build/<name>/app.sere at -O0 and
+# -O2 and compares what the executable prints with app.out.
+#   tests/build.sh path/to/sere tests/build/<name>
+SERE=$1
+DIR=$2
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+for opt in -O0 -O2; do
+    "$SERE" build "$DIR/app.sere" $opt --build-dir="$WORK/build$opt" -o "$WORK/app$opt" 2>"$WORK/log" || { cat "$WORK/log"; echo "$DIR $opt: build failed"; exit 1; }
+    out=$("$WORK/app$opt")
+    status=$?
+    if [ $status -ne 0 ]; then
+        echo "$DIR $opt: exit status $status"
+        exit 1
+    fi
+    printf '%s\n' "$out" | diff -u "$DIR/app.out" - || { echo "$DIR $opt: output differs"; exit 1; }
+done
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Compiles a program to an -O2 object without and with --cache-dir (once
+# filling the cache, once from it) and checks that the three objects hold
+# the same code and symbols. Each is linked into a shared object to resolve
+# its calls; addresses and padding are left out, since the cached object is
+# relinked from per-function pieces.
+#   tests/cache.sh path/to/sere tests/cache/<name>.sere
+SERE=$1
+PROGRAM=$2
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Linked into a shared object, every call names its target
+code() {
+    ld -shared -o "$1.so" "$1" || exit 1
+    objdump -d --no-show-raw-insn "$1.so" | sed -n 's/^ *[0-9a-f]*:\t//p' |
+        sed 's/ *#.*//; s/-*0x[0-9a-f]*(%rip)/(%rip)/g; s/[0-9a-f]* <\([^+>]*\)>/<\1>/; s/[0-9a-f]* <\([^>]*\)>/<\1>/' | grep -v '^nop'
+    nm "$1" | cut -c18- | grep -v ' \.L'
+}
+
+"$SERE" compile "$PROGRAM" -O2 --emit=obj -o "$WORK/plain.o" || exit 1
+code "$WORK/plain.o" > "$WORK/plain.txt"
+for pass in fill hit; do
+    "$SERE" compile "$PROGRAM" -O2 --emit=obj --cache-dir="$WORK/cache" -o "$WORK/$pass.o" || exit 1
+    code "$WORK/$pass.o" > "$WORK/$pass.txt"
+    diff -u "$WORK/plain.txt" "$WORK/$pass.txt" || { echo "$PROGRAM: cached object differs ($pass)"; exit 1; }
+done
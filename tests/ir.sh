@@ -0,0 +1,9 @@
+#!/bin/sh
+# Compiles an IR test at -O0 and matches the emitted LLVM IR against the
+# "# CHECK:" lines in the program itself.
+#   tests/ir.sh path/to/sere path/to/FileCheck tests/ir/<name>.sere
+SERE=$1
+FILECHECK=$2
+PROGRAM=$3
+set -e
+"$SERE" compile "$PROGRAM" -O0 --emit=ir -o - | "$FILECHECK" "$PROGRAM"
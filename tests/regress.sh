@@ -0,0 +1,19 @@
+#!/bin/sh
+# Runs a regression program with `sere run` at -O0 and -O2, adding the flags
+# on its "# flags:" line, and compares what it prints with <name>.out. A
+# "# status:" line gives the expected exit status (a trap: 132, SIGILL).
+#   tests/regress.sh path/to/sere tests/regress/<name>.sere
+SERE=$1
+PROGRAM=$2
+EXPECTED=${PROGRAM%.sere}.out
+FLAGS=$(sed -n 's/^# flags: //p' "$PROGRAM")
+STATUS=$(sed -n 's/^# status: //p' "$PROGRAM")
+for opt in -O0 -O2; do
+    out=$("$SERE" run $opt $FLAGS "$PROGRAM")
+    status=$?
+    if [ $status -ne "${STATUS:-0}" ]; then
+        echo "$PROGRAM $opt $FLAGS: exit status $status"
+        exit 1
+    fi
+    printf '%s\n' "$out" | diff -u "$EXPECTED" - || { echo "$PROGRAM $opt $FLAGS: output differs"; exit 1; }
+done